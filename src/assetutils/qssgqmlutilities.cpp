@@ -383,7 +383,9 @@ struct OutputContext
     {
         None,
         ExpandValueComponents = 0x1,
-        DesignStudioWorkarounds = ExpandValueComponents | 0x2
+        DesignStudioWorkarounds = ExpandValueComponents | 0x2,
+        CompressMeshes = 0x4,
+        QuantizeMeshes = CompressMeshes | 0x8
     };
     QTextStream &stream;
     QDir outdir;
@@ -803,7 +805,7 @@ QString asString(QSSGSceneDesc::Animation::Channel::TargetProperty prop)
     return QStringLiteral("unknown");
 }
 
-static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &scene, const QSSGSceneDesc::Mesh &meshNode, const QDir &outdir)
+static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &scene, const QSSGSceneDesc::Mesh &meshNode, const QDir &outdir, QSSGMesh::Mesh::SaveFlags saveFlags)
 {
     // Returns {name, notValidReason}
 
@@ -825,7 +827,7 @@ static std::pair<QString, QString> meshAssetName(const QSSGSceneDesc::Scene &sce
         return {QString(), QStringLiteral("Failed to find mesh at ") + path};
     }
 
-    if (mesh.save(&file) == 0) {
+    if (mesh.save(&file, 0, saveFlags) == 0) {
         return {};
     }
 
@@ -1060,7 +1062,12 @@ static ValueToQmlResult valueToQml(const QSSGSceneDesc::Node &target, const QSSG
             Q_ASSERT(meshNode->nodeType == QSSGSceneDesc::Node::Type::Mesh);
             Q_ASSERT(meshNode->scene);
             const auto &scene = *meshNode->scene;
-            const auto& [meshSourceName, notValidReason] = meshAssetName(scene, *meshNode, output.outdir);
+            QSSGMesh::Mesh::SaveFlags saveFlags;
+            if ((output.options & OutputContext::Options::QuantizeMeshes) == OutputContext::Options::QuantizeMeshes)
+                saveFlags |= QSSGMesh::Mesh::SaveQuantized;
+            else if (output.options & OutputContext::Options::CompressMeshes)
+                saveFlags |= QSSGMesh::Mesh::SaveCompressed;
+            const auto& [meshSourceName, notValidReason] = meshAssetName(scene, *meshNode, output.outdir, saveFlags);
             result.notValidReason = notValidReason;
             if (!meshSourceName.isEmpty()) {
                 result.value = toQuotedString(meshSourceName);
@@ -1594,6 +1601,12 @@ void writeQml(const QSSGSceneDesc::Scene &scene, QTextStream &stream, const QDir
     if (checkBooleanOption(QLatin1String("designStudioWorkarounds"), options))
         outputOptions |= OutputContext::Options::DesignStudioWorkarounds;
 
+    if (checkBooleanOption(QLatin1String("compressMeshes"), options)) {
+        outputOptions |= OutputContext::Options::CompressMeshes;
+        if (checkBooleanOption(QLatin1String("quantizeCompressedMeshes"), options))
+            outputOptions |= OutputContext::Options::QuantizeMeshes;
+    }
+
     const bool useBinaryKeyframes = checkBooleanOption("useBinaryKeyframes"_L1, options);
     const bool generateTimelineAnimations = !checkBooleanOption("manualAnimations"_L1, options);
 
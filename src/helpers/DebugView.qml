@@ -127,6 +127,11 @@ Pane {
                             text: root.source.renderStats.drawVertexCount + " vertices"
                             visible: root.resourceDetailsVisible
                         }
+                        Label {
+                            text: "Occlusion culled: " + root.source.renderStats.occlusionCulledCount
+                                  + " objects, " + root.source.renderStats.occlusionCulledShadowCasterCount + " shadow casters"
+                            visible: root.resourceDetailsVisible && root.source.environment && root.source.environment.occlusionCullingEnabled
+                        }
                         Label {
                             text: "Image assets: " + (root.source.renderStats.imageDataSize / 1024).toFixed(2) + " KB"
                             visible: root.resourceDetailsVisible
@@ -137,6 +142,15 @@ Pane {
                         }
                         Label {
                             text: "Pipelines: " + root.source.renderStats.pipelineCount
+                                  + " (" + root.source.renderStats.pipelineCacheHitCount + " hits, "
+                                  + root.source.renderStats.pipelineCacheMissCount + " misses)"
+                            visible: root.resourceDetailsVisible
+                        }
+                        Label {
+                            text: "Binding sets: " + root.source.renderStats.srbCount
+                                  + ", draw data: " + root.source.renderStats.drawCallDataCount
+                                  + ", instance buffers: " + root.source.renderStats.instanceBufferCount
+                                  + " (" + root.source.renderStats.evictedCacheEntryCount + " evicted)"
                             visible: root.resourceDetailsVisible
                         }
                         Label {
@@ -126,6 +126,7 @@ struct SceneInfo
         bool useFloatJointIndices = false;
         bool generateLightmapUV = false;
         bool designStudioWorkarounds = false;
+        bool quantizeVertexData = false;
 
         int lightmapBaseResolution = 1024;
         float globalScaleValue = 1.0;
@@ -1175,6 +1176,8 @@ static void setModelProperties(QSSGSceneDesc::Model &target, const aiNode &sourc
                                                       sceneInfo.opt.lodNormalMergeAngle,
                                                       sceneInfo.opt.lodNormalSplitAngle,
                                                       errorString);
+        if (sceneInfo.opt.quantizeVertexData)
+            meshData.quantizeVertexData();
         meshStorage.push_back(std::move(meshData));
 
         const auto idx = meshStorage.size() - 1;
@@ -1530,6 +1533,7 @@ static SceneInfo::Options processSceneOptions(const QJsonObject &optionsObject)
     sceneOptions.useFloatJointIndices = checkBooleanOption(QStringLiteral("useFloatJointIndices"), options);
     sceneOptions.forceMipMapGeneration = checkBooleanOption(QStringLiteral("generateMipMaps"), options);
     sceneOptions.binaryKeyframes = checkBooleanOption(QStringLiteral("useBinaryKeyframes"), options);
+    sceneOptions.quantizeVertexData = checkBooleanOption(QStringLiteral("quantizeVertexData"), options);
 
     sceneOptions.generateLightmapUV = checkBooleanOption(QStringLiteral("generateLightmapUV"), options);
     if (sceneOptions.generateLightmapUV) {
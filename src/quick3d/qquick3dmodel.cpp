@@ -537,6 +537,7 @@ void QQuick3DModel::setSource(const QUrl &source)
     m_source = source;
     emit sourceChanged();
     markDirty(SourceDirty);
+    setStatus(m_source.isEmpty() ? Null : Loading);
     if (QQuick3DObjectPrivate::get(this)->sceneManager)
         QQuick3DObjectPrivate::get(this)->sceneManager->dirtyBoundingBoxList.append(this);
 }
@@ -762,8 +763,15 @@ QSSGRenderGraphObject *QQuick3DModel::updateSpatialNode(QSSGRenderGraphObject *n
     int dirtyAttribute = 0;
 
     auto modelNode = static_cast<QSSGRenderModel *>(node);
-    if (m_dirtyAttributes & SourceDirty)
+    if (m_dirtyAttributes & SourceDirty) {
         modelNode->meshPath = QSSGRenderPath(translateMeshSource(m_source, this));
+        modelNode->asynchronous = m_asynchronous;
+        if (!m_source.isEmpty()) {
+            auto sceneManager = QQuick3DObjectPrivate::get(this)->sceneManager;
+            if (sceneManager && !sceneManager->loadStatusList.contains(this))
+                sceneManager->loadStatusList.append(this);
+        }
+    }
     if (m_dirtyAttributes & PickingDirty)
         modelNode->setState(QSSGRenderModel::LocalState::Pickable, m_pickable);
 
@@ -1166,4 +1174,68 @@ void QQuick3DModel::setLevelOfDetailBias(float newLevelOfDetailBias)
     markDirty(QQuick3DModel::PropertyDirty);
 }
 
+/*!
+    \qmlproperty bool Model::asynchronous
+    \since 6.7
+
+    When this property is \c true, the mesh file given in \l source is read
+    and decoded on a background thread, and the model is not rendered until
+    it is done. Only the upload of the data to the graphics API is left to
+    the render thread, so loading a large mesh does not stall the rendering
+    of the rest of the scene. Use \l status to know when the mesh is ready.
+
+    Built-in primitives, such as \c{#Cube}, are always loaded synchronously.
+    The \l bounds of the model are not known until the mesh has been loaded.
+
+    The default value is \c false.
+
+    \sa status, Texture::asynchronous
+*/
+
+bool QQuick3DModel::asynchronous() const
+{
+    return m_asynchronous;
+}
+
+void QQuick3DModel::setAsynchronous(bool asynchronous)
+{
+    if (m_asynchronous == asynchronous)
+        return;
+    m_asynchronous = asynchronous;
+    emit asynchronousChanged();
+    markDirty(SourceDirty);
+}
+
+/*!
+    \qmlproperty enumeration Model::status
+    \since 6.7
+    \readonly
+
+    This property holds the status of the mesh given in \l source.
+
+    \value Model.Null No mesh source has been set.
+    \value Model.Ready The mesh has been loaded.
+    \value Model.Loading The mesh is being loaded.
+    \value Model.Error An error occurred while loading the mesh.
+
+    The status is updated once the model has been rendered, when \l
+    asynchronous is \c false the mesh is loaded as part of the first frame
+    it is rendered in.
+
+    \sa asynchronous
+*/
+
+QQuick3DModel::Status QQuick3DModel::status() const
+{
+    return m_status;
+}
+
+void QQuick3DModel::setStatus(Status status)
+{
+    if (m_status == status)
+        return;
+    m_status = status;
+    emit statusChanged();
+}
+
 QT_END_NAMESPACE
@@ -82,10 +82,15 @@ class Q_QUICK3D_EXPORT QQuick3DModel : public QQuick3DNode
     Q_PROPERTY(float instancingLodMin READ instancingLodMin WRITE setInstancingLodMin NOTIFY instancingLodMinChanged REVISION(6, 5))
     Q_PROPERTY(float instancingLodMax READ instancingLodMax WRITE setInstancingLodMax NOTIFY instancingLodMaxChanged REVISION(6, 5))
     Q_PROPERTY(float levelOfDetailBias READ levelOfDetailBias WRITE setLevelOfDetailBias NOTIFY levelOfDetailBiasChanged REVISION(6, 5))
+    Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous NOTIFY asynchronousChanged REVISION(6, 7))
+    Q_PROPERTY(Status status READ status NOTIFY statusChanged REVISION(6, 7))
 
     QML_NAMED_ELEMENT(Model)
 
 public:
+    enum Status { Null, Ready, Loading, Error };
+    Q_ENUM(Status)
+
     explicit QQuick3DModel(QQuick3DNode *parent = nullptr);
     ~QQuick3DModel() override;
 
@@ -119,6 +124,9 @@ public:
     Q_REVISION(6, 5) float instancingLodMax() const;
     Q_REVISION(6, 5) float levelOfDetailBias() const;
 
+    Q_REVISION(6, 7) bool asynchronous() const;
+    Q_REVISION(6, 7) Status status() const;
+
 public Q_SLOTS:
     void setSource(const QUrl &source);
     void setCastsShadows(bool castsShadows);
@@ -142,6 +150,8 @@ public Q_SLOTS:
     Q_REVISION(6, 5) void setInstancingLodMax(float maxDistance);
     Q_REVISION(6, 5) void setLevelOfDetailBias(float newLevelOfDetailBias);
 
+    Q_REVISION(6, 7) void setAsynchronous(bool asynchronous);
+
 Q_SIGNALS:
     void sourceChanged();
     void castsShadowsChanged();
@@ -166,11 +176,18 @@ Q_SIGNALS:
     Q_REVISION(6, 5) void instancingLodMaxChanged();
     Q_REVISION(6, 5) void levelOfDetailBiasChanged();
 
+    Q_REVISION(6, 7) void asynchronousChanged();
+    Q_REVISION(6, 7) void statusChanged();
+
 protected:
     QSSGRenderGraphObject *updateSpatialNode(QSSGRenderGraphObject *node) override;
     void markAllDirty() override;
     void itemChange(ItemChange, const ItemChangeData &) override;
 
+private:
+    friend class QQuick3DSceneManager;
+    void setStatus(Status status);
+
 private Q_SLOTS:
     void onMaterialDestroyed(QObject *object);
     void onMorphTargetDestroyed(QObject *object);
@@ -238,6 +255,8 @@ private:
     float m_instancingLodMin = -1;
     float m_instancingLodMax = -1;
     float m_levelOfDetailBias = 1.0f;
+    bool m_asynchronous = false;
+    Status m_status = Null;
 };
 
 QT_END_NAMESPACE
@@ -929,8 +929,11 @@ void QQuick3DObjectPrivate::derefSceneManager()
         return; // There are still other references, so don't set the scene manager to null yet.
 
     removeFromDirtyList();
-    if (sceneManager)
+    if (sceneManager) {
         sceneManager->dirtyBoundingBoxList.removeAll(q);
+        sceneManager->loadStatusList.removeAll(q);
+        sceneManager->unrequestedTextures.remove(q);
+    }
 
     for (int ii = 0; ii < childItems.size(); ++ii) {
         QQuick3DObject *child = childItems.at(ii);
@@ -430,6 +430,7 @@ void QQuick3DRenderStats::processRhiContextStats()
     const auto textures = QSSGRhiContextPrivate::get(rhiContext).m_textures;
     const auto meshes = QSSGRhiContextPrivate::get(rhiContext).m_meshes;
     const auto pipelines = QSSGRhiContextPrivate::get(rhiContext).m_pipelines;
+    const auto &rhiContextPrivate = QSSGRhiContextPrivate::get(rhiContext);
 
     m_results.drawCallCount = 0;
     m_results.drawVertexCount = 0;
@@ -442,6 +443,14 @@ void QQuick3DRenderStats::processRhiContextStats()
 
     m_results.imageDataSize = globalData.imageDataSize;
     m_results.meshDataSize = globalData.meshDataSize;
+    m_results.peakImageDataSize = globalData.peakImageDataSize;
+    m_results.peakMeshDataSize = globalData.peakMeshDataSize;
+    m_results.evictedResourceCount = globalData.evictionCount;
+
+    m_results.occlusionCulledCount = data.occlusionCulledObjectCount;
+    m_results.occlusionCulledShadowCasterCount = data.occlusionCulledShadowCasterCount;
+    m_results.uniformDataSize = data.uniformDataSize;
+    m_results.uniformBufferSize = data.uniformBufferSize;
 
     m_results.renderPassCount = data.renderPasses.size()
             + (data.externalRenderPass.pixelSize.isEmpty() ? 0 : 1);
@@ -530,6 +539,20 @@ void QQuick3DRenderStats::processRhiContextStats()
     }
 
     m_results.pipelineCount = pipelines.count();
+    m_results.pipelineCacheHitCount = globalData.pipelineCacheHitCount;
+    m_results.pipelineCacheMissCount = globalData.pipelineCacheMissCount;
+
+    m_results.srbCount = rhiContextPrivate.m_srbCache.size();
+    m_results.srbCacheHitCount = globalData.srbCacheHitCount;
+    m_results.srbCacheMissCount = globalData.srbCacheMissCount;
+    m_results.drawCallDataCount = rhiContextPrivate.m_drawCallData.size();
+    m_results.drawCallDataHitCount = globalData.drawCallDataHitCount;
+    m_results.drawCallDataMissCount = globalData.drawCallDataMissCount;
+    m_results.instanceBufferCount = rhiContextPrivate.m_instanceBuffers.size()
+            + rhiContextPrivate.m_instanceBuffersLod.size();
+    m_results.instanceBufferHitCount = globalData.instanceBufferHitCount;
+    m_results.instanceBufferMissCount = globalData.instanceBufferMissCount;
+    m_results.evictedCacheEntryCount = globalData.cacheEvictionCount;
 
     m_results.materialGenerationTime = m_contextStats->globalInfo.materialGenerationTime;
     m_results.effectGenerationTime = m_contextStats->globalInfo.effectGenerationTime;
@@ -611,6 +634,101 @@ void QQuick3DRenderStats::notifyRhiContextStats()
         m_notifiedResults.rhiStats.usedBytes = m_results.rhiStats.usedBytes;
         emit vmemUsedBytesChanged();
     }
+
+    if (m_results.occlusionCulledCount != m_notifiedResults.occlusionCulledCount) {
+        m_notifiedResults.occlusionCulledCount = m_results.occlusionCulledCount;
+        emit occlusionCulledCountChanged();
+    }
+
+    if (m_results.occlusionCulledShadowCasterCount != m_notifiedResults.occlusionCulledShadowCasterCount) {
+        m_notifiedResults.occlusionCulledShadowCasterCount = m_results.occlusionCulledShadowCasterCount;
+        emit occlusionCulledShadowCasterCountChanged();
+    }
+
+    if (m_results.uniformDataSize != m_notifiedResults.uniformDataSize) {
+        m_notifiedResults.uniformDataSize = m_results.uniformDataSize;
+        emit uniformDataSizeChanged();
+    }
+
+    if (m_results.uniformBufferSize != m_notifiedResults.uniformBufferSize) {
+        m_notifiedResults.uniformBufferSize = m_results.uniformBufferSize;
+        emit uniformBufferSizeChanged();
+    }
+
+    if (m_results.peakImageDataSize != m_notifiedResults.peakImageDataSize) {
+        m_notifiedResults.peakImageDataSize = m_results.peakImageDataSize;
+        emit peakImageDataSizeChanged();
+    }
+
+    if (m_results.peakMeshDataSize != m_notifiedResults.peakMeshDataSize) {
+        m_notifiedResults.peakMeshDataSize = m_results.peakMeshDataSize;
+        emit peakMeshDataSizeChanged();
+    }
+
+    if (m_results.evictedResourceCount != m_notifiedResults.evictedResourceCount) {
+        m_notifiedResults.evictedResourceCount = m_results.evictedResourceCount;
+        emit evictedResourceCountChanged();
+    }
+
+    if (m_results.pipelineCacheHitCount != m_notifiedResults.pipelineCacheHitCount) {
+        m_notifiedResults.pipelineCacheHitCount = m_results.pipelineCacheHitCount;
+        emit pipelineCacheHitCountChanged();
+    }
+
+    if (m_results.pipelineCacheMissCount != m_notifiedResults.pipelineCacheMissCount) {
+        m_notifiedResults.pipelineCacheMissCount = m_results.pipelineCacheMissCount;
+        emit pipelineCacheMissCountChanged();
+    }
+
+    if (m_results.srbCount != m_notifiedResults.srbCount) {
+        m_notifiedResults.srbCount = m_results.srbCount;
+        emit srbCountChanged();
+    }
+
+    if (m_results.srbCacheHitCount != m_notifiedResults.srbCacheHitCount) {
+        m_notifiedResults.srbCacheHitCount = m_results.srbCacheHitCount;
+        emit srbCacheHitCountChanged();
+    }
+
+    if (m_results.srbCacheMissCount != m_notifiedResults.srbCacheMissCount) {
+        m_notifiedResults.srbCacheMissCount = m_results.srbCacheMissCount;
+        emit srbCacheMissCountChanged();
+    }
+
+    if (m_results.drawCallDataCount != m_notifiedResults.drawCallDataCount) {
+        m_notifiedResults.drawCallDataCount = m_results.drawCallDataCount;
+        emit drawCallDataCountChanged();
+    }
+
+    if (m_results.drawCallDataHitCount != m_notifiedResults.drawCallDataHitCount) {
+        m_notifiedResults.drawCallDataHitCount = m_results.drawCallDataHitCount;
+        emit drawCallDataHitCountChanged();
+    }
+
+    if (m_results.drawCallDataMissCount != m_notifiedResults.drawCallDataMissCount) {
+        m_notifiedResults.drawCallDataMissCount = m_results.drawCallDataMissCount;
+        emit drawCallDataMissCountChanged();
+    }
+
+    if (m_results.instanceBufferCount != m_notifiedResults.instanceBufferCount) {
+        m_notifiedResults.instanceBufferCount = m_results.instanceBufferCount;
+        emit instanceBufferCountChanged();
+    }
+
+    if (m_results.instanceBufferHitCount != m_notifiedResults.instanceBufferHitCount) {
+        m_notifiedResults.instanceBufferHitCount = m_results.instanceBufferHitCount;
+        emit instanceBufferHitCountChanged();
+    }
+
+    if (m_results.instanceBufferMissCount != m_notifiedResults.instanceBufferMissCount) {
+        m_notifiedResults.instanceBufferMissCount = m_results.instanceBufferMissCount;
+        emit instanceBufferMissCountChanged();
+    }
+
+    if (m_results.evictedCacheEntryCount != m_notifiedResults.evictedCacheEntryCount) {
+        m_notifiedResults.evictedCacheEntryCount = m_results.evictedCacheEntryCount;
+        emit evictedCacheEntryCountChanged();
+    }
 }
 
 /*!
@@ -842,6 +960,13 @@ qint64 QQuick3DRenderStats::effectGenerationTime() const
     the first run of the application. (since that may not benefit from
     persistent, disk-based caches yet)
 
+    Qt Quick 3D creates its graphics pipelines with the QRhi of the window.
+    When the shader disk cache is enabled, and the application has not chosen
+    pipeline cache files with QQuickGraphicsConfiguration itself, the View3D
+    has Qt Quick save the pipeline cache data of the graphics driver next to
+    the shader cache, and load it on the next run. This only works for a
+    View3D that is in the window before its scenegraph is initialized.
+
     The value is updated only when extendedDataCollectionEnabled is enabled.
 
     \note The value is reported on a per-QQuickWindow basis. If there are
@@ -942,6 +1067,361 @@ float QQuick3DRenderStats::lastCompletedGpuTime() const
     return m_results.lastCompletedGpuTime;
 }
 
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::occlusionCulledCount
+    \readonly
+
+    This property holds the number of opaque renderables that were skipped
+    during the last render of the \l View3D because they were hidden behind
+    other objects.
+
+    The value is always zero unless
+    \l{SceneEnvironment::occlusionCullingEnabled}{occlusion culling} is
+    enabled. It is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+*/
+quint64 QQuick3DRenderStats::occlusionCulledCount() const
+{
+    return m_results.occlusionCulledCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::occlusionCulledShadowCasterCount
+    \readonly
+
+    This property holds the number of renderables left out of the shadow maps
+    during the last render of the \l View3D because neither they nor the
+    shadows they cast could be seen.
+
+    The value is always zero unless
+    \l{SceneEnvironment::occlusionCullingEnabled}{occlusion culling} is
+    enabled. It is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+*/
+quint64 QQuick3DRenderStats::occlusionCulledShadowCasterCount() const
+{
+    return m_results.occlusionCulledShadowCasterCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::uniformDataSize
+    \readonly
+
+    This property holds the amount of per-draw uniform data, in bytes, written
+    during the last render of the \l View3D. The uniform data of all the draw
+    calls is packed into a few large buffers per \l View3D.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa uniformBufferSize
+*/
+quint64 QQuick3DRenderStats::uniformDataSize() const
+{
+    return m_results.uniformDataSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::uniformBufferSize
+    \readonly
+
+    This property holds the size, in bytes, of the buffers the per-draw
+    uniform data of the \l View3D is packed into. The buffers grow when a
+    frame needs more space, and are kept at that size afterwards.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa uniformDataSize
+*/
+quint64 QQuick3DRenderStats::uniformBufferSize() const
+{
+    return m_results.uniformBufferSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::peakImageDataSize
+    \readonly
+
+    This property holds the highest \l imageDataSize the View3D's window has
+    had so far.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa evictedResourceCount
+*/
+quint64 QQuick3DRenderStats::peakImageDataSize() const
+{
+    return m_results.peakImageDataSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::peakMeshDataSize
+    \readonly
+
+    This property holds the highest \l meshDataSize the View3D's window has
+    had so far.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa evictedResourceCount
+*/
+quint64 QQuick3DRenderStats::peakMeshDataSize() const
+{
+    return m_results.peakMeshDataSize;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::evictedResourceCount
+    \readonly
+
+    This property holds the number of meshes and textures that were released
+    to keep the View3D's window within its memory budget.
+
+    By default, meshes and textures loaded from files are released as soon as
+    no model or material uses them. When View3D::memoryBudget, or the
+    \c QT_QUICK3D_MEMORY_BUDGET environment variable, gives a size in
+    megabytes, they stay loaded after that, so that showing them again is fast. Once \l imageDataSize and
+    \l meshDataSize add up to more than the budget, the ones that have not
+    been used for the longest time are released first.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+*/
+quint64 QQuick3DRenderStats::evictedResourceCount() const
+{
+    return m_results.evictedResourceCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::pipelineCacheHitCount
+    \readonly
+
+    This property holds how many times a graphics pipeline needed for
+    rendering was found among the cached ones in the window the \l View3D
+    belongs to.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa pipelineCacheMissCount, pipelineCount
+*/
+quint64 QQuick3DRenderStats::pipelineCacheHitCount() const
+{
+    return m_results.pipelineCacheHitCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::pipelineCacheMissCount
+    \readonly
+
+    This property holds how many graphics pipelines had to be created in the
+    window the \l View3D belongs to, because they were not cached yet.
+
+    Creating a pipeline can be expensive, see \l pipelineCreationTime. The
+    pipeline cache data that is kept between runs makes the pipelines created
+    on a miss cheaper, not less frequent. The graphics APIs do not report
+    whether the driver found a pipeline in that data, its effect shows in
+    pipelineCreationTime.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa pipelineCacheHitCount, pipelineCreationTime
+*/
+quint64 QQuick3DRenderStats::pipelineCacheMissCount() const
+{
+    return m_results.pipelineCacheMissCount;
+}
+
+/*!
+    \qmlproperty int QtQuick3D::RenderStats::srbCount
+    \readonly
+
+    This property holds the number of cached shader resource binding sets for
+    the window the \l View3D belongs to.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa srbCacheHitCount, srbCacheMissCount, evictedCacheEntryCount
+*/
+int QQuick3DRenderStats::srbCount() const
+{
+    return m_results.srbCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::srbCacheHitCount
+    \readonly
+
+    This property holds how many times a shader resource binding set was
+    found among the cached ones in the window the \l View3D belongs to.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa srbCacheMissCount, srbCount
+*/
+quint64 QQuick3DRenderStats::srbCacheHitCount() const
+{
+    return m_results.srbCacheHitCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::srbCacheMissCount
+    \readonly
+
+    This property holds how many shader resource binding sets had to be
+    created in the window the \l View3D belongs to, because they were not
+    cached yet.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa srbCacheHitCount, srbCount
+*/
+quint64 QQuick3DRenderStats::srbCacheMissCount() const
+{
+    return m_results.srbCacheMissCount;
+}
+
+/*!
+    \qmlproperty int QtQuick3D::RenderStats::drawCallDataCount
+    \readonly
+
+    This property holds the number of cached per-draw data entries, such as
+    uniform buffers, for the window the \l View3D belongs to. There is
+    typically one entry for each object in each render pass it is drawn in.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa drawCallDataHitCount, drawCallDataMissCount, evictedCacheEntryCount
+*/
+int QQuick3DRenderStats::drawCallDataCount() const
+{
+    return m_results.drawCallDataCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::drawCallDataHitCount
+    \readonly
+
+    This property holds how many times the per-draw data of an object was
+    found among the cached ones in the window the \l View3D belongs to.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa drawCallDataMissCount, drawCallDataCount
+*/
+quint64 QQuick3DRenderStats::drawCallDataHitCount() const
+{
+    return m_results.drawCallDataHitCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::drawCallDataMissCount
+    \readonly
+
+    This property holds how many per-draw data entries had to be created in
+    the window the \l View3D belongs to, because they were not cached yet.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa drawCallDataHitCount, drawCallDataCount
+*/
+quint64 QQuick3DRenderStats::drawCallDataMissCount() const
+{
+    return m_results.drawCallDataMissCount;
+}
+
+/*!
+    \qmlproperty int QtQuick3D::RenderStats::instanceBufferCount
+    \readonly
+
+    This property holds the number of cached instance buffers for the window
+    the \l View3D belongs to.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa instanceBufferHitCount, instanceBufferMissCount, evictedCacheEntryCount
+*/
+int QQuick3DRenderStats::instanceBufferCount() const
+{
+    return m_results.instanceBufferCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::instanceBufferHitCount
+    \readonly
+
+    This property holds how many times the instance buffer of an instanced
+    model was found among the cached ones in the window the \l View3D
+    belongs to.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa instanceBufferMissCount, instanceBufferCount
+*/
+quint64 QQuick3DRenderStats::instanceBufferHitCount() const
+{
+    return m_results.instanceBufferHitCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::instanceBufferMissCount
+    \readonly
+
+    This property holds how many instance buffer entries had to be created in
+    the window the \l View3D belongs to, because they were not cached yet.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa instanceBufferHitCount, instanceBufferCount
+*/
+quint64 QQuick3DRenderStats::instanceBufferMissCount() const
+{
+    return m_results.instanceBufferMissCount;
+}
+
+/*!
+    \qmlproperty quint64 QtQuick3D::RenderStats::evictedCacheEntryCount
+    \readonly
+
+    This property holds the number of cached graphics pipelines, shader
+    resource binding sets, per-draw data entries and instance buffers that
+    were released because they were not used for a while.
+
+    By default, these stay cached until the window goes away or releases its
+    graphics resources. When the
+    \c QT_QUICK3D_RHI_CACHE_MAX_AGE environment variable is set to a number
+    of frames, the entries that were not used in that many frames are
+    released. Scenes that keep changing, for example by creating and
+    destroying models, then do not accumulate entries without bound. The
+    frames are counted per rendered View3D: in a window with two View3Ds
+    the entries age twice per frame of the window.
+
+    The value is updated only when extendedDataCollectionEnabled is enabled.
+
+    \since 6.7
+    \sa pipelineCount, srbCount, drawCallDataCount, instanceBufferCount
+*/
+quint64 QQuick3DRenderStats::evictedCacheEntryCount() const
+{
+    return m_results.evictedCacheEntryCount;
+}
+
 /*!
     \internal
  */
@@ -52,6 +52,25 @@ class Q_QUICK3D_EXPORT QQuick3DRenderStats : public QObject
     Q_PROPERTY(quint64 vmemUsedBytes READ vmemUsedBytes NOTIFY vmemUsedBytesChanged)
     Q_PROPERTY(QString graphicsApiName READ graphicsApiName NOTIFY graphicsApiNameChanged)
     Q_PROPERTY(float lastCompletedGpuTime READ lastCompletedGpuTime NOTIFY lastCompletedGpuTimeChanged)
+    Q_PROPERTY(quint64 occlusionCulledCount READ occlusionCulledCount NOTIFY occlusionCulledCountChanged)
+    Q_PROPERTY(quint64 occlusionCulledShadowCasterCount READ occlusionCulledShadowCasterCount NOTIFY occlusionCulledShadowCasterCountChanged)
+    Q_PROPERTY(quint64 uniformDataSize READ uniformDataSize NOTIFY uniformDataSizeChanged)
+    Q_PROPERTY(quint64 uniformBufferSize READ uniformBufferSize NOTIFY uniformBufferSizeChanged)
+    Q_PROPERTY(quint64 peakImageDataSize READ peakImageDataSize NOTIFY peakImageDataSizeChanged)
+    Q_PROPERTY(quint64 peakMeshDataSize READ peakMeshDataSize NOTIFY peakMeshDataSizeChanged)
+    Q_PROPERTY(quint64 evictedResourceCount READ evictedResourceCount NOTIFY evictedResourceCountChanged)
+    Q_PROPERTY(quint64 pipelineCacheHitCount READ pipelineCacheHitCount NOTIFY pipelineCacheHitCountChanged)
+    Q_PROPERTY(quint64 pipelineCacheMissCount READ pipelineCacheMissCount NOTIFY pipelineCacheMissCountChanged)
+    Q_PROPERTY(int srbCount READ srbCount NOTIFY srbCountChanged)
+    Q_PROPERTY(quint64 srbCacheHitCount READ srbCacheHitCount NOTIFY srbCacheHitCountChanged)
+    Q_PROPERTY(quint64 srbCacheMissCount READ srbCacheMissCount NOTIFY srbCacheMissCountChanged)
+    Q_PROPERTY(int drawCallDataCount READ drawCallDataCount NOTIFY drawCallDataCountChanged)
+    Q_PROPERTY(quint64 drawCallDataHitCount READ drawCallDataHitCount NOTIFY drawCallDataHitCountChanged)
+    Q_PROPERTY(quint64 drawCallDataMissCount READ drawCallDataMissCount NOTIFY drawCallDataMissCountChanged)
+    Q_PROPERTY(int instanceBufferCount READ instanceBufferCount NOTIFY instanceBufferCountChanged)
+    Q_PROPERTY(quint64 instanceBufferHitCount READ instanceBufferHitCount NOTIFY instanceBufferHitCountChanged)
+    Q_PROPERTY(quint64 instanceBufferMissCount READ instanceBufferMissCount NOTIFY instanceBufferMissCountChanged)
+    Q_PROPERTY(quint64 evictedCacheEntryCount READ evictedCacheEntryCount NOTIFY evictedCacheEntryCountChanged)
 
 public:
     QQuick3DRenderStats(QObject *parent = nullptr);
@@ -92,6 +111,25 @@ public:
     quint64 vmemUsedBytes() const;
     QString graphicsApiName() const;
     float lastCompletedGpuTime() const;
+    quint64 occlusionCulledCount() const;
+    quint64 occlusionCulledShadowCasterCount() const;
+    quint64 uniformDataSize() const;
+    quint64 uniformBufferSize() const;
+    quint64 peakImageDataSize() const;
+    quint64 peakMeshDataSize() const;
+    quint64 evictedResourceCount() const;
+    quint64 pipelineCacheHitCount() const;
+    quint64 pipelineCacheMissCount() const;
+    int srbCount() const;
+    quint64 srbCacheHitCount() const;
+    quint64 srbCacheMissCount() const;
+    int drawCallDataCount() const;
+    quint64 drawCallDataHitCount() const;
+    quint64 drawCallDataMissCount() const;
+    int instanceBufferCount() const;
+    quint64 instanceBufferHitCount() const;
+    quint64 instanceBufferMissCount() const;
+    quint64 evictedCacheEntryCount() const;
 
     Q_INVOKABLE void releaseCachedResources();
 
@@ -120,6 +158,25 @@ Q_SIGNALS:
     void vmemUsedBytesChanged();
     void graphicsApiNameChanged();
     void lastCompletedGpuTimeChanged();
+    void occlusionCulledCountChanged();
+    void occlusionCulledShadowCasterCountChanged();
+    void uniformDataSizeChanged();
+    void uniformBufferSizeChanged();
+    void peakImageDataSizeChanged();
+    void peakMeshDataSizeChanged();
+    void evictedResourceCountChanged();
+    void pipelineCacheHitCountChanged();
+    void pipelineCacheMissCountChanged();
+    void srbCountChanged();
+    void srbCacheHitCountChanged();
+    void srbCacheMissCountChanged();
+    void drawCallDataCountChanged();
+    void drawCallDataHitCountChanged();
+    void drawCallDataMissCountChanged();
+    void instanceBufferCountChanged();
+    void instanceBufferHitCountChanged();
+    void instanceBufferMissCountChanged();
+    void evictedCacheEntryCountChanged();
 
 private Q_SLOTS:
     void onFrameSwapped();
@@ -161,6 +218,25 @@ private:
         int pipelineCount = 0;
         qint64 materialGenerationTime = 0;
         qint64 effectGenerationTime = 0;
+        quint64 occlusionCulledCount = 0;
+        quint64 occlusionCulledShadowCasterCount = 0;
+        quint64 uniformDataSize = 0;
+        quint64 uniformBufferSize = 0;
+        quint64 peakImageDataSize = 0;
+        quint64 peakMeshDataSize = 0;
+        quint64 evictedResourceCount = 0;
+        quint64 pipelineCacheHitCount = 0;
+        quint64 pipelineCacheMissCount = 0;
+        int srbCount = 0;
+        quint64 srbCacheHitCount = 0;
+        quint64 srbCacheMissCount = 0;
+        int drawCallDataCount = 0;
+        quint64 drawCallDataHitCount = 0;
+        quint64 drawCallDataMissCount = 0;
+        int instanceBufferCount = 0;
+        quint64 instanceBufferHitCount = 0;
+        quint64 instanceBufferMissCount = 0;
+        quint64 evictedCacheEntryCount = 0;
         QRhiStats rhiStats;
     };
 
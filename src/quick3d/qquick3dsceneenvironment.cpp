@@ -1551,4 +1551,51 @@ void QQuick3DSceneEnvironment::setFog(QQuick3DFog *fog)
     update();
 }
 
+/*!
+    \qmlproperty bool QtQuick3D::SceneEnvironment::occlusionCullingEnabled
+    \since 6.7
+
+    When enabled, the renderer skips opaque objects, and the shadow casters of
+    shadow maps, that are hidden behind other opaque objects.
+
+    The visibility is tested against a hierarchical depth buffer built from the
+    depth of the opaque objects in an earlier frame, which is read back from
+    the GPU. The depth the View3D renders anyway is used for this, so the cost
+    is a reduction of it and a readback every frame. This pays off mainly in
+    scenes with many models that are often fully hidden, like the buildings
+    of a city. Only models with a static shape take part in the test: skinned,
+    morphed and instanced models, as well as particles, are always rendered.
+    Frames in which transparent objects or 2D items write depth do not update
+    the test.
+
+    As the depth is from an earlier frame, objects becoming visible because a
+    model in front of them moved away may appear with a delay of a frame or
+    two.
+
+    The default value is \c false.
+
+    \note This property has no effect when the graphics API or device does
+    not support rendering to and reading back from a 32-bit floating point
+    texture. Unless a depth texture is rendered anyway, for example for
+    \l{SceneEnvironment::aoEnabled}{ambient occlusion}, it also needs the
+    View3D to use the \l{View3D::renderMode}{Offscreen} render mode without
+    multisample antialiasing.
+
+    \sa QtQuick3D::RenderStats::occlusionCulledCount
+*/
+bool QQuick3DSceneEnvironment::occlusionCullingEnabled() const
+{
+    return m_occlusionCullingEnabled;
+}
+
+void QQuick3DSceneEnvironment::setOcclusionCullingEnabled(bool enabled)
+{
+    if (m_occlusionCullingEnabled == enabled)
+        return;
+
+    m_occlusionCullingEnabled = enabled;
+    emit occlusionCullingEnabledChanged();
+    update();
+}
+
 QT_END_NAMESPACE
@@ -75,6 +75,8 @@ class Q_QUICK3D_EXPORT QQuick3DSceneEnvironment : public QQuick3DObject
 
     Q_PROPERTY(QQuick3DFog *fog READ fog WRITE setFog NOTIFY fogChanged REVISION(6, 5))
 
+    Q_PROPERTY(bool occlusionCullingEnabled READ occlusionCullingEnabled WRITE setOcclusionCullingEnabled NOTIFY occlusionCullingEnabledChanged REVISION(6, 7))
+
     QML_NAMED_ELEMENT(SceneEnvironment)
 
 public:
@@ -154,6 +156,8 @@ public:
 
     Q_REVISION(6, 5) QQuick3DFog *fog() const;
 
+    Q_REVISION(6, 7) bool occlusionCullingEnabled() const;
+
     bool gridEnabled() const;
     void setGridEnabled(bool newGridEnabled);
 
@@ -200,6 +204,8 @@ public Q_SLOTS:
 
     Q_REVISION(6, 5) void setFog(QQuick3DFog *fog);
 
+    Q_REVISION(6, 7) void setOcclusionCullingEnabled(bool enabled);
+
 Q_SIGNALS:
     void antialiasingModeChanged();
     void antialiasingQualityChanged();
@@ -237,6 +243,8 @@ Q_SIGNALS:
 
     Q_REVISION(6, 5) void fogChanged();
 
+    Q_REVISION(6, 7) void occlusionCullingEnabledChanged();
+
 protected:
     QSSGRenderGraphObject *updateSpatialNode(QSSGRenderGraphObject *node) override;
     void itemChange(ItemChange, const ItemChangeData &) override;
@@ -293,6 +301,7 @@ private:
     float m_gridScale = 1.0f;
     QQuick3DFog *m_fog = nullptr;
     QMetaObject::Connection m_fogSignalConnection;
+    bool m_occlusionCullingEnabled = false;
 };
 
 QT_END_NAMESPACE
@@ -5,6 +5,7 @@
 #include "qquick3dobject_p.h"
 #include "qquick3dviewport_p.h"
 #include "qquick3dmodel_p.h"
+#include "qquick3dtexture_p.h"
 
 #include <QtQuick/QQuickWindow>
 
@@ -113,6 +114,12 @@ void QQuick3DSceneManager::updateBoundingBoxes(QSSGBufferManager &mgr)
             continue;
         auto model = static_cast<QSSGRenderModel *>(itemPriv->spatialNode);
         if (model) {
+            // The bounds are not known until the mesh has been loaded
+            if (model->asynchronous) {
+                const auto status = mgr.loadStatus(model);
+                if (status == QSSGBufferManager::LoadStatus::Null || status == QSSGBufferManager::LoadStatus::Loading)
+                    continue;
+            }
             QSSGBounds3 bounds = mgr.getModelBounds(model);
             static_cast<QQuick3DModel *>(object)->setBounds(bounds.minimum, bounds.maximum);
         }
@@ -120,6 +127,49 @@ void QQuick3DSceneManager::updateBoundingBoxes(QSSGBufferManager &mgr)
     }
 }
 
+void QQuick3DSceneManager::updateLoadStatus(QSSGBufferManager &mgr)
+{
+    const QList<QQuick3DObject *> statusList = loadStatusList;
+    for (auto object : statusList) {
+        QQuick3DObjectPrivate *itemPriv = QQuick3DObjectPrivate::get(object);
+        if (itemPriv->sceneManager == nullptr || itemPriv->spatialNode == nullptr)
+            continue;
+
+        if (itemPriv->type == QQuick3DObjectPrivate::Type::Model) {
+            const auto status = mgr.loadStatus(static_cast<QSSGRenderModel *>(itemPriv->spatialNode));
+            if (status == QSSGBufferManager::LoadStatus::Ready)
+                static_cast<QQuick3DModel *>(object)->setStatus(QQuick3DModel::Ready);
+            else if (status == QSSGBufferManager::LoadStatus::Error)
+                static_cast<QQuick3DModel *>(object)->setStatus(QQuick3DModel::Error);
+            else
+                continue;
+        } else {
+            auto texture = static_cast<QQuick3DTexture *>(object);
+            const auto status = mgr.loadStatus(static_cast<QSSGRenderImage *>(itemPriv->spatialNode));
+            if (status == QSSGBufferManager::LoadStatus::Ready) {
+                texture->setStatus(QQuick3DTexture::Ready);
+            } else if (status == QSSGBufferManager::LoadStatus::Error) {
+                texture->setStatus(QQuick3DTexture::Error);
+            } else {
+                // Images are only loaded once a frame uses them. A texture that
+                // a whole frame did not ask for is not used by anything and is
+                // Null until it is, it stays in the list for that.
+                if (status == QSSGBufferManager::LoadStatus::Loading) {
+                    texture->setStatus(QQuick3DTexture::Loading);
+                } else if (unrequestedTextures.contains(object)) {
+                    texture->setStatus(QQuick3DTexture::Null);
+                } else {
+                    unrequestedTextures.insert(object);
+                    requestUpdate();
+                }
+                continue;
+            }
+            unrequestedTextures.remove(object);
+        }
+        loadStatusList.removeOne(object);
+    }
+}
+
 bool QQuick3DSceneManager::updateDirtyResourceNodes()
 {
     auto it = std::begin(dirtyResources);
@@ -572,6 +622,9 @@ bool QQuick3DWindowAttachment::synchronize(QSet<QSSGRenderGraphObject *> &resour
     // Bounding Boxes
     for (auto &sceneManager : std::as_const(sceneManagers))
         sceneManager->updateBoundingBoxes(*m_rci->bufferManager());
+    // Load Status
+    for (auto &sceneManager : std::as_const(sceneManagers))
+        sceneManager->updateLoadStatus(*m_rci->bufferManager());
     // Resource Loaders
     for (auto &sceneManager : std::as_const(sceneManagers))
         resourceLoaders.unite(sceneManager->resourceLoaders);
@@ -100,6 +100,7 @@ public:
     void updateDirtyResource(QQuick3DObject *resourceObject);
     void updateDirtySpatialNode(QQuick3DNode *spatialNode);
     void updateBoundingBoxes(QSSGBufferManager &mgr);
+    void updateLoadStatus(QSSGBufferManager &mgr);
 
     QQuick3DObject *lookUpNode(const QSSGRenderGraphObject *node) const;
 
@@ -158,6 +159,10 @@ public:
     QSet<QQuick3DObject *> dirtySecondPassResources;
 
     QList<QQuick3DObject *> dirtyBoundingBoxList;
+    // Models and textures waiting for their source to be loaded
+    QList<QQuick3DObject *> loadStatusList;
+    // Textures in loadStatusList that were not requested by the last frame
+    QSet<QQuick3DObject *> unrequestedTextures;
     QSet<QSSGRenderGraphObject *> cleanupNodeList;
     QList<QSSGRenderGraphObject *> resourceCleanupQueue;
 
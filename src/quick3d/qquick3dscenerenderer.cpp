@@ -18,6 +18,8 @@
 
 #include <QtQuick3DRuntimeRender/private/qssgrendererutil_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
 
 #include <QtQuick/private/qquickwindow_p.h>
 #include <QtQuick/private/qsgdefaultrendercontext_p.h>
@@ -220,6 +222,9 @@ void QQuick3DSceneRenderer::releaseAaDependentRhiResources()
     delete m_depthStencilBuffer;
     m_depthStencilBuffer = nullptr;
 
+    delete m_depthTexture;
+    m_depthTexture = nullptr;
+
     delete m_msaaRenderBuffer;
     m_msaaRenderBuffer = nullptr;
 
@@ -502,6 +507,21 @@ void QQuick3DSceneRenderer::beginFrame()
 void QQuick3DSceneRenderer::endFrame()
 {
     m_sgContext->renderer()->endFrame(*m_layer);
+
+    // Asynchronous loads finish in the background, keep the frames coming
+    // until they are uploaded and their status has been reported.
+    const auto &bufferManager = m_sgContext->bufferManager();
+    if ((bufferManager->takeLoadStatusChanged() || bufferManager->hasPendingLoads()) && winAttacment)
+        winAttacment->requestUpdate();
+
+    // Streamed textures get their next levels at the start of a frame, so
+    // there have to be frames until they have all the levels they need
+    if (bufferManager->hasPendingStreams() && winAttacment)
+        winAttacment->requestUpdate();
+
+    // Same for the shaders that are compiled asynchronously
+    if (m_sgContext->shaderCache()->hasPendingCompilations() && winAttacment)
+        winAttacment->requestUpdate();
 }
 
 void QQuick3DSceneRenderer::rhiPrepare(const QRect &viewport, qreal displayPixelRatio)
@@ -516,6 +536,11 @@ void QQuick3DSceneRenderer::rhiPrepare(const QRect &viewport, qreal displayPixel
     renderer->setViewport(viewport);
 
     renderer->prepareLayerForRender(*m_layer);
+    if (m_layer->shaderCompilationMode == QSSGRenderLayer::ShaderCompilationMode::Parallel
+            || m_layer->precompileShadersRequested) {
+        QSSGRendererPrivate::precompileShaders(*renderer, *m_layer);
+        m_layer->precompileShadersRequested = false;
+    }
     // If sync was called the assumption is that the scene is dirty regardless of what
     // the scene prep function says, we still should verify that we have a camera before
     // we call render prep and render.
@@ -823,6 +848,11 @@ void QQuick3DSceneRenderer::synchronize(QQuick3DViewport *view3D, const QSize &s
         QRhi *rhi = rhiCtx->rhi();
         const QSize renderSize = superSamplingAA ? m_surfaceSize * m_ssaaMultiplier : m_surfaceSize;
 
+        // Occlusion culling reduces the depth the main pass leaves behind,
+        // that needs a texture instead of a renderbuffer.
+        const bool depthTextureNeeded = m_layer->occlusionCullingEnabled && !multiSamplingAA;
+        const bool depthTypeIsDirty = m_textureRenderTarget && (depthTextureNeeded != (m_depthTexture != nullptr));
+
         if (m_texture) {
             // the size changed, or the AA settings changed, or toggled between some effects - no effect
             if (layerSizeIsDirty || postProcessingStateDirty) {
@@ -833,7 +863,7 @@ void QQuick3DSceneRenderer::synchronize(QQuick3DViewport *view3D, const QSize &s
                 // If AA settings changed, then we drop and recreate all
                 // resources, otherwise use a lighter path if just the size
                 // changed.
-                if (!m_aaIsDirty) {
+                if (!m_aaIsDirty && !depthTypeIsDirty) {
                     // A special case: when toggling effects and AA is on,
                     // use the heavier AA path because the renderbuffer for
                     // MSAA and texture for SSAA may need a different
@@ -846,8 +876,13 @@ void QQuick3DSceneRenderer::synchronize(QQuick3DViewport *view3D, const QSize &s
                             m_ssaaTexture->setPixelSize(renderSize);
                             m_ssaaTexture->create();
                         }
-                        m_depthStencilBuffer->setPixelSize(renderSize);
-                        m_depthStencilBuffer->create();
+                        if (m_depthTexture) {
+                            m_depthTexture->setPixelSize(renderSize);
+                            m_depthTexture->create();
+                        } else {
+                            m_depthStencilBuffer->setPixelSize(renderSize);
+                            m_depthStencilBuffer->create();
+                        }
                         if (m_msaaRenderBuffer) {
                             m_msaaRenderBuffer->setPixelSize(renderSize);
                             m_msaaRenderBuffer->create();
@@ -881,7 +916,7 @@ void QQuick3DSceneRenderer::synchronize(QQuick3DViewport *view3D, const QSize &s
                 m_texture->create();
             }
 
-            if (m_aaIsDirty)
+            if (m_aaIsDirty || depthTypeIsDirty)
                 releaseAaDependentRhiResources();
         }
 
@@ -939,7 +974,15 @@ void QQuick3DSceneRenderer::synchronize(QQuick3DViewport *view3D, const QSize &s
             }
         }
 
-        if (!m_depthStencilBuffer) {
+        if (depthTextureNeeded) {
+            if (!m_depthTexture) {
+                // D24S8 keeps the stencil the renderbuffer would have
+                const QRhiTexture::Format depthFormat = rhi->isTextureFormatSupported(QRhiTexture::D24S8)
+                        ? QRhiTexture::D24S8 : QRhiTexture::D32F;
+                m_depthTexture = rhi->newTexture(depthFormat, renderSize, 1, QRhiTexture::RenderTarget);
+                m_depthTexture->create();
+            }
+        } else if (!m_depthStencilBuffer) {
             m_depthStencilBuffer = rhi->newRenderBuffer(QRhiRenderBuffer::DepthStencil, renderSize, m_samples);
             m_depthStencilBuffer->create();
         }
@@ -960,7 +1003,10 @@ void QQuick3DSceneRenderer::synchronize(QQuick3DViewport *view3D, const QSize &s
                 else
                     rtDesc.setColorAttachments({ m_texture });
             }
-            rtDesc.setDepthStencilBuffer(m_depthStencilBuffer);
+            if (m_depthTexture)
+                rtDesc.setDepthTexture(m_depthTexture);
+            else
+                rtDesc.setDepthStencilBuffer(m_depthStencilBuffer);
 
             m_textureRenderTarget = rhi->newTextureRenderTarget(rtDesc);
             m_textureRenderTarget->setName(QByteArrayLiteral("View3D"));
@@ -1071,6 +1117,16 @@ QQuick3DSceneRenderer::PickResultList QQuick3DSceneRenderer::syncPickAll(const Q
                                             ray);
 }
 
+QVector<QSSGRenderPickResult> QQuick3DSceneRenderer::syncPickBatch(const QVector<QSSGRenderRay> &rays)
+{
+    if (!m_layer)
+        return QVector<QSSGRenderPickResult>(rays.size());
+
+    return QSSGRendererPrivate::syncPickBatch(*m_sgContext,
+                                              *m_layer,
+                                              rays);
+}
+
 void QQuick3DSceneRenderer::setGlobalPickingEnabled(bool isEnabled)
 {
     QSSGRendererPrivate::setGlobalPickingEnabled(*m_sgContext->renderer(), isEnabled);
@@ -1155,6 +1211,7 @@ void QQuick3DRenderLayerHelpers::updateLayerNodeHelper(const QQuick3DViewport &v
 
     layerNode.layerFlags.setFlag(QSSGRenderLayer::LayerFlag::EnableDepthTest, environment->depthTestEnabled());
     layerNode.layerFlags.setFlag(QSSGRenderLayer::LayerFlag::EnableDepthPrePass, environment->depthPrePassEnabled());
+    layerNode.occlusionCullingEnabled = environment->occlusionCullingEnabled();
 
     layerNode.tonemapMode = QQuick3DSceneRenderer::getTonemapMode(*environment);
     layerNode.skyboxBlurAmount = environment->skyboxBlurAmount();
@@ -1207,6 +1264,21 @@ void QQuick3DSceneRenderer::updateLayerNode(QQuick3DViewport *view3D, const QLis
     bool temporalIsDirty = false;
     QQuick3DRenderLayerHelpers::updateLayerNodeHelper(*view3D, *m_layer, m_aaIsDirty, temporalIsDirty, m_ssaaMultiplier);
 
+    layerNode->shaderCompilationMode = QSSGRenderLayer::ShaderCompilationMode(view3D->shaderCompilationMode());
+    if (view3D->precompileShadersRequested()) {
+        layerNode->precompileShadersRequested = true;
+        view3D->clearPrecompileShadersRequested();
+    }
+
+    // The buffer manager is shared by the View3Ds of the window, so only
+    // changes are passed on
+    if (view3D->memoryBudgetDirty()) {
+        const quint64 budgetMB = quint64(view3D->memoryBudget());
+        m_sgContext->bufferManager()->setMemoryBudget(budgetMB > 0 ? budgetMB * 1024 * 1024
+                                                                   : QSSGBufferManager::defaultMemoryBudget());
+        view3D->clearMemoryBudgetDirty();
+    }
+
     int extraFramesToRender = 0;
 
     if (layerNode->antialiasingMode == QSSGRenderLayer::AAMode::ProgressiveAA) {
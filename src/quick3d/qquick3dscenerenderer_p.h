@@ -67,6 +67,7 @@ protected:
     QSSGRenderPickResult syncPick(const QSSGRenderRay &ray);
     QSSGRenderPickResult syncPickOne(const QSSGRenderRay &ray, QSSGRenderNode *node);
     PickResultList syncPickAll(const QSSGRenderRay &ray);
+    QVector<QSSGRenderPickResult> syncPickBatch(const QVector<QSSGRenderRay> &rays);
 
     void setGlobalPickingEnabled(bool isEnabled);
 
@@ -99,6 +100,7 @@ private:
     QRhiTextureRenderTarget *m_temporalAARenderTarget = nullptr;
     QRhiRenderPassDescriptor *m_temporalAARenderPassDescriptor = nullptr;
     QRhiRenderBuffer *m_depthStencilBuffer = nullptr;
+    QRhiTexture *m_depthTexture = nullptr; // instead of m_depthStencilBuffer for occlusion culling
     bool m_textureNeedsFlip = true;
     QSSGRenderLayer::Background m_backgroundMode;
     QColor m_userBackgroundColor = Qt::black;
@@ -679,6 +679,7 @@ void QQuick3DTexture::setSource(const QUrl &source)
     m_dirtyFlags.setFlag(DirtyFlag::SourceItemDirty);
     m_dirtyFlags.setFlag(DirtyFlag::TextureDataDirty);
     emit sourceChanged();
+    setStatus(m_source.isEmpty() ? Null : Loading);
     update();
 }
 
@@ -1091,9 +1092,18 @@ QSSGRenderGraphObject *QQuick3DTexture::updateSpatialNode(QSSGRenderGraphObject
     if (m_dirtyFlags.testFlag(DirtyFlag::SourceDirty)) {
         m_dirtyFlags.setFlag(DirtyFlag::SourceDirty, false);
         m_dirtyFlags.setFlag(DirtyFlag::FlipVDirty, true);
+        imageNode->m_asynchronous = m_asynchronous;
+        imageNode->m_streaming = m_streaming;
         if (!m_source.isEmpty()) {
             const QQmlContext *context = qmlContext(this);
             imageNode->m_imagePath = resolveImagePath(m_source, context);
+            auto sceneManager = QQuick3DObjectPrivate::get(this)->sceneManager;
+            if (sceneManager) {
+                if (!sceneManager->loadStatusList.contains(this))
+                    sceneManager->loadStatusList.append(this);
+                // The new source has not had a frame to be requested in yet
+                sceneManager->unrequestedTextures.remove(this);
+            }
         } else {
             imageNode->m_imagePath = QSSGRenderPath();
         }
@@ -1485,4 +1495,110 @@ void QQuick3DTexture::setTextureProvider(QQuick3DRenderExtension *textureProvide
     update();
 }
 
+/*!
+    \qmlproperty bool QtQuick3D::Texture::asynchronous
+    \since 6.7
+
+    When this property is \c true, the image file given in \l source is read
+    and decoded on a background thread. Materials using the texture are
+    rendered as if it was not set until it is done, only the upload of the
+    image data is left to the render thread. Use \l status to know when the
+    texture is ready.
+
+    This property has no effect on textures using \l sourceItem, \l
+    textureData or \l textureProvider.
+
+    The default value is \c false.
+
+    \sa status, Model::asynchronous
+*/
+
+bool QQuick3DTexture::asynchronous() const
+{
+    return m_asynchronous;
+}
+
+void QQuick3DTexture::setAsynchronous(bool asynchronous)
+{
+    if (m_asynchronous == asynchronous)
+        return;
+
+    m_asynchronous = asynchronous;
+    m_dirtyFlags.setFlag(DirtyFlag::SourceDirty);
+    emit asynchronousChanged();
+    update();
+}
+
+/*!
+    \qmlproperty enumeration QtQuick3D::Texture::status
+    \since 6.7
+    \readonly
+
+    This property holds the status of the image given in \l source.
+
+    \value Texture.Null No image source has been set.
+    \value Texture.Ready The image has been loaded.
+    \value Texture.Loading The image is being loaded.
+    \value Texture.Error An error occurred while loading the image.
+
+    The status is updated once the texture has been used in a rendered frame.
+    A texture that is not used by any rendered material reports \c Texture.Null
+    until it is.
+
+    \sa asynchronous
+*/
+
+QQuick3DTexture::Status QQuick3DTexture::status() const
+{
+    return m_status;
+}
+
+void QQuick3DTexture::setStatus(Status status)
+{
+    if (m_status == status)
+        return;
+
+    m_status = status;
+    emit statusChanged();
+}
+
+/*!
+    \qmlproperty bool QtQuick3D::Texture::streaming
+    \since 6.7
+
+    When this property is \c true and \l source is a container file, such as
+    KTX, that has a full chain of mipmap levels, only the smallest levels are
+    uploaded when the texture is first used. Higher resolution levels are
+    uploaded over the following frames, as far as the texture needs them
+    based on the size the models using it have on the screen. The amount of
+    data uploaded for this per frame is limited, so that a scene with many
+    large textures appears quickly and does not keep memory for detail that
+    cannot be seen. The limit is 4 MB, the \c QT_QUICK3D_TEXTURE_STREAMING_BUDGET
+    environment variable can give another one in kilobytes.
+
+    Once uploaded, levels are not dropped when the models get smaller on the
+    screen again.
+
+    This property has no effect on other image files, cube maps, and textures
+    using \l sourceItem, \l textureData or \l textureProvider.
+
+    The default value is \c false.
+*/
+
+bool QQuick3DTexture::streaming() const
+{
+    return m_streaming;
+}
+
+void QQuick3DTexture::setStreaming(bool streaming)
+{
+    if (m_streaming == streaming)
+        return;
+
+    m_streaming = streaming;
+    m_dirtyFlags.setFlag(DirtyFlag::SourceDirty);
+    emit streamingChanged();
+    update();
+}
+
 QT_END_NAMESPACE
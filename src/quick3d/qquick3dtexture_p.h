@@ -55,6 +55,9 @@ class Q_QUICK3D_EXPORT QQuick3DTexture : public QQuick3DObject, public QQuickIte
     Q_PROPERTY(Filter mipFilter READ mipFilter WRITE setMipFilter NOTIFY mipFilterChanged)
     Q_PROPERTY(bool generateMipmaps READ generateMipmaps WRITE setGenerateMipmaps NOTIFY generateMipmapsChanged)
     Q_PROPERTY(bool autoOrientation READ autoOrientation WRITE setAutoOrientation NOTIFY autoOrientationChanged REVISION(6, 2))
+    Q_PROPERTY(bool asynchronous READ asynchronous WRITE setAsynchronous NOTIFY asynchronousChanged REVISION(6, 7))
+    Q_PROPERTY(Status status READ status NOTIFY statusChanged REVISION(6, 7))
+    Q_PROPERTY(bool streaming READ streaming WRITE setStreaming NOTIFY streamingChanged REVISION(6, 7))
 
     QML_NAMED_ELEMENT(Texture)
 
@@ -82,6 +85,9 @@ public:
     };
     Q_ENUM(Filter)
 
+    enum Status { Null, Ready, Loading, Error };
+    Q_ENUM(Status)
+
     explicit QQuick3DTexture(QQuick3DObject *parent = nullptr);
     ~QQuick3DTexture() override;
 
@@ -113,6 +119,12 @@ public:
     Q_REVISION(6, 7) QQuick3DRenderExtension *textureProvider() const;
     Q_REVISION(6, 7) void setTextureProvider(QQuick3DRenderExtension *newRenderTexture);
 
+    Q_REVISION(6, 7) bool asynchronous() const;
+    Q_REVISION(6, 7) void setAsynchronous(bool asynchronous);
+    Q_REVISION(6, 7) Status status() const;
+    Q_REVISION(6, 7) bool streaming() const;
+    Q_REVISION(6, 7) void setStreaming(bool streaming);
+
     bool extensionDirty() const { return m_dirtyFlags.testFlag(DirtyFlag::ExtensionDirty); }
 
 public Q_SLOTS:
@@ -163,6 +175,9 @@ Q_SIGNALS:
     void generateMipmapsChanged();
     void autoOrientationChanged();
     void textureProviderChanged();
+    Q_REVISION(6, 7) void asynchronousChanged();
+    Q_REVISION(6, 7) void statusChanged();
+    Q_REVISION(6, 7) void streamingChanged();
 
 protected:
     QSSGRenderGraphObject *updateSpatialNode(QSSGRenderGraphObject *node) override;
@@ -177,6 +192,9 @@ private Q_SLOTS:
     void sourceItemDestroyed(QObject *item);
 
 private:
+    friend class QQuick3DSceneManager;
+    void setStatus(Status status);
+
     enum class DirtyFlag {
         TransformDirty = (1 << 0),
         SourceDirty = (1 << 1),
@@ -229,6 +247,9 @@ private:
     QQuick3DTextureData *m_textureData = nullptr;
     bool m_generateMipmaps = false;
     bool m_autoOrientation = true;
+    bool m_asynchronous = false;
+    bool m_streaming = false;
+    Status m_status = Null;
     QMetaMethod m_updateSlot;
     QQuick3DRenderExtension *m_renderExtension = nullptr;
 };
@@ -18,6 +18,7 @@
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderlayer_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglayerrenderdata_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
 
 #include <QtQuick3DUtils/private/qssgassert_p.h>
 
@@ -25,6 +26,7 @@
 #include <QSGSimpleTextureNode>
 #include <QSGRendererInterface>
 #include <QQuickWindow>
+#include <QQuickGraphicsConfiguration>
 #include <QtQuick/private/qquickitem_p.h>
 #include <QtQuick/private/qquickpointerhandler_p.h>
 
@@ -634,6 +636,35 @@ QSGNode *QQuick3DViewport::updatePaintNode(QSGNode *node, QQuickItem::UpdatePain
     return node;
 }
 
+// Qt Quick saves and loads the pipeline cache of a window when it is given
+// files for it, and the pipelines of Qt Quick 3D are created with the QRhi of
+// the window. Unless the application chose the files itself, they are put
+// next to the shader cache. This only has an effect before the scenegraph of
+// the window is initialized.
+static void setupPersistentPipelineCache(QQuickWindow *window)
+{
+    if (window->rhi())
+        return;
+
+    QQuickGraphicsConfiguration config = window->graphicsConfiguration();
+    if (!config.pipelineCacheSaveFile().isEmpty() || !config.pipelineCacheLoadFile().isEmpty())
+        return;
+    if (qEnvironmentVariableIsSet("QSG_RHI_PIPELINE_CACHE_SAVE") || qEnvironmentVariableIsSet("QSG_RHI_PIPELINE_CACHE_LOAD"))
+        return;
+
+    const char *apiName = QMetaEnum::fromType<QSGRendererInterface::GraphicsApi>().valueToKey(QQuickWindow::graphicsApi());
+    if (!apiName)
+        return;
+    const QString fileName = QSSGShaderCache::persistentPipelineCacheFileName(QString::fromLatin1(apiName));
+    if (fileName.isEmpty())
+        return;
+
+    config.setPipelineCacheSaveFile(fileName);
+    if (!qEnvironmentVariableIntValue("QT_QUICK3D_NO_SHADER_CACHE_LOAD"))
+        config.setPipelineCacheLoadFile(fileName);
+    window->setGraphicsConfiguration(config);
+}
+
 void QQuick3DViewport::itemChange(QQuickItem::ItemChange change, const QQuickItem::ItemChangeData &value)
 {
     if (change == ItemSceneChange) {
@@ -644,6 +675,7 @@ void QQuick3DViewport::itemChange(QQuickItem::ItemChange change, const QQuickIte
             if (m_importScene)
                 QQuick3DObjectPrivate::get(m_importScene)->sceneManager->setWindow(value.window);
             m_renderStats->setWindow(value.window);
+            setupPersistentPipelineCache(value.window);
         }
     } else if (change == ItemVisibleHasChanged && isVisible()) {
         update();
@@ -861,6 +893,83 @@ QSize QQuick3DViewport::effectiveTextureSize() const
     return m_effectiveTextureSize;
 }
 
+/*!
+    \qmlproperty enumeration QtQuick3D::View3D::shaderCompilationMode
+    \since 6.7
+
+    This property controls how the shaders of materials that have not been
+    seen before are compiled. This happens the first time a combination of a
+    material, its properties and the lights affecting it is rendered, and can
+    take a noticeable amount of time when many of them appear in the same
+    frame.
+
+    \value View3D.Synchronous
+        The shaders are compiled one after the other when the renderer first
+        needs them. This is the default value.
+    \value View3D.Parallel
+        Before a frame is rendered, the shaders needed for it are compiled on
+        worker threads in parallel. The frame is still only rendered once all
+        of them are ready.
+    \value View3D.Asynchronous
+        The shaders are compiled on worker threads without waiting for them.
+        Objects whose shaders are not ready are not rendered in the frame,
+        they appear in a later frame once the compilation has finished.
+
+    Shaders that are already in the shader cache, including the cache on
+    disk, are not affected by this.
+*/
+QQuick3DViewport::ShaderCompilationMode QQuick3DViewport::shaderCompilationMode() const
+{
+    return m_shaderCompilationMode;
+}
+
+void QQuick3DViewport::setShaderCompilationMode(QQuick3DViewport::ShaderCompilationMode mode)
+{
+    if (m_shaderCompilationMode == mode)
+        return;
+
+    m_shaderCompilationMode = mode;
+    emit shaderCompilationModeChanged();
+    update();
+}
+
+/*!
+    \qmlproperty int QtQuick3D::View3D::memoryBudget
+    \since 6.7
+
+    This property holds the amount of mesh and texture data, in megabytes,
+    that is kept loaded when no model or material uses it anymore.
+
+    By default, and when the value is \c 0, meshes and textures loaded from
+    files are released as soon as nothing uses them, unless the
+    \c QT_QUICK3D_MEMORY_BUDGET environment variable gives a budget. With a
+    budget, they stay loaded, so that showing them again, for example when
+    switching back to an earlier scene, does not load them again. Once the
+    loaded data adds up to more than the budget, the meshes and textures
+    that have not been used for the longest time are released first.
+
+    The meshes and textures are shared by all the View3Ds in a window, and so
+    is the budget: when several of them set it, the last change applies.
+
+    \sa RenderStats::evictedResourceCount
+*/
+int QQuick3DViewport::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void QQuick3DViewport::setMemoryBudget(int megabytes)
+{
+    megabytes = qMax(0, megabytes);
+    if (m_memoryBudget == megabytes)
+        return;
+
+    m_memoryBudget = megabytes;
+    m_memoryBudgetDirty = true;
+    emit memoryBudgetChanged();
+    update();
+}
+
 
 /*!
     \qmlmethod vector3d View3D::mapFrom3DScene(vector3d scenePos)
@@ -1041,6 +1150,71 @@ QList<QQuick3DPickResult> QQuick3DViewport::rayPickAll(const QVector3D &origin,
     return processedResultList;
 }
 
+/*!
+    \qmlmethod List<PickResult> View3D::rayPickBatch(list<vector3d> origins, list<vector3d> directions)
+
+    This method will "shoot" one ray for each pair of \a origins and
+    \a directions into the scene and return a list with the information about
+    the nearest intersection of each ray, in the same order as the rays. The
+    result for a ray that does not hit anything has no \l{PickResult::objectHit}{objectHit}.
+
+    The result for each ray is the same as what \l rayPick() would return,
+    but the scene is only traversed once for all the rays and the rays are
+    traced on worker threads. This is meant for casting many rays per frame,
+    for example from the controllers of a VR application.
+
+    Both lists must have the same length, otherwise an empty list is returned.
+
+    \since 6.7
+*/
+QList<QQuick3DPickResult> QQuick3DViewport::rayPickBatch(const QList<QVector3D> &origins, const QList<QVector3D> &directions) const
+{
+    if (origins.size() != directions.size()) {
+        qWarning("View3D::rayPickBatch: %lld origins but %lld directions",
+                 qlonglong(origins.size()), qlonglong(directions.size()));
+        return QList<QQuick3DPickResult>();
+    }
+
+    QQuick3DSceneRenderer *renderer = getRenderer();
+    if (!renderer)
+        return QList<QQuick3DPickResult>(origins.size());
+
+    QVector<QSSGRenderRay> rays;
+    rays.reserve(origins.size());
+    for (qsizetype i = 0, end = origins.size(); i < end; ++i)
+        rays.append(QSSGRenderRay(origins.at(i), directions.at(i)));
+
+    // The results point to backend nodes, mapping them to the frontend
+    // objects has to happen here
+    const auto resultList = renderer->syncPickBatch(rays);
+    QList<QQuick3DPickResult> processedResultList;
+    processedResultList.reserve(resultList.size());
+    for (const auto &result : resultList)
+        processedResultList.append(processPickResult(result));
+
+    return processedResultList;
+}
+
+/*!
+    \qmlmethod View3D::precompileShaders()
+
+    Requests that the shaders needed by the next frame are compiled on worker
+    threads in parallel before that frame is rendered, as if
+    \l shaderCompilationMode was \c View3D.Parallel for that one frame.
+
+    This is meant for warming up the shaders of a scene, for example while it
+    is still covered by a loading screen, when \l shaderCompilationMode is
+    otherwise \c View3D.Synchronous or \c View3D.Asynchronous. Only the
+    shaders of the objects that are visible in that frame are compiled.
+
+    \since 6.7
+*/
+void QQuick3DViewport::precompileShaders()
+{
+    m_precompileShadersRequested = true;
+    update();
+}
+
 void QQuick3DViewport::processPointerEventFromRay(const QVector3D &origin, const QVector3D &direction, QPointerEvent *event)
 {
     internalPick(event, origin, direction);
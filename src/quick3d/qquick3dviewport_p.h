@@ -58,6 +58,8 @@ class Q_QUICK3D_EXPORT QQuick3DViewport : public QQuickItem
     Q_PROPERTY(int explicitTextureWidth READ explicitTextureWidth WRITE setExplicitTextureWidth NOTIFY explicitTextureWidthChanged FINAL REVISION(6, 7))
     Q_PROPERTY(int explicitTextureHeight READ explicitTextureHeight WRITE setExplicitTextureHeight NOTIFY explicitTextureHeightChanged FINAL REVISION(6, 7))
     Q_PROPERTY(QSize effectiveTextureSize READ effectiveTextureSize NOTIFY effectiveTextureSizeChanged FINAL REVISION(6, 7))
+    Q_PROPERTY(ShaderCompilationMode shaderCompilationMode READ shaderCompilationMode WRITE setShaderCompilationMode NOTIFY shaderCompilationModeChanged FINAL REVISION(6, 7))
+    Q_PROPERTY(int memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged FINAL REVISION(6, 7))
     Q_CLASSINFO("DefaultProperty", "data")
 
     QML_NAMED_ELEMENT(View3D)
@@ -71,6 +73,13 @@ public:
     };
     Q_ENUM(RenderMode)
 
+    enum ShaderCompilationMode {
+        Synchronous,
+        Parallel,
+        Asynchronous
+    };
+    Q_ENUM(ShaderCompilationMode)
+
     explicit QQuick3DViewport(QQuickItem *parent = nullptr);
     ~QQuick3DViewport() override;
 
@@ -97,6 +106,8 @@ public:
     Q_REVISION(6, 2) Q_INVOKABLE QList<QQuick3DPickResult> pickAll(float x, float y) const;
     Q_REVISION(6, 2) Q_INVOKABLE QQuick3DPickResult rayPick(const QVector3D &origin, const QVector3D &direction) const;
     Q_REVISION(6, 2) Q_INVOKABLE QList<QQuick3DPickResult> rayPickAll(const QVector3D &origin, const QVector3D &direction) const;
+    Q_REVISION(6, 7) Q_INVOKABLE QList<QQuick3DPickResult> rayPickBatch(const QList<QVector3D> &origins, const QList<QVector3D> &directions) const;
+    Q_REVISION(6, 7) Q_INVOKABLE void precompileShaders();
 
     void processPointerEventFromRay(const QVector3D &origin, const QVector3D &direction, QPointerEvent *event);
 
@@ -110,11 +121,17 @@ public:
     Q_REVISION(6, 7) int explicitTextureWidth() const;
     Q_REVISION(6, 7) int explicitTextureHeight() const;
     Q_REVISION(6, 7) QSize effectiveTextureSize() const;
+    Q_REVISION(6, 7) ShaderCompilationMode shaderCompilationMode() const;
+    Q_REVISION(6, 7) int memoryBudget() const;
 
     // Private helpers
     [[nodiscard]] bool extensionListDirty() const { return m_extensionListDirty; }
     [[nodiscard]] const QList<QQuick3DObject *> &extensionList() const { return m_extensions; }
     void clearExtensionListDirty() { m_extensionListDirty = false; }
+    [[nodiscard]] bool precompileShadersRequested() const { return m_precompileShadersRequested; }
+    void clearPrecompileShadersRequested() { m_precompileShadersRequested = false; }
+    [[nodiscard]] bool memoryBudgetDirty() const { return m_memoryBudgetDirty; }
+    void clearMemoryBudgetDirty() { m_memoryBudgetDirty = false; }
 
     Q_INVOKABLE void rebuildExtensionList();
 
@@ -134,6 +151,8 @@ public Q_SLOTS:
     Q_REVISION(6, 4) void setRenderFormat(QQuickShaderEffectSource::Format format);
     Q_REVISION(6, 7) void setExplicitTextureWidth(int width);
     Q_REVISION(6, 7) void setExplicitTextureHeight(int height);
+    Q_REVISION(6, 7) void setShaderCompilationMode(QQuick3DViewport::ShaderCompilationMode mode);
+    Q_REVISION(6, 7) void setMemoryBudget(int megabytes);
     void cleanupDirectRenderer();
 
     // Setting this true enables picking for all the models, regardless of
@@ -155,6 +174,8 @@ Q_SIGNALS:
     Q_REVISION(6, 7) void explicitTextureWidthChanged();
     Q_REVISION(6, 7) void explicitTextureHeightChanged();
     Q_REVISION(6, 7) void effectiveTextureSizeChanged();
+    Q_REVISION(6, 7) void shaderCompilationModeChanged();
+    Q_REVISION(6, 7) void memoryBudgetChanged();
 
 private:
     friend class QQuick3DExtensionListHelper;
@@ -200,6 +221,10 @@ private:
     int m_explicitTextureWidth = 0;
     int m_explicitTextureHeight = 0;
     QSize m_effectiveTextureSize;
+    ShaderCompilationMode m_shaderCompilationMode = Synchronous;
+    bool m_precompileShadersRequested = false;
+    int m_memoryBudget = 0;
+    bool m_memoryBudgetDirty = false;
     float m_widthMultiplier = 1.0f;
     float m_heightMultiplier = 1.0f;
     QQuick3DRenderStats *m_renderStats = nullptr;
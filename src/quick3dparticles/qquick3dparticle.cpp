@@ -452,6 +452,26 @@ int QQuick3DParticle::nextCurrentIndex(const QQuick3DParticleEmitter *)
     return m_currentIndex;
 }
 
+void QQuick3DParticle::markParticleDataChanged(int index)
+{
+    if (m_particleDataReset)
+        return;
+
+    if (!m_changedParticleData.isEmpty() && m_changedParticleData.last().second == index) {
+        m_changedParticleData.last().second = index + 1;
+        return;
+    }
+
+    // Emitting wraps around the data, so there are usually only a couple of
+    // ranges. Otherwise take everything.
+    if (m_changedParticleData.size() == m_changedParticleData.capacity()) {
+        m_changedParticleData.clear();
+        m_particleDataReset = true;
+        return;
+    }
+    m_changedParticleData.append({ index, index + 1 });
+}
+
 void QQuick3DParticle::componentComplete()
 {
     QQuick3DObject::componentComplete();
@@ -465,6 +485,8 @@ void QQuick3DParticle::reset() {
 
     // Reset all particles data
     m_particleData.fill({});
+    m_changedParticleData.clear();
+    m_particleDataReset = true;
 }
 
 QT_END_NAMESPACE
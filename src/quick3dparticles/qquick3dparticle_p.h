@@ -17,6 +17,7 @@
 
 #include <QColor>
 #include <QVector4D>
+#include <QVarLengthArray>
 
 #include <QtQuick3DParticles/private/qquick3dparticlesystem_p.h>
 #include <QtQuick3DParticles/private/qquick3dparticledata_p.h>
@@ -137,7 +138,15 @@ protected:
         return node;
     }
 
+    // Called by the emitters for each particle they write to m_particleData
+    void markParticleDataChanged(int index);
+
     QList<QQuick3DParticleData> m_particleData;
+    // [begin, end) ranges of m_particleData emitted since they were last
+    // taken, for the particles simulated by the renderer. When
+    // m_particleDataReset is set all the data must be taken instead.
+    QVarLengthArray<std::pair<int, int>, 4> m_changedParticleData;
+    bool m_particleDataReset = true;
     QQuick3DParticleSpriteSequence *m_spriteSequence = nullptr;
 
     int m_maxAmount = 100;
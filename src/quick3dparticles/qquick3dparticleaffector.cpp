@@ -95,6 +95,26 @@ void QQuick3DParticleAffector::prepareToAffect()
 {
 }
 
+void QQuick3DParticleAffector::affectParticles(QQuick3DParticleDataCurrentBatch &batch)
+{
+    for (int i = 0; i < batch.count; ++i) {
+        QQuick3DParticleDataCurrent current = batch.current(i);
+        affectParticle(*batch.data[i], &current, batch.time[i]);
+        batch.setCurrent(i, current);
+    }
+}
+
+bool QQuick3DParticleAffector::isReentrant() const
+{
+    return false;
+}
+
+bool QQuick3DParticleAffector::simulationAffector(QSSGParticleSimulationAffector *affector) const
+{
+    Q_UNUSED(affector);
+    return false;
+}
+
 // Particles
 
 /*!
@@ -25,6 +25,8 @@
 
 QT_BEGIN_NAMESPACE
 
+struct QSSGParticleSimulationAffector;
+
 class Q_QUICK3DPARTICLES_EXPORT QQuick3DParticleAffector : public QQuick3DNode
 {
     Q_OBJECT
@@ -73,6 +75,18 @@ private:
     virtual void prepareToAffect();
     // Called for each living particle attached to the attractor.
     virtual void affectParticle(const QQuick3DParticleData &sd, QQuick3DParticleDataCurrent *d, float time) = 0;
+    // Called for batches of living particles attached to the affector. The
+    // default implementation calls affectParticle() for each of them,
+    // subclasses can override this to process the batch in vectorized loops.
+    virtual void affectParticles(QQuick3DParticleDataCurrentBatch &batch);
+    // Whether affectParticle() may be called from several threads at once
+    // after prepareToAffect(). False by default, affectors which only read
+    // their state while affecting particles can return true.
+    virtual bool isReentrant() const;
+    // Describes the affector for particles simulated by the renderer, called
+    // after prepareToAffect(). Returns false when the affector cannot be
+    // expressed that way, the particles are then updated on the CPU.
+    virtual bool simulationAffector(QSSGParticleSimulationAffector *affector) const;
 
     static void appendParticle(QQmlListProperty<QQuick3DParticle> *, QQuick3DParticle *);
     static qsizetype particleCount(QQmlListProperty<QQuick3DParticle> *);
@@ -5,6 +5,8 @@
 #include "qquick3dparticlerandomizer_p.h"
 #include "qquick3dparticleutils_p.h"
 
+#include <QtQuick3DRuntimeRender/private/qssgrenderparticles_p.h>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -300,4 +302,84 @@ void QQuick3DParticleAttractor::affectParticle(const QQuick3DParticleData &sd, Q
     d->position = (pStart * d->position) + (pEnd * m_particleTransform.map(pos));
 }
 
+void QQuick3DParticleAttractor::affectParticles(QQuick3DParticleDataCurrentBatch &batch)
+{
+    if (!system())
+        return;
+
+    auto rand = system()->rand();
+    const int count = batch.count;
+    const float durationVariation = m_durationVariation / 1000.0f;
+
+    // Gather the per particle values first, so that the blending below can be vectorized
+    float pEnd[QQuick3DParticleDataCurrentBatch::MaxCount];
+    float targetX[QQuick3DParticleDataCurrentBatch::MaxCount];
+    float targetY[QQuick3DParticleDataCurrentBatch::MaxCount];
+    float targetZ[QQuick3DParticleDataCurrentBatch::MaxCount];
+    for (int i = 0; i < count; ++i) {
+        const int index = batch.index[i];
+        float duration = m_duration < 0 ? batch.lifetime[i] : (m_duration / 1000.0f);
+        if (m_durationVariation != 0)
+            duration += durationVariation - 2.0f * rand->get(index, QPRand::AttractorDurationV) * durationVariation;
+        duration = std::max(duration, MIN_DURATION);
+        pEnd[i] = std::min(1.0f, std::max(0.0f, batch.time[i] / duration));
+
+        QVector3D pos = m_centerPos;
+        if (m_shape) {
+            if (m_useCachedPositions)
+                pos += m_shapePositionList[index % m_shapePositionList.size()];
+            else
+                pos += m_shape->getPosition(index);
+        }
+
+        if (!m_positionVariation.isNull()) {
+            pos.setX(pos.x() + m_positionVariation.x() - 2.0f * rand->get(index, QPRand::AttractorPosVX) * m_positionVariation.x());
+            pos.setY(pos.y() + m_positionVariation.y() - 2.0f * rand->get(index, QPRand::AttractorPosVY) * m_positionVariation.y());
+            pos.setZ(pos.z() + m_positionVariation.z() - 2.0f * rand->get(index, QPRand::AttractorPosVZ) * m_positionVariation.z());
+        }
+
+        const QVector3D target = m_particleTransform.map(pos);
+        targetX[i] = target.x();
+        targetY[i] = target.y();
+        targetZ[i] = target.z();
+    }
+
+    // Hidden particles keep their position
+    if (m_hideAtEnd) {
+        for (int i = 0; i < count; ++i) {
+            if (pEnd[i] >= 1.0f) {
+                batch.color[i].a = 0;
+                pEnd[i] = 0.0f;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const float pStart = 1.0f - pEnd[i];
+        batch.positionX[i] = (pStart * batch.positionX[i]) + (pEnd[i] * targetX[i]);
+        batch.positionY[i] = (pStart * batch.positionY[i]) + (pEnd[i] * targetY[i]);
+        batch.positionZ[i] = (pStart * batch.positionZ[i]) + (pEnd[i] * targetZ[i]);
+    }
+}
+
+bool QQuick3DParticleAttractor::isReentrant() const
+{
+    // Shapes calculate their data lazily when asked for positions
+    return !m_shape || m_useCachedPositions;
+}
+
+bool QQuick3DParticleAttractor::simulationAffector(QSSGParticleSimulationAffector *affector) const
+{
+    // Only the variants where all particles share the target and the
+    // duration, the randomized ones stay on the CPU
+    if (m_shape || !m_positionVariation.isNull() || m_durationVariation != 0)
+        return false;
+
+    affector->type = QSSGParticleSimulationAffector::Type::Attractor;
+    affector->vector = m_particleTransform.map(m_centerPos);
+    affector->duration = m_duration < 0 ? -1.0f : std::max(m_duration / 1000.0f, MIN_DURATION);
+    affector->hideAtEnd = m_hideAtEnd;
+    return true;
+}
+
 QT_END_NAMESPACE
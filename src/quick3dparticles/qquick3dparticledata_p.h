@@ -69,6 +69,70 @@ struct QQuick3DParticleData
     // Size: 12+12+3+3+4+4+4+4+4+4 = 54 bytes
 };
 
+// Currently modified data of a batch of living particles, stored as a
+// structure of arrays so that affectors can process it with vectorized loops.
+// The particles are in the order of their indices.
+struct QQuick3DParticleDataCurrentBatch
+{
+    static constexpr int MaxCount = 256;
+
+    int count = 0;
+    int particleIndex[MaxCount];
+    const QQuick3DParticleData *data[MaxCount];
+    // Seconds since the particle was emitted
+    float time[MaxCount];
+    // Copies of the matching QQuick3DParticleData members
+    float lifetime[MaxCount];
+    int index[MaxCount];
+
+    float positionX[MaxCount];
+    float positionY[MaxCount];
+    float positionZ[MaxCount];
+    float rotationX[MaxCount];
+    float rotationY[MaxCount];
+    float rotationZ[MaxCount];
+    float scaleX[MaxCount];
+    float scaleY[MaxCount];
+    float scaleZ[MaxCount];
+    Color4ub color[MaxCount];
+
+    void append(int i, const QQuick3DParticleData *d, float t, const QQuick3DParticleDataCurrent &current)
+    {
+        Q_ASSERT(count < MaxCount);
+        particleIndex[count] = i;
+        data[count] = d;
+        time[count] = t;
+        lifetime[count] = d->lifetime;
+        index[count] = d->index;
+        setCurrent(count, current);
+        count++;
+    }
+
+    QQuick3DParticleDataCurrent current(int i) const
+    {
+        QQuick3DParticleDataCurrent current;
+        current.position = QVector3D(positionX[i], positionY[i], positionZ[i]);
+        current.rotation = QVector3D(rotationX[i], rotationY[i], rotationZ[i]);
+        current.scale = QVector3D(scaleX[i], scaleY[i], scaleZ[i]);
+        current.color = color[i];
+        return current;
+    }
+
+    void setCurrent(int i, const QQuick3DParticleDataCurrent &current)
+    {
+        positionX[i] = current.position.x();
+        positionY[i] = current.position.y();
+        positionZ[i] = current.position.z();
+        rotationX[i] = current.rotation.x();
+        rotationY[i] = current.rotation.y();
+        rotationZ[i] = current.rotation.z();
+        scaleX[i] = current.scale.x();
+        scaleY[i] = current.scale.y();
+        scaleZ[i] = current.scale.z();
+        color[i] = current.color;
+    }
+};
+
 // Data structure for storing bursts
 struct QQuick3DParticleEmitBurstData {
     int amount = 0;
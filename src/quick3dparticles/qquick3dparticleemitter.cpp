@@ -652,6 +652,7 @@ void QQuick3DParticleEmitter::emitParticle(QQuick3DParticle *particle, float sta
         particleDataIndex = mbp->randomIndex(particleDataIndex);
 
     auto d = &particle->m_particleData[particleDataIndex];
+    particle->markParticleDataChanged(particleDataIndex);
     int particleIdIndex = m_system->m_particleIdIndex++;
     if (m_system->m_particleIdIndex == INT_MAX)
         m_system->m_particleIdIndex = 0;
@@ -3,6 +3,8 @@
 
 #include "qquick3dparticlegravity_p.h"
 
+#include <QtQuick3DRuntimeRender/private/qssgrenderparticles_p.h>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -76,4 +78,31 @@ void QQuick3DParticleGravity::affectParticle(const QQuick3DParticleData &sd, QQu
     d->position += velocity * m_directionNormalized;
 }
 
+void QQuick3DParticleGravity::affectParticles(QQuick3DParticleDataCurrentBatch &batch)
+{
+    const float magnitude = 0.5f * m_magnitude;
+    const float dirX = m_directionNormalized.x();
+    const float dirY = m_directionNormalized.y();
+    const float dirZ = m_directionNormalized.z();
+    const int count = batch.count;
+    for (int i = 0; i < count; ++i) {
+        const float velocity = magnitude * (batch.time[i] * batch.time[i]);
+        batch.positionX[i] += velocity * dirX;
+        batch.positionY[i] += velocity * dirY;
+        batch.positionZ[i] += velocity * dirZ;
+    }
+}
+
+bool QQuick3DParticleGravity::isReentrant() const
+{
+    return true;
+}
+
+bool QQuick3DParticleGravity::simulationAffector(QSSGParticleSimulationAffector *affector) const
+{
+    affector->type = QSSGParticleSimulationAffector::Type::Gravity;
+    affector->vector = m_magnitude * m_directionNormalized;
+    return true;
+}
+
 QT_END_NAMESPACE
@@ -44,6 +44,9 @@ Q_SIGNALS:
 
 protected:
     void affectParticle(const QQuick3DParticleData &sd, QQuick3DParticleDataCurrent *d, float time) override;
+    void affectParticles(QQuick3DParticleDataCurrentBatch &batch) override;
+    bool isReentrant() const override;
+    bool simulationAffector(QSSGParticleSimulationAffector *affector) const override;
 
 private:
     float m_magnitude = 100.0f;
@@ -630,7 +630,6 @@ void QQuick3DParticleModelBlendParticle::setParticleData(int particleIndex,
 {
     auto &dst = m_triangleParticleData[particleIndex];
     dst = {position, rotation, dst.center, color, age, size, dst.emitterIndex};
-    m_dataChanged = true;
 }
 
 QQuick3DParticleModelBlendParticle::PerEmitterData &QQuick3DParticleModelBlendParticle::perEmitterData(int emitterIndex)
@@ -100,8 +100,11 @@ protected:
     QVector3D particleEndPosition(int particleIndex) const;
     QVector3D particleEndRotation(int particleIndex) const;
     int randomIndex(int particleIndex);
+    // setParticleData() may be called from several threads, the data is
+    // flagged as changed only once all of it has been set.
     void commitParticles()
     {
+        m_dataChanged = true;
         markAllDirty();
         update();
     }
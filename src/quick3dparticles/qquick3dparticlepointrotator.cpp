@@ -109,4 +109,9 @@ void QQuick3DParticlePointRotator::affectParticle(const QQuick3DParticleData &sd
     }
 }
 
+bool QQuick3DParticlePointRotator::isReentrant() const
+{
+    return true;
+}
+
 QT_END_NAMESPACE
@@ -49,6 +49,7 @@ Q_SIGNALS:
 protected:
     void prepareToAffect() override;
     void affectParticle(const QQuick3DParticleData &sd, QQuick3DParticleDataCurrent *d, float time) override;
+    bool isReentrant() const override;
 
 private:
     float m_magnitude = 10.0f;
@@ -108,4 +108,9 @@ void QQuick3DParticleRepeller::affectParticle(const QQuick3DParticleData &, QQui
         d->position += dir * m_strength * (1.0f - qt_smoothstep(m_radius, outerRadius, radius)) / radius;
 }
 
+bool QQuick3DParticleRepeller::isReentrant() const
+{
+    return true;
+}
+
 QT_END_NAMESPACE
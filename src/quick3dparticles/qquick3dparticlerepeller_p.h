@@ -47,6 +47,7 @@ Q_SIGNALS:
 protected:
     void prepareToAffect() override;
     void affectParticle(const QQuick3DParticleData &sd, QQuick3DParticleDataCurrent *d, float time) override;
+    bool isReentrant() const override;
 
 private:
     float m_radius = 0.0f;
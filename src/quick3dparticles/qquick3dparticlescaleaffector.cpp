@@ -193,4 +193,9 @@ void QQuick3DParticleScaleAffector::affectParticle(const QQuick3DParticleData &,
     d->scale *= scale;
 }
 
+bool QQuick3DParticleScaleAffector::isReentrant() const
+{
+    return true;
+}
+
 QT_END_NAMESPACE
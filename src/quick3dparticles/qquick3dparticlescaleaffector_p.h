@@ -67,6 +67,7 @@ Q_SIGNALS:
 protected:
     void prepareToAffect() override;
     void affectParticle(const QQuick3DParticleData &, QQuick3DParticleDataCurrent *d, float time) override;
+    bool isReentrant() const override;
 
 private:
     float m_minSize = 1.0f;
@@ -356,7 +356,9 @@ QSSGRenderGraphObject *QQuick3DParticleSpriteParticle::ParticleUpdateNode::updat
         Q_QUICK3D_PROFILE_ASSIGN_ID_SG(m_particle, node);
         auto particles = static_cast<QSSGRenderParticles *>(node);
 
-        if (m_particle->m_featureLevel == QQuick3DParticleSpriteParticle::Animated || m_particle->m_featureLevel == QQuick3DParticleSpriteParticle::AnimatedVLight)
+        if (m_particle->m_simulated)
+            m_particle->updateSimulation(this, particles);
+        else if (m_particle->m_featureLevel == QQuick3DParticleSpriteParticle::Animated || m_particle->m_featureLevel == QQuick3DParticleSpriteParticle::AnimatedVLight)
             m_particle->updateAnimatedParticleBuffer(this, particles);
         else
             m_particle->updateParticleBuffer(this, particles);
@@ -562,67 +564,55 @@ void QQuick3DParticleSpriteParticle::updateParticleBuffer(ParticleUpdateNode *up
     if (!node)
         return;
     const int particleCount = perEmitter.particleCount;
+    if (node->m_simulation.enabled) {
+        // The buffer only had the layout for the renderer
+        node->m_simulation = QSSGParticleSimulation();
+        node->m_particleBuffer.resize(0);
+    }
     if (node->m_particleBuffer.particleCount() != particleCount || m_useAnimatedParticle)
         node->m_particleBuffer.resize(particleCount, sizeof(QSSGParticleSimple));
 
     m_useAnimatedParticle = false;
     char *dest = node->m_particleBuffer.pointer();
     const SpriteParticleData *src = particles.data();
+    const int sourceCount = int(particles.size());
     const int pps = node->m_particleBuffer.particlesPerSlice();
     const int ss = node->m_particleBuffer.sliceStride();
-    const int slices = node->m_particleBuffer.sliceCount();
     const int emitterIndex = perEmitter.emitterIndex;
+    const auto smode = sortMode();
+    const bool ordered = (smode == QQuick3DParticle::SortNewest || smode == QQuick3DParticle::SortOldest);
+    const int offset = m_currentIndex;
+    const int step = (smode == QQuick3DParticle::SortNewest) ? -1 : 1;
+    const auto sourceIndex = [&](int linearIndex) -> int {
+        return ordered ? (linearIndex * step + offset + m_maxAmount) % m_maxAmount : linearIndex;
+    };
+
+    // Only the living particles are written, packed to the start of the
+    // buffer, so that the renderer can upload, sort and draw just those.
+    QSSGParticleSimple *dp = reinterpret_cast<QSSGParticleSimple *>(dest);
     int i = 0;
+    int p = 0;
     QSSGBounds3 bounds;
-    const auto smode = sortMode();
-    if (smode == QQuick3DParticle::SortNewest || smode == QQuick3DParticle::SortOldest) {
-        int offset = m_currentIndex;
-        int step = (smode == QQuick3DParticle::SortNewest) ? -1 : 1;
-        int li = 0;
-        const auto sourceIndex = [&](int linearIndex, int offset, int wrap) -> int {
-            return (linearIndex + offset + wrap) % wrap;
-        };
-        for (int s = 0; s < slices; s++) {
-            QSSGParticleSimple *dp = reinterpret_cast<QSSGParticleSimple *>(dest);
-            for (int p = 0; p < pps && i < particleCount; ) {
-                const SpriteParticleData *data = src + sourceIndex(li * step, offset, m_maxAmount);
-                if (data->emitterIndex == emitterIndex) {
-                    if (data->size > 0.0f)
-                        bounds.include(data->position);
-                    dp->position = data->position;
-                    dp->rotation = data->rotation * float(M_PI / 180.0f);
-                    dp->color = data->color;
-                    dp->size = data->size * m_particleScale;
-                    dp->age = data->age;
-                    dp++;
-                    p++;
-                    i++;
-                }
-                li++;
-            }
-            dest += ss;
-        }
-    } else {
-        for (int s = 0; s < slices; s++) {
-            QSSGParticleSimple *dp = reinterpret_cast<QSSGParticleSimple *>(dest);
-            for (int p = 0; p < pps && i < particleCount; ) {
-                if (src->emitterIndex == emitterIndex) {
-                    if (src->size > 0.0f)
-                        bounds.include(src->position);
-                    dp->position = src->position;
-                    dp->rotation = src->rotation * float(M_PI / 180.0f);
-                    dp->color = src->color;
-                    dp->size = src->size * m_particleScale;
-                    dp->age = src->age;
-                    dp++;
-                    p++;
-                    i++;
-                }
-                src++;
-            }
+    for (int li = 0; li < sourceCount && i < particleCount; li++) {
+        const SpriteParticleData *data = src + sourceIndex(li);
+        if (data->emitterIndex != emitterIndex || data->size <= 0.0f)
+            continue;
+        if (p == pps) {
             dest += ss;
+            dp = reinterpret_cast<QSSGParticleSimple *>(dest);
+            p = 0;
         }
+        bounds.include(data->position);
+        dp->position = data->position;
+        dp->rotation = data->rotation * float(M_PI / 180.0f);
+        dp->color = data->color;
+        dp->size = data->size * m_particleScale;
+        dp->age = data->age;
+        dp++;
+        p++;
+        i++;
     }
+    node->m_particleBuffer.setUsedCount(i);
     node->m_particleBuffer.setBounds(bounds);
 }
 
@@ -634,70 +624,195 @@ void QQuick3DParticleSpriteParticle::updateAnimatedParticleBuffer(ParticleUpdate
     if (!node)
         return;
     const int particleCount = perEmitter.particleCount;
+    if (node->m_simulation.enabled) {
+        // The buffer only had the layout for the renderer
+        node->m_simulation = QSSGParticleSimulation();
+        node->m_particleBuffer.resize(0);
+    }
     if (node->m_particleBuffer.particleCount() != particleCount || !m_useAnimatedParticle)
         node->m_particleBuffer.resize(particleCount, sizeof(QSSGParticleAnimated));
 
     m_useAnimatedParticle = true;
     char *dest = node->m_particleBuffer.pointer();
     const SpriteParticleData *src = particles.data();
+    const int sourceCount = int(particles.size());
     const int pps = node->m_particleBuffer.particlesPerSlice();
     const int ss = node->m_particleBuffer.sliceStride();
-    const int slices = node->m_particleBuffer.sliceCount();
     const int emitterIndex = perEmitter.emitterIndex;
+    const auto smode = sortMode();
+    const bool ordered = (smode == QQuick3DParticle::SortNewest || smode == QQuick3DParticle::SortOldest);
+    const int offset = m_currentIndex;
+    const int step = (smode == QQuick3DParticle::SortNewest) ? -1 : 1;
+    const auto sourceIndex = [&](int linearIndex) -> int {
+        return ordered ? (linearIndex * step + offset + m_maxAmount) % m_maxAmount : linearIndex;
+    };
+
+    // Only the living particles are written, packed to the start of the
+    // buffer, so that the renderer can upload, sort and draw just those.
+    QSSGParticleAnimated *dp = reinterpret_cast<QSSGParticleAnimated *>(dest);
     int i = 0;
+    int p = 0;
     QSSGBounds3 bounds;
-    const auto smode = sortMode();
-    if (smode == QQuick3DParticle::SortNewest || smode == QQuick3DParticle::SortOldest) {
-        int offset = m_currentIndex;
-        int step = (smode == QQuick3DParticle::SortNewest) ? -1 : 1;
-        int li = 0;
-        const auto sourceIndex = [&](int linearIndex, int offset, int wrap) -> int {
-            return (linearIndex + offset + wrap) % wrap;
-        };
-        for (int s = 0; s < slices; s++) {
-            QSSGParticleAnimated *dp = reinterpret_cast<QSSGParticleAnimated *>(dest);
-            for (int p = 0; p < pps && i < particleCount; ) {
-                const SpriteParticleData *data = src + sourceIndex(li * step, offset, m_maxAmount);
-                if (data->emitterIndex == emitterIndex) {
-                    if (data->size > 0.0f)
-                        bounds.include(data->position);
-                    dp->position = data->position;
-                    dp->rotation = data->rotation * float(M_PI / 180.0f);
-                    dp->color = data->color;
-                    dp->size = data->size * m_particleScale;
-                    dp->age = data->age;
-                    dp->animationFrame = data->animationFrame;
-                    dp++;
-                    p++;
-                    i++;
-                }
-                li++;
-            }
+    for (int li = 0; li < sourceCount && i < particleCount; li++) {
+        const SpriteParticleData *data = src + sourceIndex(li);
+        if (data->emitterIndex != emitterIndex || data->size <= 0.0f)
+            continue;
+        if (p == pps) {
             dest += ss;
+            dp = reinterpret_cast<QSSGParticleAnimated *>(dest);
+            p = 0;
         }
-    } else {
-        for (int s = 0; s < slices; s++) {
-            QSSGParticleAnimated *dp = reinterpret_cast<QSSGParticleAnimated *>(dest);
-            for (int p = 0; p < pps && i < particleCount; ) {
-                if (src->emitterIndex == emitterIndex) {
-                    if (src->size > 0.0f)
-                        bounds.include(src->position);
-                    dp->position = src->position;
-                    dp->rotation = src->rotation * float(M_PI / 180.0f);
-                    dp->color = src->color;
-                    dp->size = src->size * m_particleScale;
-                    dp->age = src->age;
-                    dp->animationFrame = src->animationFrame;
-                    dp++;
-                    p++;
-                    i++;
-                }
-                src++;
+        bounds.include(data->position);
+        dp->position = data->position;
+        dp->rotation = data->rotation * float(M_PI / 180.0f);
+        dp->color = data->color;
+        dp->size = data->size * m_particleScale;
+        dp->age = data->age;
+        dp->animationFrame = data->animationFrame;
+        dp++;
+        p++;
+        i++;
+    }
+    node->m_particleBuffer.setUsedCount(i);
+    node->m_particleBuffer.setBounds(bounds);
+}
+
+static QSSGParticleSimulationData toSimulationData(const QQuick3DParticleData &d)
+{
+    // See QQuick3DParticleSystem::processParticleCommon
+    constexpr float step = 360.0f / 127.0f;
+    const auto &rv = d.startRotationVelocity;
+    QSSGParticleSimulationData s;
+    s.startPosition = d.startPosition;
+    s.startTime = d.startTime;
+    s.startVelocity = d.startVelocity;
+    s.lifetime = d.lifetime;
+    s.startRotation = QVector3D(d.startRotation.x, d.startRotation.y, d.startRotation.z) * step;
+    s.startSize = d.startSize;
+    s.rotationVelocity = QVector3D(abs(rv.x) * rv.x, abs(rv.y) * rv.y, abs(rv.z) * rv.z);
+    s.endSize = d.endSize;
+    s.color = QVector4D(d.startColor.r, d.startColor.g, d.startColor.b, d.startColor.a) / 255.0f;
+    return s;
+}
+
+static QSSGParticleSimulation::Fade mapFade(QQuick3DParticle::FadeType fade)
+{
+    switch (fade) {
+    case QQuick3DParticle::FadeNone:
+        return QSSGParticleSimulation::Fade::None;
+    case QQuick3DParticle::FadeOpacity:
+        return QSSGParticleSimulation::Fade::Opacity;
+    case QQuick3DParticle::FadeScale:
+        return QSSGParticleSimulation::Fade::Scale;
+    }
+    return QSSGParticleSimulation::Fade::None;
+}
+
+void QQuick3DParticleSpriteParticle::setSimulated(bool simulated)
+{
+    if (m_simulated == simulated)
+        return;
+
+    m_simulated = simulated;
+    // The renderer needs all the start data, and the CPU path updates all
+    // the particles anyway.
+    m_changedParticleData.clear();
+    m_particleDataReset = true;
+}
+
+int QQuick3DParticleSpriteParticle::prepareSimulationUpdate(float time)
+{
+    m_simulationTime = time;
+
+    // Conservative bounds of the particles over their whole lifetime, so that
+    // these only change with emitting. The motion is a line bent by the
+    // gravities and pulled towards the attractor targets.
+    QSSGBounds3 bounds;
+    int used = 0;
+    float maxLifetime = 0.0f;
+    float maxSize = 0.0f;
+    for (const QQuick3DParticleData &d : std::as_const(m_particleData)) {
+        if (time < d.startTime || time > d.startTime + d.lifetime)
+            continue;
+        bounds.include(d.startPosition);
+        bounds.include(d.startPosition + d.startVelocity * d.lifetime);
+        maxLifetime = std::max(maxLifetime, d.lifetime);
+        maxSize = std::max(maxSize, std::max(d.startSize, d.endSize));
+        used++;
+    }
+
+    if (used > 0) {
+        QVector3D accelerationMin;
+        QVector3D accelerationMax;
+        for (const QSSGParticleSimulationAffector &affector : std::as_const(m_simulationAffectors)) {
+            if (affector.type == QSSGParticleSimulationAffector::Type::Attractor) {
+                bounds.include(affector.vector);
+            } else {
+                const QVector3D distance = (0.5f * maxLifetime * maxLifetime) * affector.vector;
+                accelerationMin += QSSGUtils::vec3::minimum(distance, QVector3D());
+                accelerationMax += QSSGUtils::vec3::maximum(distance, QVector3D());
             }
-            dest += ss;
         }
+        const QVector3D offset = QVector3D(std::abs(offsetX()), std::abs(offsetY()), 0.0f) * maxSize;
+        bounds.minimum += accelerationMin - offset;
+        bounds.maximum += accelerationMax + offset;
     }
-    node->m_particleBuffer.setBounds(bounds);
+
+    m_simulationBounds = bounds;
+    m_simulationParticlesUsed = used;
+    return used;
+}
+
+void QQuick3DParticleSpriteParticle::updateSimulation(ParticleUpdateNode *updateNode, QSSGRenderGraphObject *spatialNode)
+{
+    Q_UNUSED(updateNode);
+    QSSGRenderParticles *node = static_cast<QSSGRenderParticles *>(spatialNode);
+    if (!node)
+        return;
+
+    // The particles keep their indices, the renderer writes the buffer
+    QSSGParticleSimulation &simulation = node->m_simulation;
+    const int particleCount = int(m_particleData.size());
+    if (!simulation.enabled || simulation.particleCount() != particleCount
+            || node->m_particleBuffer.particleCount() != particleCount || m_useAnimatedParticle) {
+        node->m_particleBuffer.resizeLayout(particleCount, sizeof(QSSGParticleSimple));
+        simulation.particles.resize(particleCount * sizeof(QSSGParticleSimulationData));
+        m_changedParticleData.clear();
+        m_particleDataReset = true;
+    }
+    m_useAnimatedParticle = false;
+    simulation.enabled = true;
+
+    auto *dst = reinterpret_cast<QSSGParticleSimulationData *>(simulation.particles.data());
+    simulation.changedRanges.clear();
+    if (m_particleDataReset) {
+        for (int i = 0; i < particleCount; ++i)
+            dst[i] = toSimulationData(m_particleData.at(i));
+        simulation.changedRanges.append({ 0, particleCount });
+    } else {
+        for (const auto &range : std::as_const(m_changedParticleData)) {
+            for (int i = range.first; i < range.second; ++i)
+                dst[i] = toSimulationData(m_particleData.at(i));
+            simulation.changedRanges.append(range);
+        }
+    }
+    if (!simulation.changedRanges.isEmpty())
+        simulation.serial++;
+    m_changedParticleData.clear();
+    m_particleDataReset = false;
+
+    simulation.time = m_simulationTime;
+    simulation.affectors = m_simulationAffectors;
+    simulation.fadeInDuration = fadeInDuration() / 1000.0f;
+    simulation.fadeOutDuration = fadeOutDuration() / 1000.0f;
+    simulation.fadeIn = mapFade(fadeInEffect());
+    simulation.fadeOut = mapFade(fadeOutEffect());
+    simulation.offset = QVector2D(offsetX(), offsetY());
+    simulation.particleScale = m_particleScale;
+
+    // Nothing to draw without living particles
+    node->m_particleBuffer.setUsedCount(m_simulationParticlesUsed > 0 ? particleCount : 0);
+    node->m_particleBuffer.setBounds(m_simulationBounds);
 }
 
 void QQuick3DParticleSpriteParticle::updateSceneManager(QQuick3DSceneManager *sceneManager)
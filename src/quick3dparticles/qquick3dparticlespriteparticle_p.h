@@ -175,6 +175,11 @@ private:
 
     void updateParticleBuffer(ParticleUpdateNode *updateNode, QSSGRenderGraphObject *node);
     void updateAnimatedParticleBuffer(ParticleUpdateNode *updateNode, QSSGRenderGraphObject *node);
+    void updateSimulation(ParticleUpdateNode *updateNode, QSSGRenderGraphObject *node);
+    // For particles simulated by the renderer, instead of updating them.
+    // Returns the amount of living particles.
+    int prepareSimulationUpdate(float time);
+    void setSimulated(bool simulated);
     void updateSceneManager(QQuick3DSceneManager *window);
 
 
@@ -198,6 +203,13 @@ private:
     QVector<QQuick3DAbstractLight *> m_lights;
     QVector3D m_offset = {};
     bool m_castsReflections = true;
+
+    // Simulation by the renderer, see QQuick3DParticleSystem::gpuSimulation
+    bool m_simulated = false;
+    float m_simulationTime = 0.0f;
+    int m_simulationParticlesUsed = 0;
+    QSSGBounds3 m_simulationBounds;
+    QVarLengthArray<QSSGParticleSimulationAffector, QSSGParticleSimulation::MaxAffectors> m_simulationAffectors;
 };
 
 QT_END_NAMESPACE
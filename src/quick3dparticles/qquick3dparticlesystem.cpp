@@ -14,7 +14,12 @@
 #include "qquick3dparticlemodelblendparticle_p.h"
 #include <QtQuick3DUtils/private/qquick3dprofiler_p.h>
 #include <qtquick3d_tracepoints_p.h>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVarLengthArray>
 #include <cmath>
+#include <numeric>
 
 QT_BEGIN_NAMESPACE
 
@@ -241,6 +246,28 @@ QQuick3DParticleSystemLogging *QQuick3DParticleSystem::loggingData() const
     return m_loggingData;
 }
 
+/*!
+    \qmlproperty bool ParticleSystem3D::gpuSimulation
+    \since 6.7
+
+    Set this to true to let the renderer simulate the sprite particles of the system. Only the
+    emitting is then done on the CPU, the state of the living particles is computed from their
+    start data on the GPU, using compute shaders when those are available. This scales to far
+    larger amounts of particles.
+
+    Only sprite particles without a \l {SpriteParticle3D::spriteSequence}{spriteSequence}, emitted
+    by a single emitter and not followed by trail emitters are simulated, and only when all the
+    affectors of the particles can be evaluated on the GPU. These are \l Gravity3D, and
+    \l Attractor3D without a shape, position variation or duration variation. Other particles
+    are updated on the CPU as usual.
+
+    The default value is \c false.
+*/
+bool QQuick3DParticleSystem::gpuSimulation() const
+{
+    return m_gpuSimulation;
+}
+
 /*!
     \qmlmethod  ParticleSystem3D::reset()
 
@@ -374,6 +401,18 @@ void QQuick3DParticleSystem::setEditorTime(int time)
     m_updateAnimation->setDirty(true);
 }
 
+// Takes effect from the next update, the particle types that can't be
+// simulated by the renderer stay on the CPU
+void QQuick3DParticleSystem::setGpuSimulation(bool gpuSimulation)
+{
+    if (m_gpuSimulation == gpuSimulation)
+        return;
+
+    m_gpuSimulation = gpuSimulation;
+    markDirty();
+    Q_EMIT gpuSimulationChanged();
+}
+
 void QQuick3DParticleSystem::componentComplete()
 {
     QQuick3DNode::componentComplete();
@@ -441,20 +480,25 @@ void QQuick3DParticleSystem::registerParticle(QQuick3DParticle *particle)
         return;
     }
     m_particles << particle;
+    m_particleUpdatesDirty = true;
 }
 
 void QQuick3DParticleSystem::registerParticleModel(QQuick3DParticleModelParticle *m)
 {
     m_particles << m;
+    m_particleUpdatesDirty = true;
 }
 
 void QQuick3DParticleSystem::registerParticleSprite(QQuick3DParticleSpriteParticle *m)
 {
     m_particles << m;
+    m_particleUpdatesDirty = true;
 }
 
 void QQuick3DParticleSystem::unRegisterParticle(QQuick3DParticle *particle)
 {
+    m_particleUpdatesDirty = true;
+
     auto *model = qobject_cast<QQuick3DParticleModelParticle *>(particle);
     if (model) {
         m_particles.removeAll(particle);
@@ -500,6 +544,52 @@ void QQuick3DParticleSystem::unRegisterParticleAffector(QQuick3DParticleAffector
     m_affectors.removeAll(a);
 }
 
+static constexpr int MIN_PARTICLES_PER_UPDATE_JOB = 2048;
+
+static int maxParticleUpdateJobs()
+{
+    // 0 (or unset): serial, 1: one job per core, N > 1: at most N jobs
+    static const int jobs = [] {
+        const int value = qEnvironmentVariableIntValue("QT_QUICK3D_PARALLEL_PARTICLES");
+        if (value <= 0)
+            return 1;
+        return value == 1 ? QThread::idealThreadCount() : value;
+    }();
+    return jobs;
+}
+
+// Calls update(begin, end) for jobCount ranges of [0, count) and returns the
+// sum of the results, which is the amount of particles alive.
+template <typename UpdateFunc>
+static int runParticleUpdateJobs(int jobCount, int count, const UpdateFunc &update)
+{
+    if (jobCount <= 1)
+        return update(0, count);
+
+    QVarLengthArray<int, 32> used(jobCount, 0);
+    const auto runJob = [&](int i) {
+        const int begin = int(qint64(count) * i / jobCount);
+        const int end = int(qint64(count) * (i + 1) / jobCount);
+        used[i] = update(begin, end);
+    };
+
+    // The first job runs on this thread. If the pool is busy, the job is run
+    // here as well instead of waiting for a free thread.
+    QSemaphore done;
+    int started = 0;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (int i = 1; i < jobCount; ++i) {
+        if (pool->tryStart([&runJob, &done, i] { runJob(i); done.release(); }))
+            ++started;
+        else
+            runJob(i);
+    }
+    runJob(0);
+    done.acquire(started);
+
+    return std::accumulate(used.cbegin(), used.cend(), 0);
+}
+
 void QQuick3DParticleSystem::updateCurrentTime(int currentTime)
 {
     if (!m_initialized || isGloballyDisabled() || (isEditorModeOn() && !visible()))
@@ -528,39 +618,25 @@ void QQuick3DParticleSystem::updateCurrentTime(int currentTime)
             affector->prepareToAffect();
     }
 
-    // Animate current particles
-    for (auto particle : std::as_const(m_particles)) {
-
-        // Collect possible trail emits
-        QVector<TrailEmits> trailEmits;
-        for (auto emitter : std::as_const(m_trailEmitters)) {
-            if (emitter->follow() == particle) {
-                int emitAmount = emitter->getEmitAmount();
-                if (emitAmount > 0 || emitter->hasBursts()) {
-                    TrailEmits e;
-                    e.emitter = emitter;
-                    e.amount = emitAmount;
-                    trailEmits << e;
-                }
-            }
-        }
-
-        m_particlesMax += particle->maxAmount();
+    prepareParticleUpdates();
 
-        QQuick3DParticleSpriteParticle *spriteParticle = qobject_cast<QQuick3DParticleSpriteParticle *>(particle);
-        if (spriteParticle) {
-            processSpriteParticle(spriteParticle, trailEmits, timeS);
-            continue;
-        }
-        QQuick3DParticleModelParticle *modelParticle = qobject_cast<QQuick3DParticleModelParticle *>(particle);
-        if (modelParticle) {
-            processModelParticle(modelParticle, trailEmits, timeS);
-            continue;
-        }
-        QQuick3DParticleModelBlendParticle *mbp = qobject_cast<QQuick3DParticleModelBlendParticle *>(particle);
-        if (mbp) {
-            processModelBlendParticle(mbp, trailEmits, timeS);
-            continue;
+    // Animate current particles
+    for (const auto &update : std::as_const(m_particleUpdates)) {
+        m_particlesMax += update.particle->maxAmount();
+
+        switch (update.type) {
+        case ParticleType::Sprite:
+        case ParticleType::Line:
+            processSpriteParticle(update, timeS);
+            break;
+        case ParticleType::Model:
+            processModelParticle(update, timeS);
+            break;
+        case ParticleType::ModelBlend:
+            processModelBlendParticle(update, timeS);
+            break;
+        case ParticleType::Other:
+            break;
         }
     }
 
@@ -576,266 +652,502 @@ void QQuick3DParticleSystem::updateCurrentTime(int currentTime)
 
 }
 
-void QQuick3DParticleSystem::processModelParticle(QQuick3DParticleModelParticle *modelParticle, const QVector<TrailEmits> &trailEmits, float timeS)
+void QQuick3DParticleSystem::prepareParticleUpdates()
 {
-    modelParticle->clearInstanceTable();
-
-    const int c = modelParticle->maxAmount();
+    if (m_particleUpdatesDirty) {
+        m_particleUpdates.clear();
+        m_particleUpdates.reserve(m_particles.size());
+        for (auto particle : std::as_const(m_particles)) {
+            ParticleUpdate update;
+            update.particle = particle;
+            if (qobject_cast<QQuick3DParticleLineParticle *>(particle))
+                update.type = ParticleType::Line;
+            else if (qobject_cast<QQuick3DParticleSpriteParticle *>(particle))
+                update.type = ParticleType::Sprite;
+            else if (qobject_cast<QQuick3DParticleModelParticle *>(particle))
+                update.type = ParticleType::Model;
+            else if (qobject_cast<QQuick3DParticleModelBlendParticle *>(particle))
+                update.type = ParticleType::ModelBlend;
+            m_particleUpdates << update;
+        }
+        m_particleUpdatesDirty = false;
+    }
 
-    for (int i = 0; i < c; i++) {
-        const auto d = &modelParticle->m_particleData.at(i);
+    // Clearing keeps the capacity, so there are no allocations after the first frames
+    for (auto &update : m_particleUpdates) {
+        update.trailEmits.clear();
+        update.affectors.clear();
+    }
 
-        const float particleTimeEnd = d->startTime + d->lifetime;
+    // Collect possible trail emits
+    for (auto emitter : std::as_const(m_trailEmitters)) {
+        const auto follow = emitter->follow();
+        if (!follow)
+            continue;
+        const auto it = std::find_if(m_particleUpdates.begin(), m_particleUpdates.end(),
+                                     [follow](const ParticleUpdate &update) { return update.particle == follow; });
+        if (it == m_particleUpdates.end())
+            continue;
+        int emitAmount = emitter->getEmitAmount();
+        if (emitAmount > 0 || emitter->hasBursts()) {
+            TrailEmits e;
+            e.emitter = emitter;
+            e.amount = emitAmount;
+            it->trailEmits << e;
+        }
+    }
 
-        if (timeS < d->startTime || timeS > particleTimeEnd) {
-            if (timeS > particleTimeEnd && d->lifetime > 0.0f) {
-                for (auto trailEmit : std::as_const(trailEmits))
-                    trailEmit.emitter->emitTrailParticles(d->startPosition + (d->startVelocity * (particleTimeEnd - d->startTime)), 0, QQuick3DParticleDynamicBurst::TriggerEnd);
+    const int maxJobs = maxParticleUpdateJobs();
+    for (auto &update : m_particleUpdates) {
+        bool reentrant = true;
+        for (auto affector : std::as_const(m_affectors)) {
+            // If affector is set to affect only particular particles, check these are included
+            if (affector->m_enabled && (affector->m_particles.isEmpty() || affector->m_particles.contains(update.particle))) {
+                update.affectors << affector;
+                reentrant = reentrant && affector->isReentrant();
             }
-            // Particle not alive currently
-            continue;
         }
 
-        const float particleTimeS = timeS - d->startTime;
-        QQuick3DParticleDataCurrent currentData;
-        if (timeS >= d->startTime && d->lifetime <= 0.0f) {
-            for (auto trailEmit : std::as_const(trailEmits))
-                trailEmit.emitter->emitTrailParticles(d->startPosition, 0, QQuick3DParticleDynamicBurst::TriggerStart);
+        // Trail emitters and line segments are updated as the particles are
+        // processed, in order, so those particles are processed serially.
+        if (!reentrant || !update.trailEmits.isEmpty() || update.type == ParticleType::Line)
+            update.jobCount = 1;
+        else
+            update.jobCount = qBound(1, update.particle->maxAmount() / MIN_PARTICLES_PER_UPDATE_JOB, maxJobs);
+
+        // Particles emitted into the particle type itself must be seen by
+        // the following particles, like when processing one by one.
+        update.batchSize = QQuick3DParticleDataCurrentBatch::MaxCount;
+        for (const auto &trailEmit : std::as_const(update.trailEmits)) {
+            if (trailEmit.emitter->particle() == update.particle)
+                update.batchSize = 1;
         }
-        // Process features shared for both model & sprite particles
-        processParticleCommon(currentData, d, particleTimeS);
 
-        // Add a base rotation if alignment requested
-        if (modelParticle->m_alignMode != QQuick3DParticle::AlignNone)
-            processParticleAlignment(currentData, modelParticle, d);
+        if (update.type == ParticleType::Sprite) {
+            auto *spriteParticle = static_cast<QQuick3DParticleSpriteParticle *>(update.particle);
+            update.simulated = m_gpuSimulation && prepareSimulation(update);
+            spriteParticle->setSimulated(update.simulated);
+        }
+    }
+}
 
-        // 0.0 -> 1.0 during the particle lifetime
-        const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+bool QQuick3DParticleSystem::prepareSimulation(const ParticleUpdate &update)
+{
+    auto *spriteParticle = static_cast<QQuick3DParticleSpriteParticle *>(update.particle);
+
+    // Sprite sequences, alignment and the trails need the current state of
+    // the particles on the CPU, as does ordering them by their age.
+    const auto sortMode = spriteParticle->sortMode();
+    if (spriteParticle->m_spriteSequence
+            || (!spriteParticle->m_billboard && spriteParticle->m_alignMode != QQuick3DParticle::AlignNone)
+            || !update.trailEmits.isEmpty()
+            || spriteParticle->m_perEmitterData.size() > 1
+            || (sortMode != QQuick3DParticle::SortNone && sortMode != QQuick3DParticle::SortDistance)
+            || update.affectors.size() > QSSGParticleSimulation::MaxAffectors) {
+        return false;
+    }
 
-        // Scale from initial to endScale
-        currentData.scale = modelParticle->m_initialScale * (d->endSize * timeChange + d->startSize * (1.0f - timeChange));
+    auto &affectors = spriteParticle->m_simulationAffectors;
+    affectors.resize(update.affectors.size());
+    for (qsizetype i = 0; i < update.affectors.size(); ++i) {
+        if (!update.affectors[i]->simulationAffector(&affectors[i]))
+            return false;
+    }
+    return true;
+}
 
-        // Fade in & out
-        const float particleTimeLeftS = d->lifetime - particleTimeS;
-        processParticleFadeInOut(currentData, modelParticle, particleTimeS, particleTimeLeftS);
+void QQuick3DParticleSystem::processModelParticle(const ParticleUpdate &update, float timeS)
+{
+    auto *modelParticle = static_cast<QQuick3DParticleModelParticle *>(update.particle);
+    modelParticle->clearInstanceTable();
 
-        // Affectors
-        for (auto affector : std::as_const(m_affectors)) {
-            // If affector is set to affect only particular particles, check these are included
-            if (affector->m_enabled && (affector->m_particles.isEmpty() || affector->m_particles.contains(modelParticle)))
-                affector->affectParticle(*d, &currentData, particleTimeS);
-        }
+    const int c = modelParticle->maxAmount();
+    m_modelParticleInstances.resize(c);
 
-        // Emit new particles from trails
-        for (auto trailEmit : std::as_const(trailEmits))
-            trailEmit.emitter->emitTrailParticles(currentData.position, trailEmit.amount, QQuick3DParticleDynamicBurst::TriggerTime);
+    m_particlesUsed += runParticleUpdateJobs(update.jobCount, c, [&](int begin, int end) {
+        return updateModelParticles(update, timeS, begin, end);
+    });
 
-        const QColor color(currentData.color.r, currentData.color.g, currentData.color.b, currentData.color.a);
-        // Set current particle properties
-        modelParticle->addInstance(currentData.position, currentData.scale, currentData.rotation, color, timeChange);
+    // The instance table is filled in order
+    for (const auto &instance : std::as_const(m_modelParticleInstances)) {
+        if (instance.alive)
+            modelParticle->addInstance(instance.position, instance.scale, instance.rotation, instance.color, instance.age);
     }
     modelParticle->commitInstance();
 }
 
+int QQuick3DParticleSystem::updateModelParticles(const ParticleUpdate &update, float timeS, int begin, int end)
+{
+    const auto *modelParticle = static_cast<const QQuick3DParticleModelParticle *>(update.particle);
+    const auto &trailEmits = update.trailEmits;
+    QQuick3DParticleDataCurrentBatch batch;
+    int used = 0;
+
+    for (int batchBegin = begin; batchBegin < end; batchBegin += update.batchSize) {
+        const int batchEnd = std::min(end, batchBegin + update.batchSize);
+
+        // Collect the living particles
+        batch.count = 0;
+        for (int i = batchBegin; i < batchEnd; i++) {
+            const auto d = &modelParticle->m_particleData.at(i);
+            const float particleTimeEnd = d->startTime + d->lifetime;
+            if (timeS < d->startTime || timeS > particleTimeEnd)
+                continue;
+
+            const float particleTimeS = timeS - d->startTime;
+            QQuick3DParticleDataCurrent currentData;
+            // Process features shared for both model & sprite particles
+            processParticleCommon(currentData, d, particleTimeS);
+
+            // Add a base rotation if alignment requested
+            if (modelParticle->m_alignMode != QQuick3DParticle::AlignNone)
+                processParticleAlignment(currentData, modelParticle, d);
+
+            // 0.0 -> 1.0 during the particle lifetime
+            const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+
+            // Scale from initial to endScale
+            currentData.scale = modelParticle->m_initialScale * (d->endSize * timeChange + d->startSize * (1.0f - timeChange));
+
+            // Fade in & out
+            const float particleTimeLeftS = d->lifetime - particleTimeS;
+            processParticleFadeInOut(currentData, modelParticle, particleTimeS, particleTimeLeftS);
+
+            batch.append(i, d, particleTimeS, currentData);
+        }
+        used += batch.count;
+
+        // Affectors
+        for (auto affector : update.affectors)
+            affector->affectParticles(batch);
+
+        // Store the results and emit the trails in particle order
+        int b = 0;
+        for (int i = batchBegin; i < batchEnd; i++) {
+            const auto d = &modelParticle->m_particleData.at(i);
+            auto &instance = m_modelParticleInstances[i];
+
+            if (b == batch.count || batch.particleIndex[b] != i) {
+                const float particleTimeEnd = d->startTime + d->lifetime;
+                if (timeS > particleTimeEnd && d->lifetime > 0.0f) {
+                    for (auto trailEmit : trailEmits)
+                        trailEmit.emitter->emitTrailParticles(d->startPosition + (d->startVelocity * (particleTimeEnd - d->startTime)), 0, QQuick3DParticleDynamicBurst::TriggerEnd);
+                }
+                // Particle not alive currently
+                instance.alive = false;
+                continue;
+            }
+
+            const float particleTimeS = batch.time[b];
+            const QQuick3DParticleDataCurrent currentData = batch.current(b);
+            b++;
+
+            if (d->lifetime <= 0.0f) {
+                for (auto trailEmit : trailEmits)
+                    trailEmit.emitter->emitTrailParticles(d->startPosition, 0, QQuick3DParticleDynamicBurst::TriggerStart);
+            }
+
+            // Emit new particles from trails
+            for (auto trailEmit : trailEmits)
+                trailEmit.emitter->emitTrailParticles(currentData.position, trailEmit.amount, QQuick3DParticleDynamicBurst::TriggerTime);
+
+            // Set current particle properties
+            instance.position = currentData.position;
+            instance.scale = currentData.scale;
+            instance.rotation = currentData.rotation;
+            instance.color = QColor(currentData.color.r, currentData.color.g, currentData.color.b, currentData.color.a);
+            instance.age = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+            instance.alive = true;
+        }
+    }
+
+    return used;
+}
+
 static QVector3D mix(const QVector3D &a, const QVector3D &b, float f)
 {
     return (b - a) * f + a;
 }
 
-void QQuick3DParticleSystem::processModelBlendParticle(QQuick3DParticleModelBlendParticle *particle, const QVector<TrailEmits> &trailEmits, float timeS)
+void QQuick3DParticleSystem::processModelBlendParticle(const ParticleUpdate &update, float timeS)
 {
+    auto *particle = static_cast<QQuick3DParticleModelBlendParticle *>(update.particle);
     const int c = particle->maxAmount();
 
-    for (int i = 0; i < c; i++) {
-        const auto d = &particle->m_particleData.at(i);
+    // Jobs must not detach the data concurrently
+    particle->m_triangleParticleData.detach();
 
-        const float particleTimeEnd = d->startTime + d->lifetime;
+    m_particlesUsed += runParticleUpdateJobs(update.jobCount, c, [&](int begin, int end) {
+        return updateModelBlendParticles(update, timeS, begin, end);
+    });
 
-        if (timeS < d->startTime || timeS > particleTimeEnd) {
-            if (timeS > particleTimeEnd && d->lifetime > 0.0f) {
-                for (auto trailEmit : std::as_const(trailEmits))
-                    trailEmit.emitter->emitTrailParticles(d->startPosition + (d->startVelocity * (particleTimeEnd - d->startTime)), 0, QQuick3DParticleDynamicBurst::TriggerEnd);
-            }
-            // Particle not alive currently
-            float age = 0.0f;
-            float size = 0.0f;
-            QVector3D pos;
-            QVector3D rot;
-            QVector4D color(float(d->startColor.r)/ 255.0f,
-                            float(d->startColor.g)/ 255.0f,
-                            float(d->startColor.b)/ 255.0f,
-                            float(d->startColor.a)/ 255.0f);
-            if (d->startTime > 0.0f && timeS > particleTimeEnd
-                    && (particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Construct ||
-                        particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Transfer)) {
-                age = 1.0f;
-                size = 1.0f;
-                pos = particle->particleEndPosition(i);
-                rot = particle->particleEndRotation(i);
-                if (particle->fadeOutEffect() == QQuick3DParticle::FadeOpacity)
-                    color.setW(0.0f);
-            } else if (particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Explode ||
-                       particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Transfer) {
-                age = 0.0f;
-                size = 1.0f;
-                pos = particle->particleCenter(i);
-                if (particle->fadeInEffect() == QQuick3DParticle::FadeOpacity)
-                    color.setW(0.0f);
-            }
-            particle->setParticleData(i, pos, rot, color, size, age);
-            continue;
-        }
+    particle->commitParticles();
+}
 
-        const float particleTimeS = timeS - d->startTime;
-        QQuick3DParticleDataCurrent currentData;
-        if (timeS >= d->startTime && d->lifetime <= 0.0f) {
-            for (auto trailEmit : std::as_const(trailEmits))
-                trailEmit.emitter->emitTrailParticles(d->startPosition, 0, QQuick3DParticleDynamicBurst::TriggerStart);
+int QQuick3DParticleSystem::updateModelBlendParticles(const ParticleUpdate &update, float timeS, int begin, int end)
+{
+    auto *particle = static_cast<QQuick3DParticleModelBlendParticle *>(update.particle);
+    const auto &trailEmits = update.trailEmits;
+    QQuick3DParticleDataCurrentBatch batch;
+    int used = 0;
+
+    for (int batchBegin = begin; batchBegin < end; batchBegin += update.batchSize) {
+        const int batchEnd = std::min(end, batchBegin + update.batchSize);
+
+        // Collect the living particles
+        batch.count = 0;
+        for (int i = batchBegin; i < batchEnd; i++) {
+            const auto d = &particle->m_particleData.at(i);
+            const float particleTimeEnd = d->startTime + d->lifetime;
+            if (timeS < d->startTime || timeS > particleTimeEnd)
+                continue;
+
+            const float particleTimeS = timeS - d->startTime;
+            QQuick3DParticleDataCurrent currentData;
+            // Process features shared for both model & sprite particles
+            processParticleCommon(currentData, d, particleTimeS);
+
+            // 0.0 -> 1.0 during the particle lifetime
+            const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+
+            // Scale from initial to endScale
+            const float scale = d->endSize * timeChange + d->startSize * (1.0f - timeChange);
+            currentData.scale = QVector3D(scale, scale, scale);
+
+            // Fade in & out
+            const float particleTimeLeftS = d->lifetime - particleTimeS;
+            processParticleFadeInOut(currentData, particle, particleTimeS, particleTimeLeftS);
+
+            batch.append(i, d, particleTimeS, currentData);
         }
+        used += batch.count;
 
-        // Process features shared for both model & sprite particles
-        processParticleCommon(currentData, d, particleTimeS);
-
-        // 0.0 -> 1.0 during the particle lifetime
-        const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
-
-        // Scale from initial to endScale
-        const float scale = d->endSize * timeChange + d->startSize * (1.0f - timeChange);
-        currentData.scale = QVector3D(scale, scale, scale);
+        // Affectors
+        for (auto affector : update.affectors)
+            affector->affectParticles(batch);
+
+        // Store the results and emit the trails in particle order
+        int b = 0;
+        for (int i = batchBegin; i < batchEnd; i++) {
+            const auto d = &particle->m_particleData.at(i);
+            const float particleTimeEnd = d->startTime + d->lifetime;
+
+            if (b == batch.count || batch.particleIndex[b] != i) {
+                if (timeS > particleTimeEnd && d->lifetime > 0.0f) {
+                    for (auto trailEmit : trailEmits)
+                        trailEmit.emitter->emitTrailParticles(d->startPosition + (d->startVelocity * (particleTimeEnd - d->startTime)), 0, QQuick3DParticleDynamicBurst::TriggerEnd);
+                }
+                // Particle not alive currently
+                float age = 0.0f;
+                float size = 0.0f;
+                QVector3D pos;
+                QVector3D rot;
+                QVector4D color(float(d->startColor.r)/ 255.0f,
+                                float(d->startColor.g)/ 255.0f,
+                                float(d->startColor.b)/ 255.0f,
+                                float(d->startColor.a)/ 255.0f);
+                if (d->startTime > 0.0f && timeS > particleTimeEnd
+                        && (particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Construct ||
+                            particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Transfer)) {
+                    age = 1.0f;
+                    size = 1.0f;
+                    pos = particle->particleEndPosition(i);
+                    rot = particle->particleEndRotation(i);
+                    if (particle->fadeOutEffect() == QQuick3DParticle::FadeOpacity)
+                        color.setW(0.0f);
+                } else if (particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Explode ||
+                           particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Transfer) {
+                    age = 0.0f;
+                    size = 1.0f;
+                    pos = particle->particleCenter(i);
+                    if (particle->fadeInEffect() == QQuick3DParticle::FadeOpacity)
+                        color.setW(0.0f);
+                }
+                particle->setParticleData(i, pos, rot, color, size, age);
+                continue;
+            }
 
-        // Fade in & out
-        const float particleTimeLeftS = d->lifetime - particleTimeS;
-        processParticleFadeInOut(currentData, particle, particleTimeS, particleTimeLeftS);
+            const float particleTimeS = batch.time[b];
+            QQuick3DParticleDataCurrent currentData = batch.current(b);
+            b++;
 
-        // Affectors
-        for (auto affector : std::as_const(m_affectors)) {
-            // If affector is set to affect only particular particles, check these are included
-            if (affector->m_enabled && (affector->m_particles.isEmpty() || affector->m_particles.contains(particle)))
-                affector->affectParticle(*d, &currentData, particleTimeS);
-        }
+            if (d->lifetime <= 0.0f) {
+                for (auto trailEmit : trailEmits)
+                    trailEmit.emitter->emitTrailParticles(d->startPosition, 0, QQuick3DParticleDynamicBurst::TriggerStart);
+            }
 
-        // Emit new particles from trails
-        for (auto trailEmit : std::as_const(trailEmits))
-            trailEmit.emitter->emitTrailParticles(currentData.position, trailEmit.amount, QQuick3DParticleDynamicBurst::TriggerTime);
-
-        // Set current particle properties
-        const QVector4D color(float(currentData.color.r) / 255.0f,
-                              float(currentData.color.g) / 255.0f,
-                              float(currentData.color.b) / 255.0f,
-                              float(currentData.color.a) / 255.0f);
-        float endTimeS = particle->endTime() * 0.001f;
-        if ((particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Construct ||
-             particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Transfer)
-                && particleTimeLeftS < endTimeS) {
-            QVector3D endPosition = particle->particleEndPosition(i);
-            QVector3D endRotation = particle->particleEndRotation(i);
-            float factor = 1.0f - particleTimeLeftS / endTimeS;
-            currentData.position = mix(currentData.position, endPosition, factor);
-            currentData.rotation = mix(currentData.rotation, endRotation, factor);
+            // Emit new particles from trails
+            for (auto trailEmit : trailEmits)
+                trailEmit.emitter->emitTrailParticles(currentData.position, trailEmit.amount, QQuick3DParticleDynamicBurst::TriggerTime);
+
+            // Set current particle properties
+            const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+            const float particleTimeLeftS = d->lifetime - particleTimeS;
+            const QVector4D color(float(currentData.color.r) / 255.0f,
+                                  float(currentData.color.g) / 255.0f,
+                                  float(currentData.color.b) / 255.0f,
+                                  float(currentData.color.a) / 255.0f);
+            float endTimeS = particle->endTime() * 0.001f;
+            if ((particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Construct ||
+                 particle->modelBlendMode() == QQuick3DParticleModelBlendParticle::Transfer)
+                    && particleTimeLeftS < endTimeS) {
+                QVector3D endPosition = particle->particleEndPosition(i);
+                QVector3D endRotation = particle->particleEndRotation(i);
+                float factor = 1.0f - particleTimeLeftS / endTimeS;
+                currentData.position = mix(currentData.position, endPosition, factor);
+                currentData.rotation = mix(currentData.rotation, endRotation, factor);
+            }
+            particle->setParticleData(i, currentData.position, currentData.rotation,
+                                      color, currentData.scale.x(), timeChange);
         }
-        particle->setParticleData(i, currentData.position, currentData.rotation,
-                                  color, currentData.scale.x(), timeChange);
     }
-    particle->commitParticles();
+
+    return used;
 }
 
-void QQuick3DParticleSystem::processSpriteParticle(QQuick3DParticleSpriteParticle *spriteParticle, const QVector<TrailEmits> &trailEmits, float timeS)
+void QQuick3DParticleSystem::processSpriteParticle(const ParticleUpdate &update, float timeS)
 {
+    auto *spriteParticle = static_cast<QQuick3DParticleSpriteParticle *>(update.particle);
+    if (update.simulated) {
+        // The renderer evaluates the particles from their start data
+        m_particlesUsed += spriteParticle->prepareSimulationUpdate(timeS);
+        spriteParticle->commitParticles(timeS);
+        return;
+    }
+
     const int c = spriteParticle->maxAmount();
 
-    for (int i = 0; i < c; i++) {
-        const auto d = &spriteParticle->m_particleData.at(i);
-
-        const float particleTimeEnd = d->startTime + d->lifetime;
-        auto &particleData = spriteParticle->m_spriteParticleData[i];
-        if (timeS < d->startTime || timeS > particleTimeEnd) {
-            if (timeS > particleTimeEnd && particleData.age > 0.0f) {
-                for (auto trailEmit : std::as_const(trailEmits))
-                    trailEmit.emitter->emitTrailParticles(particleData.position, 0, QQuick3DParticleDynamicBurst::TriggerEnd);
-                auto *lineParticle = qobject_cast<QQuick3DParticleLineParticle *>(spriteParticle);
-                if (lineParticle)
-                    lineParticle->saveLineSegment(i, timeS);
-            }
-            // Particle not alive currently
-            spriteParticle->resetParticleData(i);
-            continue;
-        }
-        const float particleTimeS = timeS - d->startTime;
-        QQuick3DParticleDataCurrent currentData;
-        if (timeS >= d->startTime && timeS < particleTimeEnd && particleData.age == 0.0f) {
-            for (auto trailEmit : std::as_const(trailEmits))
-                trailEmit.emitter->emitTrailParticles(d->startPosition, 0, QQuick3DParticleDynamicBurst::TriggerStart);
-        }
-        // Process features shared for both model & sprite particles
-        processParticleCommon(currentData, d, particleTimeS);
-
-        // Add a base rotation if alignment requested
-        if (!spriteParticle->m_billboard && spriteParticle->m_alignMode != QQuick3DParticle::AlignNone)
-            processParticleAlignment(currentData, spriteParticle, d);
-
-        // 0.0 -> 1.0 during the particle lifetime
-        const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
-
-        // Scale from initial to endScale
-        const float scale = d->endSize * timeChange + d->startSize * (1.0f - timeChange);
-        currentData.scale = QVector3D(scale, scale, scale);
-
-        // Fade in & out
-        const float particleTimeLeftS = d->lifetime - particleTimeS;
-        processParticleFadeInOut(currentData, spriteParticle, particleTimeS, particleTimeLeftS);
-
-        float animationFrame = 0.0f;
-        if (auto sequence = spriteParticle->m_spriteSequence) {
-            // animationFrame range is [0..1) where 0.0 is the beginning of the first frame
-            // and 0.9999 is the end of the last frame.
-            const bool isSingleFrame = (sequence->animationDirection() == QQuick3DParticleSpriteSequence::SingleFrame);
-            float startFrame = sequence->firstFrame(d->index, isSingleFrame);
-            if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::Normal) {
-                animationFrame = fmodf(startFrame + particleTimeS / d->animationTime, 1.0f);
-            } else if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::Reverse) {
-                animationFrame = fmodf(startFrame + 0.9999f - fmodf(particleTimeS / d->animationTime, 1.0f), 1.0f);
-            } else if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::Alternate) {
-                animationFrame = startFrame + particleTimeS / d->animationTime;
-                animationFrame = fabsf(fmodf(1.0f + animationFrame, 2.0f) - 1.0f);
-            } else if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::AlternateReverse) {
-                animationFrame = fmodf(startFrame + 0.9999f, 1.0f) - particleTimeS / d->animationTime;
-                animationFrame = fabsf(fmodf(fabsf(1.0f + animationFrame), 2.0f) - 1.0f);
-            } else {
-                // SingleFrame
-                animationFrame = startFrame;
-            }
-            animationFrame = std::clamp(animationFrame, 0.0f, 0.9999f);
+    // Jobs must not detach the data concurrently
+    spriteParticle->m_spriteParticleData.detach();
+
+    m_particlesUsed += runParticleUpdateJobs(update.jobCount, c, [&](int begin, int end) {
+        return updateSpriteParticles(update, timeS, begin, end);
+    });
+
+    spriteParticle->commitParticles(timeS);
+}
+
+int QQuick3DParticleSystem::updateSpriteParticles(const ParticleUpdate &update, float timeS, int begin, int end)
+{
+    auto *spriteParticle = static_cast<QQuick3DParticleSpriteParticle *>(update.particle);
+    const auto &trailEmits = update.trailEmits;
+    QQuick3DParticleDataCurrentBatch batch;
+    int used = 0;
+
+    for (int batchBegin = begin; batchBegin < end; batchBegin += update.batchSize) {
+        const int batchEnd = std::min(end, batchBegin + update.batchSize);
+
+        // Collect the living particles
+        batch.count = 0;
+        for (int i = batchBegin; i < batchEnd; i++) {
+            const auto d = &spriteParticle->m_particleData.at(i);
+            const float particleTimeEnd = d->startTime + d->lifetime;
+            if (timeS < d->startTime || timeS > particleTimeEnd)
+                continue;
+
+            const float particleTimeS = timeS - d->startTime;
+            QQuick3DParticleDataCurrent currentData;
+            // Process features shared for both model & sprite particles
+            processParticleCommon(currentData, d, particleTimeS);
+
+            // Add a base rotation if alignment requested
+            if (!spriteParticle->m_billboard && spriteParticle->m_alignMode != QQuick3DParticle::AlignNone)
+                processParticleAlignment(currentData, spriteParticle, d);
+
+            // 0.0 -> 1.0 during the particle lifetime
+            const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+
+            // Scale from initial to endScale
+            const float scale = d->endSize * timeChange + d->startSize * (1.0f - timeChange);
+            currentData.scale = QVector3D(scale, scale, scale);
+
+            // Fade in & out
+            const float particleTimeLeftS = d->lifetime - particleTimeS;
+            processParticleFadeInOut(currentData, spriteParticle, particleTimeS, particleTimeLeftS);
+
+            batch.append(i, d, particleTimeS, currentData);
         }
+        used += batch.count;
 
         // Affectors
-        for (auto affector : std::as_const(m_affectors)) {
-            // If affector is set to affect only particular particles, check these are included
-            if (affector->m_enabled && (affector->m_particles.isEmpty() || affector->m_particles.contains(spriteParticle)))
-                affector->affectParticle(*d, &currentData, particleTimeS);
-        }
+        for (auto affector : update.affectors)
+            affector->affectParticles(batch);
+
+        // Store the results and emit the trails in particle order
+        int b = 0;
+        for (int i = batchBegin; i < batchEnd; i++) {
+            const auto d = &spriteParticle->m_particleData.at(i);
+            const float particleTimeEnd = d->startTime + d->lifetime;
+            auto &particleData = spriteParticle->m_spriteParticleData[i];
+
+            if (b == batch.count || batch.particleIndex[b] != i) {
+                if (timeS > particleTimeEnd && particleData.age > 0.0f) {
+                    for (auto trailEmit : trailEmits)
+                        trailEmit.emitter->emitTrailParticles(particleData.position, 0, QQuick3DParticleDynamicBurst::TriggerEnd);
+                    if (update.type == ParticleType::Line)
+                        static_cast<QQuick3DParticleLineParticle *>(spriteParticle)->saveLineSegment(i, timeS);
+                }
+                // Particle not alive currently
+                spriteParticle->resetParticleData(i);
+                continue;
+            }
 
-        // Emit new particles from trails
-        for (auto trailEmit : std::as_const(trailEmits))
-            trailEmit.emitter->emitTrailParticles(currentData.position, trailEmit.amount, QQuick3DParticleDynamicBurst::TriggerTime);
+            const float particleTimeS = batch.time[b];
+            const QQuick3DParticleDataCurrent currentData = batch.current(b);
+            b++;
 
+            if (timeS < particleTimeEnd && particleData.age == 0.0f) {
+                for (auto trailEmit : trailEmits)
+                    trailEmit.emitter->emitTrailParticles(d->startPosition, 0, QQuick3DParticleDynamicBurst::TriggerStart);
+            }
+
+            // 0.0 -> 1.0 during the particle lifetime
+            const float timeChange = std::max(0.0f, std::min(1.0f, particleTimeS / d->lifetime));
+
+            float animationFrame = 0.0f;
+            if (auto sequence = spriteParticle->m_spriteSequence) {
+                // animationFrame range is [0..1) where 0.0 is the beginning of the first frame
+                // and 0.9999 is the end of the last frame.
+                const bool isSingleFrame = (sequence->animationDirection() == QQuick3DParticleSpriteSequence::SingleFrame);
+                float startFrame = sequence->firstFrame(d->index, isSingleFrame);
+                if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::Normal) {
+                    animationFrame = fmodf(startFrame + particleTimeS / d->animationTime, 1.0f);
+                } else if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::Reverse) {
+                    animationFrame = fmodf(startFrame + 0.9999f - fmodf(particleTimeS / d->animationTime, 1.0f), 1.0f);
+                } else if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::Alternate) {
+                    animationFrame = startFrame + particleTimeS / d->animationTime;
+                    animationFrame = fabsf(fmodf(1.0f + animationFrame, 2.0f) - 1.0f);
+                } else if (sequence->animationDirection() == QQuick3DParticleSpriteSequence::AlternateReverse) {
+                    animationFrame = fmodf(startFrame + 0.9999f, 1.0f) - particleTimeS / d->animationTime;
+                    animationFrame = fabsf(fmodf(fabsf(1.0f + animationFrame), 2.0f) - 1.0f);
+                } else {
+                    // SingleFrame
+                    animationFrame = startFrame;
+                }
+                animationFrame = std::clamp(animationFrame, 0.0f, 0.9999f);
+            }
 
-        // Set current particle properties
-        const QVector4D color(float(currentData.color.r) / 255.0f,
-                              float(currentData.color.g) / 255.0f,
-                              float(currentData.color.b) / 255.0f,
-                              float(currentData.color.a) / 255.0f);
-        const QVector3D offset(spriteParticle->offsetX(), spriteParticle->offsetY(), 0);
-        spriteParticle->setParticleData(i, currentData.position + (offset * currentData.scale.x()),
-                                        currentData.rotation, color, currentData.scale.x(), timeChange,
-                                        animationFrame);
+            // Emit new particles from trails
+            for (auto trailEmit : trailEmits)
+                trailEmit.emitter->emitTrailParticles(currentData.position, trailEmit.amount, QQuick3DParticleDynamicBurst::TriggerTime);
+
+            // Set current particle properties
+            const QVector4D color(float(currentData.color.r) / 255.0f,
+                                  float(currentData.color.g) / 255.0f,
+                                  float(currentData.color.b) / 255.0f,
+                                  float(currentData.color.a) / 255.0f);
+            const QVector3D offset(spriteParticle->offsetX(), spriteParticle->offsetY(), 0);
+            spriteParticle->setParticleData(i, currentData.position + (offset * currentData.scale.x()),
+                                            currentData.rotation, color, currentData.scale.x(), timeChange,
+                                            animationFrame);
+        }
     }
-    spriteParticle->commitParticles(timeS);
+
+    return used;
 }
 
 void QQuick3DParticleSystem::processParticleCommon(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticleData *d, float particleTimeS)
 {
-    m_particlesUsed++;
-
     currentData.position = d->startPosition;
 
     // Initial color from start color
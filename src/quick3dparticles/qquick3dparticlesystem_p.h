@@ -59,6 +59,7 @@ class Q_QUICK3DPARTICLES_EXPORT QQuick3DParticleSystem : public QQuick3DNode
     Q_PROPERTY(int seed READ seed WRITE setSeed NOTIFY seedChanged)
     Q_PROPERTY(bool logging READ logging WRITE setLogging NOTIFY loggingChanged)
     Q_PROPERTY(QQuick3DParticleSystemLogging *loggingData READ loggingData NOTIFY loggingDataChanged)
+    Q_PROPERTY(bool gpuSimulation READ gpuSimulation WRITE setGpuSimulation NOTIFY gpuSimulationChanged REVISION(6, 7))
     QML_NAMED_ELEMENT(ParticleSystem3D)
     QML_ADDED_IN_VERSION(6, 2)
 
@@ -76,6 +77,7 @@ public:
     int particleCount() const;
     bool logging() const;
     QQuick3DParticleSystemLogging *loggingData() const;
+    Q_REVISION(6, 7) bool gpuSimulation() const;
 
     // Registering of different components into system
     void registerParticle(QQuick3DParticle *particle);
@@ -106,6 +108,7 @@ public Q_SLOTS:
     void setUseRandomSeed(bool randomize);
     void setSeed(int seed);
     void setLogging(bool logging);
+    Q_REVISION(6, 7) void setGpuSimulation(bool gpuSimulation);
 
     void setEditorTime(int time);
 
@@ -118,6 +121,7 @@ Q_SIGNALS:
     void seedChanged();
     void loggingChanged();
     void loggingDataChanged();
+    Q_REVISION(6, 7) void gpuSimulationChanged();
 
 protected:
     void componentComplete() override;
@@ -130,12 +134,47 @@ private:
     void doSeedRandomization();
     void refresh();
     void markDirty();
-    void processModelParticle(QQuick3DParticleModelParticle *modelParticle, const QVector<TrailEmits> &trailEmits, float timeS);
-    void processSpriteParticle(QQuick3DParticleSpriteParticle *spriteParticle, const QVector<TrailEmits> &trailEmits, float timeS);
-    void processModelBlendParticle(QQuick3DParticleModelBlendParticle *particle, const QVector<TrailEmits> &trailEmits, float timeS);
-    void processParticleCommon(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticleData *d, float particleTimeS);
-    void processParticleFadeInOut(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticle *particle, float particleTimeS, float particleTimeLeftS);
-    void processParticleAlignment(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticle *particle, const QQuick3DParticleData *d);
+    enum class ParticleType { Other, Sprite, Line, Model, ModelBlend };
+    // What is needed to update the particles of a particle type, collected
+    // once per update.
+    struct ParticleUpdate
+    {
+        QQuick3DParticle *particle = nullptr;
+        ParticleType type = ParticleType::Other;
+        QVector<TrailEmits> trailEmits;
+        QVector<QQuick3DParticleAffector *> affectors;
+        // Amount of threads the particles are split between
+        int jobCount = 1;
+        // Amount of particles passed to the affectors at once
+        int batchSize = 1;
+        // The particles are simulated by the renderer, see gpuSimulation
+        bool simulated = false;
+    };
+    // Model particles are added to the instance table in order after the update
+    struct ModelParticleInstance
+    {
+        QVector3D position;
+        QVector3D scale;
+        QVector3D rotation;
+        QColor color;
+        float age = 0.0f;
+        bool alive = false;
+    };
+    void prepareParticleUpdates();
+    // Whether the particles of the update can be simulated by the renderer,
+    // collects the affectors for that.
+    bool prepareSimulation(const ParticleUpdate &update);
+    void processModelParticle(const ParticleUpdate &update, float timeS);
+    void processSpriteParticle(const ParticleUpdate &update, float timeS);
+    void processModelBlendParticle(const ParticleUpdate &update, float timeS);
+    // These are called concurrently for separate ranges of particles and
+    // return the amount of particles alive.
+    int updateModelParticles(const ParticleUpdate &update, float timeS, int begin, int end);
+    int updateSpriteParticles(const ParticleUpdate &update, float timeS, int begin, int end);
+    int updateModelBlendParticles(const ParticleUpdate &update, float timeS, int begin, int end);
+    static void processParticleCommon(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticleData *d, float particleTimeS);
+    static void processParticleFadeInOut(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticle *particle, float particleTimeS, float particleTimeLeftS);
+    static void processParticleAlignment(QQuick3DParticleDataCurrent &currentData, const QQuick3DParticle *particle, const QQuick3DParticleData *d);
     static bool isGloballyDisabled();
     static bool isEditorModeOn();
 
@@ -161,6 +200,9 @@ private:
     QList<QQuick3DParticleTrailEmitter *> m_trailEmitters;
     QList<QQuick3DParticleAffector *> m_affectors;
     QMap<QQuick3DParticleAffector *, QMetaObject::Connection> m_connections;
+    QVector<ParticleUpdate> m_particleUpdates;
+    QVector<ModelParticleInstance> m_modelParticleInstances;
+    bool m_particleUpdatesDirty = true;
 
     int m_startTime = 0;
     // Current time in ms
@@ -179,6 +221,7 @@ private:
     bool m_useRandomSeed = true;
     int m_seed = 0;
     bool m_logging;
+    bool m_gpuSimulation = false;
     QQuick3DParticleSystemLogging *m_loggingData = nullptr;
     QPRand m_rand;
     int m_particleIdIndex = 0;
@@ -311,4 +311,68 @@ void QQuick3DParticleWander::affectParticle(const QQuick3DParticleData &sd, QQui
     }
 }
 
+void QQuick3DParticleWander::affectParticles(QQuick3DParticleDataCurrentBatch &batch)
+{
+    if (!system())
+        return;
+    auto rand = system()->rand();
+    const int count = batch.count;
+
+    // Optionally smoothen the beginning & end of wander
+    float smooth[QQuick3DParticleDataCurrentBatch::MaxCount];
+    const float fadeInS = float(m_fadeInDuration) / 1000.0f;
+    const float fadeOutS = float(m_fadeOutDuration) / 1000.0f;
+    for (int i = 0; i < count; ++i) {
+        float s = 1.0f;
+        if (m_fadeInDuration > 0)
+            s = std::min(1.0f, batch.time[i] / fadeInS);
+        if (m_fadeOutDuration > 0) {
+            const float timeLeft = (batch.lifetime[i] - batch.time[i]);
+            // When fading both in & out, select smaller (which is always max 1.0)
+            s = std::min(timeLeft / fadeOutS, s);
+        }
+        smooth[i] = s;
+    }
+
+    const float pi2 = float(M_PI * 2);
+
+    // Global
+    const auto wanderGlobal = [&](float *position, float amount, float pace, float paceStart) {
+        if (qFuzzyIsNull(amount) || qFuzzyIsNull(pace))
+            return;
+        for (int i = 0; i < count; ++i)
+            position[i] += smooth[i] * QPSIN(paceStart + batch.time[i] * pi2 * pace) * amount;
+    };
+    wanderGlobal(batch.positionX, m_globalAmount.x(), m_globalPace.x(), m_globalPaceStart.x());
+    wanderGlobal(batch.positionY, m_globalAmount.y(), m_globalPace.y(), m_globalPaceStart.y());
+    wanderGlobal(batch.positionZ, m_globalAmount.z(), m_globalPace.z(), m_globalPaceStart.z());
+
+    // Unique
+    const auto wanderUnique = [&](float *position, float uniqueAmount, float uniquePace,
+                                  QPRand::UserType paceStartUser, QPRand::UserType paceVariationUser,
+                                  QPRand::UserType amountVariationUser) {
+        if (qFuzzyIsNull(uniqueAmount) || qFuzzyIsNull(uniquePace))
+            return;
+        for (int i = 0; i < count; ++i) {
+            const int index = batch.index[i];
+            // Values between  1.0 +/- variation
+            const float paceVariation = 1.0f + m_uniquePaceVariation - 2.0f * rand->get(index, paceVariationUser) * m_uniquePaceVariation;
+            const float amountVariation = 1.0f + m_uniqueAmountVariation - 2.0f * rand->get(index, amountVariationUser) * m_uniqueAmountVariation;
+            const float startPace = rand->get(index, paceStartUser) * pi2;
+            const float pace = startPace + paceVariation * batch.time[i] * pi2 * uniquePace;
+            const float amount = amountVariation * uniqueAmount;
+            position[i] += smooth[i] * QPSIN(pace) * amount;
+        }
+    };
+    wanderUnique(batch.positionX, m_uniqueAmount.x(), m_uniquePace.x(), QPRand::WanderXPS, QPRand::WanderXPV, QPRand::WanderXAV);
+    wanderUnique(batch.positionY, m_uniqueAmount.y(), m_uniquePace.y(), QPRand::WanderYPS, QPRand::WanderYPV, QPRand::WanderYAV);
+    wanderUnique(batch.positionZ, m_uniqueAmount.z(), m_uniquePace.z(), QPRand::WanderZPS, QPRand::WanderZPV, QPRand::WanderZAV);
+}
+
+bool QQuick3DParticleWander::isReentrant() const
+{
+    // The unique values only use the deterministic part of the randomizer
+    return true;
+}
+
 QT_END_NAMESPACE
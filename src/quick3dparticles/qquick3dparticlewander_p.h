@@ -73,6 +73,8 @@ Q_SIGNALS:
 
 protected:
     void affectParticle(const QQuick3DParticleData &sd, QQuick3DParticleDataCurrent *d, float time) override;
+    void affectParticles(QQuick3DParticleDataCurrentBatch &batch) override;
+    bool isReentrant() const override;
 
 private:
     QVector3D m_globalAmount;
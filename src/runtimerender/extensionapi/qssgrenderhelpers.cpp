@@ -32,6 +32,7 @@ void QSSGRenderHelpers::rhiPrepareRenderable(QSSGRhiContext &rhiCtx,
                                         ps,
                                         layerData->getShaderFeatures(),
                                         samples);
+    layerData->uniformArena.flush();
 }
 
 void QSSGRenderHelpers::rhiRenderRenderable(QSSGRhiContext &rhiCtx,
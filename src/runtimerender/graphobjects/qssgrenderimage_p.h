@@ -82,6 +82,12 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderImage : public QSSGRenderGraphObj
     // the texture transform is covered by TransformDirty.
     QMatrix4x4 m_textureTransform;
 
+    // m_imagePath is read on a worker thread, see QSSGBufferManager::loadRenderImage()
+    bool m_asynchronous = false;
+    // Only the low mip levels of m_imagePath are uploaded at first, see
+    // QSSGBufferManager::streamImages()
+    bool m_streaming = false;
+
     QSSGRenderImage(QSSGRenderGraphObject::Type type = QSSGRenderGraphObject::Type::Image2D);
     ~QSSGRenderImage();
 
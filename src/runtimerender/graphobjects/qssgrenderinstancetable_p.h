@@ -39,6 +39,7 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderInstanceTable : public QSSGRender
     int count() const { return instanceCount; }
     qsizetype dataSize() const { return table.size(); }
     const void *constData() const { return table.constData(); }
+    QByteArray data() const { return table; }
     void setData(const QByteArray &data, int count, int stride) { table = data; instanceCount = count; instanceStride = stride; ++instanceSerial; }
     void setInstanceCountOverride(int count) { instanceCount = count; }
     int serial() const { return instanceSerial; }
@@ -119,6 +119,13 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderLayer : public QSSGRenderNode
         F0
     };
 
+    enum class ShaderCompilationMode : quint8
+    {
+        Synchronous,
+        Parallel,
+        Asynchronous
+    };
+
     // First effect in a list of effects.
     QSSGRenderEffect *firstEffect;
     QSSGLayerRenderData *renderData = nullptr;
@@ -177,6 +184,9 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderLayer : public QSSGRenderNode
                             LayerFlag::EnableDepthTest,
                             LayerFlag::EnableDepthPrePass };
 
+    // Skip opaque objects and shadow casters hidden behind the depth of an earlier frame
+    bool occlusionCullingEnabled = false;
+
     // references to objects owned by the QSSGRhiContext
     QRhiShaderResourceBindings *skyBoxSrb = nullptr;
     QVarLengthArray<QRhiShaderResourceBindings *, 4> item2DSrbs;
@@ -220,6 +230,10 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderLayer : public QSSGRenderNode
 
     bool wireframeMode = false;
 
+    ShaderCompilationMode shaderCompilationMode = ShaderCompilationMode::Synchronous;
+    // Compile the shaders of the next frame in parallel once, whatever the mode
+    bool precompileShadersRequested = false;
+
     QSSGRenderLayer();
     ~QSSGRenderLayer();
 
@@ -6,6 +6,7 @@
 #include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderdefaultmaterial_p.h>
+#include <QtQuick3DRuntimeRender/private/qssginstancebvh_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -14,4 +15,6 @@ QSSGRenderModel::QSSGRenderModel()
 {
 }
 
+QSSGRenderModel::~QSSGRenderModel() = default;
+
 QT_END_NAMESPACE
@@ -31,6 +31,7 @@ QT_BEGIN_NAMESPACE
 struct QSSGRenderDefaultMaterial;
 struct QSSGParticleBuffer;
 class QSSGBufferManager;
+class QSSGInstanceBVH;
 class QRhiTexture;
 
 struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderModel : public QSSGRenderNode
@@ -39,6 +40,8 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderModel : public QSSGRenderNode
     QVector<QSSGRenderGraphObject *> morphTargets;
     QSSGRenderGeometry *geometry = nullptr;
     QSSGRenderPath meshPath;
+    // meshPath is read on a worker thread, see QSSGBufferManager::loadMesh()
+    bool asynchronous = false;
     QSSGRenderSkeleton *skeleton = nullptr;
     QSSGRenderSkin *skin = nullptr;
     QVector<QMatrix4x4> inverseBindPoses;
@@ -51,6 +54,10 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderModel : public QSSGRenderNode
     QSSGRenderInstanceTable *instanceTable = nullptr;
     int instanceCount() const { return instanceTable ? instanceTable->count() : 0; }
     bool instancing() const { return instanceTable;}
+    // Top level for picking the instances, see QSSGInstanceBVH::forModel().
+    // Picking can happen on other threads, so it is only accessed with
+    // std::atomic_load() and std::atomic_store().
+    mutable std::shared_ptr<const QSSGInstanceBVH> instancePickingBVH;
 
     QSSGParticleBuffer *particleBuffer = nullptr;
     QMatrix4x4 particleMatrix;
@@ -71,6 +78,7 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderModel : public QSSGRenderNode
     float levelOfDetailBias = 1.0f; // values < 1.0 will decrease usage of LODs, values > 1.0 will increase usage of LODs
 
     QSSGRenderModel();
+    ~QSSGRenderModel() override;
 };
 QT_END_NAMESPACE
 
@@ -127,6 +127,7 @@ bool QSSGRenderNode::calculateGlobalVariables()
         }
         // Clear dirty flags
         clearDirty(DirtyFlag::GlobalValuesDirty);
+        ++globalTransformSerial;
     }
     // We always clear dirty in a reasonable manner but if we aren't active
     // there is no reason to tell the universe if we are dirty or not.
@@ -88,6 +88,10 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderNode : public QSSGRenderGraphObje
     // Property maintained solely by the render system.
     // Depth-first-search index assigned and maintained by render system.
     quint32 dfsIndex = 0;
+    // Bumped whenever the global values are recalculated. Unlike the dirty
+    // flag, which the first layer to recalculate them clears, every layer
+    // showing the node can compare it with the value it saw last.
+    quint32 globalTransformSerial = 0;
 
     using ChildList = QSSGInvasiveLinkedList<QSSGRenderNode, &QSSGRenderNode::previousSibling, &QSSGRenderNode::nextSibling>;
     ChildList children;
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderparticles_p.h>
+#include <QtCore/qmath.h>
 #include <cmath>
 
 QT_BEGIN_NAMESPACE
@@ -19,12 +20,19 @@ static int ceilDivide(int a, int b)
 
 void QSSGParticleBuffer::resize(int particleCount, int particleSize)
 {
+    resizeLayout(particleCount, particleSize);
+    m_particleBuffer.resize(particleCount ? m_sliceStride * m_size.height() : 0);
+}
+
+void QSSGParticleBuffer::resizeLayout(int particleCount, int particleSize)
+{
+    m_particleBuffer.clear();
     if (particleCount == 0) {
         m_particlesPerSlice = 0;
         m_particleCount = 0;
+        m_usedCount = 0;
         m_sliceStride = 0;
         m_size = QSize();
-        m_particleBuffer.resize(0);
         return;
     }
     int vec4PerParticle = ceilDivide(particleSize, 16);
@@ -33,11 +41,11 @@ void QSSGParticleBuffer::resize(int particleCount, int particleSize)
     int height = ceilDivide(vec4s, width);
     m_particlesPerSlice = width / vec4PerParticle;
     m_particleCount = particleCount;
+    m_usedCount = particleCount;
     width = divisibleBy(width, 4);
     height = divisibleBy(height, 4);
     m_sliceStride = width * 16;
     m_size = QSize(width, height);
-    m_particleBuffer.resize(m_sliceStride * height);
 }
 
 void QSSGParticleBuffer::resizeLine(int particleCount, int segmentCount)
@@ -77,6 +85,21 @@ int QSSGParticleBuffer::particleCount() const
     return m_particleCount;
 }
 
+void QSSGParticleBuffer::setUsedCount(int count)
+{
+    m_usedCount = qBound(0, count, m_particleCount);
+}
+
+int QSSGParticleBuffer::usedCount() const
+{
+    return m_usedCount;
+}
+
+int QSSGParticleBuffer::usedSliceCount() const
+{
+    return m_particlesPerSlice > 0 ? ceilDivide(m_usedCount, m_particlesPerSlice) : 0;
+}
+
 QSize QSSGParticleBuffer::size() const
 {
     return m_size;
@@ -112,6 +135,91 @@ QSSGBounds3 QSSGParticleBuffer::bounds() const
     return m_bounds;
 }
 
+bool QSSGParticleSimulation::evaluate(int index, QSSGParticleSimple *particle) const
+{
+    // Keep in sync with particlesimulate.comp and the sprite particle update
+    // of QQuick3DParticleSystem.
+    const QSSGParticleSimulationData &d = data()[index];
+    const float t = time - d.startTime;
+    if (d.startTime < 0.0f || t < 0.0f || t > d.lifetime)
+        return false;
+
+    const float timeChange = d.lifetime > 0.0f ? qBound(0.0f, t / d.lifetime, 1.0f) : 1.0f;
+    QVector3D position = d.startPosition + d.startVelocity * t;
+    const QVector3D rotation = d.startRotation + d.rotationVelocity * t;
+    QVector4D color = d.color;
+    float size = d.endSize * timeChange + d.startSize * (1.0f - timeChange);
+
+    const float timeLeft = d.lifetime - t;
+    if (t < fadeInDuration) {
+        const float fade = t / fadeInDuration;
+        if (fadeIn == Fade::Opacity)
+            color.setW(color.w() * fade);
+        else if (fadeIn == Fade::Scale)
+            size *= fade;
+    }
+    if (timeLeft < fadeOutDuration) {
+        const float fade = timeLeft / fadeOutDuration;
+        if (fadeOut == Fade::Opacity)
+            color.setW(color.w() * fade);
+        else if (fadeOut == Fade::Scale)
+            size *= fade;
+    }
+
+    for (const QSSGParticleSimulationAffector &affector : affectors) {
+        if (affector.type == QSSGParticleSimulationAffector::Type::Gravity) {
+            position += (0.5f * t * t) * affector.vector;
+        } else {
+            const float duration = std::max(affector.duration < 0.0f ? d.lifetime : affector.duration, 0.001f);
+            const float pEnd = qBound(0.0f, t / duration, 1.0f);
+            if (affector.hideAtEnd && pEnd >= 1.0f)
+                color.setW(0.0f);
+            else
+                position = (1.0f - pEnd) * position + pEnd * affector.vector;
+        }
+    }
+
+    if (size <= 0.0f)
+        return false;
+
+    particle->position = position + QVector3D(offset, 0.0f) * size;
+    particle->size = size * particleScale;
+    particle->rotation = rotation * float(M_PI / 180.0f);
+    particle->age = timeChange;
+    particle->color = color;
+    return true;
+}
+
+void QSSGParticleSimulation::simulate(QSSGParticleBuffer &buffer) const
+{
+    const int count = particleCount();
+    if (buffer.particleCount() != count || buffer.bufferSize() == 0)
+        buffer.resize(count, sizeof(QSSGParticleSimple));
+
+    char *dest = buffer.pointer();
+    const int pps = buffer.particlesPerSlice();
+    const int ss = buffer.sliceStride();
+    QSSGParticleSimple *dp = reinterpret_cast<QSSGParticleSimple *>(dest);
+    int used = 0;
+    int p = 0;
+    QSSGBounds3 bounds;
+    for (int i = 0; i < count; ++i) {
+        if (p == pps) {
+            dest += ss;
+            dp = reinterpret_cast<QSSGParticleSimple *>(dest);
+            p = 0;
+        }
+        if (!evaluate(i, dp))
+            continue;
+        bounds.include(dp->position);
+        dp++;
+        p++;
+        used++;
+    }
+    buffer.setUsedCount(used);
+    buffer.setBounds(bounds);
+}
+
 QSSGRenderParticles::QSSGRenderParticles()
     : QSSGRenderNode(QSSGRenderGraphObject::Type::Particles)
 {
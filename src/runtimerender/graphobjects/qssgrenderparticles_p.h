@@ -82,9 +82,44 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGLineParticle
 
 Q_STATIC_ASSERT_X(sizeof(QSSGLineParticle) == 64, "size of QSSGLineParticle must be 64");
 
+// Start data of a particle simulated by the renderer, see QSSGParticleSimulation
+struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGParticleSimulationData
+{
+    QVector3D startPosition;
+    float startTime; // seconds, in the time of QSSGParticleSimulation, < 0 when not emitted
+    QVector3D startVelocity;
+    float lifetime; // seconds
+    QVector3D startRotation; // degrees
+    float startSize;
+    QVector3D rotationVelocity; // degrees per second
+    float endSize;
+    QVector4D color;
+    // total 80 bytes
+};
+
+Q_STATIC_ASSERT_X(sizeof(QSSGParticleSimulationData) == 80, "size of QSSGParticleSimulationData must be 80");
+
+struct QSSGParticleSimulationAffector
+{
+    enum class Type : quint8
+    {
+        Gravity = 0,
+        Attractor
+    };
+    Type type = Type::Gravity;
+    bool hideAtEnd = false; // Attractor
+    // Gravity: acceleration, Attractor: target position, in the particle space
+    QVector3D vector;
+    // Attractor: seconds to reach the target, < 0 for the particle lifetime
+    float duration = -1.0f;
+};
+
 struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGParticleBuffer
 {
     void resize(int particleCount, int particleSize = sizeof(QSSGParticleSimple));
+    // Like resize(), but only sets up the layout, for particles which are
+    // written by the renderer.
+    void resizeLayout(int particleCount, int particleSize = sizeof(QSSGParticleSimple));
     void resizeLine(int particleCount, int segmentCount);
     void setBounds(const QSSGBounds3& bounds);
 
@@ -93,6 +128,11 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGParticleBuffer
     int particlesPerSlice() const;
     int sliceStride() const;
     int particleCount() const;
+    // Particles in use from the start of the buffer, the rest are not drawn.
+    // Reset to particleCount() on resize.
+    void setUsedCount(int count);
+    int usedCount() const;
+    int usedSliceCount() const;
     int sliceCount() const;
     QSize size() const;
     QByteArray data() const;
@@ -105,6 +145,7 @@ private:
     int m_particlesPerSlice = 0;
     int m_sliceStride = 0;
     int m_particleCount = 0;
+    int m_usedCount = 0;
     int m_serial = 0;
     int m_segments = 0;
     QSize m_size;
@@ -112,6 +153,52 @@ private:
     QSSGBounds3 m_bounds;
 };
 
+// Sprite particles which are simulated by the renderer instead of being
+// written to the particle buffer on the CPU. The particle system only updates
+// the start data of the particles emitted since the previous sync, the state
+// at time is computed from that and the affectors, with compute shaders when
+// available. The particle buffer only provides the texture layout then.
+struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGParticleSimulation
+{
+    static constexpr int MaxAffectors = 8;
+
+    enum class Fade : quint8
+    {
+        None = 0,
+        Opacity,
+        Scale
+    };
+
+    bool enabled = false;
+    float time = 0.0f; // seconds
+    // QSSGParticleSimulationData for each particle of the particle buffer
+    QByteArray particles;
+    // [begin, end) ranges of the particles changed since the previous serial
+    QVarLengthArray<std::pair<int, int>, 4> changedRanges;
+    int serial = 0;
+    // Applied in order, like the affectors of the particle system
+    QVarLengthArray<QSSGParticleSimulationAffector, MaxAffectors> affectors;
+    float fadeInDuration = 0.0f; // seconds
+    float fadeOutDuration = 0.0f; // seconds
+    Fade fadeIn = Fade::Opacity;
+    Fade fadeOut = Fade::Opacity;
+    QVector2D offset;
+    float particleScale = 1.0f;
+
+    const QSSGParticleSimulationData *data() const
+    {
+        return reinterpret_cast<const QSSGParticleSimulationData *>(particles.constData());
+    }
+    int particleCount() const { return int(particles.size() / sizeof(QSSGParticleSimulationData)); }
+
+    // The state of the particle at time. Returns false if it is not alive or
+    // not visible. This is the CPU version of particlesimulate.comp.
+    bool evaluate(int index, QSSGParticleSimple *particle) const;
+    // Writes the visible particles to the start of buffer, for when compute
+    // shaders are not available.
+    void simulate(QSSGParticleBuffer &buffer) const;
+};
+
 struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderParticles : public QSSGRenderNode
 {
     enum class BlendMode : quint8
@@ -139,6 +226,7 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderParticles : public QSSGRenderNode
     Q_DISABLE_COPY(QSSGRenderParticles)
 
     QSSGParticleBuffer m_particleBuffer;
+    QSSGParticleSimulation m_simulation;
 
     QVarLengthArray<QSSGRenderLight *, 4> m_lights;
 
@@ -6,6 +6,9 @@
 
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 
+#include <QtCore/qalgorithms.h>
+#include <QtCore/private/qsimd_p.h>
+
 QT_BEGIN_NAMESPACE
 
 QSSGClippingFrustum::QSSGClippingFrustum(const QMatrix4x4 &modelviewprojection, const QSSGClipPlane &nearPlane)
@@ -43,4 +46,127 @@ QSSGClippingFrustum::QSSGClippingFrustum(const QMatrix4x4 &modelviewprojection,
         mPlanes[idx].calculateBBoxEdges();
 }
 
+namespace {
+// A plane together with the bounds corner furthest along its normal. A box is
+// completely behind the plane when that corner is, see QSSGClipPlane::intersectSimple().
+struct CullPlane
+{
+    float nx, ny, nz, d;
+    const float *x;
+    const float *y;
+    const float *z;
+};
+using CullPlanes = CullPlane[6];
+}
+
+static qsizetype cullScalar(const CullPlanes &planes, qsizetype begin, qsizetype count, quint32 *visibleIndices, qsizetype visibleCount)
+{
+    for (qsizetype i = begin; i < count; ++i) {
+        bool visible = true;
+        for (const CullPlane &p : planes)
+            visible &= !((p.nx * p.x[i] + p.ny * p.y[i] + p.nz * p.z[i]) + p.d < 0.0f);
+        if (visible)
+            visibleIndices[visibleCount++] = quint32(i);
+    }
+    return visibleCount;
+}
+
+static inline qsizetype appendVisibleLanes(uint mask, qsizetype base, quint32 *visibleIndices, qsizetype visibleCount)
+{
+    while (mask) {
+        visibleIndices[visibleCount++] = quint32(base + qCountTrailingZeroBits(mask));
+        mask &= mask - 1;
+    }
+    return visibleCount;
+}
+
+#ifdef __SSE2__
+static qsizetype cullSse2(const CullPlanes &planes, qsizetype count, quint32 *visibleIndices)
+{
+    __m128 nx[6], ny[6], nz[6], d[6];
+    for (int p = 0; p < 6; ++p) {
+        nx[p] = _mm_set1_ps(planes[p].nx);
+        ny[p] = _mm_set1_ps(planes[p].ny);
+        nz[p] = _mm_set1_ps(planes[p].nz);
+        d[p] = _mm_set1_ps(planes[p].d);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    qsizetype visibleCount = 0;
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], _mm_loadu_ps(planes[p].x + i)),
+                                                     _mm_mul_ps(ny[p], _mm_loadu_ps(planes[p].y + i))),
+                                          _mm_mul_ps(nz[p], _mm_loadu_ps(planes[p].z + i)));
+            visible = _mm_and_ps(visible, _mm_cmpnlt_ps(_mm_add_ps(dot, d[p]), zero));
+        }
+        visibleCount = appendVisibleLanes(uint(_mm_movemask_ps(visible)), i, visibleIndices, visibleCount);
+    }
+
+    return cullScalar(planes, i, count, visibleIndices, visibleCount);
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX)
+QT_FUNCTION_TARGET(AVX)
+static qsizetype cullAvx(const CullPlanes &planes, qsizetype count, quint32 *visibleIndices)
+{
+    __m256 nx[6], ny[6], nz[6], d[6];
+    for (int p = 0; p < 6; ++p) {
+        nx[p] = _mm256_set1_ps(planes[p].nx);
+        ny[p] = _mm256_set1_ps(planes[p].ny);
+        nz[p] = _mm256_set1_ps(planes[p].nz);
+        d[p] = _mm256_set1_ps(planes[p].d);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    qsizetype visibleCount = 0;
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[p], _mm256_loadu_ps(planes[p].x + i)),
+                                                           _mm256_mul_ps(ny[p], _mm256_loadu_ps(planes[p].y + i))),
+                                             _mm256_mul_ps(nz[p], _mm256_loadu_ps(planes[p].z + i)));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(dot, d[p]), zero, _CMP_NLT_UQ));
+        }
+        visibleCount = appendVisibleLanes(uint(_mm256_movemask_ps(visible)), i, visibleIndices, visibleCount);
+    }
+
+    return cullScalar(planes, i, count, visibleIndices, visibleCount);
+}
+#endif
+
+qsizetype QSSGClippingFrustum::intersectsWith(const QSSGBoundsList &bounds, quint32 *visibleIndices) const
+{
+    return intersectsWith(bounds, 0, bounds.size(), visibleIndices);
+}
+
+qsizetype QSSGClippingFrustum::intersectsWith(const QSSGBoundsList &bounds, qsizetype first, qsizetype count, quint32 *visibleIndices) const
+{
+    Q_ASSERT(first >= 0 && first + count <= bounds.size());
+
+    CullPlanes planes;
+    for (int idx = 0; idx < 6; ++idx) {
+        const QSSGClipPlane &plane = mPlanes[idx];
+        const auto upperEdge = plane.mEdges.upperEdge;
+        planes[idx] = { plane.normal.x(), plane.normal.y(), plane.normal.z(), plane.d,
+                        ((upperEdge & QSSGClipPlane::xMax) ? bounds.maxX.data() : bounds.minX.data()) + first,
+                        ((upperEdge & QSSGClipPlane::yMax) ? bounds.maxY.data() : bounds.minY.data()) + first,
+                        ((upperEdge & QSSGClipPlane::zMax) ? bounds.maxZ.data() : bounds.minZ.data()) + first };
+    }
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX)
+    if (qCpuHasFeature(AVX))
+        return cullAvx(planes, count, visibleIndices);
+#endif
+#ifdef __SSE2__
+    return cullSse2(planes, count, visibleIndices);
+#else
+    return cullScalar(planes, 0, count, visibleIndices, 0);
+#endif
+}
+
 QT_END_NAMESPACE
@@ -20,6 +20,8 @@
 #include <QtQuick3DUtils/private/qssgbounds3_p.h>
 #include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
 
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 struct QSSGClipPlane
@@ -117,6 +119,50 @@ struct QSSGClipPlane
     }
 };
 
+// World space bounds stored as a structure of arrays, so that several boxes
+// can be tested against the frustum planes at once.
+struct QSSGBoundsList
+{
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    [[nodiscard]] qsizetype size() const { return qsizetype(minX.size()); }
+    [[nodiscard]] bool isEmpty() const { return minX.empty(); }
+
+    void clear()
+    {
+        minX.clear(); minY.clear(); minZ.clear();
+        maxX.clear(); maxY.clear(); maxZ.clear();
+    }
+
+    void reserve(qsizetype count)
+    {
+        const size_t n = size_t(count);
+        minX.reserve(n); minY.reserve(n); minZ.reserve(n);
+        maxX.reserve(n); maxY.reserve(n); maxZ.reserve(n);
+    }
+
+    void append(const QSSGBounds3 &bounds)
+    {
+        minX.push_back(bounds.minimum.x()); minY.push_back(bounds.minimum.y()); minZ.push_back(bounds.minimum.z());
+        maxX.push_back(bounds.maximum.x()); maxY.push_back(bounds.maximum.y()); maxZ.push_back(bounds.maximum.z());
+    }
+
+    void resize(qsizetype count)
+    {
+        const size_t n = size_t(count);
+        minX.resize(n); minY.resize(n); minZ.resize(n);
+        maxX.resize(n); maxY.resize(n); maxZ.resize(n);
+    }
+
+    void set(qsizetype i, const QSSGBounds3 &bounds)
+    {
+        const size_t n = size_t(i);
+        minX[n] = bounds.minimum.x(); minY[n] = bounds.minimum.y(); minZ[n] = bounds.minimum.z();
+        maxX[n] = bounds.maximum.x(); maxY[n] = bounds.maximum.y(); maxZ[n] = bounds.maximum.z();
+    }
+};
+
 struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGClippingFrustum
 {
     QSSGClipPlane mPlanes[6];
@@ -141,6 +187,16 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGClippingFrustum
             ret = !(mPlanes[idx].distance(point) < radius);
         return ret;
     }
+
+    // Same test as intersectsWith(QSSGBounds3), but for all the boxes in the
+    // list at once (using SSE2/AVX when available). The indices of the boxes
+    // intersecting the frustum are written, in order, to visibleIndices,
+    // which must have room for bounds.size() entries.
+    // Returns the number of visible boxes.
+    qsizetype intersectsWith(const QSSGBoundsList &bounds, quint32 *visibleIndices) const;
+    // Same as above, for the count boxes starting at first. The indices
+    // written are relative to first.
+    qsizetype intersectsWith(const QSSGBoundsList &bounds, qsizetype first, qsizetype count, quint32 *visibleIndices) const;
 };
 QT_END_NAMESPACE
 
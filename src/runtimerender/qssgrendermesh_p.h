@@ -34,6 +34,8 @@ struct QSSGRenderSubset
         QSSGRhiBufferPtr indexBuffer;
         QSSGRhiInputAssemblerState ia;
         QRhiTexture *targetsTexture = nullptr;
+        // The normals, tangents and binormals are unsigned normalized bytes
+        bool quantizedDirections = false;
     } rhi;
 
     struct Lod {
@@ -97,7 +99,8 @@ struct QSSGRenderMesh
     QVector<QSSGRenderSubset> subsets;
     QSSGRenderDrawMode drawMode;
     QSSGRenderWinding winding;
-    std::unique_ptr<QSSGMeshBVH> bvh;
+    // Shared with the picking data, see QSSGBufferManager::getMeshPickingData()
+    std::shared_ptr<QSSGMeshBVH> bvh;
     QSize lightmapSizeHint;
 
     QSSGRenderMesh(QSSGRenderDrawMode inDrawMode, QSSGRenderWinding inWinding)
@@ -9,6 +9,9 @@
 #include <QtQuick3DUtils/private/qssgmeshbvh_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
 
+#include <QtCore/qvarlengtharray.h>
+
+#include <functional>
 #include <optional>
 
 QT_BEGIN_NAMESPACE
@@ -188,43 +191,13 @@ bool QSSGRenderRay::triangleIntersect(const QSSGRenderRay &ray,
 }
 
 
-void QSSGRenderRay::intersectWithBVH(const RayData &data,
-                                     const QSSGMeshBVHNode *bvh,
-                                     const QSSGRenderMesh *mesh,
-                                     QVector<IntersectionResult> &intersections,
-                                     int depth)
+static void appendTriangleIntersections(const QSSGRenderRay::RayData &data,
+                                        const QVector<QSSGMeshBVHTriangle> &bvhTriangles,
+                                        int triangleOffset,
+                                        int triangleCount,
+                                        QVector<QSSGRenderRay::IntersectionResult> &results)
 {
-    if (!bvh || !mesh || !mesh->bvh)
-        return;
-
-    // If this is a leaf node, process it's triangles
-    if (bvh->count != 0) {
-        // If there is an intersection on a leaf node, then test against geometry
-        auto results = intersectWithBVHTriangles(data, mesh->bvh->triangles, bvh->offset, bvh->count);
-        if (!results.isEmpty())
-            intersections.append(results);
-        return;
-    }
-
-    auto hit = QSSGRenderRay::intersectWithAABBv2(data, bvh->left->boundingData);
-    if (hit.intersects())
-        intersectWithBVH(data, static_cast<const QSSGMeshBVHNode *>(bvh->left), mesh, intersections, depth + 1);
-
-    hit = QSSGRenderRay::intersectWithAABBv2(data, bvh->right->boundingData);
-    if (hit.intersects())
-        intersectWithBVH(data, static_cast<const QSSGMeshBVHNode *>(bvh->right), mesh, intersections, depth + 1);
-}
-
-
-
-QVector<QSSGRenderRay::IntersectionResult> QSSGRenderRay::intersectWithBVHTriangles(const RayData &data,
-                                                                                    const QVector<QSSGMeshBVHTriangle> &bvhTriangles,
-                                                                                    int triangleOffset,
-                                                                                    int triangleCount)
-{
-    Q_ASSERT(bvhTriangles.size() >= triangleOffset + triangleCount);
-
-    QVector<QSSGRenderRay::IntersectionResult> results;
+    using IntersectionResult = QSSGRenderRay::IntersectionResult;
 
     for (int i = triangleOffset; i < triangleCount + triangleOffset; ++i) {
         const auto &triangle = bvhTriangles[i];
@@ -235,13 +208,13 @@ QVector<QSSGRenderRay::IntersectionResult> QSSGRenderRay::intersectWithBVHTriang
         float u = 0.f;
         float v = 0.f;
         QVector3D normal;
-        const bool intersects = triangleIntersect(relativeRay,
-                                                  triangle.vertex1,
-                                                  triangle.vertex2,
-                                                  triangle.vertex3,
-                                                  u,
-                                                  v,
-                                                  normal);
+        const bool intersects = QSSGRenderRay::triangleIntersect(relativeRay,
+                                                                 triangle.vertex1,
+                                                                 triangle.vertex2,
+                                                                 triangle.vertex3,
+                                                                 u,
+                                                                 v,
+                                                                 normal);
         if (intersects) {
             const float w = 1.0f - u - v;
             const QVector3D localIntersectionPoint = w * triangle.vertex1 +
@@ -264,6 +237,97 @@ QVector<QSSGRenderRay::IntersectionResult> QSSGRenderRay::intersectWithBVHTriang
                                               normal));
         }
     }
+}
+
+// Fallback for trees without flat nodes
+static void intersectWithBVHNodes(const QSSGRenderRay::RayData &data,
+                                  const QSSGMeshBVHNode *bvh,
+                                  const QSSGMeshBVH &meshBvh,
+                                  QVector<QSSGRenderRay::IntersectionResult> &intersections)
+{
+    // If this is a leaf node, process it's triangles
+    if (bvh->count != 0) {
+        // If there is an intersection on a leaf node, then test against geometry
+        appendTriangleIntersections(data, meshBvh.triangles, bvh->offset, bvh->count, intersections);
+        return;
+    }
+
+    auto hit = QSSGRenderRay::intersectWithAABBv2(data, bvh->left->boundingData);
+    if (hit.intersects())
+        intersectWithBVHNodes(data, static_cast<const QSSGMeshBVHNode *>(bvh->left), meshBvh, intersections);
+
+    hit = QSSGRenderRay::intersectWithAABBv2(data, bvh->right->boundingData);
+    if (hit.intersects())
+        intersectWithBVHNodes(data, static_cast<const QSSGMeshBVHNode *>(bvh->right), meshBvh, intersections);
+}
+
+void QSSGRenderRay::intersectWithBVH(const RayData &data,
+                                     const QSSGMeshBVHNode *bvh,
+                                     const QSSGRenderMesh *mesh,
+                                     QVector<IntersectionResult> &intersections,
+                                     int depth)
+{
+    Q_UNUSED(depth);
+    if (mesh)
+        intersectWithBVH(data, bvh, mesh->bvh.get(), intersections);
+}
+
+void QSSGRenderRay::intersectWithBVH(const RayData &data,
+                                     const QSSGMeshBVHNode *bvh,
+                                     const QSSGMeshBVH *meshBvh,
+                                     QVector<IntersectionResult> &intersections)
+{
+    if (!bvh || !meshBvh)
+        return;
+
+    // Walk the flattened nodes with an explicit stack when the tree has them
+    const QSSGMeshBVHNode *firstNode = meshBvh->m_nodes.constData();
+    const bool hasFlatNodes = meshBvh->flatNodes.size() == meshBvh->m_nodes.size();
+    if (!hasFlatNodes || std::less<>()(bvh, firstNode) || !std::less<>()(bvh, firstNode + meshBvh->m_nodes.size())) {
+        intersectWithBVHNodes(data, bvh, *meshBvh, intersections);
+        return;
+    }
+
+    const QSSGMeshBVHFlatNode *nodes = meshBvh->flatNodes.constData();
+    QVarLengthArray<quint32, 64> stack;
+    quint32 current = quint32(bvh - firstNode);
+    while (true) {
+        const QSSGMeshBVHFlatNode &node = nodes[current];
+        if (node.isLeaf()) {
+            appendTriangleIntersections(data, meshBvh->triangles, int(node.rightOrOffset), int(node.count), intersections);
+        } else if (!node.isEmpty()) {
+            const quint32 left = current + 1;
+            const quint32 right = node.rightOrOffset;
+            const bool hitLeft = intersectWithAABBv2(data, nodes[left].bounds).intersects();
+            const bool hitRight = intersectWithAABBv2(data, nodes[right].bounds).intersects();
+            if (hitLeft) {
+                if (hitRight)
+                    stack.append(right);
+                current = left;
+                continue;
+            }
+            if (hitRight) {
+                current = right;
+                continue;
+            }
+        }
+        if (stack.isEmpty())
+            break;
+        current = stack.takeLast();
+    }
+}
+
+
+
+QVector<QSSGRenderRay::IntersectionResult> QSSGRenderRay::intersectWithBVHTriangles(const RayData &data,
+                                                                                    const QVector<QSSGMeshBVHTriangle> &bvhTriangles,
+                                                                                    int triangleOffset,
+                                                                                    int triangleCount)
+{
+    Q_ASSERT(bvhTriangles.size() >= triangleOffset + triangleCount);
+
+    QVector<QSSGRenderRay::IntersectionResult> results;
+    appendTriangleIntersections(data, bvhTriangles, triangleOffset, triangleCount, results);
 
     // Does not intersect with any of the triangles
     return results;
@@ -27,6 +27,7 @@
 
 QT_BEGIN_NAMESPACE
 struct QSSGMeshBVHNode;
+struct QSSGMeshBVH;
 struct QSSGRenderMesh;
 struct QSSGMeshBVHTriangle;
 enum class QSSGRenderBasisPlanes
@@ -120,6 +121,12 @@ struct Q_AUTOTEST_EXPORT QSSGRenderRay
                                         QVector<IntersectionResult> &intersections,
                                         int depth = 0);
 
+    // Same as above without the mesh, for picking data that outlives the mesh
+    static void intersectWithBVH(const RayData &data,
+                                 const QSSGMeshBVHNode *bvh,
+                                 const QSSGMeshBVH *meshBvh,
+                                 QVector<IntersectionResult> &intersections);
+
     static QVector<IntersectionResult> intersectWithBVHTriangles(const RayData &data,
                                                                  const QVector<QSSGMeshBVHTriangle> &bvhTriangles,
                                                                  int triangleOffset,
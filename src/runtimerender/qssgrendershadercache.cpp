@@ -8,6 +8,7 @@
 
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 #include <QtQuick3DUtils/private/qquick3dprofiler_p.h>
+#include <QtQuick3DUtils/private/qssgassert_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
 #include <qtquick3d_tracepoints_p.h>
@@ -28,6 +29,7 @@
 #endif
 
 #include <QtCore/qmutex.h>
+#include <QtConcurrent/qtconcurrentrun.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -244,6 +246,20 @@ static inline QString persistentQsbcFileName()
     return QString();
 }
 
+QString QSSGShaderCache::persistentPipelineCacheFileName(const QString &graphicsApiName)
+{
+    if (!isAutoDiskCacheEnabled())
+        return QString();
+
+    // The data is only usable with the same device and driver, QRhi checks
+    // that itself when seeding the cache and ignores anything else.
+    const QString cacheDir = persistentQsbcDir();
+    if (!cacheDir.isEmpty())
+        return cacheDir + QLatin1String("q3dpipelinecache-") + graphicsApiName.toLower() + QLatin1String(".bin");
+
+    return QString();
+}
+
 QSSGShaderCache::QSSGShaderCache(QSSGRhiContext &ctx,
                                  const InitBakerFunc initBakeFn)
     : m_rhiContext(ctx),
@@ -283,6 +299,9 @@ QSSGShaderCache::QSSGShaderCache(QSSGRhiContext &ctx,
 
 QSSGShaderCache::~QSSGShaderCache()
 {
+    // What is still being compiled is good to have in the disk cache too
+    waitForPendingCompilations();
+
     if (!m_persistentShaderStorageFileName.isEmpty())
         m_persistentShaderBakingCache.save(m_persistentShaderStorageFileName);
 }
@@ -290,6 +309,7 @@ QSSGShaderCache::~QSSGShaderCache()
 void QSSGShaderCache::releaseCachedResources()
 {
     m_rhiShaders.clear();
+    m_rhiMaterialShaders.clear();
 
     // m_persistentShaderBakingCache is not cleared, that is intentional,
     // otherwise we would permanently lose what got loaded at startup.
@@ -307,6 +327,24 @@ QSSGRhiShaderPipelinePtr QSSGShaderCache::tryGetRhiShaderPipeline(const QByteArr
     return nullptr;
 }
 
+QSSGRhiShaderPipelinePtr QSSGShaderCache::tryGetRhiShaderPipeline(const QSSGShaderMaterialKey &inKey,
+                                                                  QByteArray &outKey) const
+{
+    const auto theIter = m_rhiMaterialShaders.constFind(inKey);
+    if (theIter == m_rhiMaterialShaders.cend())
+        return nullptr;
+    outKey = theIter->key;
+    return theIter->pipeline;
+}
+
+void QSSGShaderCache::insertRhiShaderPipeline(const QSSGShaderMaterialKey &inKey,
+                                              const QByteArray &inStringKey,
+                                              const QSSGRhiShaderPipelinePtr &pipeline)
+{
+    QSSG_ASSERT(pipeline, return);
+    m_rhiMaterialShaders.insert(inKey, { pipeline, inStringKey });
+}
+
 
 void QSSGShaderCache::addShaderPreprocessor(QByteArray &str,
                                             const QByteArray &inKey,
@@ -358,73 +396,59 @@ QByteArray QSSGShaderCache::shaderCollectionFile()
     return QByteArrayLiteral("qtappshaders.qsbc");
 }
 
-QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey, const QByteArray &inVert, const QByteArray &inFrag,
-                                                        const QSSGShaderFeatures &inFeatures, QSSGRhiShaderPipeline::StageFlags stageFlags)
-{
 #ifdef QT_QUICK3D_HAS_RUNTIME_SHADERS
-    const QSSGRhiShaderPipelinePtr &rhiShaders = tryGetRhiShaderPipeline(inKey, inFeatures);
-    if (rhiShaders)
-        return rhiShaders;
-
-    QSSGShaderCacheKey tempKey(inKey);
-    tempKey.m_features = inFeatures;
-    tempKey.updateHashCode();
-
-    QByteArray vertexCode = inVert;
-    QByteArray fragmentCode = inFrag;
-
-    if (!vertexCode.isEmpty())
-        addShaderPreprocessor(vertexCode, inKey, ShaderType::Vertex, inFeatures);
-
-    if (!fragmentCode.isEmpty())
-        addShaderPreprocessor(fragmentCode, inKey, ShaderType::Fragment, inFeatures);
+static void dumpShader(QShader::Stage stage, const QByteArray &code)
+{
+    switch (stage) {
+    case QShader::Stage::VertexStage:
+        qDebug("VERTEX SHADER:\n*****\n");
+        break;
+    case QShader::Stage::FragmentStage:
+        qDebug("FRAGMENT SHADER:\n*****\n");
+        break;
+    default:
+        qDebug("SHADER:\n*****\n");
+        break;
+    }
+    const auto lines = code.split('\n');
+    for (int i = 0; i < lines.size(); i++)
+        qDebug("%3d  %s", i + 1, lines.at(i).constData());
+    qDebug("\n*****\n");
+}
 
-    // lo and behold the final shader strings are ready
+static void dumpShaderToFile(QShader::Stage stage, const QByteArray &data)
+{
+    QFile f(dumpFilename(stage));
+    f.open(QIODevice::WriteOnly | QIODevice::Text);
+    f.write(data);
+    f.close();
+}
 
-    QSSGRhiShaderPipelinePtr shaders;
-    QString vertErr, fragErr;
+// Does not touch the cache, so that it can run on a worker thread
+static QSSGShaderCache::BakeResult bakeShaders(QSSGShaderCache::InitBakerFunc initBaker,
+                                               QRhi *rhi,
+                                               const QByteArray &inKey,
+                                               const QByteArray &vertexCode,
+                                               const QByteArray &fragmentCode)
+{
+    QSSGShaderCache::BakeResult result;
 
     QShaderBaker baker;
-    m_initBaker(&baker, m_rhiContext.rhi());
+    initBaker(&baker, rhi);
 
     const bool editorMode = QSSGRhiContextPrivate::editorMode();
     // Shader debug is disabled in editor mode
     const bool shaderDebug = !editorMode && QSSGRhiContextPrivate::shaderDebuggingEnabled();
 
-   static auto dumpShader = [](QShader::Stage stage, const QByteArray &code) {
-       switch (stage) {
-       case QShader::Stage::VertexStage:
-           qDebug("VERTEX SHADER:\n*****\n");
-           break;
-       case QShader::Stage::FragmentStage:
-           qDebug("FRAGMENT SHADER:\n*****\n");
-           break;
-       default:
-           qDebug("SHADER:\n*****\n");
-           break;
-       }
-       const auto lines = code.split('\n');
-       for (int i = 0; i < lines.size(); i++)
-           qDebug("%3d  %s", i + 1, lines.at(i).constData());
-       qDebug("\n*****\n");
-   };
-
-   static auto dumpShaderToFile = [](QShader::Stage stage, const QByteArray &data) {
-       QFile f(dumpFilename(stage));
-       f.open(QIODevice::WriteOnly | QIODevice::Text);
-       f.write(data);
-       f.close();
-   };
-
     baker.setSourceString(vertexCode, QShader::VertexStage);
-    QShader vertexShader = baker.bake();
-    const auto vertShaderValid = vertexShader.isValid();
+    result.vertexShader = baker.bake();
+    const auto vertShaderValid = result.vertexShader.isValid();
     if (!vertShaderValid) {
-        vertErr = baker.errorMessage();
+        result.vertexError = baker.errorMessage();
         if (!editorMode) {
             qWarning("Failed to compile vertex shader:\n");
             if (!shaderDebug)
-                qWarning() << inKey << '\n' << vertErr;
+                qWarning() << inKey << '\n' << result.vertexError;
         }
     }
 
@@ -435,14 +459,14 @@ QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey,
     }
 
     baker.setSourceString(fragmentCode, QShader::FragmentStage);
-    QShader fragmentShader = baker.bake();
-    const bool fragShaderValid = fragmentShader.isValid();
+    result.fragmentShader = baker.bake();
+    const bool fragShaderValid = result.fragmentShader.isValid();
     if (!fragShaderValid) {
-        fragErr = baker.errorMessage();
+        result.fragmentError = baker.errorMessage();
         if (!editorMode) {
             qWarning("Failed to compile fragment shader \n");
             if (!shaderDebug)
-                qWarning() << inKey << '\n' << fragErr;
+                qWarning() << inKey << '\n' << result.fragmentError;
         }
     }
 
@@ -452,34 +476,91 @@ QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey,
             dumpShaderToFile(QShader::Stage::FragmentStage, fragmentCode);
     }
 
+    return result;
+}
+#endif // QT_QUICK3D_HAS_RUNTIME_SHADERS
+
+QSSGRhiShaderPipelinePtr QSSGShaderCache::finishCompilation(const QSSGShaderCacheKey &key,
+                                                            const BakeResult &result,
+                                                            QSSGRhiShaderPipeline::StageFlags stageFlags)
+{
+    QSSGRhiShaderPipelinePtr shaders;
+
+    const bool editorMode = QSSGRhiContextPrivate::editorMode();
+    const bool shaderDebug = !editorMode && QSSGRhiContextPrivate::shaderDebuggingEnabled();
+    const bool vertShaderValid = result.vertexShader.isValid();
+    const bool fragShaderValid = result.fragmentShader.isValid();
+
     if (vertShaderValid && fragShaderValid) {
         shaders = std::make_shared<QSSGRhiShaderPipeline>(m_rhiContext);
-        shaders->addStage(QRhiShaderStage(QRhiShaderStage::Vertex, vertexShader), stageFlags);
-        shaders->addStage(QRhiShaderStage(QRhiShaderStage::Fragment, fragmentShader), stageFlags);
+        shaders->addStage(QRhiShaderStage(QRhiShaderStage::Vertex, result.vertexShader), stageFlags);
+        shaders->addStage(QRhiShaderStage(QRhiShaderStage::Fragment, result.fragmentShader), stageFlags);
         if (shaderDebug)
             qDebug("Compilation for vertex and fragment stages succeeded");
     }
 
+    // Reported from here, not from the worker, the callback is not expected
+    // to be called on another thread
     if (editorMode && s_statusCallback) {
         using namespace QtQuick3DEditorHelpers::ShaderBaker;
         const auto vertStatus = vertShaderValid ? Status::Success : Status::Error;
         const auto fragStatus = fragShaderValid ? Status::Success : Status::Error;
         QMutexLocker locker(&*s_statusMutex);
-        s_statusCallback(inKey, vertStatus, vertErr, QShader::VertexStage);
-        s_statusCallback(inKey, fragStatus, fragErr, QShader::FragmentStage);
+        s_statusCallback(key.m_key, vertStatus, result.vertexError, QShader::VertexStage);
+        s_statusCallback(key.m_key, fragStatus, result.fragmentError, QShader::FragmentStage);
     }
 
-    auto result = m_rhiShaders.insert(tempKey, shaders).value();
-    if (result && result->vertexStage() && result->fragmentStage()) {
+    auto pipeline = m_rhiShaders.insert(key, shaders).value();
+    if (pipeline && pipeline->vertexStage() && pipeline->fragmentStage()) {
         QQsbCollection::EntryDesc entryDesc = {
-            inKey,
-            QQsbCollection::toFeatureSet(inFeatures),
-            result->vertexStage()->shader(),
-            result->fragmentStage()->shader()
+            key.m_key,
+            QQsbCollection::toFeatureSet(key.m_features),
+            pipeline->vertexStage()->shader(),
+            pipeline->fragmentStage()->shader()
         };
         m_persistentShaderBakingCache.addEntry(entryDesc.generateSha(), entryDesc);
     }
-    return result;
+    return pipeline;
+}
+
+QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey, const QByteArray &inVert, const QByteArray &inFrag,
+                                                        const QSSGShaderFeatures &inFeatures, QSSGRhiShaderPipeline::StageFlags stageFlags)
+{
+#ifdef QT_QUICK3D_HAS_RUNTIME_SHADERS
+    const QSSGRhiShaderPipelinePtr &rhiShaders = tryGetRhiShaderPipeline(inKey, inFeatures);
+    if (rhiShaders)
+        return rhiShaders;
+
+    QSSGShaderCacheKey tempKey(inKey);
+    tempKey.m_features = inFeatures;
+    tempKey.updateHashCode();
+
+    if (m_asyncCompilation) {
+        // A failed compilation leaves a null entry behind, do not retry that
+        // every frame
+        if (m_rhiShaders.contains(tempKey) || m_pendingCompilations.contains(tempKey))
+            return {};
+    }
+
+    QByteArray vertexCode = inVert;
+    QByteArray fragmentCode = inFrag;
+
+    if (!vertexCode.isEmpty())
+        addShaderPreprocessor(vertexCode, inKey, ShaderType::Vertex, inFeatures);
+
+    if (!fragmentCode.isEmpty())
+        addShaderPreprocessor(fragmentCode, inKey, ShaderType::Fragment, inFeatures);
+
+    // lo and behold the final shader strings are ready
+
+    if (m_asyncCompilation) {
+        m_pendingCompilations.insert(tempKey, { QtConcurrent::run(&m_compilePool, bakeShaders, m_initBaker, m_rhiContext.rhi(),
+                                                                  inKey, vertexCode, fragmentCode),
+                                                stageFlags });
+        return {};
+    }
+
+    return finishCompilation(tempKey, bakeShaders(m_initBaker, m_rhiContext.rhi(), inKey, vertexCode, fragmentCode), stageFlags);
 
 #else
     Q_UNUSED(inKey);
@@ -493,6 +574,35 @@ QSSGRhiShaderPipelinePtr QSSGShaderCache::compileForRhi(const QByteArray &inKey,
 #endif
 }
 
+bool QSSGShaderCache::isCompiling(const QByteArray &inKey, const QSSGShaderFeatures &inFeatures) const
+{
+    if (m_pendingCompilations.isEmpty())
+        return false;
+    QSSGShaderCacheKey cacheKey(inKey);
+    cacheKey.m_features = inFeatures;
+    cacheKey.updateHashCode();
+    return m_pendingCompilations.contains(cacheKey);
+}
+
+void QSSGShaderCache::collectCompiledShaders()
+{
+    for (auto it = m_pendingCompilations.begin(); it != m_pendingCompilations.end(); ) {
+        if (it->future.isFinished()) {
+            finishCompilation(it.key(), it->future.result(), it->stageFlags);
+            it = m_pendingCompilations.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QSSGShaderCache::waitForPendingCompilations()
+{
+    for (const auto &pending : std::as_const(m_pendingCompilations))
+        pending.future.waitForFinished();
+    collectCompiledShaders();
+}
+
 QSSGRhiShaderPipelinePtr QSSGShaderCache::newPipelineFromPregenerated(const QByteArray &inKey,
                                                                       const QSSGShaderFeatures &inFeatures,
                                                                       QQsbCollection::Entry entry,
@@ -22,11 +22,14 @@
 
 #include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendererimplshaders_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershaderkeys_p.h>
 
 #include <QtCore/QString>
 #include <QtCore/qcryptographichash.h>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QVector>
+#include <QtCore/QFuture>
+#include <QtCore/QThreadPool>
 
 QT_BEGIN_NAMESPACE
 
@@ -158,6 +161,35 @@ inline size_t qHash(const QSSGShaderCacheKey &key)
     return key.m_hashCode;
 }
 
+// The binary form of the QSSGShaderCacheKey of a default material: the
+// material key and the features. It identifies the same shaders as the
+// string that QSSGShaderDefaultMaterialKey::toString() builds, but it is
+// cheap to build, hash and compare. The string is only needed when
+// compiling and for the disk cache.
+struct QSSGShaderMaterialKey
+{
+    QSSGShaderDefaultMaterialKey m_materialKey;
+    QSSGShaderFeatures m_features;
+    size_t m_hashCode = 0;
+
+    QSSGShaderMaterialKey(const QSSGShaderDefaultMaterialKey &materialKey, QSSGShaderFeatures features)
+        : m_materialKey(materialKey)
+        , m_features(features)
+        , m_hashCode(materialKey.hash() ^ qHash(features))
+    {
+    }
+
+    bool operator==(const QSSGShaderMaterialKey &other) const
+    {
+        return m_features == other.m_features && m_materialKey == other.m_materialKey;
+    }
+};
+
+inline size_t qHash(const QSSGShaderMaterialKey &key, size_t seed = 0) noexcept
+{
+    return key.m_hashCode ^ seed;
+}
+
 class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGShaderCache
 {
     Q_DISABLE_COPY(QSSGShaderCache)
@@ -169,12 +201,51 @@ public:
     };
 
     using InitBakerFunc = void (*)(QShaderBaker *baker, QRhi *rhi);
+
+    struct BakeResult
+    {
+        QShader vertexShader;
+        QShader fragmentShader;
+        QString vertexError;
+        QString fragmentError;
+    };
+
+    // Makes compileForRhi() bake on a worker thread for as long as the scope
+    // is alive. Only the material shader generation opts in to this, the
+    // other users of the cache need their shaders right away.
+    class AsynchronousScope
+    {
+        Q_DISABLE_COPY_MOVE(AsynchronousScope)
+    public:
+        AsynchronousScope(QSSGShaderCache &cache, bool enable)
+            : m_cache(cache), m_wasEnabled(std::exchange(cache.m_asyncCompilation, enable)) {}
+        ~AsynchronousScope() { m_cache.m_asyncCompilation = m_wasEnabled; }
+    private:
+        QSSGShaderCache &m_cache;
+        bool m_wasEnabled;
+    };
+
 private:
     friend class QSSGBuiltInRhiShaderCache;
 
     typedef QHash<QSSGShaderCacheKey, QSSGRhiShaderPipelinePtr> TRhiShaderMap;
     QSSGRhiContext &m_rhiContext; // Not own, the RCI owns us and the QSSGRhiContext.
     TRhiShaderMap m_rhiShaders;
+    struct MaterialShaders
+    {
+        QSSGRhiShaderPipelinePtr pipeline;
+        QByteArray key; // the string form, shared with the caller
+    };
+    QHash<QSSGShaderMaterialKey, MaterialShaders> m_rhiMaterialShaders;
+    struct PendingCompilation
+    {
+        QFuture<BakeResult> future;
+        QSSGRhiShaderPipeline::StageFlags stageFlags;
+    };
+    QHash<QSSGShaderCacheKey, PendingCompilation> m_pendingCompilations;
+    // Not the global pool, the render thread uses that for its own jobs
+    QThreadPool m_compilePool;
+    bool m_asyncCompilation = false;
     QByteArray m_insertStr; // member to potentially reuse the allocation after clear
     InitBakerFunc m_initBaker;
     QQsbInMemoryCollection m_persistentShaderBakingCache;
@@ -188,6 +259,10 @@ private:
                                ShaderType shaderType,
                                const QSSGShaderFeatures &inFeatures);
 
+    QSSGRhiShaderPipelinePtr finishCompilation(const QSSGShaderCacheKey &key,
+                                               const BakeResult &result,
+                                               QSSGRhiShaderPipeline::StageFlags stageFlags);
+
 public:
     QSSGShaderCache(QSSGRhiContext &ctx,
                     const InitBakerFunc initBakeFn = nullptr);
@@ -200,6 +275,14 @@ public:
     QSSGRhiShaderPipelinePtr tryGetRhiShaderPipeline(const QByteArray &inKey,
                                                      const QSSGShaderFeatures &inFeatures);
 
+    // The in-memory cache of the default material shaders by their binary
+    // key, on a hit outKey gets the string key the pipeline was built with.
+    QSSGRhiShaderPipelinePtr tryGetRhiShaderPipeline(const QSSGShaderMaterialKey &inKey,
+                                                     QByteArray &outKey) const;
+    void insertRhiShaderPipeline(const QSSGShaderMaterialKey &inKey,
+                                 const QByteArray &inStringKey,
+                                 const QSSGRhiShaderPipelinePtr &pipeline);
+
     QSSGRhiShaderPipelinePtr tryNewPipelineFromPersistentCache(const QByteArray &qsbcKey,
                                                                const QByteArray &inKey,
                                                                const QSSGShaderFeatures &inFeatures,
@@ -217,10 +300,24 @@ public:
                                            const QSSGShaderFeatures &inFeatures,
                                            QSSGRhiShaderPipeline::StageFlags stageFlags);
 
+    // Shaders compiled asynchronously are not available before the first
+    // collectCompiledShaders() after they are done. Until then
+    // compileForRhi() returns null for them and isCompiling() is true.
+    bool asynchronousCompilation() const { return m_asyncCompilation; }
+    bool isCompiling(const QByteArray &inKey, const QSSGShaderFeatures &inFeatures) const;
+    [[nodiscard]] bool hasPendingCompilations() const { return !m_pendingCompilations.isEmpty(); }
+    void collectCompiledShaders();
+    void waitForPendingCompilations();
+    void setMaxCompileThreads(int count) { m_compilePool.setMaxThreadCount(count); }
+
     QSSGBuiltInRhiShaderCache &getBuiltInRhiShaders() { return m_builtInShaders; }
 
     static QByteArray resourceFolder();
     static QByteArray shaderCollectionFile();
+
+    // Where the pipeline cache data of the graphics driver is kept between
+    // runs, next to the shader cache. Empty when the disk cache is disabled.
+    static QString persistentPipelineCacheFileName(const QString &graphicsApiName);
 };
 
 namespace QtQuick3DEditorHelpers {
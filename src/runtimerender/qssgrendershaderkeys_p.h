@@ -568,6 +568,7 @@ struct QSSGShaderDefaultMaterialKeyProperties
     QSSGShaderKeyAlphaMode m_alphaMode;
     QSSGShaderKeyVertexAttribute m_vertexAttributes;
     QSSGShaderKeyBoolean m_usesFloatJointIndices;
+    QSSGShaderKeyBoolean m_usesQuantizedDirections;
     qsizetype m_stringBufferSizeHint = 0;
     QSSGShaderKeyBoolean m_usesInstancing;
     QSSGShaderKeyUnsigned<8> m_targetCount;
@@ -605,6 +606,7 @@ struct QSSGShaderDefaultMaterialKeyProperties
         , m_alphaMode("alphaMode")
         , m_vertexAttributes("vertexAttributes")
         , m_usesFloatJointIndices("usesFloatJointIndices")
+        , m_usesQuantizedDirections("usesQuantizedDirections")
         , m_usesInstancing("usesInstancing")
         , m_targetCount("targetCount")
         , m_targetPositionOffset("targetPositionOffset")
@@ -760,6 +762,7 @@ struct QSSGShaderDefaultMaterialKeyProperties
         inVisitor.visit(m_alphaMode);
         inVisitor.visit(m_vertexAttributes);
         inVisitor.visit(m_usesFloatJointIndices);
+        inVisitor.visit(m_usesQuantizedDirections);
         inVisitor.visit(m_usesInstancing);
         inVisitor.visit(m_targetCount);
         inVisitor.visit(m_targetPositionOffset);
@@ -858,18 +861,14 @@ struct QSSGShaderDefaultMaterialKey
 
     size_t hash() const
     {
-        size_t retval = 0;
-        for (size_t idx = 0; idx < DataBufferSize; ++idx)
-            retval = retval ^ qHash(m_dataBuffer[idx]);
-        return retval ^ m_featureSetHash;
+        // Not a xor of the words, that cancels out equal words
+        return qHashBits(m_dataBuffer, sizeof(m_dataBuffer), m_featureSetHash);
     }
 
     bool operator==(const QSSGShaderDefaultMaterialKey &other) const
     {
-        bool retval = true;
-        for (size_t idx = 0; idx < DataBufferSize && retval; ++idx)
-            retval = m_dataBuffer[idx] == other.m_dataBuffer[idx];
-        return retval && m_featureSetHash == other.m_featureSetHash;
+        return memcmp(m_dataBuffer, other.m_dataBuffer, sizeof(m_dataBuffer)) == 0
+                && m_featureSetHash == other.m_featureSetHash;
     }
 
     // Cast operators to make getting properties easier.
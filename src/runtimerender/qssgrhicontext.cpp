@@ -85,6 +85,31 @@ QRhiVertexInputAttribute::Format QSSGRhiInputAssemblerState::toVertexInputFormat
         default:
             break;
         }
+    } else if (compType == QSSGRenderComponentType::Float16) {
+        switch (numComps) {
+        case 1:
+            return QRhiVertexInputAttribute::Half;
+        case 2:
+            return QRhiVertexInputAttribute::Half2;
+        case 3:
+            return QRhiVertexInputAttribute::Half3;
+        case 4:
+            return QRhiVertexInputAttribute::Half4;
+        default:
+            break;
+        }
+    } else if (compType == QSSGRenderComponentType::UnsignedInt8) {
+        // Bytes are always normalized, see QSSGMesh::Mesh::quantizeVertexData()
+        switch (numComps) {
+        case 1:
+            return QRhiVertexInputAttribute::UNormByte;
+        case 2:
+            return QRhiVertexInputAttribute::UNormByte2;
+        case 4:
+            return QRhiVertexInputAttribute::UNormByte4;
+        default:
+            break;
+        }
     }
     Q_ASSERT(false);
     return QRhiVertexInputAttribute::Float4;
@@ -796,7 +821,7 @@ void QSSGRhiShaderPipeline::setUniformArray(char *ubufData, const char *name, co
 
 void QSSGRhiShaderPipeline::ensureCombinedMainLightsUniformBuffer(QRhiBuffer **ubuf)
 {
-    const quint32 totalBufferSize = m_ub0NextUBufOffset + sizeof(QSSGShaderLightsUniformData);
+    const quint32 totalBufferSize = combinedMainLightsUniformBufferSize();
     if (!*ubuf) {
         *ubuf = m_context.rhi()->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, totalBufferSize);
         (*ubuf)->create();
@@ -924,9 +949,11 @@ void QSSGRhiContext::releaseCachedResources()
 
     d->m_drawCallData.clear();
 
-    qDeleteAll(d->m_pipelines);
+    for (const auto &pipeline : std::as_const(d->m_pipelines))
+        delete pipeline.resource;
     qDeleteAll(d->m_computePipelines);
-    qDeleteAll(d->m_srbCache);
+    for (const auto &srb : std::as_const(d->m_srbCache))
+        delete srb.resource;
     qDeleteAll(d->m_dummyTextures);
 
     d->m_pipelines.clear();
@@ -939,8 +966,10 @@ void QSSGRhiContext::releaseCachedResources()
 
     d->m_samplers.clear();
 
-    for (const auto &particleData : std::as_const(d->m_particleData))
+    for (auto &particleData : d->m_particleData) {
         delete particleData.texture;
+        particleData.releaseSimulation();
+    }
 
     d->m_particleData.clear();
 
@@ -962,14 +991,18 @@ void QSSGRhiContext::releaseCachedResources()
 QRhiShaderResourceBindings *QSSGRhiContext::srb(const QSSGRhiShaderResourceBindingList &bindings)
 {
     Q_D(QSSGRhiContext);
-    auto it = d->m_srbCache.constFind(bindings);
-    if (it != d->m_srbCache.constEnd())
-        return *it;
+    auto it = d->m_srbCache.find(bindings);
+    const bool found = (it != d->m_srbCache.end());
+    d->m_stats.srbCacheLookup(found);
+    if (found) {
+        it->lastUsedFrame = d->m_currentFrame;
+        return it->resource;
+    }
 
     QRhiShaderResourceBindings *srb = d->m_rhi->newShaderResourceBindings();
     srb->setBindings(bindings.v, bindings.v + bindings.p);
     if (srb->create()) {
-        d->m_srbCache.insert(bindings, srb);
+        d->m_srbCache.insert(bindings, { srb, d->m_currentFrame });
     } else {
         qWarning("Failed to build srb");
         delete srb;
@@ -982,7 +1015,7 @@ void QSSGRhiContextPrivate::releaseDrawCallData(QSSGRhiDrawCallData &dcd)
 {
     delete dcd.ubuf;
     dcd.ubuf = nullptr;
-    auto srb = m_srbCache.take(dcd.bindings);
+    auto srb = m_srbCache.take(dcd.bindings).resource;
     QSSG_CHECK(srb == dcd.srb);
     delete srb;
     dcd.srb = nullptr;
@@ -1006,7 +1039,13 @@ QRhiComputePipeline *QSSGRhiContext::computePipeline(const QShader &shader,
 
 QSSGRhiDrawCallData &QSSGRhiContextPrivate::drawCallData(const QSSGRhiDrawCallDataKey &key)
 {
-    return m_drawCallData[key];
+    auto it = m_drawCallData.find(key);
+    const bool found = (it != m_drawCallData.end());
+    m_stats.drawCallDataLookup(found);
+    if (!found)
+        it = m_drawCallData.insert(key, {});
+    it->lastUsedFrame = m_currentFrame;
+    return *it;
 }
 
 using SamplerInfo = QPair<QSSGRhiSamplerDescription, QRhiSampler*>;
@@ -1114,6 +1153,82 @@ void QSSGRhiContextPrivate::cleanupDrawCallData(const QSSGRenderModel *model)
     }
 }
 
+quint32 QSSGRhiContextPrivate::defaultMaxUnusedFrames()
+{
+    static const int frames = qEnvironmentVariableIntValue("QT_QUICK3D_RHI_CACHE_MAX_AGE");
+    return quint32(qMax(0, frames));
+}
+
+void QSSGRhiContextPrivate::releaseUnusedResources(quint32 frameId)
+{
+    if (m_maxUnusedFrames == 0)
+        return;
+
+    // Going through the caches every frame is not needed for an age limit,
+    // this keeps entries around for at most 1/8 longer than the limit.
+    const quint32 interval = qMax(1u, m_maxUnusedFrames / 8);
+    if (frameId - m_lastReleaseFrame < interval)
+        return;
+    m_lastReleaseFrame = frameId;
+
+    const auto isStale = [this, frameId](quint32 lastUsedFrame) {
+        return frameId - lastUsedFrame > m_maxUnusedFrames;
+    };
+
+    // The command buffer of a frame still in flight may reference anything
+    // released here, hence deleteLater() instead of delete.
+    quint64 evictionCount = 0;
+
+    // The srb and pipeline of a draw call data entry are reused without
+    // going through srb() and pipeline(), so they are only released when
+    // the draw call data is.
+    QSet<QRhiResource *> inUse;
+    for (auto it = m_drawCallData.begin(); it != m_drawCallData.end(); ) {
+        if (isStale(it->lastUsedFrame)) {
+            if (it->ubuf)
+                it->ubuf->deleteLater();
+            it = m_drawCallData.erase(it);
+            ++evictionCount;
+        } else {
+            inUse.insert(it->srb);
+            inUse.insert(it->pipeline);
+            ++it;
+        }
+    }
+
+    const auto releaseStale = [&](auto &cache) {
+        for (auto it = cache.begin(); it != cache.end(); ) {
+            if (isStale(it->lastUsedFrame) && !inUse.contains(it->resource)) {
+                it->resource->deleteLater();
+                it = cache.erase(it);
+                ++evictionCount;
+            } else {
+                ++it;
+            }
+        }
+    };
+    releaseStale(m_pipelines);
+    releaseStale(m_srbCache);
+
+    const auto releaseStaleInstanceData = [&](auto &cache) {
+        for (auto it = cache.begin(); it != cache.end(); ) {
+            if (isStale(it->lastUsedFrame)) {
+                if (it->owned && it->buffer)
+                    it->buffer->deleteLater();
+                it = cache.erase(it);
+                ++evictionCount;
+            } else {
+                ++it;
+            }
+        }
+    };
+    releaseStaleInstanceData(m_instanceBuffers);
+    releaseStaleInstanceData(m_instanceBuffersLod);
+
+    if (evictionCount)
+        m_stats.cacheEntriesEvicted(evictionCount);
+}
+
 QRhiTexture *QSSGRhiContext::dummyTexture(QRhiTexture::Flags flags, QRhiResourceUpdateBatch *rub,
                                           const QSize &size, const QColor &fillColor)
 {
@@ -1135,14 +1250,196 @@ QRhiTexture *QSSGRhiContext::dummyTexture(QRhiTexture::Flags flags, QRhiResource
     return t;
 }
 
+QSSGRhiUniformArena::~QSSGRhiUniformArena()
+{
+    releaseResources();
+}
+
+bool QSSGRhiUniformArena::ensureBlock(QRhi *rhi, Block &block, quint32 size)
+{
+    if (block.buffer && quint32(block.data.size()) >= size)
+        return true;
+
+    const quint32 capacity = qMax(MIN_BLOCK_SIZE, qNextPowerOfTwo(size - 1));
+    if (!block.buffer) {
+        QSSG_ASSERT(rhi, return false);
+        block.buffer = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, capacity);
+        block.buffer->setName(QByteArrayLiteral("Per-draw uniform data"));
+    } else {
+        block.buffer->setSize(capacity);
+    }
+    if (!block.buffer->create()) {
+        qWarning("Failed to build uniform buffer of size %u", capacity);
+        block.data.clear();
+        return false;
+    }
+    block.data.resize(capacity);
+    block.flushed = 0;
+    return true;
+}
+
+QSSGRhiUniformArena::Allocation QSSGRhiUniformArena::allocate(QRhi *rhi, quint32 size)
+{
+    if (m_blocks.empty())
+        m_blocks.resize(1);
+
+    Block *block = &m_blocks[m_current];
+    quint32 offset = quint32(rhi->ubufAligned(int(block->used)));
+    if (!block->buffer || offset + size > quint32(block->data.size())) {
+        // Nothing allocated from the block in this frame yet, it can still grow
+        if (block->used > 0) {
+            if (++m_current == m_blocks.size())
+                m_blocks.emplace_back();
+            block = &m_blocks[m_current];
+        }
+        if (!ensureBlock(rhi, *block, size))
+            return {};
+        offset = 0;
+    }
+
+    block->used = offset + size;
+    char *data = block->data.data() + offset;
+    memset(data, 0, size);
+    return { block->buffer, offset, data };
+}
+
+void QSSGRhiUniformArena::shrink(const Allocation &allocation, quint32 size)
+{
+    QSSG_ASSERT(!m_blocks.empty(), return);
+    Block &block = m_blocks[m_current];
+    QSSG_ASSERT(allocation.buffer == block.buffer
+                && allocation.offset >= block.flushed
+                && allocation.offset + size <= block.used, return);
+    block.used = allocation.offset + size;
+}
+
+void QSSGRhiUniformArena::addUniformBufferWithDynamicOffset(QSSGRhiShaderResourceBindingList &bindings,
+                                                            int binding,
+                                                            QRhiShaderResourceBinding::StageFlags stage,
+                                                            QRhiBuffer *buf,
+                                                            int size)
+{
+#ifdef QT_DEBUG
+    if (bindings.p == QSSGRhiShaderResourceBindingList::MAX_SIZE) {
+        qWarning("Out of shader resource bindings slots (max is %d)", QSSGRhiShaderResourceBindingList::MAX_SIZE);
+        return;
+    }
+#endif
+    QRhiShaderResourceBinding::Data *d = QRhiImplementation::shaderResourceBindingData(bindings.v[bindings.p++]);
+    bindings.h ^= qintptr(buf) ^ size_t(size);
+    d->binding = binding;
+    d->stage = stage;
+    d->type = QRhiShaderResourceBinding::UniformBuffer;
+    d->u.ubuf.buf = buf;
+    d->u.ubuf.offset = 0;
+    d->u.ubuf.maybeSize = size;
+    d->u.ubuf.hasDynamicOffset = true;
+}
+
+QSSGRhiUniformOffsets QSSGRhiUniformArena::addMainUniformBindings(const Allocation &allocation,
+                                                                  const QSSGRhiShaderPipeline &shaderPipeline,
+                                                                  bool withLightData,
+                                                                  QRhiShaderResourceBinding::StageFlags stage,
+                                                                  QSSGRhiShaderResourceBindingList &bindings)
+{
+    QSSGRhiUniformOffsets offsets;
+    quint32 usedSize = quint32(shaderPipeline.ub0Size());
+    addUniformBufferWithDynamicOffset(bindings, 0, stage, allocation.buffer, int(usedSize));
+    offsets.offsets[0] = allocation.offset;
+    offsets.count = 1;
+    if (withLightData) {
+        const quint32 lightDataOffset = quint32(shaderPipeline.ub0LightDataOffset());
+        const quint32 lightDataSize = quint32(shaderPipeline.ub0LightDataSize());
+        addUniformBufferWithDynamicOffset(bindings, 1, stage, allocation.buffer, int(lightDataSize));
+        offsets.offsets[1] = allocation.offset + lightDataOffset;
+        offsets.count = 2;
+        usedSize = lightDataOffset + lightDataSize;
+    }
+    shrink(allocation, usedSize);
+    return offsets;
+}
+
+void QSSGRhiUniformArena::flush()
+{
+    for (size_t i = 0, end = qMin(m_current + 1, m_blocks.size()); i < end; ++i) {
+        Block &block = m_blocks[i];
+        if (block.used <= block.flushed)
+            continue;
+        // Only what was written since the last flush. The rest of the
+        // buffer is either written already or not used in this frame.
+        char *p = block.buffer->beginFullDynamicBufferUpdateForCurrentFrame();
+        memcpy(p + block.flushed, block.data.constData() + block.flushed, block.used - block.flushed);
+        block.buffer->endFullDynamicBufferUpdateForCurrentFrame();
+        block.flushed = block.used;
+    }
+}
+
+void QSSGRhiUniformArena::reset()
+{
+    if (m_current > 0) {
+        // The last frame did not fit into the first buffer, make it large
+        // enough and drop the others until the next time they are needed.
+        quint32 total = 0;
+        for (size_t i = 0; i <= m_current; ++i)
+            total += quint32(m_blocks[i].data.size());
+        ensureBlock(nullptr, m_blocks[0], total);
+        for (size_t i = 1; i < m_blocks.size(); ++i) {
+            m_blocks[i].buffer->destroy();
+            m_blocks[i].data = QByteArray();
+        }
+    }
+
+    for (Block &block : m_blocks) {
+        block.used = 0;
+        block.flushed = 0;
+    }
+    m_current = 0;
+}
+
+void QSSGRhiUniformArena::releaseResources()
+{
+    for (Block &block : m_blocks)
+        delete block.buffer;
+    m_blocks.clear();
+    m_current = 0;
+}
+
+quint64 QSSGRhiUniformArena::usedSize() const
+{
+    quint64 size = 0;
+    for (size_t i = 0, end = qMin(m_current + 1, m_blocks.size()); i < end; ++i)
+        size += m_blocks[i].used;
+    return size;
+}
+
+quint64 QSSGRhiUniformArena::capacity() const
+{
+    quint64 size = 0;
+    for (const Block &block : m_blocks)
+        size += quint64(block.data.size());
+    return size;
+}
+
 QSSGRhiInstanceBufferData &QSSGRhiContextPrivate::instanceBufferData(QSSGRenderInstanceTable *instanceTable)
 {
-    return m_instanceBuffers[instanceTable];
+    auto it = m_instanceBuffers.find(instanceTable);
+    const bool found = (it != m_instanceBuffers.end());
+    m_stats.instanceBufferLookup(found);
+    if (!found)
+        it = m_instanceBuffers.insert(instanceTable, {});
+    it->lastUsedFrame = m_currentFrame;
+    return *it;
 }
 
 QSSGRhiInstanceBufferData &QSSGRhiContextPrivate::instanceBufferData(const QSSGRenderModel *model)
 {
-    return m_instanceBuffersLod[model];
+    auto it = m_instanceBuffersLod.find(model);
+    const bool found = (it != m_instanceBuffersLod.end());
+    m_stats.instanceBufferLookup(found);
+    if (!found)
+        it = m_instanceBuffersLod.insert(model, {});
+    it->lastUsedFrame = m_currentFrame;
+    return *it;
 }
 
 QSSGRhiParticleData &QSSGRhiContextPrivate::particleData(const QSSGRenderGraphObject *particlesOrModel)
@@ -1157,6 +1454,10 @@ void QSSGRhiContextStats::start(QSSGRenderLayer *layer)
     info.renderPasses.clear();
     info.externalRenderPass = {};
     info.currentRenderPassIndex = -1;
+    info.occlusionCulledObjectCount = 0;
+    info.occlusionCulledShadowCasterCount = 0;
+    info.uniformDataSize = 0;
+    info.uniformBufferSize = 0;
 }
 
 void QSSGRhiContextStats::stop(QSSGRenderLayer *layer)
@@ -1328,9 +1629,13 @@ QRhiGraphicsPipeline *QSSGRhiContextPrivate::pipeline(const QSSGGraphicsPipeline
                                                       QRhiRenderPassDescriptor *rpDesc,
                                                       QRhiShaderResourceBindings *srb)
 {
-    auto it = m_pipelines.constFind(key);
-    if (it != m_pipelines.constEnd())
-        return it.value();
+    auto it = m_pipelines.find(key);
+    const bool found = (it != m_pipelines.end());
+    m_stats.pipelineCacheLookup(found);
+    if (found) {
+        it->lastUsedFrame = m_currentFrame;
+        return it->resource;
+    }
 
            // Build a new one. This is potentially expensive.
     QRhiGraphicsPipeline *ps = m_rhi->newGraphicsPipeline();
@@ -1384,7 +1689,7 @@ QRhiGraphicsPipeline *QSSGRhiContextPrivate::pipeline(const QSSGGraphicsPipeline
         return nullptr;
     }
 
-    m_pipelines.insert(key, ps);
+    m_pipelines.insert(key, { ps, m_currentFrame });
     return ps;
 }
 
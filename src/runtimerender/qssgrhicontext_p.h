@@ -21,6 +21,10 @@
 #include <ssg/qssgrenderbasetypes.h>
 #include <ssg/qssgrhicontext.h>
 
+#include <QtQuick3DRuntimeRender/private/qssgrenderparticles_p.h>
+
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 struct QSSGRenderLayer;
@@ -242,6 +246,11 @@ public:
     {
         return int(4 * sizeof(qint32) + m_lightsUniformData.count * sizeof(QSSGShaderLightData));
     }
+    // ub0 followed by the largest possible light data
+    quint32 combinedMainLightsUniformBufferSize() const
+    {
+        return quint32(m_ub0NextUBufOffset) + quint32(sizeof(QSSGShaderLightsUniformData));
+    }
 
     const QHash<QSSGRhiInputAssemblerState::InputSemantic, QShaderDescription::InOutVariable> &vertexInputs() const { return m_vertexInputs; }
 
@@ -487,6 +496,7 @@ struct QSSGRhiDrawCallData
     size_t renderTargetDescriptionHash = 0;
     QVector<quint32> renderTargetDescription;
     QSSGRhiGraphicsPipelineState ps;
+    quint32 lastUsedFrame = 0;
 
     void reset()
     {
@@ -497,6 +507,97 @@ struct QSSGRhiDrawCallData
     }
 };
 
+// The dynamic offsets of bindings 0 and 1 (the main uniform block and the
+// light data) for a draw that has its uniform data in a QSSGRhiUniformArena.
+// Draws with their own uniform buffer have no offsets.
+struct QSSGRhiUniformOffsets
+{
+    quint32 offsets[2] = {};
+    int count = 0;
+
+    void setShaderResources(QRhiCommandBuffer *cb, QRhiShaderResourceBindings *srb) const
+    {
+        if (!count) {
+            cb->setShaderResources(srb);
+            return;
+        }
+        const QRhiCommandBuffer::DynamicOffset dynamicOffsets[2] = { { 0, offsets[0] }, { 1, offsets[1] } };
+        cb->setShaderResources(srb, count, dynamicOffsets);
+    }
+};
+
+// Sub-allocates the per-draw uniform data of a frame from a few large dynamic
+// uniform buffers, instead of one buffer per draw. The data is written to a
+// CPU side copy, and uploaded with one map and copy per buffer on flush(), so
+// the draws of a pass only differ in their dynamic offsets, and share the srb
+// as long as their textures match. QRhi keeps a copy of dynamic buffers per
+// frame in flight, writing the current one, so the data can be written from
+// the start again each frame.
+//
+// When a frame does not fit, more buffers are added for the rest of it. The
+// first buffer is then grown to fit the whole frame when the next one starts.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRhiUniformArena
+{
+public:
+    struct Allocation
+    {
+        QRhiBuffer *buffer = nullptr;
+        quint32 offset = 0;
+        char *data = nullptr; // valid until reset()
+    };
+
+    QSSGRhiUniformArena() = default;
+    ~QSSGRhiUniformArena();
+
+    Q_DISABLE_COPY_MOVE(QSSGRhiUniformArena)
+
+    // Zero-filled, at an offset that can be used as a dynamic offset
+    Allocation allocate(QRhi *rhi, quint32 size);
+    // Gives back the end of the latest allocation, once it is known how much
+    // of it is used
+    void shrink(const Allocation &allocation, quint32 size);
+    // Binds the main uniform block of shaderPipeline, and optionally the
+    // light data after it, to the latest allocation, and gives back the rest.
+    QSSGRhiUniformOffsets addMainUniformBindings(const Allocation &allocation,
+                                                 const QSSGRhiShaderPipeline &shaderPipeline,
+                                                 bool withLightData,
+                                                 QRhiShaderResourceBinding::StageFlags stage,
+                                                 QSSGRhiShaderResourceBindingList &bindings);
+    // Uploads what was allocated since the previous flush, must be called
+    // before recording the draws using the data.
+    void flush();
+    // Starts over for a new frame
+    void reset();
+    void releaseResources();
+
+    [[nodiscard]] quint64 usedSize() const;
+    [[nodiscard]] quint64 capacity() const;
+
+private:
+    static constexpr quint32 MIN_BLOCK_SIZE = 256 * 1024;
+
+    struct Block
+    {
+        QRhiBuffer *buffer = nullptr;
+        QByteArray data;
+        quint32 used = 0;
+        quint32 flushed = 0;
+    };
+
+    bool ensureBlock(QRhi *rhi, Block &block, quint32 size);
+    // Like QSSGRhiShaderResourceBindingList::addUniformBuffer(), but the
+    // offset is given when setting the srb on the command buffer, so the
+    // draws of an arena buffer can share it.
+    static void addUniformBufferWithDynamicOffset(QSSGRhiShaderResourceBindingList &bindings,
+                                                  int binding,
+                                                  QRhiShaderResourceBinding::StageFlags stage,
+                                                  QRhiBuffer *buf,
+                                                  int size);
+
+    std::vector<Block> m_blocks;
+    size_t m_current = 0;
+};
+
 struct QSSGRhiRenderableTexture
 {
     QRhiTexture *texture = nullptr;
@@ -533,6 +634,7 @@ struct QSSGRhiInstanceBufferData
     QVector3D cameraPosition;
     QByteArray lodData;
     int serial = -1;
+    quint32 lastUsedFrame = 0;
     bool owned = true;
     bool sorting = false;
 };
@@ -543,9 +645,42 @@ struct QSSGRhiParticleData
     QByteArray sortedData;
     QByteArray convertData;
     QList<QSSGRhiSortData> sortData;
+    QList<QSSGRhiSortData> sortScratch;
+    QVector3D sortedCameraDirection;
     int particleCount = 0;
     int serial = -1;
     bool sorting = false;
+
+    // QSSGParticleSimulation, with compute shaders
+    QRhiBuffer *simulationData = nullptr;
+    QRhiBuffer *simulationUniforms = nullptr;
+    QRhiBuffer *sortKeys = nullptr;
+    QRhiBuffer *sortUniforms = nullptr;
+    QRhiShaderResourceBindings *simulationSrb = nullptr;
+    QRhiShaderResourceBindings *sortSrb = nullptr;
+    // QSSGParticleSimulation, without compute shaders
+    QSSGParticleBuffer simulatedBuffer;
+    int simulationSerial = -1;
+    float simulatedTime = -1.0f;
+
+    void releaseSimulation()
+    {
+        delete simulationSrb;
+        delete sortSrb;
+        delete simulationData;
+        delete simulationUniforms;
+        delete sortKeys;
+        delete sortUniforms;
+        simulationSrb = nullptr;
+        sortSrb = nullptr;
+        simulationData = nullptr;
+        simulationUniforms = nullptr;
+        sortKeys = nullptr;
+        sortUniforms = nullptr;
+        simulatedBuffer.resize(0);
+        simulationSerial = -1;
+        simulatedTime = -1.0f;
+    }
 };
 
 class QSSGComputePipelineStateKeyPrivate
@@ -685,10 +820,34 @@ public:
         RenderPassInfo externalRenderPass;
 
         int currentRenderPassIndex = -1;
+
+        // Renderables skipped because they were hidden in the Hi-Z buffer
+        quint64 occlusionCulledObjectCount = 0;
+        quint64 occlusionCulledShadowCasterCount = 0;
+
+        // Per-draw uniform data, see QSSGRhiUniformArena
+        quint64 uniformDataSize = 0;
+        quint64 uniformBufferSize = 0;
     };
     struct GlobalInfo { // global as in per QSSGRhiContext which is per-QQuickWindow
         quint64 meshDataSize = 0;
         quint64 imageDataSize = 0;
+        quint64 peakMeshDataSize = 0;
+        quint64 peakImageDataSize = 0;
+        // Meshes and images released to stay in the QSSGBufferManager memory budget
+        quint64 evictionCount = 0;
+        // Graphics pipeline lookups, a miss means creating a new QRhiGraphicsPipeline
+        quint64 pipelineCacheHitCount = 0;
+        quint64 pipelineCacheMissCount = 0;
+        // Lookups in the other QSSGRhiContext caches, a miss means a new entry
+        quint64 srbCacheHitCount = 0;
+        quint64 srbCacheMissCount = 0;
+        quint64 drawCallDataHitCount = 0;
+        quint64 drawCallDataMissCount = 0;
+        quint64 instanceBufferHitCount = 0;
+        quint64 instanceBufferMissCount = 0;
+        // Cache entries released after going unused for too many frames
+        quint64 cacheEvictionCount = 0;
         qint64 materialGenerationTime = 0;
         qint64 effectGenerationTime = 0;
     };
@@ -724,11 +883,55 @@ public:
     void meshDataSizeChanges(quint64 newSize) // can be called outside start-stop
     {
         globalInfo.meshDataSize = newSize;
+        globalInfo.peakMeshDataSize = qMax(globalInfo.peakMeshDataSize, newSize);
     }
 
     void imageDataSizeChanges(quint64 newSize) // can be called outside start-stop
     {
         globalInfo.imageDataSize = newSize;
+        globalInfo.peakImageDataSize = qMax(globalInfo.peakImageDataSize, newSize);
+    }
+
+    void resourcesEvicted(quint64 count) // can be called outside start-stop
+    {
+        globalInfo.evictionCount += count;
+    }
+
+    void pipelineCacheLookup(bool hit) // can be called outside start-stop
+    {
+        if (hit)
+            ++globalInfo.pipelineCacheHitCount;
+        else
+            ++globalInfo.pipelineCacheMissCount;
+    }
+
+    void srbCacheLookup(bool hit) // can be called outside start-stop
+    {
+        if (hit)
+            ++globalInfo.srbCacheHitCount;
+        else
+            ++globalInfo.srbCacheMissCount;
+    }
+
+    void drawCallDataLookup(bool hit) // can be called outside start-stop
+    {
+        if (hit)
+            ++globalInfo.drawCallDataHitCount;
+        else
+            ++globalInfo.drawCallDataMissCount;
+    }
+
+    void instanceBufferLookup(bool hit) // can be called outside start-stop
+    {
+        if (hit)
+            ++globalInfo.instanceBufferHitCount;
+        else
+            ++globalInfo.instanceBufferMissCount;
+    }
+
+    void cacheEntriesEvicted(quint64 count) // can be called outside start-stop
+    {
+        globalInfo.cacheEvictionCount += count;
     }
 
     void registerMaterialShaderGenerationTime(qint64 ms)
@@ -741,6 +944,22 @@ public:
         globalInfo.effectGenerationTime += ms;
     }
 
+    void occlusionCulledObjects(quint64 count)
+    {
+        perLayerInfo[layerKey].occlusionCulledObjectCount += count;
+    }
+
+    void occlusionCulledShadowCasters(quint64 count)
+    {
+        perLayerInfo[layerKey].occlusionCulledShadowCasterCount += count;
+    }
+
+    void uniformArenaUsage(quint64 usedSize, quint64 capacity)
+    {
+        perLayerInfo[layerKey].uniformDataSize = usedSize;
+        perLayerInfo[layerKey].uniformBufferSize = capacity;
+    }
+
     static quint64 totalDrawCallCountForPass(const QSSGRhiContextStats::RenderPassInfo &pass)
     {
         return pass.draws.callCount
@@ -777,6 +996,7 @@ class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRhiContextPrivate
         : q_ptr(&rhiCtx)
         , m_rhi(rhi_)
         , m_stats(rhiCtx)
+        , m_maxUnusedFrames(defaultMaxUnusedFrames())
     {}
 
 public:
@@ -806,6 +1026,27 @@ public:
 
     QSSGRhiParticleData &particleData(const QSSGRenderGraphObject *particlesOrModel);
 
+    // Entries of the srb, pipeline, draw call data and instance buffer caches
+    // that were not used in the last maxUnusedFrames() frames are released
+    // by releaseUnusedResources(). 0, the default, keeps everything until
+    // releaseCachedResources(). The frames are the ones of the renderer,
+    // which counts every layer it renders, so with several View3Ds in a
+    // window the age advances once per View3D per window frame. Anything
+    // holding on to a cached srb or pipeline across frames without asking
+    // the cache again must drop it at the start of the frame.
+    [[nodiscard]] static quint32 defaultMaxUnusedFrames();
+    quint32 maxUnusedFrames() const { return m_maxUnusedFrames; }
+    void setMaxUnusedFrames(quint32 frames) { m_maxUnusedFrames = frames; }
+    void setCurrentFrame(quint32 frameId) { m_currentFrame = frameId; }
+    void releaseUnusedResources(quint32 frameId);
+
+    template<typename T>
+    struct CachedResource
+    {
+        T *resource = nullptr;
+        quint32 lastUsedFrame = 0;
+    };
+
     QSSGRhiContext *q_ptr = nullptr;
     QRhi *m_rhi = nullptr;
 
@@ -819,14 +1060,17 @@ public:
     QVector<QPair<QSSGRhiSamplerDescription, QRhiSampler*>> m_samplers;
 
     QHash<QSSGRhiDrawCallDataKey, QSSGRhiDrawCallData> m_drawCallData;
-    QHash<QSSGRhiShaderResourceBindingList, QRhiShaderResourceBindings *> m_srbCache;
-    QHash<QSSGGraphicsPipelineStateKeyPrivate, QRhiGraphicsPipeline *> m_pipelines;
+    QHash<QSSGRhiShaderResourceBindingList, CachedResource<QRhiShaderResourceBindings>> m_srbCache;
+    QHash<QSSGGraphicsPipelineStateKeyPrivate, CachedResource<QRhiGraphicsPipeline>> m_pipelines;
     QHash<QSSGComputePipelineStateKeyPrivate, QRhiComputePipeline *> m_computePipelines;
     QHash<QSSGRhiDummyTextureKey, QRhiTexture *> m_dummyTextures;
     QHash<QSSGRenderInstanceTable *, QSSGRhiInstanceBufferData> m_instanceBuffers;
     QHash<const QSSGRenderModel *, QSSGRhiInstanceBufferData> m_instanceBuffersLod;
     QHash<const QSSGRenderGraphObject *, QSSGRhiParticleData> m_particleData;
     QSSGRhiContextStats m_stats;
+    quint32 m_maxUnusedFrames = 0;
+    quint32 m_currentFrame = 0;
+    quint32 m_lastReleaseFrame = 0;
 };
 
 inline bool operator==(const QSSGRhiDrawCallDataKey &a, const QSSGRhiDrawCallDataKey &b) noexcept
@@ -18,6 +18,7 @@
 #include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrhiparticles_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
 #include <qtquick3d_tracepoints_p.h>
 
 #include <QtCore/qbitarray.h>
@@ -61,14 +62,13 @@ QSSGRhiShaderPipelinePtr QSSGCustomMaterialSystem::shadersForCustomMaterial(QSSG
 
     QSSGRhiShaderPipelinePtr shaderPipeline;
 
-    // This just references inFeatureSet and inRenderable.shaderDescription -
-    // cheap to construct and is good enough for the find(). This is the first
+    // Cheap to construct and is good enough for the find(). This is the first
     // level, fast lookup. (equivalent to what
     // QSSGRenderer::getShaderPipelineForDefaultMaterial does for the
     // default/principled material)
-    QSSGShaderMapKey skey = QSSGShaderMapKey(material.m_shaderPathKey,
-                                             featureSet,
-                                             renderable.shaderDescription);
+    const QSSGShaderMapKey skey = QSSGShaderMapKey(material.m_shaderPathKey,
+                                                   featureSet,
+                                                   renderable.shaderDescription);
     auto it = shaderMap.find(skey);
     if (it == shaderMap.end()) {
         // NB this key calculation must replicate exactly what the generator does in generateMaterialRhiShader()
@@ -76,9 +76,17 @@ QSSGRhiShaderPipelinePtr QSSGCustomMaterialSystem::shadersForCustomMaterial(QSSG
         QSSGShaderDefaultMaterialKey matKey(renderable.shaderDescription);
         matKey.toString(shaderString, defaultMaterialShaderKeyProperties);
 
+        // Being compiled on a worker thread, the renderable is skipped until
+        // that is done. When it is, the pipeline is in the runtime cache.
+        const auto &shaderCache = context->shaderCache();
+        if (shaderCache->isCompiling(shaderString, featureSet))
+            return {};
+        shaderPipeline = shaderCache->tryGetRhiShaderPipeline(shaderString, featureSet);
+
         // Try the persistent (disk-based) cache.
         const QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(shaderString, QQsbCollection::toFeatureSet(featureSet));
-        shaderPipeline = context->shaderCache()->tryNewPipelineFromPersistentCache(qsbcKey, material.m_shaderPathKey, featureSet);
+        if (!shaderPipeline)
+            shaderPipeline = shaderCache->tryNewPipelineFromPersistentCache(qsbcKey, material.m_shaderPathKey, featureSet);
 
         if (!shaderPipeline) {
             // Have to generate the shaders and send it all through the shader conditioning pipeline.
@@ -99,10 +107,10 @@ QSSGRhiShaderPipelinePtr QSSGCustomMaterialSystem::shadersForCustomMaterial(QSSG
                                                                                     *context->shaderLibraryManager(),
                                                                                     *context->shaderCache());
             Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DGenerateShader, 0, material.profilingId);
+            if (!shaderPipeline && shaderCache->isCompiling(shaderString, featureSet))
+                return {};
         }
 
-        // make skey useable as a key for the QHash (makes a copy of the materialKey, instead of just referencing)
-        skey.detach();
         // insert it no matter what, no point in trying over and over again
         shaderMap.insert(skey, shaderPipeline);
     } else {
@@ -203,7 +211,13 @@ void QSSGCustomMaterialSystem::rhiPrepareRenderable(QSSGRhiGraphicsPipelineState
 
     const bool blendParticles = defaultMaterialShaderKeyProperties.m_blendParticles.getValue(renderable.shaderDescription);
 
-    const auto &shaderPipeline = shadersForCustomMaterial(ps, material, renderable, defaultMaterialShaderKeyProperties, featureSet);
+    QSSGRhiShaderPipelinePtr shaderPipeline;
+    {
+        const auto &shaderCache = context->shaderCache();
+        const bool async = layerData.layer.shaderCompilationMode == QSSGRenderLayer::ShaderCompilationMode::Asynchronous;
+        QSSGShaderCache::AsynchronousScope asyncScope(*shaderCache, async || shaderCache->asynchronousCompilation());
+        shaderPipeline = shadersForCustomMaterial(ps, material, renderable, defaultMaterialShaderKeyProperties, featureSet);
+    }
 
     if (shaderPipeline) {
         QSSGRhiShaderResourceBindingList bindings;
@@ -222,15 +236,15 @@ void QSSGCustomMaterialSystem::rhiPrepareRenderable(QSSGRhiGraphicsPipelineState
 
         QSSGRhiDrawCallData &dcd = QSSGRhiContextPrivate::get(*rhiCtx).drawCallData({ passKey, &modelNode, entryKey, entryIdx });
 
-        shaderPipeline->ensureCombinedMainLightsUniformBuffer(&dcd.ubuf);
-        char *ubufData = dcd.ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
+        const auto ubuf = layerData.uniformArena.allocate(rhiCtx->rhi(), shaderPipeline->combinedMainLightsUniformBufferSize());
+        if (!ubuf.buffer)
+            return;
         if (!camera)
-            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubufData, ps, material, renderable, *layerData.camera, nullptr, nullptr);
+            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubuf.data, ps, material, renderable, *layerData.camera, nullptr, nullptr);
         else
-            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubufData, ps, material, renderable, *camera, nullptr, modelViewProjection);
+            updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, layerData, ubuf.data, ps, material, renderable, *camera, nullptr, modelViewProjection);
         if (blendParticles)
-            QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubufData, &renderable.modelContext.model, renderable.subset.offset);
-        dcd.ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+            QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubuf.data, &renderable.modelContext.model, renderable.subset.offset);
 
         if (blendParticles)
             QSSGParticleRenderer::prepareParticlesForModel(*shaderPipeline, rhiCtx, bindings, &renderable.modelContext.model);
@@ -269,10 +283,8 @@ void QSSGCustomMaterialSystem::rhiPrepareRenderable(QSSGRhiGraphicsPipelineState
         QRhiTexture *dummyCubeTexture = rhiCtx->dummyTexture(QRhiTexture::CubeMap, resourceUpdates);
         rhiCtx->commandBuffer()->resourceUpdate(resourceUpdates);
 
-        bindings.addUniformBuffer(0, CUSTOM_MATERIAL_VISIBILITY_ALL, dcd.ubuf, 0, shaderPipeline->ub0Size());
-        bindings.addUniformBuffer(1, CUSTOM_MATERIAL_VISIBILITY_ALL, dcd.ubuf,
-                                  shaderPipeline->ub0LightDataOffset(),
-                                  shaderPipeline->ub0LightDataSize());
+        const QSSGRhiUniformOffsets uniformOffsets = layerData.uniformArena.addMainUniformBindings(ubuf, *shaderPipeline, true,
+                                                                                                 CUSTOM_MATERIAL_VISIBILITY_ALL, bindings);
 
         QVector<QShaderDescription::InOutVariable> samplerVars =
                 shaderPipeline->fragmentStage()->shader().description().combinedImageSamplers();
@@ -500,10 +512,13 @@ void QSSGCustomMaterialSystem::rhiPrepareRenderable(QSSGRhiGraphicsPipelineState
             srbChanged = true;
         }
 
-        if (cubeFace == QSSGRenderTextureCubeFaceNone)
+        if (cubeFace == QSSGRenderTextureCubeFaceNone) {
             renderable.rhiRenderData.mainPass.srb = srb;
-        else
+            renderable.rhiRenderData.mainPass.uniformOffsets = uniformOffsets;
+        } else {
             renderable.rhiRenderData.reflectionPass.srb[cubeFaceIdx] = srb;
+            renderable.rhiRenderData.reflectionPass.uniformOffsets[cubeFaceIdx] = uniformOffsets;
+        }
 
         const auto pipelineKey = QSSGGraphicsPipelineStateKeyPrivate::create(*ps, renderPassDescriptor, srb);
         if (dcd.pipeline
@@ -593,11 +608,13 @@ void QSSGCustomMaterialSystem::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
 {
     QRhiGraphicsPipeline *ps = renderable.rhiRenderData.mainPass.pipeline;
     QRhiShaderResourceBindings *srb = renderable.rhiRenderData.mainPass.srb;
+    const QSSGRhiUniformOffsets *uniformOffsets = &renderable.rhiRenderData.mainPass.uniformOffsets;
 
     if (cubeFace != QSSGRenderTextureCubeFaceNone) {
         const auto cubeFaceIdx = QSSGBaseTypeHelpers::indexOfCubeFace(cubeFace);
         ps = renderable.rhiRenderData.reflectionPass.pipeline;
         srb = renderable.rhiRenderData.reflectionPass.srb[cubeFaceIdx];
+        uniformOffsets = &renderable.rhiRenderData.reflectionPass.uniformOffsets[cubeFaceIdx];
     }
 
     if (!ps || !srb)
@@ -609,7 +626,7 @@ void QSSGCustomMaterialSystem::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
 
     QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
     cb->setGraphicsPipeline(ps);
-    cb->setShaderResources(srb);
+    uniformOffsets->setShaderResources(cb, srb);
 
     if (*needsSetViewport) {
         cb->setViewport(state.viewport);
@@ -620,8 +637,8 @@ void QSSGCustomMaterialSystem::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
     int vertexBufferCount = 1;
     vertexBuffers[0] = QRhiCommandBuffer::VertexInput(vertexBuffer, 0);
     quint32 instances = 1;
-    if (renderable.modelContext.model.instancing()) {
-        instances = renderable.modelContext.model.instanceCount();
+    if (renderable.usesInstancing()) {
+        instances = renderable.instanceCount();
         vertexBuffers[1] = QRhiCommandBuffer::VertexInput(renderable.instanceBuffer, 0);
         vertexBufferCount = 2;
     }
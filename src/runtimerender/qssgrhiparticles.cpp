@@ -5,12 +5,17 @@
 #include "qssgrhicontext_p.h"
 
 #include <qfloat16.h>
+#include <QtCore/qmath.h>
+
+#include <limits>
 
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendercamera_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglayerrenderdata_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include "qssgrendercontextcore.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -182,18 +187,59 @@ static void fillTargetBlend(QRhiGraphicsPipeline::TargetBlend &targetBlend, QSSG
     }
 }
 
-static void sortParticles(QByteArray &result, QList<QSSGRhiSortData> &sortData,
-                          const QSSGParticleBuffer &buffer, const QSSGRenderParticles &particles,
-                          const QVector3D &cameraDirection, bool animatedParticles)
+// Sorts by descending depth. The depths are quantized to 16 bits over the
+// range of the particles, which is plenty for the blending order, so two
+// 8-bit counting passes do the job. The sort is stable.
+static void radixSortByDepth(QList<QSSGRhiSortData> &sortData, QList<QSSGRhiSortData> &scratch)
+{
+    const qsizetype count = sortData.size();
+    if (count < 2)
+        return;
+
+    float minD = std::numeric_limits<float>::max();
+    float maxD = std::numeric_limits<float>::lowest();
+    for (const QSSGRhiSortData &data : std::as_const(sortData)) {
+        minD = qMin(minD, data.d);
+        maxD = qMax(maxD, data.d);
+    }
+    if (!(maxD > minD))
+        return;
+
+    const float scale = 65535.0f / (maxD - minD);
+    const auto key = [maxD, scale](const QSSGRhiSortData &data) -> quint32 {
+        return qMin(quint32((maxD - data.d) * scale), 65535u);
+    };
+
+    scratch.resize(count);
+    QSSGRhiSortData *src = sortData.data();
+    QSSGRhiSortData *dst = scratch.data();
+    for (int shift = 0; shift < 16; shift += 8) {
+        qsizetype offsets[256] = {};
+        for (qsizetype i = 0; i < count; ++i)
+            ++offsets[(key(src[i]) >> shift) & 0xff];
+        qsizetype sum = 0;
+        for (qsizetype &offset : offsets) {
+            const qsizetype bucketSize = offset;
+            offset = sum;
+            sum += bucketSize;
+        }
+        for (qsizetype i = 0; i < count; ++i)
+            dst[offsets[(key(src[i]) >> shift) & 0xff]++] = src[i];
+        std::swap(src, dst);
+    }
+    // An even number of passes, the result is back in sortData
+}
+
+static void sortParticles(QSSGRhiParticleData &particleData, const QSSGParticleBuffer &buffer,
+                          const QVector3D &sortDirection, bool animatedParticles)
 {
-    const QMatrix4x4 &invModelMatrix = particles.globalTransform.inverted();
-    QVector3D dir = invModelMatrix.map(cameraDirection);
-    QVector3D n = dir.normalized();
+    QByteArray &result = particleData.sortedData;
+    QList<QSSGRhiSortData> &sortData = particleData.sortData;
+    QVector3D n = sortDirection.normalized();
     const auto segments = buffer.segments();
-    auto particleCount = buffer.particleCount();
     const bool lineParticles = segments > 0;
-    if (lineParticles)
-        particleCount /= segments;
+    // Sprites are packed to the start of the buffer, only the used ones are sorted
+    auto particleCount = lineParticles ? buffer.particleCount() / segments : buffer.usedCount();
     sortData.resize(particleCount);
     sortData.fill({});
 
@@ -252,13 +298,11 @@ static void sortParticles(QByteArray &result, QList<QSSGRhiSortData> &sortData,
     }
 
     // sort
-    result.resize(buffer.bufferSize());
-    std::sort(sortData.begin(), sortData.end(), [](const QSSGRhiSortData &a, const QSSGRhiSortData &b){
-        return a.d > b.d;
-    });
+    result.resize(qsizetype(buffer.usedSliceCount()) * buffer.sliceStride());
+    radixSortByDepth(sortData, particleData.sortScratch);
 
     auto copyParticles = [&](QByteArray &dst, const QList<QSSGRhiSortData> &data, const QSSGParticleBuffer &buffer) {
-        const auto slices = buffer.sliceCount();
+        const auto slices = buffer.usedSliceCount();
         const auto ss = buffer.sliceStride();
         const auto pps = buffer.particlesPerSlice();
         const QSSGRhiSortData *sdata = data.data();
@@ -321,6 +365,259 @@ static QByteArray convertParticleData(QByteArray &dest, const QByteArray &data,
     return dest;
 }
 
+// Uploads the rows holding the used particles, the rest of the texture keeps
+// whatever it had since those particles are not drawn.
+static void uploadParticleData(QSSGRhiContext *rhiCtx, QSSGRhiParticleData &particleData,
+                               const QSSGParticleBuffer &buffer, const QByteArray &data,
+                               bool needsConversion)
+{
+    const int rows = buffer.usedSliceCount();
+    if (rows == 0)
+        return;
+
+    const qsizetype byteCount = qsizetype(rows) * buffer.sliceStride();
+    QRhiTextureSubresourceUploadDescription upload;
+    if (data.size() == byteCount) {
+        upload.setData(convertParticleData(particleData.convertData, data, needsConversion));
+    } else {
+        // The particle buffer is only written during sync, when the previous
+        // frame holding on to the data has already been submitted.
+        const QByteArray usedData = QByteArray::fromRawData(data.constData(), byteCount);
+        upload.setData(convertParticleData(particleData.convertData, usedData, needsConversion));
+    }
+    upload.setSourceSize(QSize(buffer.size().width(), rows));
+
+    QRhiResourceUpdateBatch *rub = rhiCtx->rhi()->nextResourceUpdateBatch();
+    QRhiTextureUploadDescription uploadDesc(QRhiTextureUploadEntry(0, 0, upload));
+    rub->uploadTexture(particleData.texture, uploadDesc);
+    rhiCtx->commandBuffer()->resourceUpdate(rub);
+}
+
+// Returns true if the texture was (re)created
+static bool prepareParticleTexture(QRhi *rhi, QSSGRhiParticleData &particleData, const QSSGParticleBuffer &buffer,
+                                   QRhiTexture::Format format, QRhiTexture::Flags flags)
+{
+    const int particleCount = buffer.particleCount();
+    if (particleData.texture && particleData.particleCount == particleCount
+            && particleData.texture->format() == format && particleData.texture->flags() == flags) {
+        return false;
+    }
+
+    const QSize size(buffer.size());
+    if (!particleData.texture) {
+        particleData.texture = rhi->newTexture(format, size, 1, flags);
+    } else {
+        particleData.texture->setFormat(format);
+        particleData.texture->setPixelSize(size);
+        particleData.texture->setFlags(flags);
+    }
+    particleData.texture->create();
+    particleData.particleCount = particleCount;
+    return true;
+}
+
+static bool useComputeSimulation(QRhi *rhi)
+{
+    static const bool disabled = qEnvironmentVariableIntValue("QT_QUICK3D_DISABLE_PARTICLE_COMPUTE");
+    return !disabled && rhi->isFeatureSupported(QRhi::Compute)
+            && rhi->isTextureFormatSupported(QRhiTexture::RGBA32F);
+}
+
+static constexpr int SIMULATION_WORKGROUP_SIZE = 256;
+
+// Uniform block of particlesimulate.comp, std140
+struct ParticleSimulationUniforms
+{
+    float affectorVector[QSSGParticleSimulation::MaxAffectors][4];
+    float affectorParams[QSSGParticleSimulation::MaxAffectors][4];
+    float fade[4];
+    float sortDirection[4];
+    float offsetScale[4];
+    float time;
+    qint32 particleCount;
+    qint32 particlesPerSlice;
+    qint32 affectorCount;
+    qint32 sortCount;
+    qint32 pass;
+};
+
+// Uniform block of particlesort.comp, std140
+struct ParticleSortUniforms
+{
+    quint32 k;
+    quint32 j;
+};
+
+// Returns true if the buffer was (re)created
+static bool prepareSimulationBuffer(QRhi *rhi, QRhiBuffer *&buffer, QRhiBuffer::Type type,
+                                    QRhiBuffer::UsageFlags usage, quint32 size)
+{
+    if (buffer && buffer->size() >= size)
+        return false;
+    delete buffer;
+    buffer = rhi->newBuffer(type, usage, size);
+    if (!buffer->create())
+        qWarning("Failed to build particle simulation buffer (size %u)", size);
+    return true;
+}
+
+// Records the compute passes evaluating the simulated particles into the
+// particle texture. With depth sorting the sort keys are written first and
+// sorted with a bitonic sort, one dispatch per step, and the particles are
+// then written in the sorted order.
+static void simulateParticles(QSSGRhiContext *rhiCtx,
+                              QSSGRhiParticleData &particleData,
+                              const QSSGRenderParticles &particles,
+                              const QSSGRenderer &renderer,
+                              const QVector3D &sortDirection,
+                              bool textureChanged)
+{
+    QRhi *rhi = rhiCtx->rhi();
+    const QSSGParticleSimulation &simulation = particles.m_simulation;
+    const int particleCount = simulation.particleCount();
+    if (particleCount == 0)
+        return;
+
+    auto &builtInShaders = renderer.contextInterface()->shaderCache()->getBuiltInRhiShaders();
+    const QShader simulateShader = builtInShaders.getRhiParticleSimulateShader();
+    const QShader sortShader = builtInShaders.getRhiParticleSortShader();
+    if (!simulateShader.isValid() || !sortShader.isValid())
+        return;
+
+    const int sortCount = particles.m_depthSorting
+            ? qMax(SIMULATION_WORKGROUP_SIZE, int(qNextPowerOfTwo(quint32(particleCount - 1))))
+            : 0;
+    int sortSteps = 0;
+    for (int k = 2; k <= sortCount; k <<= 1) {
+        for (int j = k >> 1; j > 0; j >>= 1)
+            ++sortSteps;
+    }
+
+    const quint32 simulationBlockSize = rhi->ubufAligned(sizeof(ParticleSimulationUniforms));
+    const quint32 sortBlockSize = rhi->ubufAligned(sizeof(ParticleSortUniforms));
+    const quint32 dataSize = quint32(particleCount * sizeof(QSSGParticleSimulationData));
+    const bool dataChanged = prepareSimulationBuffer(rhi, particleData.simulationData, QRhiBuffer::Static,
+                                                     QRhiBuffer::StorageBuffer, dataSize);
+    bool resourcesChanged = textureChanged || dataChanged;
+    resourcesChanged |= prepareSimulationBuffer(rhi, particleData.simulationUniforms, QRhiBuffer::Dynamic,
+                                                QRhiBuffer::UniformBuffer, 2 * simulationBlockSize);
+    // The keys are bound to the simulation even when not sorting
+    resourcesChanged |= prepareSimulationBuffer(rhi, particleData.sortKeys, QRhiBuffer::Static, QRhiBuffer::StorageBuffer,
+                                                quint32(qMax(sortCount, 1) * 2 * sizeof(quint32)));
+    if (sortSteps > 0) {
+        resourcesChanged |= prepareSimulationBuffer(rhi, particleData.sortUniforms, QRhiBuffer::Dynamic,
+                                                    QRhiBuffer::UniformBuffer, sortSteps * sortBlockSize);
+    }
+
+    if (resourcesChanged || !particleData.simulationSrb || (sortSteps > 0 && !particleData.sortSrb)) {
+        delete particleData.simulationSrb;
+        delete particleData.sortSrb;
+        particleData.sortSrb = nullptr;
+        particleData.simulationSrb = rhi->newShaderResourceBindings();
+        particleData.simulationSrb->setBindings({
+            QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(0, QRhiShaderResourceBinding::ComputeStage,
+                                                                      particleData.simulationUniforms, sizeof(ParticleSimulationUniforms)),
+            QRhiShaderResourceBinding::bufferLoad(1, QRhiShaderResourceBinding::ComputeStage, particleData.simulationData),
+            QRhiShaderResourceBinding::bufferLoadStore(2, QRhiShaderResourceBinding::ComputeStage, particleData.sortKeys),
+            QRhiShaderResourceBinding::imageStore(3, QRhiShaderResourceBinding::ComputeStage, particleData.texture, 0)
+        });
+        particleData.simulationSrb->create();
+        if (particleData.sortUniforms) {
+            particleData.sortSrb = rhi->newShaderResourceBindings();
+            particleData.sortSrb->setBindings({
+                QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(0, QRhiShaderResourceBinding::ComputeStage,
+                                                                          particleData.sortUniforms, sizeof(ParticleSortUniforms)),
+                QRhiShaderResourceBinding::bufferLoadStore(1, QRhiShaderResourceBinding::ComputeStage, particleData.sortKeys)
+            });
+            particleData.sortSrb->create();
+        }
+    }
+
+    QRhiComputePipeline *simulatePipeline = rhiCtx->computePipeline(simulateShader, particleData.simulationSrb);
+    QRhiComputePipeline *sortPipeline = sortSteps > 0 ? rhiCtx->computePipeline(sortShader, particleData.sortSrb) : nullptr;
+    if (!simulatePipeline || (sortSteps > 0 && !sortPipeline))
+        return;
+
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+
+    // Only the particles emitted since the previous sync are uploaded, unless
+    // a sync was missed or the buffer is new.
+    if (dataChanged || simulation.serial != particleData.simulationSerial) {
+        const char *data = simulation.particles.constData();
+        if (dataChanged || simulation.serial != particleData.simulationSerial + 1) {
+            rub->uploadStaticBuffer(particleData.simulationData, 0, dataSize, data);
+        } else {
+            for (const auto &range : simulation.changedRanges) {
+                const quint32 offset = quint32(range.first * sizeof(QSSGParticleSimulationData));
+                const quint32 size = quint32((range.second - range.first) * sizeof(QSSGParticleSimulationData));
+                rub->uploadStaticBuffer(particleData.simulationData, offset, size, data + offset);
+            }
+        }
+        particleData.simulationSerial = simulation.serial;
+    }
+
+    ParticleSimulationUniforms uniforms = {};
+    const int affectorCount = qMin(int(simulation.affectors.size()), QSSGParticleSimulation::MaxAffectors);
+    for (int i = 0; i < affectorCount; ++i) {
+        const QSSGParticleSimulationAffector &affector = simulation.affectors[i];
+        uniforms.affectorVector[i][0] = affector.vector.x();
+        uniforms.affectorVector[i][1] = affector.vector.y();
+        uniforms.affectorVector[i][2] = affector.vector.z();
+        uniforms.affectorVector[i][3] = float(affector.type);
+        uniforms.affectorParams[i][0] = affector.duration;
+        uniforms.affectorParams[i][1] = affector.hideAtEnd ? 1.0f : 0.0f;
+    }
+    uniforms.fade[0] = simulation.fadeInDuration;
+    uniforms.fade[1] = simulation.fadeOutDuration;
+    uniforms.fade[2] = float(simulation.fadeIn);
+    uniforms.fade[3] = float(simulation.fadeOut);
+    const QVector3D n = sortDirection.normalized();
+    uniforms.sortDirection[0] = n.x();
+    uniforms.sortDirection[1] = n.y();
+    uniforms.sortDirection[2] = n.z();
+    uniforms.offsetScale[0] = simulation.offset.x();
+    uniforms.offsetScale[1] = simulation.offset.y();
+    uniforms.offsetScale[2] = simulation.particleScale;
+    uniforms.time = simulation.time;
+    uniforms.particleCount = particleCount;
+    uniforms.particlesPerSlice = particles.m_particleBuffer.particlesPerSlice();
+    uniforms.affectorCount = affectorCount;
+    uniforms.sortCount = sortCount;
+    uniforms.pass = 0;
+    rub->updateDynamicBuffer(particleData.simulationUniforms, 0, sizeof(uniforms), &uniforms);
+    uniforms.pass = 1;
+    rub->updateDynamicBuffer(particleData.simulationUniforms, simulationBlockSize, sizeof(uniforms), &uniforms);
+
+    int step = 0;
+    for (int k = 2; k <= sortCount; k <<= 1) {
+        for (int j = k >> 1; j > 0; j >>= 1) {
+            const ParticleSortUniforms sortUniforms = { quint32(k), quint32(j) };
+            rub->updateDynamicBuffer(particleData.sortUniforms, step++ * sortBlockSize, sizeof(sortUniforms), &sortUniforms);
+        }
+    }
+
+    QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
+    cb->beginComputePass(rub);
+    if (sortSteps > 0) {
+        const QRhiCommandBuffer::DynamicOffset keysPass(0, 0);
+        cb->setComputePipeline(simulatePipeline);
+        cb->setShaderResources(particleData.simulationSrb, 1, &keysPass);
+        cb->dispatch(sortCount / SIMULATION_WORKGROUP_SIZE, 1, 1);
+
+        cb->setComputePipeline(sortPipeline);
+        for (step = 0; step < sortSteps; ++step) {
+            const QRhiCommandBuffer::DynamicOffset sortStep(0, step * sortBlockSize);
+            cb->setShaderResources(particleData.sortSrb, 1, &sortStep);
+            cb->dispatch(sortCount / SIMULATION_WORKGROUP_SIZE, 1, 1);
+        }
+    }
+    const QRhiCommandBuffer::DynamicOffset writePass(0, simulationBlockSize);
+    cb->setComputePipeline(simulatePipeline);
+    cb->setShaderResources(particleData.simulationSrb, 1, &writePass);
+    cb->dispatch((particleCount + SIMULATION_WORKGROUP_SIZE - 1) / SIMULATION_WORKGROUP_SIZE, 1, 1);
+    cb->endComputePass();
+}
+
 void QSSGParticleRenderer::rhiPrepareRenderable(QSSGRhiShaderPipeline &shaderPipeline,
                                                 QSSGPassKey passKey,
                                                 QSSGRhiContext *rhiCtx,
@@ -348,46 +645,68 @@ void QSSGParticleRenderer::rhiPrepareRenderable(QSSGRhiShaderPipeline &shaderPip
     dcd.ubuf->endFullDynamicBufferUpdateForCurrentFrame();
 
     QSSGRhiParticleData &particleData = QSSGRhiContextPrivate::get(*rhiCtx).particleData(&renderable.particles);
-    const QSSGParticleBuffer &particleBuffer = renderable.particles.m_particleBuffer;
-    int particleCount = particleBuffer.particleCount();
-    if (particleData.texture == nullptr || particleData.particleCount != particleCount) {
-        QSize size(particleBuffer.size());
-        if (!particleData.texture) {
-            particleData.texture = rhiCtx->rhi()->newTexture(needsConversion ? QRhiTexture::RGBA16F : QRhiTexture::RGBA32F, size);
-            particleData.texture->create();
-        } else {
-            particleData.texture->setPixelSize(size);
-            particleData.texture->create();
-        }
-        particleData.particleCount = particleCount;
+    const QSSGParticleSimulation &simulation = renderable.particles.m_simulation;
+    const bool computeSimulation = simulation.enabled && useComputeSimulation(rhiCtx->rhi());
+    const bool simulationChanged = simulation.time != particleData.simulatedTime
+            || simulation.serial != particleData.simulationSerial;
+    if (simulation.enabled && !computeSimulation && simulationChanged) {
+        // Without compute shaders the simulation runs here, and the result
+        // takes the same path as the particles written by the particle system.
+        simulation.simulate(particleData.simulatedBuffer);
+        particleData.simulatedTime = simulation.time;
+        particleData.simulationSerial = simulation.serial;
+    }
+    const QSSGParticleBuffer &particleBuffer = (simulation.enabled && !computeSimulation)
+            ? particleData.simulatedBuffer
+            : renderable.particles.m_particleBuffer;
+
+    // The texture persists, it only needs an upload when the particles or
+    // their sort order changed.
+    const bool textureChanged = prepareParticleTexture(rhiCtx->rhi(), particleData, particleBuffer,
+                                                       needsConversion ? QRhiTexture::RGBA16F : QRhiTexture::RGBA32F,
+                                                       computeSimulation ? QRhiTexture::UsedWithLoadStore : QRhiTexture::Flags());
+    bool update = particleBuffer.serial() != particleData.serial || textureChanged;
+    if (!simulation.enabled && particleData.simulationSerial >= 0) {
+        // The serial belonged to the simulated buffer
+        particleData.releaseSimulation();
+        update = true;
     }
 
     bool sortingChanged = particleData.sorting != renderable.particles.m_depthSorting;
     if (sortingChanged && !renderable.particles.m_depthSorting) {
         particleData.sortData.clear();
+        particleData.sortScratch.clear();
         particleData.sortedData.clear();
     }
     particleData.sorting = renderable.particles.m_depthSorting;
+    update |= sortingChanged;
 
-    QByteArray uploadData;
-
+    QVector3D sortDirection;
     if (renderable.particles.m_depthSorting) {
-        bool animatedParticles = renderable.particles.m_featureLevel == QSSGRenderParticles::FeatureLevel::Animated;
-        if (!camera)
-            sortParticles(particleData.sortedData, particleData.sortData, particleBuffer, renderable.particles, inData.cameraData->direction, animatedParticles);
-        else
-            sortParticles(particleData.sortedData, particleData.sortData, particleBuffer, renderable.particles, camera->getScalingCorrectDirection(), animatedParticles);
-        uploadData = convertParticleData(particleData.convertData, particleData.sortedData, needsConversion);
-    } else {
-        uploadData = convertParticleData(particleData.convertData, particleBuffer.data(), needsConversion);
+        const QVector3D cameraDirection = camera ? camera->getScalingCorrectDirection() : inData.cameraData->direction;
+        const QMatrix4x4 &invModelMatrix = renderable.particles.globalTransform.inverted();
+        sortDirection = invModelMatrix.map(cameraDirection);
     }
-
-    QRhiResourceUpdateBatch *rub = rhiCtx->rhi()->nextResourceUpdateBatch();
-    QRhiTextureSubresourceUploadDescription upload;
-    upload.setData(uploadData);
-    QRhiTextureUploadDescription uploadDesc(QRhiTextureUploadEntry(0, 0, upload));
-    rub->uploadTexture(particleData.texture, uploadDesc);
-    rhiCtx->commandBuffer()->resourceUpdate(rub);
+    const bool sortDirectionChanged = renderable.particles.m_depthSorting
+            && sortDirection != particleData.sortedCameraDirection;
+
+    if (computeSimulation) {
+        if (textureChanged || sortingChanged || simulationChanged || sortDirectionChanged) {
+            simulateParticles(rhiCtx, particleData, renderable.particles, *renderable.renderer, sortDirection, textureChanged);
+            particleData.simulatedTime = simulation.time;
+            particleData.sortedCameraDirection = sortDirection;
+        }
+    } else if (renderable.particles.m_depthSorting) {
+        if (update || sortDirectionChanged) {
+            bool animatedParticles = renderable.particles.m_featureLevel == QSSGRenderParticles::FeatureLevel::Animated;
+            sortParticles(particleData, particleBuffer, sortDirection, animatedParticles);
+            particleData.sortedCameraDirection = sortDirection;
+            uploadParticleData(rhiCtx, particleData, particleBuffer, particleData.sortedData, needsConversion);
+        }
+    } else if (update) {
+        uploadParticleData(rhiCtx, particleData, particleBuffer, particleBuffer.data(), needsConversion);
+    }
+    particleData.serial = particleBuffer.serial();
 
     ps->ia.topology = QRhiGraphicsPipeline::TriangleStrip;
     ps->ia.inputLayout = QRhiVertexInputLayout();
@@ -533,30 +852,13 @@ void QSSGParticleRenderer::prepareParticlesForModel(QSSGRhiShaderPipeline &shade
 {
     QSSGRhiParticleData &particleData = QSSGRhiContextPrivate::get(*rhiCtx).particleData(model);
     const QSSGParticleBuffer &particleBuffer = *model->particleBuffer;
-    int particleCount = particleBuffer.particleCount();
     bool update = particleBuffer.serial() != particleData.serial;
     const bool needsConversion = !rhiCtx->rhi()->isTextureFormatSupported(QRhiTexture::RGBA32F);
-    if (particleData.texture == nullptr || particleData.particleCount != particleCount) {
-        QSize size(particleBuffer.size());
-        if (!particleData.texture) {
-            particleData.texture = rhiCtx->rhi()->newTexture(needsConversion ? QRhiTexture::RGBA16F : QRhiTexture::RGBA32F, size);
-            particleData.texture->create();
-        } else {
-            particleData.texture->setPixelSize(size);
-            particleData.texture->create();
-        }
-        particleData.particleCount = particleCount;
-        update = true;
-    }
+    update |= prepareParticleTexture(rhiCtx->rhi(), particleData, particleBuffer,
+                                     needsConversion ? QRhiTexture::RGBA16F : QRhiTexture::RGBA32F, {});
 
-    if (update) {
-        QRhiResourceUpdateBatch *rub = rhiCtx->rhi()->nextResourceUpdateBatch();
-        QRhiTextureSubresourceUploadDescription upload;
-        upload.setData(convertParticleData(particleData.convertData, particleBuffer.data(), needsConversion));
-        QRhiTextureUploadDescription uploadDesc(QRhiTextureUploadEntry(0, 0, upload));
-        rub->uploadTexture(particleData.texture, uploadDesc);
-        rhiCtx->commandBuffer()->resourceUpdate(rub);
-    }
+    if (update)
+        uploadParticleData(rhiCtx, particleData, particleBuffer, particleBuffer.data(), needsConversion);
     particleData.serial = particleBuffer.serial();
     int samplerBinding = shaderPipeline.bindingForTexture("qt_particleTexture");
     if (samplerBinding >= 0) {
@@ -592,6 +894,14 @@ void QSSGParticleRenderer::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
     if (!ps || !srb)
         return;
 
+    const QSSGParticleSimulation &simulation = renderable.particles.m_simulation;
+    const QSSGParticleBuffer &particleBuffer = (simulation.enabled && !useComputeSimulation(rhiCtx->rhi()))
+            ? QSSGRhiContextPrivate::get(*rhiCtx).particleData(&renderable.particles).simulatedBuffer
+            : renderable.particles.m_particleBuffer;
+    const bool lineParticles = renderable.particles.m_featureLevel >= QSSGRenderParticles::FeatureLevel::Line;
+    if (!lineParticles && particleBuffer.usedCount() == 0)
+        return;
+
     Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderCall);
 
     QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
@@ -604,18 +914,20 @@ void QSSGParticleRenderer::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
         cb->setViewport(state.viewport);
         *needsSetViewport = false;
     }
-    if (renderable.particles.m_featureLevel >= QSSGRenderParticles::FeatureLevel::Line) {
+    if (lineParticles) {
         // draw triangle strip with 2 * segmentCount vertices N times
-        int S = renderable.particles.m_particleBuffer.segments();
-        int N = renderable.particles.m_particleBuffer.particleCount() / S;
+        int S = particleBuffer.segments();
+        int N = particleBuffer.particleCount() / S;
         cb->draw(2 * S, N);
         QSSGRHICTX_STAT(rhiCtx, draw(2 * S, N));
         Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DRenderCall, (2 * S | quint64(N) << 32), renderable.particles.profilingId);
     } else {
-        // draw triangle strip with 2 triangles N times
-        cb->draw(4, renderable.particles.m_particleBuffer.particleCount());
-        QSSGRHICTX_STAT(rhiCtx, draw(4, renderable.particles.m_particleBuffer.particleCount()));
-        Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DRenderCall, (4 | quint64(renderable.particles.m_particleBuffer.particleCount()) << 32), renderable.particles.profilingId);
+        // draw triangle strip with 2 triangles N times, the used particles
+        // are at the start of the buffer
+        const int N = particleBuffer.usedCount();
+        cb->draw(4, N);
+        QSSGRHICTX_STAT(rhiCtx, draw(4, N));
+        Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DRenderCall, (4 | quint64(N) << 32), renderable.particles.profilingId);
     }
 }
 
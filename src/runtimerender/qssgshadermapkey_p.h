@@ -20,42 +20,27 @@
 #include <QtQuick3DRuntimeRender/private/qssgrendershaderkeys_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
 
+// The key of the first level caches of the material shaders. The name is
+// only set for custom materials, the rest is the binary material key, so
+// building one for every renderable in every frame is cheap.
 struct QSSGShaderMapKey
 {
     QByteArray m_name;
-    const QSSGShaderFeatures m_featuresOrig;
-    const QSSGShaderDefaultMaterialKey *m_materialKeyOrig;
-    QSSGShaderDefaultMaterialKey m_materialKeyCopy;
+    QSSGShaderMaterialKey m_key;
     size_t m_hashCode;
 
-    void detach()
-    {
-        if (m_materialKeyOrig) {
-            m_materialKeyCopy = *m_materialKeyOrig;
-            m_materialKeyOrig = nullptr;
-        }
-    }
-
     QSSGShaderMapKey(const QByteArray &inName,
                      const QSSGShaderFeatures &inFeatures,
                      const QSSGShaderDefaultMaterialKey &inMaterialKey)
-        : m_name(inName), m_featuresOrig(inFeatures), m_materialKeyOrig(&inMaterialKey)
+        : m_name(inName), m_key(inMaterialKey, inFeatures)
     {
-        m_hashCode = qHash(m_name) ^ qHash(m_featuresOrig) ^ qHash(m_materialKeyOrig->hash());
+        m_hashCode = m_name.isEmpty() ? m_key.m_hashCode : (qHash(m_name) ^ m_key.m_hashCode);
     }
 };
 
 inline bool operator==(const QSSGShaderMapKey &a, const QSSGShaderMapKey &b) Q_DECL_NOTHROW
 {
-    if (a.m_name != b.m_name)
-        return false;
-
-    const QSSGShaderDefaultMaterialKey *keyA = a.m_materialKeyOrig ? a.m_materialKeyOrig : &a.m_materialKeyCopy;
-    const QSSGShaderDefaultMaterialKey *keyB = b.m_materialKeyOrig ? b.m_materialKeyOrig : &b.m_materialKeyCopy;
-    if (!(*keyA == *keyB))
-        return false;
-
-    return (a.m_featuresOrig == b.m_featuresOrig);
+    return a.m_key == b.m_key && a.m_name == b.m_name;
 }
 
 inline size_t qHash(const QSSGShaderMapKey &key, size_t seed)
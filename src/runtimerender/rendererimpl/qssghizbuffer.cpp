@@ -0,0 +1,296 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssghizbuffer_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhiquadrenderer_p.h>
+
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+QSSGHiZBuffer::~QSSGHiZBuffer()
+{
+    releaseResources();
+}
+
+bool QSSGHiZBuffer::isSupported(QRhi *rhi)
+{
+    // The null backend does not rasterize, there would be no depth to read back.
+    return rhi && rhi->backend() != QRhi::Null
+            && rhi->isFeatureSupported(QRhi::TexelFetch)
+            && rhi->isTextureFormatSupported(QRhiTexture::R32F);
+}
+
+QRhiTexture *QSSGHiZBuffer::mainPassDepthTexture(const QSSGRhiContext *rhiCtx)
+{
+    QRhiRenderTarget *rt = rhiCtx->renderTarget();
+    if (!rt || rt->resourceType() != QRhiResource::TextureRenderTarget || rhiCtx->mainPassSampleCount() > 1)
+        return nullptr;
+
+    QRhiTexture *depthTexture = static_cast<QRhiTextureRenderTarget *>(rt)->description().depthTexture();
+    return (depthTexture && depthTexture->sampleCount() <= 1) ? depthTexture : nullptr;
+}
+
+bool QSSGHiZBuffer::prepare(QSSGRhiContext *rhiCtx)
+{
+    m_rhi = rhiCtx->rhi();
+
+    if (m_readbackCompleted) {
+        m_readbackCompleted = false;
+        m_frame = m_readbackFrame;
+        buildLevels();
+    }
+
+    return isValid();
+}
+
+bool QSSGHiZBuffer::prepareChain(QRhi *rhi, const QSize &depthSize)
+{
+    // Depth textures cannot be read back, so there is always at least one
+    // reduction, even for tiny layers.
+    int chainLength = 0;
+    QSize size = depthSize;
+    do {
+        size = QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+        ++chainLength;
+    } while (size.width() > MAX_READBACK_SIZE || size.height() > MAX_READBACK_SIZE);
+
+    if (m_chain.size() < size_t(chainLength))
+        m_chain.resize(chainLength);
+
+    size = depthSize;
+    for (int i = 0; i < chainLength; ++i) {
+        size = QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+        QSSGRhiRenderableTexture &level = m_chain[i];
+        bool needsBuild = false;
+        if (!level.texture) {
+            level.texture = rhi->newTexture(QRhiTexture::R32F, size, 1, QRhiTexture::RenderTarget | QRhiTexture::UsedAsTransferSource);
+            needsBuild = true;
+        } else if (level.texture->pixelSize() != size) {
+            level.texture->setPixelSize(size);
+            needsBuild = true;
+        }
+
+        if (needsBuild) {
+            if (!level.texture->create()) {
+                qWarning("Failed to build Hi-Z texture (size %dx%d)", size.width(), size.height());
+                level.reset();
+                return false;
+            }
+            level.resetRenderTarget();
+            level.rt = rhi->newTextureRenderTarget({ level.texture });
+            level.rt->setName(QByteArrayLiteral("Hi-Z"));
+            level.rpDesc = level.rt->newCompatibleRenderPassDescriptor();
+            level.rt->setRenderPassDescriptor(level.rpDesc);
+            if (!level.rt->create()) {
+                qWarning("Failed to build render target for Hi-Z texture");
+                level.reset();
+                return false;
+            }
+        }
+    }
+
+    m_chainLength = chainLength;
+    return true;
+}
+
+void QSSGHiZBuffer::render(QSSGRhiContext *rhiCtx,
+                           QSSGRenderer &renderer,
+                           const QSSGRhiShaderPipeline &shaderPipeline,
+                           QRhiTexture *depthTexture,
+                           const QRhiViewport &viewport,
+                           const QMatrix4x4 &viewProjection)
+{
+    if (m_readbackPending)
+        return;
+
+    QRhi *rhi = rhiCtx->rhi();
+    m_rhi = rhi;
+    const QSize depthSize = depthTexture->pixelSize();
+    if (!prepareChain(rhi, depthSize))
+        return;
+
+    QRhiSampler *sampler = rhiCtx->sampler({ QRhiSampler::Nearest, QRhiSampler::Nearest, QRhiSampler::None,
+                                             QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge, QRhiSampler::Repeat });
+    renderer.rhiQuadRenderer()->prepareQuad(rhiCtx, nullptr);
+
+    QRhiTexture *source = depthTexture;
+    for (int i = 0; i < m_chainLength; ++i) {
+        const QSSGRhiRenderableTexture &level = m_chain[i];
+        const QSize size = level.texture->pixelSize();
+        QSSGRhiShaderResourceBindingList bindings;
+        bindings.addTexture(0, QRhiShaderResourceBinding::FragmentStage, source, sampler);
+        QRhiShaderResourceBindings *srb = rhiCtx->srb(bindings);
+
+        QSSGRhiGraphicsPipelineState ps;
+        ps.shaderPipeline = &shaderPipeline;
+        ps.viewport = QRhiViewport(0, 0, float(size.width()), float(size.height()));
+        renderer.rhiQuadRenderer()->recordRenderQuadPass(rhiCtx, &ps, srb, level.rt, {});
+        source = level.texture;
+    }
+
+    m_readbackResult = {};
+    m_readbackResult.completed = [this] {
+        m_readbackPending = false;
+        m_readbackCompleted = true;
+    };
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+    rub->readBackTexture({ source }, &m_readbackResult);
+    rhiCtx->commandBuffer()->resourceUpdate(rub);
+    m_readbackPending = true;
+
+    m_readbackFrame.viewProjection = viewProjection;
+    m_readbackFrame.viewport = viewport.viewport();
+    m_readbackFrame.depthSize = depthSize;
+    m_readbackFrame.firstLevelShift = m_chainLength;
+    // Fixed point depth needs a bias of a couple of steps
+    switch (depthTexture->format()) {
+    case QRhiTexture::D16:
+        m_readbackFrame.depthBias = 2.0f / 65535.0f;
+        break;
+    case QRhiTexture::D24:
+    case QRhiTexture::D24S8:
+        m_readbackFrame.depthBias = 2.0f / 16777215.0f;
+        break;
+    default:
+        m_readbackFrame.depthBias = 1.0e-6f;
+        break;
+    }
+    m_readbackFrame.isYUpInFramebuffer = rhi->isYUpInFramebuffer();
+}
+
+void QSSGHiZBuffer::buildLevels()
+{
+    m_levels.clear();
+
+    const QSize size = m_readbackResult.pixelSize;
+    const qsizetype texelCount = qsizetype(size.width()) * size.height();
+    if (m_readbackResult.format != QRhiTexture::R32F || texelCount == 0
+            || m_readbackResult.data.size() < texelCount * qsizetype(sizeof(float))) {
+        return;
+    }
+
+    Level first;
+    first.width = size.width();
+    first.height = size.height();
+    first.depth.resize(texelCount);
+    memcpy(first.depth.data(), m_readbackResult.data.constData(), texelCount * sizeof(float));
+    m_levels.push_back(std::move(first));
+
+    // Same reduction as in hizdownsample.frag, down to a single texel
+    while (m_levels.back().width > 1 || m_levels.back().height > 1) {
+        const Level &src = m_levels.back();
+        Level dst;
+        dst.width = (src.width + 1) / 2;
+        dst.height = (src.height + 1) / 2;
+        dst.depth.resize(size_t(dst.width) * dst.height);
+        for (int y = 0; y < dst.height; ++y) {
+            const int y0 = y * 2;
+            const int y1 = qMin(y0 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                const int x0 = x * 2;
+                const int x1 = qMin(x0 + 1, src.width - 1);
+                dst.depth[size_t(y) * dst.width + x] = qMax(qMax(src.depth[size_t(y0) * src.width + x0], src.depth[size_t(y0) * src.width + x1]),
+                                                            qMax(src.depth[size_t(y1) * src.width + x0], src.depth[size_t(y1) * src.width + x1]));
+            }
+        }
+        m_levels.push_back(std::move(dst));
+    }
+}
+
+bool QSSGHiZBuffer::isOccluded(const QSSGBounds3 &bounds) const
+{
+    if (m_levels.empty() || bounds.isEmpty())
+        return false;
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float minZ = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    for (int i = 0; i < 8; ++i) {
+        const QVector4D corner((i & 1) ? bounds.maximum.x() : bounds.minimum.x(),
+                               (i & 2) ? bounds.maximum.y() : bounds.minimum.y(),
+                               (i & 4) ? bounds.maximum.z() : bounds.minimum.z(),
+                               1.0f);
+        const QVector4D clipPos = m_frame.viewProjection.map(corner);
+        if (clipPos.w() <= std::numeric_limits<float>::epsilon())
+            return false;
+        const float invW = 1.0f / clipPos.w();
+        const float x = clipPos.x() * invW;
+        const float y = clipPos.y() * invW;
+        minX = qMin(minX, x);
+        maxX = qMax(maxX, x);
+        minY = qMin(minY, y);
+        maxY = qMax(maxY, y);
+        minZ = qMin(minZ, clipPos.z() * invW);
+    }
+
+    // The projection matrices are OpenGL style, [-1, 1] in z maps to [0, 1]
+    // in the depth buffer on every backend.
+    const float minDepth = minZ * 0.5f + 0.5f;
+    if (minDepth <= 0.0f)
+        return false;
+
+    // Viewport coordinates have their origin in the bottom left corner
+    const auto &viewport = m_frame.viewport;
+    const float width = float(m_frame.depthSize.width());
+    const float height = float(m_frame.depthSize.height());
+    const float left = viewport[0] + (minX * 0.5f + 0.5f) * viewport[2];
+    const float right = viewport[0] + (maxX * 0.5f + 0.5f) * viewport[2];
+    float bottom = viewport[1] + (minY * 0.5f + 0.5f) * viewport[3];
+    float top = viewport[1] + (maxY * 0.5f + 0.5f) * viewport[3];
+    if (!m_frame.isYUpInFramebuffer) {
+        const float flippedBottom = height - top;
+        top = height - bottom;
+        bottom = flippedBottom;
+    }
+
+    // Whatever was outside of the frame may well be visible by now
+    if (left < 0.0f || bottom < 0.0f || right > width || top > height)
+        return false;
+
+    const int x0 = int(left);
+    const int y0 = int(bottom);
+    const int x1 = qMax(x0, int(std::ceil(right)) - 1);
+    const int y1 = qMax(y0, int(std::ceil(top)) - 1);
+
+    // Pick the level where the rectangle covers at most 2x2 texels
+    int level = 0;
+    int shift = m_frame.firstLevelShift;
+    while (level + 1 < int(m_levels.size()) && ((x1 >> shift) - (x0 >> shift) > 1 || (y1 >> shift) - (y0 >> shift) > 1)) {
+        ++level;
+        ++shift;
+    }
+
+    const Level &hiZ = m_levels[level];
+    const int tx1 = qMin(x1 >> shift, hiZ.width - 1);
+    const int ty1 = qMin(y1 >> shift, hiZ.height - 1);
+    float maxDepth = 0.0f;
+    for (int ty = (y0 >> shift); ty <= ty1; ++ty) {
+        for (int tx = (x0 >> shift); tx <= tx1; ++tx)
+            maxDepth = qMax(maxDepth, hiZ.depth[size_t(ty) * hiZ.width + tx]);
+    }
+
+    return minDepth > maxDepth + m_frame.depthBias;
+}
+
+void QSSGHiZBuffer::releaseResources()
+{
+    // QRhi holds on to m_readbackResult until the readback completes
+    if (m_readbackPending && m_rhi)
+        m_rhi->finish();
+
+    m_readbackPending = false;
+    m_readbackCompleted = false;
+    for (auto &level : m_chain)
+        level.reset();
+    m_chain.clear();
+    m_chainLength = 0;
+    m_levels.clear();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,115 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGHIZBUFFER_P_H
+#define QSSGHIZBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <QtGui/qmatrix4x4.h>
+
+#include <array>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QSSGRenderer;
+
+// Hierarchical depth buffer for occlusion culling. The depth of the opaque
+// objects is reduced on the GPU to a small chain of R32F textures
+// holding the farthest depth of each block, the last one is read back, and
+// the rest of the pyramid is built on the CPU.
+//
+// There is no GPU-driven draw submission to feed the results into, so the
+// tests are done on the CPU against the latest completed readback. That is
+// one or more frames behind, which is why the view projection matrix of the
+// frame the depth belongs to is kept with it: bounds are projected the same
+// way the occluders were.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGHiZBuffer
+{
+public:
+    QSSGHiZBuffer() = default;
+    ~QSSGHiZBuffer();
+
+    Q_DISABLE_COPY_MOVE(QSSGHiZBuffer)
+
+    static bool isSupported(QRhi *rhi);
+
+    // The depth texture of the main render target, nullptr when the depth
+    // is not sampleable (renderbuffer, multisampled, swapchain).
+    static QRhiTexture *mainPassDepthTexture(const QSSGRhiContext *rhiCtx);
+
+    // Picks up the data of a completed readback. Returns false if there's
+    // nothing to test against (yet).
+    bool prepare(QSSGRhiContext *rhiCtx);
+
+    // Records the reduction of depthTexture and the readback of the result.
+    // Skipped while the previous readback is still in flight.
+    void render(QSSGRhiContext *rhiCtx,
+                QSSGRenderer &renderer,
+                const QSSGRhiShaderPipeline &shaderPipeline,
+                QRhiTexture *depthTexture,
+                const QRhiViewport &viewport,
+                const QMatrix4x4 &viewProjection);
+
+    void releaseResources();
+
+    [[nodiscard]] bool isValid() const { return !m_levels.empty(); }
+
+    // True when the bounds are certainly behind the depth of the last read
+    // back frame. Bounds crossing the near plane are never occluded.
+    [[nodiscard]] bool isOccluded(const QSSGBounds3 &bounds) const;
+
+private:
+    // The reduction stops once both dimensions are at or below this.
+    static constexpr int MAX_READBACK_SIZE = 128;
+
+    struct Level
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth;
+    };
+
+    // What is needed to map world space onto the read back data
+    struct FrameInfo
+    {
+        QMatrix4x4 viewProjection;
+        std::array<float, 4> viewport {};
+        QSize depthSize;
+        int firstLevelShift = 0; // log2 of the pixels covered by the read back texels
+        float depthBias = 0.0f;
+        bool isYUpInFramebuffer = true;
+    };
+
+    bool prepareChain(QRhi *rhi, const QSize &depthSize);
+    void buildLevels();
+
+    QRhi *m_rhi = nullptr;
+    std::vector<QSSGRhiRenderableTexture> m_chain;
+    int m_chainLength = 0;
+    QRhiReadbackResult m_readbackResult;
+    FrameInfo m_readbackFrame;
+    bool m_readbackPending = false;
+    bool m_readbackCompleted = false;
+
+    FrameInfo m_frame;
+    std::vector<Level> m_levels;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGHIZBUFFER_P_H
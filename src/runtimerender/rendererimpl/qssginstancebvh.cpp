@@ -0,0 +1,226 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssginstancebvh_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderinstancetable_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DUtils/private/qssgassert_p.h>
+
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+static float halfSurfaceArea(const QSSGBounds3 &bounds)
+{
+    if (bounds.isEmpty())
+        return 0.0f;
+    const QVector3D d = bounds.dimensions();
+    return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+}
+
+std::shared_ptr<const QSSGInstanceBVH> QSSGInstanceBVH::forModel(const QSSGRenderModel &model, const QSSGBounds3 &meshBounds)
+{
+    QSSG_ASSERT(model.instanceTable, return nullptr);
+
+    const auto current = std::atomic_load(&model.instancePickingBVH);
+    if (current && current->isUpToDate(*model.instanceTable, model.localInstanceTransform, meshBounds))
+        return current;
+
+    // A published tree may be in use by another thread or a snapshot, so it
+    // is replaced, never changed in place. A copy is still cheaper than a rebuild.
+    auto bvh = current ? std::make_shared<QSSGInstanceBVH>(*current) : std::make_shared<QSSGInstanceBVH>();
+    bvh->update(*model.instanceTable, model.localInstanceTransform, meshBounds);
+    std::shared_ptr<const QSSGInstanceBVH> result = std::move(bvh);
+    std::atomic_store(&model.instancePickingBVH, result);
+    return result;
+}
+
+bool QSSGInstanceBVH::isUpToDate(const QSSGRenderInstanceTable &table,
+                                 const QMatrix4x4 &localInstanceTransform,
+                                 const QSSGBounds3 &meshBounds) const
+{
+    return m_table == &table && m_serial == table.serial() && m_count == table.count()
+            && m_localInstanceTransform == localInstanceTransform
+            && m_meshBounds.minimum == meshBounds.minimum && m_meshBounds.maximum == meshBounds.maximum;
+}
+
+void QSSGInstanceBVH::update(const QSSGRenderInstanceTable &table,
+                             const QMatrix4x4 &localInstanceTransform,
+                             const QSSGBounds3 &meshBounds)
+{
+    if (isUpToDate(table, localInstanceTransform, meshBounds))
+        return;
+
+    const bool sameInstances = m_table == &table && m_count == table.count()
+            && m_localInstanceTransform == localInstanceTransform
+            && m_meshBounds.minimum == meshBounds.minimum && m_meshBounds.maximum == meshBounds.maximum;
+
+    m_table = &table;
+    m_serial = table.serial();
+    m_count = table.count();
+    m_tableData = table.data();
+    m_tableStride = table.stride();
+    m_localInstanceTransform = localInstanceTransform;
+    m_meshBounds = meshBounds;
+
+    // Only the data changed, the old tree is still a good start
+    if (sameInstances && !m_nodes.empty()) {
+        refit();
+        if (halfSurfaceArea(m_nodes.front().bounds) <= MAX_REFIT_GROWTH * m_builtRootArea)
+            return;
+    }
+
+    rebuild(m_count);
+}
+
+void QSSGInstanceBVH::clear()
+{
+    m_nodes.clear();
+    m_instances.clear();
+    m_table = nullptr;
+    m_tableData.clear();
+    m_serial = -1;
+    m_count = -1;
+}
+
+QMatrix4x4 QSSGInstanceBVH::instanceTransform(qint32 index) const
+{
+    Q_ASSERT(index >= 0 && qsizetype(index + 1) * m_tableStride <= m_tableData.size());
+    auto *entry = reinterpret_cast<const QSSGRenderInstanceTableEntry *>(m_tableData.constData() + qsizetype(index) * m_tableStride);
+
+    QMatrix4x4 transform;
+    transform.setRow(0, entry->row0);
+    transform.setRow(1, entry->row1);
+    transform.setRow(2, entry->row2);
+    transform.setRow(3, { 0, 0, 0, 1 });
+    return transform * m_localInstanceTransform;
+}
+
+QSSGBounds3 QSSGInstanceBVH::instanceBounds(qint32 index) const
+{
+    QSSGBounds3 bounds = m_meshBounds;
+    bounds.transform(instanceTransform(index));
+    return bounds;
+}
+
+void QSSGInstanceBVH::rebuild(int count)
+{
+    m_nodes.clear();
+    m_instances.clear();
+    m_builtRootArea = 0.0f;
+
+    // The table can hold fewer instances than its count says
+    if (m_tableStride > 0)
+        count = qMin(count, int(m_tableData.size() / m_tableStride));
+    if (count <= 0 || m_meshBounds.isEmpty())
+        return;
+
+    m_instances.resize(size_t(count));
+    for (qint32 i = 0; i < count; ++i) {
+        Instance &instance = m_instances[i];
+        instance.index = i;
+        instance.bounds = instanceBounds(i);
+        instance.center = instance.bounds.center();
+    }
+
+    m_nodes.reserve(2 * (m_instances.size() / MAX_INSTANCES_PER_LEAF) + 1);
+    m_nodes.emplace_back();
+    buildNode(0, 0, quint32(count));
+    m_builtRootArea = halfSurfaceArea(m_nodes.front().bounds);
+}
+
+void QSSGInstanceBVH::buildNode(quint32 nodeIndex, quint32 first, quint32 count)
+{
+    QSSGBounds3 bounds;
+    QSSGBounds3 centers;
+    for (quint32 i = first, end = first + count; i != end; ++i) {
+        bounds.include(m_instances[i].bounds);
+        centers.include(m_instances[i].center);
+    }
+
+    {
+        Node &node = m_nodes[nodeIndex];
+        node.bounds = bounds;
+        node.first = first;
+        node.count = count;
+    }
+
+    if (count <= MAX_INSTANCES_PER_LEAF)
+        return;
+
+    const QVector3D dimensions = centers.dimensions();
+    int axis = 0;
+    if (dimensions.y() > dimensions[axis])
+        axis = 1;
+    if (dimensions.z() > dimensions[axis])
+        axis = 2;
+
+    const quint32 half = count / 2;
+    const auto begin = m_instances.begin() + first;
+    std::nth_element(begin, begin + half, begin + count, [axis](const Instance &lhs, const Instance &rhs) {
+        return lhs.center[axis] < rhs.center[axis];
+    });
+
+    const quint32 left = quint32(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[nodeIndex].left = left;
+
+    buildNode(left, first, half);
+    buildNode(left + 1, first + half, count - half);
+}
+
+void QSSGInstanceBVH::refit()
+{
+    for (Instance &instance : m_instances) {
+        instance.bounds = instanceBounds(instance.index);
+        instance.center = instance.bounds.center();
+    }
+
+    // Children are always after their parent
+    for (auto it = m_nodes.rbegin(), end = m_nodes.rend(); it != end; ++it) {
+        Node &node = *it;
+        node.bounds.setEmpty();
+        if (node.left == 0) {
+            for (quint32 i = node.first, last = node.first + node.count; i != last; ++i)
+                node.bounds.include(m_instances[i].bounds);
+        } else {
+            node.bounds.include(m_nodes[node.left].bounds);
+            node.bounds.include(m_nodes[node.left + 1].bounds);
+        }
+    }
+}
+
+void QSSGInstanceBVH::intersectRay(const QSSGRenderRay::RayData &rayData, QVector<qint32> &result) const
+{
+    if (m_nodes.empty())
+        return;
+
+    const qsizetype firstResult = result.size();
+    QVarLengthArray<quint32, 64> stack;
+    stack.push_back(0);
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes[stack.last()];
+        stack.removeLast();
+        if (!QSSGRenderRay::intersectWithAABBv2(rayData, node.bounds).intersects())
+            continue;
+
+        if (node.left == 0) {
+            for (quint32 i = node.first, end = node.first + node.count; i != end; ++i) {
+                if (QSSGRenderRay::intersectWithAABBv2(rayData, m_instances[i].bounds).intersects())
+                    result.append(m_instances[i].index);
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.left + 1);
+        }
+    }
+
+    // Keep the order of the instance table
+    std::sort(result.begin() + firstResult, result.end());
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,109 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGINSTANCEBVH_P_H
+#define QSSGINSTANCEBVH_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderray_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <QtGui/qmatrix4x4.h>
+#include <QtCore/qvector.h>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+struct QSSGRenderInstanceTable;
+struct QSSGRenderModel;
+
+// Bounding volume hierarchy over the instances of an instanced model. It is
+// the top level when picking instanced models: only the instances with
+// bounds hit by the ray are tested against the mesh and its BVH.
+//
+// The bounds are in the space of the instance table, before the model's
+// globalInstanceTransform, so moving the model does not touch the tree. If
+// the table data changes but the instance count doesn't, the tree is
+// refitted, otherwise it is rebuilt.
+//
+// The tree keeps a (shared) copy of the instance data, so a tree that is up
+// to date can be used from any thread, see QSSGPickSnapshot.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGInstanceBVH
+{
+public:
+    // The up to date tree of the model, safe to call from any thread. A tree
+    // is never changed once it is published in the model: when it needs
+    // updating, the model gets a new one.
+    static std::shared_ptr<const QSSGInstanceBVH> forModel(const QSSGRenderModel &model, const QSSGBounds3 &meshBounds);
+
+    [[nodiscard]] bool isUpToDate(const QSSGRenderInstanceTable &table,
+                                  const QMatrix4x4 &localInstanceTransform,
+                                  const QSSGBounds3 &meshBounds) const;
+    void update(const QSSGRenderInstanceTable &table,
+                const QMatrix4x4 &localInstanceTransform,
+                const QSSGBounds3 &meshBounds);
+    void clear();
+
+    [[nodiscard]] qsizetype instanceCount() const { return qsizetype(m_instances.size()); }
+    // Bounds of all the instances, in the space of the instance table
+    [[nodiscard]] QSSGBounds3 bounds() const { return m_nodes.empty() ? QSSGBounds3() : m_nodes.front().bounds; }
+    // The instance's transform from the table combined with the local instance transform
+    [[nodiscard]] QMatrix4x4 instanceTransform(qint32 index) const;
+
+    // Appends the instances with bounds hit by the ray, in ascending order.
+    // The ray data must be created with the model's globalInstanceTransform.
+    void intersectRay(const QSSGRenderRay::RayData &rayData, QVector<qint32> &result) const;
+
+private:
+    static constexpr quint32 MAX_INSTANCES_PER_LEAF = 4;
+    // Rebuild instead of refitting when the refitted root grows past this
+    static constexpr float MAX_REFIT_GROWTH = 2.0f;
+
+    struct Node
+    {
+        QSSGBounds3 bounds;
+        quint32 left = 0; // Right child is left + 1, 0 for leaves (the root is never a child)
+        quint32 first = 0; // The instances of a subtree are always consecutive
+        quint32 count = 0;
+    };
+
+    struct Instance
+    {
+        QSSGBounds3 bounds;
+        QVector3D center;
+        qint32 index = -1;
+    };
+
+    void rebuild(int count);
+    void buildNode(quint32 nodeIndex, quint32 first, quint32 count);
+    void refit();
+    QSSGBounds3 instanceBounds(qint32 index) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<Instance> m_instances;
+    const QSSGRenderInstanceTable *m_table = nullptr;
+    QByteArray m_tableData;
+    int m_tableStride = 0;
+    int m_serial = -1;
+    int m_count = -1;
+    QMatrix4x4 m_localInstanceTransform;
+    QSSGBounds3 m_meshBounds;
+    float m_builtRootArea = 0.0f;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGINSTANCEBVH_P_H
@@ -23,6 +23,7 @@
 #include <QtQuick3DRuntimeRender/private/qssgruntimerenderlogging_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglightmapper_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgdebugdrawsystem_p.h>
+#include <QtQuick3DRuntimeRender/private/qssginstancebvh_p.h>
 
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 #include <QtQuick3DUtils/private/qssgassert_p.h>
@@ -32,7 +33,11 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QBitArray>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 #include <array>
+#include <limits>
 
 #include "qssgrenderpass_p.h"
 
@@ -76,45 +81,186 @@ static const QVector2D s_ProgressiveAAVertexOffsets[QSSGLayerRenderData::MAX_AA_
     QVector2D(0.235760f, 0.527760f), // 8x
 };
 
+// Gathers the world space bounds into a structure of arrays, so the frustum
+// test can run on several boxes at once, and returns the (ascending) indices
+// of the visible renderables. The buffers are kept around to avoid
+// reallocating them every frame.
+static const QVector<quint32> &frustumCullingIndices(const QSSGClippingFrustum &clipFrustum, const QSSGRenderableObjectList &renderables)
+{
+    static thread_local QSSGBoundsList bounds;
+    static thread_local QVector<quint32> visibleIndices;
+
+    bounds.clear();
+    bounds.reserve(renderables.size());
+    for (const auto &handle : renderables)
+        bounds.append(handle.obj->globalBounds);
+
+    visibleIndices.resize(renderables.size());
+    visibleIndices.resize(clipFrustum.intersectsWith(bounds, visibleIndices.data()));
+
+    return visibleIndices;
+}
+
 qsizetype QSSGLayerRenderData::frustumCulling(const QSSGClippingFrustum &clipFrustum, const QSSGRenderableObjectList &renderables, QSSGRenderableObjectList &visibleRenderables)
 {
     QSSG_ASSERT(visibleRenderables.isEmpty(), visibleRenderables.clear());
-    visibleRenderables.reserve(renderables.size());
-    for (quint32 end = renderables.size(), idx = quint32(0); idx != end; ++idx) {
-        auto handle = renderables.at(idx);
-        const auto &b = handle.obj->globalBounds;
-        if (clipFrustum.intersectsWith(b))
-            visibleRenderables.push_back(handle);
-    }
+    const auto &visibleIndices = frustumCullingIndices(clipFrustum, renderables);
+    visibleRenderables.reserve(visibleIndices.size());
+    for (const quint32 idx : visibleIndices)
+        visibleRenderables.push_back(renderables.at(idx));
 
     return visibleRenderables.size();
 }
 
 qsizetype QSSGLayerRenderData::frustumCullingInline(const QSSGClippingFrustum &clipFrustum, QSSGRenderableObjectList &renderables)
 {
-    const qint32 end = renderables.size();
-    qint32 front = 0;
-    qint32 back = end - 1;
+    // Move the visible renderables to the front, keeping their order. The
+    // indices are ascending, so visibleIndices[i] >= i.
+    const auto &visibleIndices = frustumCullingIndices(clipFrustum, renderables);
+    for (qsizetype i = 0, end = visibleIndices.size(); i != end; ++i) {
+        if (visibleIndices.at(i) != quint32(i))
+            renderables.swapItemsAt(i, visibleIndices.at(i));
+    }
 
-    while (front <= back) {
-        const auto &b = renderables.at(front).obj->globalBounds;
-        if (clipFrustum.intersectsWith(b))
-            ++front;
-        else
-            renderables.swapItemsAt(front, back--);
+    return visibleIndices.size();
+}
+
+static bool isSameFrustum(const QSSGClippingFrustum &a, const QSSGClippingFrustum &b)
+{
+    for (int idx = 0; idx < 6; ++idx) {
+        if (a.mPlanes[idx].normal != b.mPlanes[idx].normal || a.mPlanes[idx].d != b.mPlanes[idx].d)
+            return false;
+    }
+    return true;
+}
+
+// Slot of the renderable in renderableBounds, or -1. A batch draws several
+// models, the slot it got is the one of the first of them only.
+static qint32 boundsSlotOf(const QSSGRenderableObject &renderable)
+{
+    if (renderable.boundsSlot < 0 || renderable.type == QSSGRenderableObject::Type::Particles)
+        return -1;
+    return static_cast<const QSSGSubsetRenderable &>(renderable).batch ? -1 : renderable.boundsSlot;
+}
+
+void QSSGLayerRenderData::updateRenderableBounds()
+{
+    // Hand out the slots in model order. Only the models whose slots, mesh
+    // or transform changed get their bounds written by the prepare jobs.
+    renderableBoundsEntries.resize(renderableModels.size());
+    quint32 slot = 0;
+    for (qsizetype i = 0, end = renderableModels.size(); i != end; ++i) {
+        const QSSGRenderableNodeEntry &renderable = renderableModels.at(i);
+        const auto &model = static_cast<const QSSGRenderModel &>(*renderable.node);
+        const quint32 slotCount = renderable.mesh ? quint32(renderable.mesh->subsets.size()) : 0;
+        RenderableBoundsEntry &entry = renderableBoundsEntries[i];
+        // Particle and custom geometry bounds change without the node knowing
+        entry.dirty = entry.node != renderable.node
+                || entry.mesh != renderable.mesh
+                || entry.transformSerial != renderable.node->globalTransformSerial
+                || entry.firstSlot != slot
+                || entry.slotCount != slotCount
+                || model.particleBuffer != nullptr
+                || model.geometry != nullptr;
+        entry.node = renderable.node;
+        entry.mesh = renderable.mesh;
+        entry.transformSerial = renderable.node->globalTransformSerial;
+        entry.firstSlot = slot;
+        entry.slotCount = slotCount;
+        slot += slotCount;
+    }
+    renderableBounds.resize(slot);
+    hasRenderableBoundsVisibility = false;
+}
+
+const QBitArray &QSSGLayerRenderData::cullRenderableBounds(const QSSGClippingFrustum &clipFrustum) const
+{
+    // The opaque and transparent lists are culled with the same frustum
+    if (hasRenderableBoundsVisibility && isSameFrustum(renderableBoundsVisibilityFrustum, clipFrustum))
+        return renderableBoundsVisibility;
+
+    static thread_local QVector<quint32> visibleIndices;
+    const auto cullSlots = [this, &clipFrustum](qsizetype first, qsizetype count) {
+        visibleIndices.resize(count);
+        const qsizetype visibleCount = clipFrustum.intersectsWith(renderableBounds, first, count, visibleIndices.data());
+        for (qsizetype i = 0; i != visibleCount; ++i)
+            renderableBoundsVisibility.setBit(first + visibleIndices.at(i));
+    };
+
+    renderableBoundsVisibility.fill(false, renderableBounds.size());
+    if (sceneBVH.isValid() && sceneBVH.primitiveCount() > 0) {
+        // The subsets' bounds are contained in their model's bounds, so the
+        // result for the model holds for all of its subsets, unless the
+        // model crosses one of the planes. The slots of consecutive crossing
+        // models are tested together.
+        using Visibility = QSSGSceneBVH::Visibility;
+        static thread_local QVector<Visibility> primitiveVisibility;
+        sceneBVH.cullFrustum(clipFrustum, primitiveVisibility);
+
+        qsizetype runFirst = 0;
+        qsizetype runCount = 0;
+        for (const RenderableBoundsEntry &entry : renderableBoundsEntries) {
+            if (entry.slotCount == 0)
+                continue;
+            const qint32 primitive = sceneBVH.primitiveIndex(*entry.node);
+            const Visibility visibility = (primitive >= 0) ? primitiveVisibility.at(primitive) : Visibility::Intersecting;
+            if (visibility == Visibility::Intersecting) {
+                if (runCount == 0)
+                    runFirst = entry.firstSlot;
+                runCount += entry.slotCount;
+                continue;
+            }
+            if (runCount > 0) {
+                cullSlots(runFirst, runCount);
+                runCount = 0;
+            }
+            if (visibility == Visibility::Inside)
+                renderableBoundsVisibility.fill(true, entry.firstSlot, entry.firstSlot + entry.slotCount);
+        }
+        if (runCount > 0)
+            cullSlots(runFirst, runCount);
+    } else {
+        cullSlots(0, renderableBounds.size());
     }
 
-    return back + 1;
+    renderableBoundsVisibilityFrustum = clipFrustum;
+    hasRenderableBoundsVisibility = true;
+    return renderableBoundsVisibility;
 }
 
-[[nodiscard]] constexpr static inline bool nearestToFurthestCompare(const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) noexcept
+qsizetype QSSGLayerRenderData::sceneFrustumCulling(const QSSGClippingFrustum &clipFrustum, const QSSGRenderableObjectList &renderables, QSSGRenderableObjectList &visibleRenderables) const
 {
-    return lhs.cameraDistanceSq < rhs.cameraDistanceSq;
+    QSSG_ASSERT(visibleRenderables.isEmpty(), visibleRenderables.clear());
+
+    // Renderables without a slot (particles, batches, models prepared by
+    // extensions) are few, those are tested on their own.
+    const QBitArray &slotVisibility = cullRenderableBounds(clipFrustum);
+    visibleRenderables.reserve(renderables.size());
+    for (const auto &handle : renderables) {
+        const qint32 slot = boundsSlotOf(*handle.obj);
+        const bool visible = (slot >= 0) ? slotVisibility.testBit(slot) : clipFrustum.intersectsWith(handle.obj->globalBounds);
+        if (visible)
+            visibleRenderables.push_back(handle);
+    }
+
+    return visibleRenderables.size();
 }
 
-[[nodiscard]] constexpr static inline bool furthestToNearestCompare(const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) noexcept
+qsizetype QSSGLayerRenderData::occlusionCullingInline(QSSGRenderableObjectList &renderables) const
 {
-    return lhs.cameraDistanceSq > rhs.cameraDistanceSq;
+    if (!hiZBuffer.isValid() || !sceneBVH.isValid())
+        return 0;
+
+    // Only static models are tested, the bounds of anything else may not be
+    // where the renderer thinks they are (skinning, instancing, etc.)
+    return renderables.removeIf([this](const QSSGRenderableObjectHandle &handle) {
+        return sceneBVH.primitiveIndex(*handle.obj) >= 0 && hiZBuffer.isOccluded(handle.obj->globalBounds);
+    });
+}
+
+[[nodiscard]] constexpr static inline bool nearestToFurthestCompare(const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) noexcept
+{
+    return lhs.cameraDistanceSq < rhs.cameraDistanceSq;
 }
 
 static void collectBoneTransforms(QSSGRenderNode *node, QSSGRenderSkeleton *skeletonNode, const QVector<QMatrix4x4> &poses)
@@ -210,12 +356,13 @@ static bool maybeQueueNodeForRender(QSSGRenderNode &inNode,
         ++ioDFSIndex;
         inNode.dfsIndex = ioDFSIndex;
         if (QSSGRenderGraphObject::isRenderable(inNode.type)) {
-            if (inNode.type == QSSGRenderNode::Type::Model)
+            if (inNode.type == QSSGRenderNode::Type::Model) {
                 collectNode(QSSGRenderableNodeEntry(inNode), outRenderableModels, ioRenderableModelsCount);
-            else if (inNode.type == QSSGRenderNode::Type::Particles)
+            } else if (inNode.type == QSSGRenderNode::Type::Particles) {
                 collectNode(QSSGRenderableNodeEntry(inNode), outRenderableParticles, ioRenderableParticlesCount);
-            else if (inNode.type == QSSGRenderNode::Type::Item2D) // Pushing front to keep item order inside QML file
+            } else if (inNode.type == QSSGRenderNode::Type::Item2D) { // Pushing front to keep item order inside QML file
                 collectNodeFront(static_cast<QSSGRenderItem2D *>(&inNode), outRenderableItem2Ds, ioRenderableItem2DsCount);
+            }
         } else if (QSSGRenderGraphObject::isCamera(inNode.type)) {
             collectNode(static_cast<QSSGRenderCamera *>(&inNode), outCameras, ioCameraCount);
         } else if (QSSGRenderGraphObject::isLight(inNode.type)) {
@@ -291,6 +438,18 @@ QSSGCameraRenderData QSSGLayerRenderData::getCachedCameraData()
     return QVector3D::dotProduct(difference, camera.direction) + obj.depthBiasSq;
 }
 
+static bool useTemporalSorting()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_QUICK3D_DISABLE_TEMPORAL_SORTING") == 0;
+    return enabled;
+}
+
+static bool defaultRenderableBatching()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_QUICK3D_DISABLE_RENDERABLE_BATCHING") == 0;
+    return enabled;
+}
+
 // Per-frame cache of renderable objects post-sort.
 const QVector<QSSGRenderableObjectHandle> &QSSGLayerRenderData::getSortedOpaqueRenderableObjects()
 {
@@ -299,8 +458,13 @@ const QVector<QSSGRenderableObjectHandle> &QSSGLayerRenderData::getSortedOpaqueR
 
     if (layer.layerFlags.testFlag(QSSGRenderLayer::LayerFlag::EnableDepthTest) && !opaqueObjects.empty()) {
         renderedOpaqueObjects = opaqueObjects;
-        // Render nearest to furthest objects
-        std::sort(renderedOpaqueObjects.begin(), renderedOpaqueObjects.end(), nearestToFurthestCompare);
+        // Render nearest to furthest objects, grouped by pipeline and material
+        renderableSorter.sortOpaque(renderedOpaqueObjects, useTemporalSorting() ? &opaqueSortHistory : nullptr);
+        // Merge the models that differ only in their transform. The order
+        // within the merged draws no longer matters with the depth test.
+        QSSGRenderContextInterface &ctx = *renderer->contextInterface();
+        if (renderableBatchingEnabled && QSSGRenderableBatcher::isSupported(ctx.rhi()))
+            renderableBatcher.batch(renderedOpaqueObjects, defaultMaterialShaderKeyProperties, *perFrameAllocator(ctx));
     }
     return renderedOpaqueObjects;
 }
@@ -318,7 +482,7 @@ const QVector<QSSGRenderableObjectHandle> &QSSGLayerRenderData::getSortedTranspa
 
     if (!renderedTransparentObjects.empty()) {
         // render furthest to nearest.
-        std::sort(renderedTransparentObjects.begin(), renderedTransparentObjects.end(), furthestToNearestCompare);
+        renderableSorter.sortTransparent(renderedTransparentObjects, useTemporalSorting() ? &transparentSortHistory : nullptr);
     }
 
     return renderedTransparentObjects;
@@ -331,7 +495,7 @@ const QVector<QSSGRenderableObjectHandle> &QSSGLayerRenderData::getSortedScreenT
     renderedScreenTextureObjects = screenTextureObjects;
     if (!renderedScreenTextureObjects.empty()) {
         // render furthest to nearest.
-        std::sort(renderedScreenTextureObjects.begin(), renderedScreenTextureObjects.end(), furthestToNearestCompare);
+        renderableSorter.sortTransparent(renderedScreenTextureObjects, useTemporalSorting() ? &screenTextureSortHistory : nullptr);
     }
     return renderedScreenTextureObjects;
 }
@@ -468,10 +632,34 @@ template <typename T>
     return { reinterpret_cast<T *>(QSSGLayerRenderData::perFrameAllocator(ctx)->allocate(asize)), qsizetype(count) };
 }
 
+// Same as above, but for a specific allocator, such as the one owned by a
+// prepareModelsForRender() job.
+template <typename T, typename... Args>
+[[nodiscard]] inline T *RENDER_FRAME_NEW(QSSGPerFrameAllocator &allocator, Args&&... args)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "Objects allocated using the per-frame allocator needs to be trivially destructible!");
+    return new (allocator.allocate(sizeof(T)))T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+[[nodiscard]] inline QSSGDataRef<T> RENDER_FRAME_NEW_BUFFER(QSSGPerFrameAllocator &allocator, size_t count)
+{
+    static_assert(std::is_trivially_destructible_v<T>, "Objects allocated using the per-frame allocator needs to be trivially destructible!");
+    const size_t asize = sizeof(T) * count;
+    return { reinterpret_cast<T *>(allocator.allocate(asize)), qsizetype(count) };
+}
+
 QSSGShaderDefaultMaterialKey QSSGLayerRenderData::generateLightingKey(
         QSSGRenderDefaultMaterial::MaterialLighting inLightingType, const QSSGShaderLightListView &lights, bool receivesShadows)
 {
-    QSSGShaderDefaultMaterialKey theGeneratedKey(qHash(features));
+    return generateLightingKey(features, inLightingType, lights, receivesShadows);
+}
+
+QSSGShaderDefaultMaterialKey QSSGLayerRenderData::generateLightingKey(
+        const QSSGShaderFeatures &seedFeatures, QSSGRenderDefaultMaterial::MaterialLighting inLightingType,
+        const QSSGShaderLightListView &lights, bool receivesShadows)
+{
+    QSSGShaderDefaultMaterialKey theGeneratedKey(qHash(seedFeatures));
     const bool lighting = inLightingType != QSSGRenderDefaultMaterial::MaterialLighting::NoLighting;
     defaultMaterialShaderKeyProperties.m_hasLighting.setValue(theGeneratedKey, lighting);
     if (lighting) {
@@ -501,31 +689,39 @@ QSSGShaderDefaultMaterialKey QSSGLayerRenderData::generateLightingKey(
     return theGeneratedKey;
 }
 
-void QSSGLayerRenderData::prepareImageForRender(QSSGRenderImage &inImage,
-                                                           QSSGRenderableImage::Type inMapType,
-                                                           QSSGRenderableImage *&ioFirstImage,
-                                                           QSSGRenderableImage *&ioNextImage,
-                                                           QSSGRenderableObjectFlags &ioFlags,
-                                                           QSSGShaderDefaultMaterialKey &inShaderKey,
-                                                           quint32 inImageIndex,
-                                                           QSSGRenderDefaultMaterial *inMaterial)
-{
-    QSSGRenderContextInterface &contextInterface = *renderer->contextInterface();
-    const auto &bufferManager = contextInterface.bufferManager();
-
-    if (inImage.clearDirty())
-        ioFlags |= QSSGRenderableObjectFlag::Dirty;
-
-    // This is where the QRhiTexture gets created, if not already done. Note
-    // that the bufferManager is per-QQuickWindow, and so per-render-thread.
-    // Hence using the same Texture (backed by inImage as the backend node) in
-    // multiple windows will work by each scene in each window getting its own
-    // QRhiTexture. And that's why the QSSGRenderImageTexture cannot be a
-    // member of the QSSGRenderImage. Conceptually this matches what we do for
-    // models (QSSGRenderModel -> QSSGRenderMesh retrieved from the
-    // bufferManager in each prepareModelForRender, etc.).
-
-    const QSSGRenderImageTexture texture = bufferManager->loadRenderImage(&inImage);
+void QSSGLayerRenderData::prepareImageForRender(ModelPrepJob &job,
+                                                QSSGRenderImage &inImage,
+                                                QSSGRenderableImage::Type inMapType,
+                                                QSSGRenderableImage *&ioFirstImage,
+                                                QSSGRenderableImage *&ioNextImage,
+                                                QSSGRenderableObjectFlags &ioFlags,
+                                                QSSGShaderDefaultMaterialKey &inShaderKey,
+                                                quint32 inImageIndex,
+                                                QSSGRenderDefaultMaterial *inMaterial)
+{
+    QSSGRenderImageTexture texture;
+    if (job.resources) {
+        // Already loaded (and the dirty flag cleared) on the render thread
+        const auto it = job.resources->images.constFind(&inImage);
+        if (it != job.resources->images.cend()) {
+            texture = it->texture;
+            if (it->dirty)
+                ioFlags |= QSSGRenderableObjectFlag::Dirty;
+        }
+    } else {
+        if (inImage.clearDirty())
+            ioFlags |= QSSGRenderableObjectFlag::Dirty;
+
+        // This is where the QRhiTexture gets created, if not already done. Note
+        // that the bufferManager is per-QQuickWindow, and so per-render-thread.
+        // Hence using the same Texture (backed by inImage as the backend node) in
+        // multiple windows will work by each scene in each window getting its own
+        // QRhiTexture. And that's why the QSSGRenderImageTexture cannot be a
+        // member of the QSSGRenderImage. Conceptually this matches what we do for
+        // models (QSSGRenderModel -> QSSGRenderMesh retrieved from the
+        // bufferManager in each prepareModelForRender, etc.).
+        texture = renderer->contextInterface()->bufferManager()->loadRenderImage(&inImage);
+    }
 
     if (texture.m_texture) {
         if (texture.m_flags.hasTransparency()
@@ -536,7 +732,7 @@ void QSSGLayerRenderData::prepareImageForRender(QSSGRenderImage &inImage,
             ioFlags |= QSSGRenderableObjectFlag::HasTransparency;
         }
 
-        QSSGRenderableImage *theImage = RENDER_FRAME_NEW<QSSGRenderableImage>(contextInterface, inMapType, inImage, texture);
+        QSSGRenderableImage *theImage = RENDER_FRAME_NEW<QSSGRenderableImage>(*job.allocator, inMapType, inImage, texture);
         QSSGShaderKeyImageMap &theKeyProp = defaultMaterialShaderKeyProperties.m_imageMaps[inImageIndex];
 
         theKeyProp.setEnabled(inShaderKey, true);
@@ -673,14 +869,14 @@ void QSSGLayerRenderData::setVertexInputPresence(const QSSGRenderableObjectFlags
 }
 
 QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareDefaultMaterialForRender(
+        ModelPrepJob &job,
         QSSGRenderDefaultMaterial &inMaterial,
         QSSGRenderableObjectFlags &inExistingFlags,
         float inOpacity,
-        const QSSGShaderLightListView &lights,
-        QSSGLayerRenderPreparationResultFlags &ioFlags)
+        const QSSGShaderLightListView &lights)
 {
     QSSGRenderDefaultMaterial *theMaterial = &inMaterial;
-    QSSGDefaultMaterialPreparationResult retval(generateLightingKey(theMaterial->lighting, lights, inExistingFlags.receivesShadows()));
+    QSSGDefaultMaterialPreparationResult retval(generateLightingKey(job.features, theMaterial->lighting, lights, inExistingFlags.receivesShadows()));
     retval.renderableFlags = inExistingFlags;
     QSSGRenderableObjectFlags &renderableFlags(retval.renderableFlags);
     QSSGShaderDefaultMaterialKey &theGeneratedKey(retval.materialKey);
@@ -729,7 +925,7 @@ QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareDefaultMaterial
     defaultMaterialShaderKeyProperties.m_fogEnabled.setValue(theGeneratedKey, layer.fog.enabled);
 
     if (!defaultMaterialShaderKeyProperties.m_hasIbl.getValue(theGeneratedKey) && theMaterial->iblProbe) {
-        features.set(QSSGShaderFeatures::Feature::LightProbe, true);
+        job.features.set(QSSGShaderFeatures::Feature::LightProbe, true);
         defaultMaterialShaderKeyProperties.m_hasIbl.setValue(theGeneratedKey, true);
         // features.set(ShaderFeatureDefines::enableIblFov(),
         // m_Renderer.GetLayerRenderData()->m_Layer.m_ProbeFov < 180.0f );
@@ -779,8 +975,8 @@ QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareDefaultMaterial
         QSSGRenderableImage *nextImage = nullptr;
 #define CHECK_IMAGE_AND_PREPARE(img, imgtype, shadercomponent)                          \
     if ((img))                                                                          \
-        prepareImageForRender(*(img), imgtype, firstImage, nextImage, renderableFlags,  \
-                              theGeneratedKey, shadercomponent, &inMaterial)
+        prepareImageForRender(job, *(img), imgtype, firstImage, nextImage,              \
+                              renderableFlags, theGeneratedKey, shadercomponent, &inMaterial)
 
         if (theMaterial->type == QSSGRenderGraphObject::Type::PrincipledMaterial ||
             theMaterial->type == QSSGRenderGraphObject::Type::SpecularGlossyMaterial) {
@@ -852,8 +1048,8 @@ QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareDefaultMaterial
         renderableFlags |= QSSGRenderableObjectFlag::HasTransparency;
 
     if (inMaterial.isTransmissionEnabled()) {
-        ioFlags.setRequiresScreenTexture(true);
-        ioFlags.setRequiresMipmapsForScreenTexture(true);
+        job.flags.setRequiresScreenTexture(true);
+        job.flags.setRequiresMipmapsForScreenTexture(true);
         renderableFlags |= QSSGRenderableObjectFlag::RequiresScreenTexture;
     }
 
@@ -861,17 +1057,17 @@ QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareDefaultMaterial
     if (retval.renderableFlags.isDirty())
         retval.dirty = true;
     if (retval.dirty)
-        renderer->addMaterialDirtyClear(&inMaterial);
+        job.dirtyMaterials.push_back(&inMaterial);
     return retval;
 }
 
 QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareCustomMaterialForRender(
+        ModelPrepJob &job,
         QSSGRenderCustomMaterial &inMaterial, QSSGRenderableObjectFlags &inExistingFlags,
-        float inOpacity, bool alreadyDirty, const QSSGShaderLightListView &lights,
-        QSSGLayerRenderPreparationResultFlags &ioFlags)
+        float inOpacity, bool alreadyDirty, const QSSGShaderLightListView &lights)
 {
     QSSGDefaultMaterialPreparationResult retval(
-                generateLightingKey(QSSGRenderDefaultMaterial::MaterialLighting::FragmentLighting,
+                generateLightingKey(job.features, QSSGRenderDefaultMaterial::MaterialLighting::FragmentLighting,
                                     lights, inExistingFlags.receivesShadows()));
     retval.renderableFlags = inExistingFlags;
     QSSGRenderableObjectFlags &renderableFlags(retval.renderableFlags);
@@ -934,28 +1130,28 @@ QSSGDefaultMaterialPreparationResult QSSGLayerRenderData::prepareCustomMaterialF
         renderableFlags |= QSSGRenderableObjectFlag::HasTransparency;
 
     if (inMaterial.m_renderFlags.testFlag(QSSGRenderCustomMaterial::RenderFlag::ScreenTexture)) {
-        ioFlags.setRequiresScreenTexture(true);
+        job.flags.setRequiresScreenTexture(true);
         renderableFlags |= QSSGRenderableObjectFlag::RequiresScreenTexture;
     }
 
     if (inMaterial.m_renderFlags.testFlag(QSSGRenderCustomMaterial::RenderFlag::ScreenMipTexture)) {
-        ioFlags.setRequiresScreenTexture(true);
-        ioFlags.setRequiresMipmapsForScreenTexture(true);
+        job.flags.setRequiresScreenTexture(true);
+        job.flags.setRequiresMipmapsForScreenTexture(true);
         renderableFlags |= QSSGRenderableObjectFlag::RequiresScreenTexture;
     }
 
     if (inMaterial.m_renderFlags.testFlag(QSSGRenderCustomMaterial::RenderFlag::DepthTexture))
-        ioFlags.setRequiresDepthTexture(true);
+        job.flags.setRequiresDepthTexture(true);
 
     if (inMaterial.m_renderFlags.testFlag(QSSGRenderCustomMaterial::RenderFlag::AoTexture)) {
-        ioFlags.setRequiresDepthTexture(true);
-        ioFlags.setRequiresSsaoPass(true);
+        job.flags.setRequiresDepthTexture(true);
+        job.flags.setRequiresSsaoPass(true);
     }
 
     retval.firstImage = nullptr;
 
     if (retval.dirty || alreadyDirty)
-        renderer->addMaterialDirtyClear(&inMaterial);
+        job.dirtyMaterials.push_back(&inMaterial);
     return retval;
 }
 
@@ -1005,6 +1201,7 @@ void QSSGLayerRenderData::prepareModelMeshesForRenderInternal(const QSSGRenderCo
                     if (theMesh->bvh) {
                         for (int i = 0; i < theMesh->bvh->roots.size(); ++i)
                             theMesh->subsets[i].bvhRoot = theMesh->bvh->roots.at(i);
+                        bufferManager->invalidateMeshPickingData();
                     }
                 }
             }
@@ -1059,15 +1256,280 @@ QRhiTexture *QSSGLayerRenderData::getBonemapTexture(const QSSGModelContext &mode
     return ret;
 }
 
-// inModel is const to emphasize the fact that its members cannot be written
-// here: in case there is a scene shared between multiple View3Ds in different
-// QQuickWindows, each window may run this in their own render thread, while
-// inModel is the same.
+static constexpr qsizetype MIN_MODELS_PER_PREPARE_JOB = 128;
+
+static int defaultMaxPrepareJobs()
+{
+    // 0 (or unset): serial, 1: one job per core, N > 1: at most N jobs
+    static const int jobs = [] {
+        const int value = qEnvironmentVariableIntValue("QT_QUICK3D_PARALLEL_PREPARE");
+        if (value <= 0)
+            return 1;
+        return value == 1 ? QThread::idealThreadCount() : value;
+    }();
+    return jobs;
+}
+
+// The size of the bounds on the screen, in pixels along the larger side
+static float screenSizeOf(const QSSGBounds3 &bounds, const QMatrix4x4 &viewProjection, const QSizeF &viewportSize)
+{
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    for (int i = 0; i < 8; ++i) {
+        const QVector4D corner((i & 1) ? bounds.maximum.x() : bounds.minimum.x(),
+                               (i & 2) ? bounds.maximum.y() : bounds.minimum.y(),
+                               (i & 4) ? bounds.maximum.z() : bounds.minimum.z(),
+                               1.0f);
+        const QVector4D clipPos = viewProjection.map(corner);
+        // Partly behind the camera, as large as it gets
+        if (clipPos.w() <= std::numeric_limits<float>::epsilon())
+            return float(qMax(viewportSize.width(), viewportSize.height()));
+        const float invW = 1.0f / clipPos.w();
+        minX = qMin(minX, clipPos.x() * invW);
+        maxX = qMax(maxX, clipPos.x() * invW);
+        minY = qMin(minY, clipPos.y() * invW);
+        maxY = qMax(maxY, clipPos.y() * invW);
+    }
+    return qMax((maxX - minX) * 0.5f * float(viewportSize.width()), (maxY - minY) * 0.5f * float(viewportSize.height()));
+}
+
 bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &renderableModels,
                                                  QSSGLayerRenderPreparationResultFlags &ioFlags,
                                                  const QSSGCameraRenderData &cameraData,
                                                  RenderableFilter filter,
                                                  float lodThreshold)
+{
+    QSSGRenderContextInterface &contextInterface = *renderer->contextInterface();
+
+    const auto &debugDrawSystem = contextInterface.debugDrawSystem();
+    const bool maybeDebugDraw = debugDrawSystem && debugDrawSystem->isEnabled();
+
+    // Neither the filter nor the debug draw system can be called from
+    // multiple threads, so those cases are always prepared serially.
+    const qsizetype modelCount = renderableModels.size();
+    const qsizetype jobCount = (filter || maybeDebugDraw)
+            ? 1
+            : qBound<qsizetype>(1, modelCount / MIN_MODELS_PER_PREPARE_JOB, qMax(1, maxPrepareJobs));
+
+    // Only the layer's own models have slots in renderableBounds, extensions
+    // may prepare lists of their own.
+    const bool updatesBounds = (&renderableModels == &this->renderableModels);
+    if (updatesBounds)
+        updateRenderableBounds();
+    const RenderableBoundsEntry *boundsEntries = updatesBounds ? renderableBoundsEntries.data() : nullptr;
+
+    if (jobCount == 1) {
+        ModelPrepJob job;
+        job.boundsEntries = boundsEntries;
+        job.features = features;
+        job.allocator = perFrameAllocator(contextInterface).get();
+        // Let the job append to the layer's lists directly
+        job.modelContexts.swap(modelContexts);
+        job.opaqueObjects.swap(opaqueObjects);
+        job.transparentObjects.swap(transparentObjects);
+        job.screenTextureObjects.swap(screenTextureObjects);
+        job.bakedLightingModels.swap(bakedLightingModels);
+        prepareModelsForRenderJob(job, renderableModels, 0, modelCount, cameraData, filter, lodThreshold);
+        modelContexts.swap(job.modelContexts);
+        opaqueObjects.swap(job.opaqueObjects);
+        transparentObjects.swap(job.transparentObjects);
+        screenTextureObjects.swap(job.screenTextureObjects);
+        bakedLightingModels.swap(job.bakedLightingModels);
+        mergeModelPrepJob(job);
+        ioFlags |= job.flags;
+        return job.wasDirty;
+    }
+
+    // Anything that may create or update graphics resources stays on the
+    // render thread.
+    ModelPrepResources resources;
+    prepareModelResourcesForJobs(renderableModels, resources);
+
+    while (prepareJobAllocators.size() < size_t(jobCount - 1))
+        prepareJobAllocators.push_back(std::make_unique<QSSGPerFrameAllocator>());
+
+    // Each job starts with the features the serial preparation would have
+    // when getting to its first model, so the keys are seeded the same way.
+    std::vector<ModelPrepJob> jobs(jobCount);
+    QSSGShaderFeatures jobFeatures = features;
+    for (qsizetype i = 0; i < jobCount; ++i) {
+        jobs[i].allocator = (i == 0) ? perFrameAllocator(contextInterface).get() : prepareJobAllocators[i - 1].get();
+        jobs[i].resources = &resources;
+        jobs[i].boundsEntries = boundsEntries;
+        jobs[i].features = jobFeatures;
+        for (qsizetype m = modelCount * i / jobCount, end = modelCount * (i + 1) / jobCount; m < end; ++m) {
+            if (resources.setsLightProbe.at(m))
+                jobFeatures.set(QSSGShaderFeatures::Feature::LightProbe, true);
+        }
+    }
+
+    const auto runJob = [&](qsizetype i) {
+        const qsizetype begin = modelCount * i / jobCount;
+        const qsizetype end = modelCount * (i + 1) / jobCount;
+        prepareModelsForRenderJob(jobs[i], renderableModels, begin, end, cameraData, filter, lodThreshold);
+    };
+
+    // The first job runs on this thread. If the pool is busy, the job is run
+    // here as well instead of waiting for a free thread.
+    QSemaphore done;
+    int started = 0;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (qsizetype i = 1; i < jobCount; ++i) {
+        if (pool->tryStart([&runJob, &done, i] { runJob(i); done.release(); }))
+            ++started;
+        else
+            runJob(i);
+    }
+    runJob(0);
+    done.acquire(started);
+
+    // Merge in job order, so the result matches the serial preparation
+    bool wasDirty = false;
+    for (ModelPrepJob &job : jobs) {
+        mergeModelPrepJob(job);
+        ioFlags |= job.flags;
+        wasDirty |= job.wasDirty;
+    }
+
+    return wasDirty;
+}
+
+void QSSGLayerRenderData::prepareModelResourcesForJobs(const RenderableNodeEntries &renderableModels,
+                                                       ModelPrepResources &resources)
+{
+    const auto &bufferManager = renderer->contextInterface()->bufferManager();
+
+    const auto loadImage = [&](QSSGRenderImage *image) {
+        if (image && !resources.images.contains(image)) {
+            const bool dirty = image->clearDirty();
+            resources.images.insert(image, { bufferManager->loadRenderImage(image), dirty });
+        }
+    };
+
+    const qsizetype modelCount = renderableModels.size();
+    resources.bonemapTextures.resize(modelCount);
+    resources.lightmapTextures.resize(modelCount);
+    resources.setsLightProbe.resize(modelCount);
+
+    QSet<const QSSGRenderGraphObject *> visitedMaterials;
+    for (qsizetype i = 0; i < modelCount; ++i) {
+        const QSSGRenderableNodeEntry &renderable = renderableModels.at(i);
+        const QSSGRenderModel &model = *static_cast<QSSGRenderModel *>(renderable.node);
+        if (!renderable.mesh)
+            continue;
+
+        if (model.skin)
+            resources.bonemapTextures[i] = bufferManager->loadSkinmap(model.skin).m_texture;
+        else if (model.skeleton)
+            resources.bonemapTextures[i] = bufferManager->loadSkinmap(&(model.skeleton->boneTexData)).m_texture;
+
+        if (model.hasLightmap() && !renderable.mesh->subsets.isEmpty())
+            resources.lightmapTextures[i] = bufferManager->loadLightmap(model).m_texture;
+
+        // Where prepareDefaultMaterialForRender() turns on the LightProbe
+        // feature, going through the subsets' materials like the jobs do
+        const auto &materials = renderable.materials;
+        for (qsizetype idx = 0, end = renderable.mesh->subsets.size(); idx < end && !materials.isEmpty(); ++idx) {
+            const QSSGRenderGraphObject *materialObject = (idx >= materials.size()) ? materials.last() : materials.at(idx);
+            if (!materialObject || (materialObject->type != QSSGRenderGraphObject::Type::DefaultMaterial
+                                    && materialObject->type != QSSGRenderGraphObject::Type::PrincipledMaterial
+                                    && materialObject->type != QSSGRenderGraphObject::Type::SpecularGlossyMaterial)) {
+                continue;
+            }
+            const auto &material = static_cast<const QSSGRenderDefaultMaterial &>(*materialObject);
+            if (material.iblProbe && (!material.hasLighting() || !layer.lightProbe)) {
+                resources.setsLightProbe[i] = true;
+                break;
+            }
+        }
+
+        for (QSSGRenderGraphObject *materialObject : renderable.materials) {
+            if (!materialObject || visitedMaterials.contains(materialObject))
+                continue;
+            visitedMaterials.insert(materialObject);
+
+            if (materialObject->type == QSSGRenderGraphObject::Type::CustomMaterial) {
+                auto &customMaterial = static_cast<QSSGRenderCustomMaterial &>(*materialObject);
+                if (customMaterial.m_iblProbe)
+                    customMaterial.m_iblProbe->clearDirty();
+                continue;
+            }
+
+            if (materialObject->type != QSSGRenderGraphObject::Type::DefaultMaterial
+                    && materialObject->type != QSSGRenderGraphObject::Type::PrincipledMaterial
+                    && materialObject->type != QSSGRenderGraphObject::Type::SpecularGlossyMaterial) {
+                continue;
+            }
+
+            auto &material = static_cast<QSSGRenderDefaultMaterial &>(*materialObject);
+            if (material.opacity < QSSG_RENDER_MINIMUM_RENDER_OPACITY)
+                continue;
+
+            if (material.type == QSSGRenderGraphObject::Type::PrincipledMaterial ||
+                material.type == QSSGRenderGraphObject::Type::SpecularGlossyMaterial) {
+                loadImage(material.occlusionMap);
+                loadImage(material.heightMap);
+                loadImage(material.clearcoatMap);
+                loadImage(material.clearcoatRoughnessMap);
+                loadImage(material.clearcoatNormalMap);
+                loadImage(material.transmissionMap);
+                loadImage(material.thicknessMap);
+                if (material.type == QSSGRenderGraphObject::Type::PrincipledMaterial)
+                    loadImage(material.metalnessMap);
+            }
+            loadImage(material.colorMap);
+            loadImage(material.emissiveMap);
+            loadImage(material.specularReflection);
+            loadImage(material.roughnessMap);
+            loadImage(material.opacityMap);
+            loadImage(material.bumpMap);
+            loadImage(material.specularMap);
+            loadImage(material.normalMap);
+            loadImage(material.translucencyMap);
+        }
+    }
+}
+
+void QSSGLayerRenderData::mergeModelPrepJob(ModelPrepJob &job)
+{
+    modelContexts.append(job.modelContexts);
+    opaqueObjects.append(job.opaqueObjects);
+    transparentObjects.append(job.transparentObjects);
+    screenTextureObjects.append(job.screenTextureObjects);
+    bakedLightingModels.append(job.bakedLightingModels);
+
+    for (const auto &[modelContext, texture] : std::as_const(job.bonemapTextures))
+        setBonemapTexture(*modelContext, texture);
+    for (const auto &[modelContext, texture] : std::as_const(job.lightmapTextures))
+        setLightmapTexture(*modelContext, texture);
+    for (QSSGRenderGraphObject *material : std::as_const(job.dirtyMaterials))
+        renderer->addMaterialDirtyClear(material);
+    if (!job.streamedImages.isEmpty()) {
+        const auto &bufferManager = renderer->contextInterface()->bufferManager();
+        for (const auto &[image, screenSize] : std::as_const(job.streamedImages))
+            bufferManager->requestImageDetail(image, screenSize);
+    }
+
+    if (job.features.isSet(QSSGShaderFeatures::Feature::LightProbe))
+        features.set(QSSGShaderFeatures::Feature::LightProbe, true);
+    depthPrepassObjectsState |= job.depthPrepassObjectsState;
+    hasDepthWriteObjects |= job.hasDepthWriteObjects;
+    hasTransparentDepthWriteObjects |= job.hasTransparentDepthWriteObjects;
+}
+
+// inModel is const to emphasize the fact that its members cannot be written
+// here: in case there is a scene shared between multiple View3Ds in different
+// QQuickWindows, each window may run this in their own render thread, while
+// inModel is the same.
+void QSSGLayerRenderData::prepareModelsForRenderJob(ModelPrepJob &job,
+                                                    const RenderableNodeEntries &renderableModels,
+                                                    qsizetype begin,
+                                                    qsizetype end,
+                                                    const QSSGCameraRenderData &cameraData,
+                                                    const RenderableFilter &filter,
+                                                    float lodThreshold)
 {
     const auto &rhiCtx = renderer->contextInterface()->rhiContext();
     QSSGRenderContextInterface &contextInterface = *renderer->contextInterface();
@@ -1076,32 +1538,37 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
     const auto &debugDrawSystem = renderer->contextInterface()->debugDrawSystem();
     const bool maybeDebugDraw = debugDrawSystem && debugDrawSystem->isEnabled();
 
-    bool wasDirty = false;
+    QSSGPerFrameAllocator &allocator = *job.allocator;
+    bool &wasDirty = job.wasDirty;
+    const QSizeF viewportSize = layerPrepResult.textureDimensions();
 
-    for (const QSSGRenderableNodeEntry &renderable : renderableModels) {
+    for (qsizetype modelIdx = begin; modelIdx < end; ++modelIdx) {
+        const QSSGRenderableNodeEntry &renderable = renderableModels.at(modelIdx);
         const QSSGRenderModel &model = *static_cast<QSSGRenderModel *>(renderable.node);
         const auto &lights = renderable.lights;
         QSSGRenderMesh *theMesh = renderable.mesh;
 
         QSSG_ASSERT_X(theMesh != nullptr, "Only renderables with a mesh will be processed!", continue);
 
-        QSSGModelContext &theModelContext = *RENDER_FRAME_NEW<QSSGModelContext>(contextInterface, model, cameraData.viewProjection);
-        modelContexts.push_back(&theModelContext);
+        QSSGModelContext &theModelContext = *RENDER_FRAME_NEW<QSSGModelContext>(allocator, model, cameraData.viewProjection);
+        job.modelContexts.push_back(&theModelContext);
         // We might over-allocate here, as the material list technically can contain an invalid (nullptr) material.
         // We'll fix that by adjusting the size at the end for now...
         const auto &meshSubsets = theMesh->subsets;
         const auto meshSubsetCount = meshSubsets.size();
-        theModelContext.subsets = RENDER_FRAME_NEW_BUFFER<QSSGSubsetRenderable>(contextInterface, meshSubsetCount);
+        theModelContext.subsets = RENDER_FRAME_NEW_BUFFER<QSSGSubsetRenderable>(allocator, meshSubsetCount);
 
         // Prepare boneTexture for skinning
-        if (model.skin) {
+        if (job.resources) {
+            job.bonemapTextures.push_back({ &theModelContext, job.resources->bonemapTextures.at(modelIdx) });
+        } else if (model.skin) {
             auto boneTexture = bufferManager->loadSkinmap(model.skin);
-            setBonemapTexture(theModelContext, boneTexture.m_texture);
+            job.bonemapTextures.push_back({ &theModelContext, boneTexture.m_texture });
         } else if (model.skeleton) {
             auto boneTexture = bufferManager->loadSkinmap(&(model.skeleton->boneTexData));
-            setBonemapTexture(theModelContext, boneTexture.m_texture);
+            job.bonemapTextures.push_back({ &theModelContext, boneTexture.m_texture });
         } else {
-            setBonemapTexture(theModelContext, nullptr);
+            job.bonemapTextures.push_back({ &theModelContext, nullptr });
         }
 
         // many renderableFlags are the same for all the subsets
@@ -1117,10 +1584,11 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
 
             renderableFlagsForModel.setUsedInBakedLighting(model.usedInBakedLighting);
             if (model.hasLightmap()) {
-                QSSGRenderImageTexture lmImageTexture = bufferManager->loadLightmap(model);
-                if (lmImageTexture.m_texture) {
+                QRhiTexture *lightmapTexture = job.resources ? job.resources->lightmapTextures.at(modelIdx)
+                                                             : bufferManager->loadLightmap(model).m_texture;
+                if (lightmapTexture) {
                     renderableFlagsForModel.setRendersWithLightmap(true);
-                    setLightmapTexture(theModelContext, lmImageTexture.m_texture);
+                    job.lightmapTextures.push_back({ &theModelContext, lightmapTexture });
                 }
             }
 
@@ -1255,7 +1723,7 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                 theMaterialObject->type == QSSGRenderGraphObject::Type::PrincipledMaterial ||
                 theMaterialObject->type == QSSGRenderGraphObject::Type::SpecularGlossyMaterial) {
                 QSSGRenderDefaultMaterial &theMaterial(static_cast<QSSGRenderDefaultMaterial &>(*theMaterialObject));
-                QSSGDefaultMaterialPreparationResult theMaterialPrepResult(prepareDefaultMaterialForRender(theMaterial, renderableFlags, subsetOpacity, lights, ioFlags));
+                QSSGDefaultMaterialPreparationResult theMaterialPrepResult(prepareDefaultMaterialForRender(job, theMaterial, renderableFlags, subsetOpacity, lights));
                 QSSGShaderDefaultMaterialKey &theGeneratedKey(theMaterialPrepResult.materialKey);
                 subsetOpacity = theMaterialPrepResult.opacity;
                 QSSGRenderableImage *firstImage(theMaterialPrepResult.firstImage);
@@ -1271,6 +1739,8 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                 defaultMaterialShaderKeyProperties.m_boneCount.setValue(theGeneratedKey, boneCount);
                 defaultMaterialShaderKeyProperties.m_usesFloatJointIndices.setValue(
                         theGeneratedKey, !rhiCtx->rhi()->isFeatureSupported(QRhi::IntAttributes));
+                defaultMaterialShaderKeyProperties.m_usesQuantizedDirections.setValue(
+                        theGeneratedKey, theSubset.rhi.quantizedDirections);
                 // Instancing
                 defaultMaterialShaderKeyProperties.m_usesInstancing.setValue(theGeneratedKey, usesInstancing);
                 // Morphing
@@ -1304,6 +1774,20 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                                                                theGeneratedKey,
                                                                lights);
                 wasDirty = wasDirty || renderableFlags.isDirty();
+
+                // Streamed textures need as much detail as the subset has
+                // pixels on the screen. The scale multiplies the UVs, so a
+                // texture tiled N times needs 1/N of that.
+                float screenSize = -1.0f;
+                for (const QSSGRenderableImage *image = firstImage; image; image = image->m_nextImage) {
+                    const QSSGRenderImage &imageNode = image->m_imageNode;
+                    if (!imageNode.m_streaming)
+                        continue;
+                    if (screenSize < 0.0f)
+                        screenSize = screenSizeOf(theRenderableObject->globalBounds, cameraData.viewProjection, viewportSize);
+                    const float tiling = qMax(qAbs(imageNode.m_scale.x()), qAbs(imageNode.m_scale.y()));
+                    job.streamedImages.push_back({ &imageNode, screenSize / qMax(tiling, 0.001f) });
+                }
             } else if (theMaterialObject->type == QSSGRenderGraphObject::Type::CustomMaterial) {
                 QSSGRenderCustomMaterial &theMaterial(static_cast<QSSGRenderCustomMaterial &>(*theMaterialObject));
 
@@ -1311,8 +1795,8 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                 wasDirty |= theMaterialSystem->prepareForRender(theModelContext.model, theSubset, theMaterial);
 
                 QSSGDefaultMaterialPreparationResult theMaterialPrepResult(
-                        prepareCustomMaterialForRender(theMaterial, renderableFlags, subsetOpacity, wasDirty,
-                                                       lights, ioFlags));
+                        prepareCustomMaterialForRender(job, theMaterial, renderableFlags, subsetOpacity, wasDirty,
+                                                       lights));
                 QSSGShaderDefaultMaterialKey &theGeneratedKey(theMaterialPrepResult.materialKey);
                 subsetOpacity = theMaterialPrepResult.opacity;
                 QSSGRenderableImage *firstImage(theMaterialPrepResult.firstImage);
@@ -1329,6 +1813,8 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                 defaultMaterialShaderKeyProperties.m_boneCount.setValue(theGeneratedKey, boneCount);
                 defaultMaterialShaderKeyProperties.m_usesFloatJointIndices.setValue(
                         theGeneratedKey, !rhiCtx->rhi()->isFeatureSupported(QRhi::IntAttributes));
+                defaultMaterialShaderKeyProperties.m_usesQuantizedDirections.setValue(
+                        theGeneratedKey, theSubset.rhi.quantizedDirections);
 
                 // Instancing
                 bool usesInstancing = theModelContext.model.instancing()
@@ -1352,7 +1838,7 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                 defaultMaterialShaderKeyProperties.m_targetColorOffset.setValue(theGeneratedKey,
                                         theSubset.rhi.ia.targetOffsets[QSSGRhiInputAssemblerState::ColorSemantic]);
 
-                if (theMaterial.m_iblProbe)
+                if (theMaterial.m_iblProbe && !job.resources)
                     theMaterial.m_iblProbe->clearDirty();
 
                 new (theRenderableObject) QSSGSubsetRenderable(QSSGSubsetRenderable::Type::CustomMaterialMeshSubset,
@@ -1368,8 +1854,16 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
                                                                theGeneratedKey,
                                                                lights);
             }
-            if (theRenderableObject) // NOTE: Should just go in with the ctor args
+            if (theRenderableObject) { // NOTE: Should just go in with the ctor args
                 theRenderableObject->camdistSq = getCameraDistanceSq(*theRenderableObject, cameraData);
+                // The jobs write to disjoint slots
+                if (job.boundsEntries) {
+                    const RenderableBoundsEntry &boundsEntry = job.boundsEntries[modelIdx];
+                    theRenderableObject->boundsSlot = qint32(boundsEntry.firstSlot) + idx;
+                    if (boundsEntry.dirty)
+                        renderableBounds.set(theRenderableObject->boundsSlot, theRenderableObject->globalBounds);
+                }
+            }
         }
 
         // If the indices don't match then something's off and we need to adjust the subset renderable list size.
@@ -1383,21 +1877,23 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
         if (!handled) {
             for (auto &ro : renderableSubsets) {
                 const auto depthMode = ro.depthWriteMode;
-                hasDepthWriteObjects |= (depthMode == QSSGDepthDrawMode::Always || depthMode == QSSGDepthDrawMode::OpaqueOnly);
+                job.hasDepthWriteObjects |= (depthMode == QSSGDepthDrawMode::Always || depthMode == QSSGDepthDrawMode::OpaqueOnly);
+                job.hasTransparentDepthWriteObjects |= (ro.renderableFlags.hasTransparency()
+                                                        && (depthMode == QSSGDepthDrawMode::Always || depthMode == QSSGDepthDrawMode::OpaquePrePass));
                 enum ObjectType : quint8 { ScreenTexture, Transparent, Opaque };
                 static constexpr DepthPrepassObject ppState[][2] = { {DepthPrepassObject::None, DepthPrepassObject::ScreenTexture},
                                                                      {DepthPrepassObject::None, DepthPrepassObject::Transparent},
                                                                      {DepthPrepassObject::None, DepthPrepassObject::Opaque} };
 
                 if (ro.renderableFlags.requiresScreenTexture()) {
-                    depthPrepassObjectsState |= DepthPrepassObjectStateT(ppState[ObjectType::ScreenTexture][size_t(depthMode == QSSGDepthDrawMode::OpaquePrePass)]);
-                    screenTextureObjects.push_back({&ro, ro.camdistSq});
+                    job.depthPrepassObjectsState |= DepthPrepassObjectStateT(ppState[ObjectType::ScreenTexture][size_t(depthMode == QSSGDepthDrawMode::OpaquePrePass)]);
+                    job.screenTextureObjects.push_back({&ro, ro.camdistSq});
                 } else if (ro.renderableFlags.hasTransparency()) {
-                    depthPrepassObjectsState |= DepthPrepassObjectStateT(ppState[ObjectType::Transparent][size_t(depthMode == QSSGDepthDrawMode::OpaquePrePass)]);
-                    transparentObjects.push_back({&ro, ro.camdistSq});
+                    job.depthPrepassObjectsState |= DepthPrepassObjectStateT(ppState[ObjectType::Transparent][size_t(depthMode == QSSGDepthDrawMode::OpaquePrePass)]);
+                    job.transparentObjects.push_back({&ro, ro.camdistSq});
                 } else {
-                    depthPrepassObjectsState |= DepthPrepassObjectStateT(ppState[ObjectType::Opaque][size_t(depthMode == QSSGDepthDrawMode::OpaquePrePass)]);
-                    opaqueObjects.push_back({&ro, ro.camdistSq});
+                    job.depthPrepassObjectsState |= DepthPrepassObjectStateT(ppState[ObjectType::Opaque][size_t(depthMode == QSSGDepthDrawMode::OpaquePrePass)]);
+                    job.opaqueObjects.push_back({&ro, ro.camdistSq});
                 }
 
                 if (ro.renderableFlags.usedInBakedLighting())
@@ -1406,10 +1902,8 @@ bool QSSGLayerRenderData::prepareModelsForRender(const RenderableNodeEntries &re
         }
 
         if (!bakedLightingObjects.isEmpty())
-            bakedLightingModels.push_back(QSSGBakedLightingModel(&model, bakedLightingObjects));
+            job.bakedLightingModels.push_back(QSSGBakedLightingModel(&model, bakedLightingObjects));
     }
-
-    return wasDirty;
 }
 
 bool QSSGLayerRenderData::prepareParticlesForRender(const RenderableNodeEntries &renderableParticles, const QSSGCameraRenderData &cameraData)
@@ -1463,7 +1957,7 @@ bool QSSGLayerRenderData::prepareParticlesForRender(const RenderableNodeEntries
             colorTable = theImage;
         }
 
-        if (opacity > 0.0f && particles.m_particleBuffer.particleCount()) {
+        if (opacity > 0.0f && particles.m_particleBuffer.usedCount()) {
             auto *theRenderableObject = RENDER_FRAME_NEW<QSSGParticlesRenderable>(contextInterface,
                                                                                   renderableFlags,
                                                                                   center,
@@ -1694,6 +2188,23 @@ void QSSGLayerRenderData::prepareForRender()
         if (theEffect->requiresDepthTexture)
             requiresDepthTexture = true;
     }
+
+    // Occlusion culling. Builds a Hi-Z buffer from the depth of the opaque
+    // objects, see the pass list below for where that depth comes from.
+    bool occlusionCullingEnabled = false;
+    if (layer.occlusionCullingEnabled) {
+        occlusionCullingEnabled = QSSGHiZBuffer::isSupported(renderer->contextInterface()->rhi());
+        if (!occlusionCullingEnabled && !occlusionCullingWarningShown) {
+            qWarning("Occlusion culling is not supported with the current graphics API and device");
+            occlusionCullingWarningShown = true;
+        }
+    }
+    if (!occlusionCullingEnabled) {
+        hiZBuffer.releaseResources();
+        hiZSource = {};
+    }
+    layerPrepResult.flags.setRequiresOcclusionCulling(occlusionCullingEnabled);
+
     layerPrepResult.flags.setRequiresDepthTexture(requiresDepthTexture);
 
     // Tonemapping. Except when there are effects, then it is up to the
@@ -1749,6 +2260,10 @@ void QSSGLayerRenderData::prepareForRender()
         }
     }
 
+    // Gathering the nodes clears their dirty flags, so until the scene BVH
+    // has been updated below it cannot be used (by picking) to reject them.
+    sceneBVH.invalidate();
+
     // Gather Spatial Nodes from Render Tree
     // Do not just clear() renderableNodes and friends. Rather, reuse
     // the space (even if clear does not actually deallocate, it still
@@ -1964,6 +2479,26 @@ void QSSGLayerRenderData::prepareForRender()
     // Ensure meshes for models
     prepareModelMeshesForRenderInternal(*renderer->contextInterface(), renderableModels, QSSGRendererPrivate::isGlobalPickingEnabled(*renderer));
 
+    // The meshes are known now, so the static models can be (re)fitted.
+    sceneBVH.update(renderableModels);
+
+    // The instance trees for picking are brought up to date here, before the
+    // frame is shown. Picking, and the snapshots rayPickBatch() traces on the
+    // worker threads, then only read the published trees.
+    const bool pickEverything = QSSGRendererPrivate::isGlobalPickingEnabled(*renderer);
+    for (const auto &renderable : std::as_const(renderableModels)) {
+        const auto &model = static_cast<const QSSGRenderModel &>(*renderable.node);
+        if (!model.instancing() || !renderable.mesh)
+            continue;
+        if (!pickEverything && !model.getLocalState(QSSGRenderNode::LocalState::Pickable))
+            continue;
+        // Same as the bounds of the mesh's picking data
+        QSSGBounds3 meshBounds;
+        for (const auto &subset : std::as_const(renderable.mesh->subsets))
+            meshBounds.include(subset.bounds);
+        QSSGInstanceBVH::forModel(model, meshBounds);
+    }
+
     if (camera) { // NOTE: We shouldn't really get this far without a camera...
         const auto &cameraData = getCachedCameraData();
         wasDirty |= prepareModelsForRender(renderableModels, layerPrepResult.flags, cameraData, {}, meshLodThreshold);
@@ -2037,6 +2572,27 @@ void QSSGLayerRenderData::prepareForRender()
     if (layerPrepResult.flags.requiresDepthTexture())
         activePasses.push_back(&depthMapPass);
 
+    // Hi-Z buffer for occlusion culling, the opaque and shadow map passes
+    // test against it. Reduces the depth texture when there is one anyway,
+    // otherwise the depth the main pass of the previous frame left behind,
+    // which avoids an extra depth pass but needs a sampleable depth
+    // attachment.
+    if (layerPrepResult.flags.requiresOcclusionCulling()) {
+        if (layerPrepResult.flags.requiresDepthTexture()
+                || QSSGHiZBuffer::mainPassDepthTexture(renderer->contextInterface()->rhiContext().get())) {
+            activePasses.push_back(&occlusionCullingPass);
+        } else {
+            if (!occlusionCullingDepthWarningShown) {
+                qWarning("Occlusion culling needs the depth of the View3D, which is only available with "
+                         "renderMode Offscreen and without multisample antialiasing");
+                occlusionCullingDepthWarningShown = true;
+            }
+            layerPrepResult.flags.setRequiresOcclusionCulling(false);
+            hiZBuffer.releaseResources();
+            hiZSource = {};
+        }
+    }
+
     // Screen space ambient occlusion. Relies on the depth texture and generates an AO map.
     if (layerPrepResult.flags.requiresSsaoPass())
         activePasses.push_back(&ssaoMapPass);
@@ -2091,6 +2647,12 @@ void QSSGLayerRenderData::prepareForRender()
 
     if (const auto &dbgDrawSystem = renderer->contextInterface()->debugDrawSystem(); dbgDrawSystem && dbgDrawSystem->isEnabled() && dbgDrawSystem->hasContent())
         activePasses.push_back(&debugDrawPass);
+
+    // Transparent objects, 2D items and user passes may write depth as well,
+    // the Hi-Z buffer must not be built from such a frame.
+    mainPassDepthIsOpaque = layerEnableDepthTest && !hasTransparentDepthWriteObjects && !hasItem2Ds
+            && !underlayPass.hasData() && !overlayPass.hasData()
+            && !activePasses.contains(&infiniteGridPass) && !activePasses.contains(&debugDrawPass);
 }
 
 void QSSGLayerRenderData::resetForFrame()
@@ -2098,6 +2660,7 @@ void QSSGLayerRenderData::resetForFrame()
     for (const auto &pass : activePasses)
         pass->resetForFrame();
     activePasses.clear();
+    uniformArena.reset();
     transparentObjects.clear();
     screenTextureObjects.clear();
     opaqueObjects.clear();
@@ -2121,8 +2684,17 @@ void QSSGLayerRenderData::resetForFrame()
     modelContexts.clear();
     features = QSSGShaderFeatures();
     hasDepthWriteObjects = false;
+    hasTransparentDepthWriteObjects = false;
+    hasRenderableBoundsVisibility = false;
+    mainPassDepthIsOpaque = false;
+    // Set again by the passes that use them. The srbs of an earlier frame may
+    // have been released since, when the srb cache has an age limit.
+    layer.skyBoxSrb = nullptr;
+    layer.gridSrb = nullptr;
     depthPrepassObjectsState = { DepthPrepassObjectStateT(DepthPrepassObject::None) };
     zPrePassActive = false;
+    for (const auto &allocator : prepareJobAllocators)
+        allocator->reset();
 }
 
 QSSGLayerRenderPreparationResult::QSSGLayerRenderPreparationResult(const QRectF &inViewport, QSSGRenderLayer &inLayer)
@@ -2163,6 +2735,8 @@ QSSGCameraGlobalCalculationResult QSSGLayerRenderPreparationResult::setupCameraF
 QSSGLayerRenderData::QSSGLayerRenderData(QSSGRenderLayer &inLayer, QSSGRenderer &inRenderer)
     : layer(inLayer)
     , renderer(&inRenderer)
+    , maxPrepareJobs(defaultMaxPrepareJobs())
+    , renderableBatchingEnabled(defaultRenderableBatching())
     , particlesEnabled(checkParticleSupport(inRenderer.contextInterface()->rhi()))
 {
 }
@@ -2234,6 +2808,8 @@ bool QSSGLayerRenderData::prepareInstancing(QSSGRhiContext *rhiCtx,
 {
     auto &modelContext = renderable->modelContext;
     auto &instanceBuffer = renderable->instanceBuffer; // intentional ref2ptr
+    if (renderable->batch && !instanceBuffer)
+        instanceBuffer = QSSGRenderableBatcher::prepareInstanceBuffer(rhiCtx, *renderable->batch);
     if (!modelContext.model.instancing() || instanceBuffer)
         return instanceBuffer;
     auto *table = modelContext.model.instanceTable;
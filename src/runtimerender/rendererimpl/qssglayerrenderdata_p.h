@@ -32,6 +32,10 @@
 #include <QtQuick3DRuntimeRender/private/qssgrendermaterialshadergenerator_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgshadermapkey_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglightmapper_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgscenebvh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssghizbuffer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderablesort_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderablebatch_p.h>
 #include <ssg/qssgrenderextensions.h>
 
 #include <ssg/qssgrenderbasetypes.h>
@@ -68,7 +72,11 @@ enum class QSSGLayerRenderPreparationResultFlag
     RequiresScreenTexture = 1 << 5,
 
     // set together with RequiresScreenTexture when SCREEN_MIP_TEXTURE is used
-    RequiresMipmapsForScreenTexture = 1 << 6
+    RequiresMipmapsForScreenTexture = 1 << 6,
+
+    // The Hi-Z buffer is built from the depth texture, so this flag should
+    // never be set without the RequiresDepthTexture flag as well.
+    RequiresOcclusionCulling = 1 << 7
 };
 
 struct QSSGLayerRenderPreparationResultFlags : public QFlags<QSSGLayerRenderPreparationResultFlag>
@@ -126,6 +134,15 @@ struct QSSGLayerRenderPreparationResultFlags : public QFlags<QSSGLayerRenderPrep
     {
         setFlag(QSSGLayerRenderPreparationResultFlag::RequiresMipmapsForScreenTexture, inValue);
     }
+
+    bool requiresOcclusionCulling() const
+    {
+        return this->operator&(QSSGLayerRenderPreparationResultFlag::RequiresOcclusionCulling);
+    }
+    void setRequiresOcclusionCulling(bool inValue)
+    {
+        setFlag(QSSGLayerRenderPreparationResultFlag::RequiresOcclusionCulling, inValue);
+    }
 };
 
 struct QSSGCameraRenderData
@@ -192,14 +209,10 @@ public:
 
     QSSGShaderDefaultMaterialKey generateLightingKey(QSSGRenderDefaultMaterial::MaterialLighting inLightingType,
                                                      const QSSGShaderLightListView &lights, bool receivesShadows = true);
-
-    void prepareImageForRender(QSSGRenderImage &inImage,
-                               QSSGRenderableImage::Type inMapType,
-                               QSSGRenderableImage *&ioFirstImage,
-                               QSSGRenderableImage *&ioNextImage,
-                               QSSGRenderableObjectFlags &ioFlags,
-                               QSSGShaderDefaultMaterialKey &ioGeneratedShaderKey,
-                               quint32 inImageIndex, QSSGRenderDefaultMaterial *inMaterial = nullptr);
+    // Same, with the key seeded from the given features instead of the layer's
+    QSSGShaderDefaultMaterialKey generateLightingKey(const QSSGShaderFeatures &seedFeatures,
+                                                     QSSGRenderDefaultMaterial::MaterialLighting inLightingType,
+                                                     const QSSGShaderLightListView &lights, bool receivesShadows = true);
 
     void setVertexInputPresence(const QSSGRenderableObjectFlags &renderableFlags,
                                 QSSGShaderDefaultMaterialKey &key);
@@ -230,6 +243,13 @@ public:
 
     static qsizetype frustumCulling(const QSSGClippingFrustum &clipFrustum, const QSSGRenderableObjectList &renderables, QSSGRenderableObjectList &visibleRenderables);
     [[nodiscard]] static qsizetype frustumCullingInline(const QSSGClippingFrustum &clipFrustum, QSSGRenderableObjectList &renderables);
+    // Same as frustumCulling(), but the renderables of renderableModels are
+    // looked up in renderableBounds, which is tested once per frustum (models
+    // in sceneBVH that are fully inside or outside skip the per subset test).
+    qsizetype sceneFrustumCulling(const QSSGClippingFrustum &clipFrustum, const QSSGRenderableObjectList &renderables, QSSGRenderableObjectList &visibleRenderables) const;
+    // Removes the renderables of static models that hiZBuffer reports as
+    // occluded, returns the number of renderables removed.
+    qsizetype occlusionCullingInline(QSSGRenderableObjectList &renderables) const;
 
 
     // Per-frame cache of renderable objects post-sort (for the MAIN rendering camera, i.e., don't use these lists for rendering from a different camera).
@@ -253,6 +273,7 @@ public:
     ZPrePassPass zPrePassPass;
     SSAOMapPass ssaoMapPass;
     DepthMapPass depthMapPass;
+    OcclusionCullingPass occlusionCullingPass;
     ScreenMapPass screenMapPass;
     ScreenReflectionPass reflectionPass;
     Item2DPass item2DPass;
@@ -281,6 +302,53 @@ public:
     QVector<QSSGRenderLight *> lights;
     QVector<QSSGRenderReflectionProbe *> reflectionProbes;
 
+    // Hierarchy over the static models in renderableModels, updated in prepareForRender().
+    QSSGSceneBVH sceneBVH;
+    // World space bounds of the subsets of renderableModels, kept between
+    // frames in the layout the frustum test wants. The subsets of a model
+    // get consecutive slots, which are only rewritten when the model's
+    // transform or mesh changed.
+    struct RenderableBoundsEntry
+    {
+        const QSSGRenderNode *node = nullptr;
+        const QSSGRenderMesh *mesh = nullptr;
+        quint32 transformSerial = 0;
+        quint32 firstSlot = 0;
+        quint32 slotCount = 0;
+        bool dirty = true; // this frame
+    };
+    std::vector<RenderableBoundsEntry> renderableBoundsEntries; // indexed like renderableModels
+    QSSGBoundsList renderableBounds;
+    // Frustum test result per slot, for the last frustum tested this frame
+    mutable QBitArray renderableBoundsVisibility;
+    mutable QSSGClippingFrustum renderableBoundsVisibilityFrustum;
+    mutable bool hasRenderableBoundsVisibility = false;
+    // Depth of an earlier frame, used for occlusion culling.
+    QSSGHiZBuffer hiZBuffer;
+    // The depth attachment of the main pass as left by the previous frame,
+    // reduced into hiZBuffer before the main pass of this frame clears it.
+    // Only set when nothing but opaque objects wrote to it.
+    struct HiZSource
+    {
+        QRhiTexture *depthTexture = nullptr;
+        QSize pixelSize;
+        QRhiViewport viewport;
+        QMatrix4x4 viewProjection;
+    } hiZSource;
+    // Nothing but opaque objects write depth in the main pass of this frame.
+    bool mainPassDepthIsOpaque = false;
+    // Orders the renderable lists, keeps the pipeline and material ids between frames.
+    QSSGRenderableSorter renderableSorter;
+    // The order of the sorted lists in the previous frame
+    QSSGRenderableSorter::History opaqueSortHistory;
+    QSSGRenderableSorter::History transparentSortHistory;
+    QSSGRenderableSorter::History screenTextureSortHistory;
+    // Merges the opaque models sharing mesh and material into instanced draws.
+    QSSGRenderableBatcher renderableBatcher;
+    // Per-draw uniform data of this frame. Mutable, as it is filled in by
+    // the prepare steps that only get to see a const layer.
+    mutable QSSGRhiUniformArena uniformArena;
+
     // Results of prepare for render.
     QSSGRenderCamera *camera = nullptr;
     QSSGShaderLightList globalLights; // All non-scoped lights
@@ -304,8 +372,18 @@ public:
     TModelContextPtrList modelContexts;
 
 
+    // Upper bound for the number of jobs prepareModelsForRender() splits its
+    // work into. Defaults to 1 (serial), see QT_QUICK3D_PARALLEL_PREPARE.
+    int maxPrepareJobs = 1;
+
+    // Instanced drawing of opaque models that share the mesh and the
+    // material. On by default, see QT_QUICK3D_DISABLE_RENDERABLE_BATCHING.
+    bool renderableBatchingEnabled = true;
+
     bool tooManyLightsWarningShown = false;
     bool tooManyShadowLightsWarningShown = false;
+    bool occlusionCullingWarningShown = false;
+    bool occlusionCullingDepthWarningShown = false;
 
     QSSGLightmapper *m_lightmapper = nullptr;
 
@@ -393,17 +471,91 @@ private:
     [[nodiscard]] QSSGCameraRenderData getCachedCameraData();
     void updateSortedDepthObjectsListImp();
 
-    QSSGDefaultMaterialPreparationResult prepareDefaultMaterialForRender(QSSGRenderDefaultMaterial &inMaterial,
+    enum class DepthPrepassObject : quint8
+    {
+        None = 0x0,
+        ScreenTexture = 0x1,
+        Transparent = 0x2,
+        Opaque = 0x4
+    };
+    using DepthPrepassObjectStateT = std::underlying_type_t<DepthPrepassObject>;
+
+    // Textures resolved on the render thread before running the model
+    // preparation in parallel (the buffer manager is not thread-safe).
+    struct ModelPrepResources
+    {
+        struct Image
+        {
+            QSSGRenderImageTexture texture;
+            bool dirty = false;
+        };
+        QHash<const QSSGRenderImage *, Image> images;
+        // Indexed like the renderable model list
+        QVector<QRhiTexture *> bonemapTextures;
+        QVector<QRhiTexture *> lightmapTextures;
+        // The model has a subset whose material turns on the LightProbe feature
+        QVector<bool> setsLightProbe;
+    };
+
+    // Output of one prepareModelsForRender() job. A job only writes to its
+    // own state, the jobs are merged in order afterwards.
+    struct ModelPrepJob
+    {
+        QSSGPerFrameAllocator *allocator = nullptr;
+        const ModelPrepResources *resources = nullptr; // nullptr: load on the spot
+        TModelContextPtrList modelContexts;
+        QSSGRenderableObjectList opaqueObjects;
+        QSSGRenderableObjectList transparentObjects;
+        QSSGRenderableObjectList screenTextureObjects;
+        QVector<QSSGBakedLightingModel> bakedLightingModels;
+        QVector<QSSGRenderGraphObject *> dirtyMaterials;
+        QVector<std::pair<const QSSGModelContext *, QRhiTexture *>> bonemapTextures;
+        QVector<std::pair<const QSSGModelContext *, QRhiTexture *>> lightmapTextures;
+        QVector<std::pair<const QSSGRenderImage *, float>> streamedImages; // with their size on the screen
+        QSSGLayerRenderPreparationResultFlags flags;
+        DepthPrepassObjectStateT depthPrepassObjectsState { DepthPrepassObjectStateT(DepthPrepassObject::None) };
+        // Indexed like the models, nullptr: the models have no renderableBounds slots
+        const RenderableBoundsEntry *boundsEntries = nullptr;
+        // The layer's features as the serial preparation has them when it
+        // gets to the job's models. The material keys are seeded with them.
+        QSSGShaderFeatures features;
+        bool hasDepthWriteObjects = false;
+        bool hasTransparentDepthWriteObjects = false;
+        bool wasDirty = false;
+    };
+
+    void prepareModelsForRenderJob(ModelPrepJob &job,
+                                   const RenderableNodeEntries &renderableModels,
+                                   qsizetype begin,
+                                   qsizetype end,
+                                   const QSSGCameraRenderData &cameraData,
+                                   const RenderableFilter &filter,
+                                   float lodThreshold);
+    void prepareModelResourcesForJobs(const RenderableNodeEntries &renderableModels, ModelPrepResources &resources);
+    void mergeModelPrepJob(ModelPrepJob &job);
+    void updateRenderableBounds();
+    const QBitArray &cullRenderableBounds(const QSSGClippingFrustum &clipFrustum) const;
+
+    void prepareImageForRender(ModelPrepJob &job,
+                               QSSGRenderImage &inImage,
+                               QSSGRenderableImage::Type inMapType,
+                               QSSGRenderableImage *&ioFirstImage,
+                               QSSGRenderableImage *&ioNextImage,
+                               QSSGRenderableObjectFlags &ioFlags,
+                               QSSGShaderDefaultMaterialKey &ioGeneratedShaderKey,
+                               quint32 inImageIndex, QSSGRenderDefaultMaterial *inMaterial = nullptr);
+
+    QSSGDefaultMaterialPreparationResult prepareDefaultMaterialForRender(ModelPrepJob &job,
+                                                                         QSSGRenderDefaultMaterial &inMaterial,
                                                                          QSSGRenderableObjectFlags &inExistingFlags,
                                                                          float inOpacity,
-                                                                         const QSSGShaderLightListView &lights,
-                                                                         QSSGLayerRenderPreparationResultFlags &ioFlags);
+                                                                         const QSSGShaderLightListView &lights);
 
-    QSSGDefaultMaterialPreparationResult prepareCustomMaterialForRender(QSSGRenderCustomMaterial &inMaterial,
+    QSSGDefaultMaterialPreparationResult prepareCustomMaterialForRender(ModelPrepJob &job,
+                                                                        QSSGRenderCustomMaterial &inMaterial,
                                                                         QSSGRenderableObjectFlags &inExistingFlags,
                                                                         float inOpacity, bool alreadyDirty,
-                                                                        const QSSGShaderLightListView &lights,
-                                                                        QSSGLayerRenderPreparationResultFlags &ioFlags);
+                                                                        const QSSGShaderLightListView &lights);
 
 
     static void prepareModelMeshesForRenderInternal(const QSSGRenderContextInterface &contextInterface,
@@ -421,21 +573,17 @@ private:
     QSSGShaderFeatures features; // Base feature set
     bool particlesEnabled = true;
     bool hasDepthWriteObjects = false;
+    bool hasTransparentDepthWriteObjects = false; // Always or OpaquePrePass
     bool zPrePassActive = false;
-    enum class DepthPrepassObject : quint8
-    {
-        None = 0x0,
-        ScreenTexture = 0x1,
-        Transparent = 0x2,
-        Opaque = 0x4
-    };
-    using DepthPrepassObjectStateT = std::underlying_type_t<DepthPrepassObject>;
     DepthPrepassObjectStateT depthPrepassObjectsState { DepthPrepassObjectStateT(DepthPrepassObject::None) };
     QSSGRenderShadowMapPtr shadowMapManager;
     QSSGRenderReflectionMapPtr reflectionMapManager;
     QHash<const QSSGModelContext *, QRhiTexture *> lightmapTextures;
     QHash<const QSSGModelContext *, QRhiTexture *> bonemapTextures;
     QSSGRhiRenderableTexture renderResults[3] {};
+    // Allocators for the prepareModelsForRender() jobs that do not run on the
+    // render thread, reset in resetForFrame().
+    std::vector<std::unique_ptr<QSSGPerFrameAllocator>> prepareJobAllocators;
 };
 
 QT_END_NAMESPACE
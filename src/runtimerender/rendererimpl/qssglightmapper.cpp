@@ -337,6 +337,10 @@ bool QSSGLightmapperPrivate::commitGeometry()
             return false;
         }
 
+        // The data is read on the CPU and by the baking shaders as floats,
+        // which have no remapping of quantized normals, tangents and binormals.
+        mesh.dequantizeVertexData();
+
         if (!mesh.hasLightmapUVChannel()) {
             QElapsedTimer unwrapTimer;
             unwrapTimer.start();
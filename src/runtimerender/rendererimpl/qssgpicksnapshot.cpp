@@ -0,0 +1,234 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgpicksnapshot_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssginstancebvh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderitem2d_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlayer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DUtils/private/qssgutils_p.h>
+
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+using NodeList = QVarLengthArray<const QSSGRenderNode *>;
+static void collectRenderables(const QSSGRenderNode &node, NodeList &nodes)
+{
+    if (QSSGRenderGraphObject::isRenderable(node.type))
+        nodes.push_back(&node);
+
+    for (const auto &child : node.children)
+        collectRenderables(child, nodes);
+}
+
+std::shared_ptr<const QSSGPickSnapshot> QSSGPickSnapshot::create(QSSGBufferManager &bufferManager,
+                                                                 const QSSGRenderLayer &layer,
+                                                                 bool pickEverything)
+{
+    NodeList nodes;
+    for (const auto &childNode : layer.children)
+        collectRenderables(childNode, nodes);
+
+    auto snapshot = std::make_shared<QSSGPickSnapshot>();
+    snapshot->m_entries.reserve(nodes.size());
+    for (qsizetype idx = nodes.size() - 1; idx >= 0; --idx) {
+        const QSSGRenderNode &node = *nodes.at(idx);
+        if (!pickEverything && !node.getLocalState(QSSGRenderNode::LocalState::Pickable))
+            continue;
+
+        Entry entry;
+        entry.node = &node;
+        if (node.type == QSSGRenderGraphObject::Type::Item2D) {
+            const QSSGRenderItem2D &item2D = static_cast<const QSSGRenderItem2D &>(node);
+            entry.transform = item2D.globalTransform.inverted();
+            entry.position = item2D.getGlobalPos();
+            entry.normal = -item2D.getDirection();
+        } else if (node.type == QSSGRenderGraphObject::Type::Model) {
+            const QSSGRenderModel &model = static_cast<const QSSGRenderModel &>(node);
+            entry.mesh = bufferManager.getMeshPickingData(model);
+            if (!entry.mesh || entry.mesh->bounds.isEmpty())
+                continue;
+            if (model.instancing()) {
+                // Normally the tree the render thread built when preparing
+                // the frame. The snapshot keeps it alive and never changes it.
+                entry.instances = QSSGInstanceBVH::forModel(model, entry.mesh->bounds);
+                if (!entry.instances || entry.instances->instanceCount() == 0)
+                    continue;
+                entry.transform = model.globalInstanceTransform;
+                entry.globalBounds = entry.instances->bounds();
+            } else {
+                entry.transform = model.globalTransform;
+                entry.globalBounds = entry.mesh->bounds;
+            }
+            entry.globalBounds.transform(entry.transform);
+        } else {
+            continue;
+        }
+        snapshot->m_entries.push_back(std::move(entry));
+    }
+
+    return snapshot;
+}
+
+void QSSGPickSnapshot::pick(const QSSGRenderRay *rays, qsizetype count, QSSGRenderPickResult *results) const
+{
+    static const QMatrix4x4 identity;
+    for (qsizetype i = 0; i < count; ++i) {
+        const QSSGRenderRay &ray = rays[i];
+        QSSGRenderPickResult &closest = results[i];
+        closest = QSSGRenderPickResult();
+
+        const auto rayData = QSSGRenderRay::createRayData(identity, ray);
+        for (const Entry &entry : m_entries) {
+            QSSGRenderPickResult result;
+            if (entry.mesh) {
+                // Nothing in the bounds can be closer than where the ray enters them
+                const auto hit = QSSGRenderRay::intersectWithAABBv2(rayData, entry.globalBounds);
+                const float enter = qMax(hit.min, 0.0f);
+                if (!hit.intersects() || enter * enter > closest.m_distanceSq)
+                    continue;
+                if (!intersectRayWithModel(ray, entry, result))
+                    continue;
+            } else if (!intersectRayWithItem2D(ray, entry, result)) {
+                continue;
+            }
+            // Strictly closer only, equal distances go to the earlier node
+            if (result.m_distanceSq < closest.m_distanceSq)
+                closest = result;
+        }
+    }
+}
+
+void QSSGPickSnapshot::pickParallel(const QSSGRenderRay *rays, qsizetype count, QSSGRenderPickResult *results) const
+{
+    const qsizetype jobCount = (count + RAYS_PER_JOB - 1) / RAYS_PER_JOB;
+    if (jobCount <= 1) {
+        pick(rays, count, results);
+        return;
+    }
+
+    const auto runJob = [&](qsizetype i) {
+        const qsizetype begin = i * RAYS_PER_JOB;
+        pick(rays + begin, qMin(RAYS_PER_JOB, count - begin), results + begin);
+    };
+
+    // Same as preparing the models, the first job runs on this thread and so
+    // does a job the pool has no free thread for
+    QSemaphore done;
+    int started = 0;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (qsizetype i = 1; i < jobCount; ++i) {
+        if (pool->tryStart([&runJob, &done, i] { runJob(i); done.release(); }))
+            ++started;
+        else
+            runJob(i);
+    }
+    runJob(0);
+    done.acquire(started);
+}
+
+bool QSSGPickSnapshot::intersectRayWithMesh(const QSSGRenderRay &ray,
+                                            const QMatrix4x4 &transform,
+                                            const QSSGBufferManager::MeshPickingData &mesh,
+                                            QSSGRenderRay::IntersectionResult &result,
+                                            int &subset)
+{
+    const auto rayData = QSSGRenderRay::createRayData(transform, ray);
+
+    // If we don't intersect with the mesh at all, then there's no need to go further down!
+    if (!QSSGRenderRay::intersectWithAABBv2(rayData, mesh.bounds).intersects())
+        return false;
+
+    // Check each subset to find the closest intersection point
+    float minRayLength = std::numeric_limits<float>::max();
+    QVector<QSSGRenderRay::IntersectionResult> results;
+    result = QSSGRenderRay::IntersectionResult();
+    for (int i = 0, end = int(mesh.subsetBounds.size()); i < end; ++i) {
+        QSSGRenderRay::IntersectionResult subsetResult;
+        const QSSGMeshBVHNode::Handle root = mesh.subsetRoots.at(i);
+        if (!root.isNull()) {
+            if (QSSGRenderRay::intersectWithAABBv2(rayData, root->boundingData).intersects()) {
+                results.clear();
+                QSSGRenderRay::intersectWithBVH(rayData, static_cast<const QSSGMeshBVHNode *>(root), mesh.bvh.get(), results);
+                float subsetMinRayLength = std::numeric_limits<float>::max();
+                for (const auto &hit : std::as_const(results)) {
+                    if (hit.rayLengthSquared < subsetMinRayLength) {
+                        subsetResult = hit;
+                        subsetMinRayLength = hit.rayLengthSquared;
+                    }
+                }
+            }
+        } else {
+            const auto hit = QSSGRenderRay::intersectWithAABBv2(rayData, mesh.subsetBounds.at(i));
+            if (hit.intersects())
+                subsetResult = QSSGRenderRay::createIntersectionResult(rayData, hit);
+        }
+        if (subsetResult.intersects && subsetResult.rayLengthSquared < minRayLength) {
+            result = subsetResult;
+            minRayLength = subsetResult.rayLengthSquared;
+            subset = i;
+        }
+    }
+
+    return result.intersects;
+}
+
+bool QSSGPickSnapshot::intersectRayWithModel(const QSSGRenderRay &ray, const Entry &entry, QSSGRenderPickResult &result)
+{
+    QSSGRenderRay::IntersectionResult hit;
+    int subset = 0;
+    if (!entry.instances) {
+        if (!intersectRayWithMesh(ray, entry.transform, *entry.mesh, hit, subset))
+            return false;
+        result = QSSGRenderPickResult { entry.node, hit.rayLengthSquared, hit.relXY, hit.scenePosition,
+                                        hit.localPosition, hit.faceNormal, subset, 0 };
+        return true;
+    }
+
+    // Only the instances with bounds hit by the ray need a closer look
+    QVector<qint32> hitInstances;
+    entry.instances->intersectRay(QSSGRenderRay::createRayData(entry.transform, ray), hitInstances);
+    bool found = false;
+    for (const qint32 instanceIndex : std::as_const(hitInstances)) {
+        const QMatrix4x4 transform = entry.transform * entry.instances->instanceTransform(instanceIndex);
+        if (!intersectRayWithMesh(ray, transform, *entry.mesh, hit, subset))
+            continue;
+        if (!found || hit.rayLengthSquared < result.m_distanceSq) {
+            result = QSSGRenderPickResult { entry.node, hit.rayLengthSquared, hit.relXY, hit.scenePosition,
+                                            hit.localPosition, hit.faceNormal, subset, instanceIndex };
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool QSSGPickSnapshot::intersectRayWithItem2D(const QSSGRenderRay &ray, const Entry &entry, QSSGRenderPickResult &result)
+{
+    // Same as QSSGRendererPrivate::intersectRayWithItem2D()
+    const float d = QVector3D::dotProduct(ray.direction, entry.normal);
+    if (d <= 1e-6f)
+        return false;
+
+    const float intersectionTime = QVector3D::dotProduct(entry.position - ray.origin, entry.normal) / d;
+    if (intersectionTime < 0)
+        return false;
+
+    const QVector3D intersectionPoint = ray.origin + ray.direction * intersectionTime;
+    const QVector3D localIntersectionPoint = QSSGUtils::mat44::transform(entry.transform, intersectionPoint);
+    const QVector2D qmlCoordinate(localIntersectionPoint.x(), -localIntersectionPoint.y());
+    result = QSSGRenderPickResult { entry.node,
+                                    intersectionTime * intersectionTime,
+                                    qmlCoordinate,
+                                    intersectionPoint,
+                                    localIntersectionPoint,
+                                    entry.normal };
+    return true;
+}
+
+QT_END_NAMESPACE
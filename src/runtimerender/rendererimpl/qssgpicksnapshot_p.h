@@ -0,0 +1,95 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGPICKSNAPSHOT_P_H
+#define QSSGPICKSNAPSHOT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderpickresult_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderray_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <QtGui/qmatrix4x4.h>
+#include <QtCore/qvector.h>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QSSGInstanceBVH;
+struct QSSGRenderLayer;
+struct QSSGRenderNode;
+
+// Everything picking needs from the pickable nodes of a layer, copied when
+// the snapshot is created. Picking against a snapshot does not touch the
+// scene or the buffer manager, so it does not lock anything and can run on
+// any thread, for as many rays as needed.
+//
+// The nodes are only used for identifying the hits, they must not be
+// dereferenced after the scene has changed.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGPickSnapshot
+{
+public:
+    // Must be called where syncPick() could be called
+    static std::shared_ptr<const QSSGPickSnapshot> create(QSSGBufferManager &bufferManager,
+                                                          const QSSGRenderLayer &layer,
+                                                          bool pickEverything);
+
+    [[nodiscard]] qsizetype nodeCount() const { return qsizetype(m_entries.size()); }
+
+    // The closest hit of each ray, with a null m_hitObject for the rays that
+    // don't hit anything. Ties go to the node syncPick() would have picked.
+    void pick(const QSSGRenderRay *rays, qsizetype count, QSSGRenderPickResult *results) const;
+    // Same, with the rays spread over the threads of the global thread pool
+    void pickParallel(const QSSGRenderRay *rays, qsizetype count, QSSGRenderPickResult *results) const;
+
+    // The closest hit of the ray with the subsets of the mesh, transform is
+    // the mesh's global transform
+    static bool intersectRayWithMesh(const QSSGRenderRay &ray,
+                                     const QMatrix4x4 &transform,
+                                     const QSSGBufferManager::MeshPickingData &mesh,
+                                     QSSGRenderRay::IntersectionResult &result,
+                                     int &subset);
+
+private:
+    // Rays per job when picking in parallel
+    static constexpr qsizetype RAYS_PER_JOB = 64;
+
+    struct Entry
+    {
+        const QSSGRenderNode *node = nullptr;
+        // globalTransform, globalInstanceTransform for instanced models and
+        // the inverted globalTransform for Item2Ds
+        QMatrix4x4 transform;
+        // Models only
+        QSSGBounds3 globalBounds;
+        QSSGBufferManager::MeshPickingDataPtr mesh;
+        std::shared_ptr<const QSSGInstanceBVH> instances;
+        // Item2Ds only
+        QVector3D position;
+        QVector3D normal;
+    };
+
+    static bool intersectRayWithModel(const QSSGRenderRay &ray, const Entry &entry, QSSGRenderPickResult &result);
+    static bool intersectRayWithItem2D(const QSSGRenderRay &ray, const Entry &entry, QSSGRenderPickResult &result);
+
+    // In the order the nodes are picked in, the reverse of the scene order
+    std::vector<Entry> m_entries;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGPICKSNAPSHOT_P_H
@@ -0,0 +1,180 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgrenderablebatch_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgperframeallocator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershaderkeys_p.h>
+
+QT_BEGIN_NAMESPACE
+
+QSSGRenderableBatcher::~QSSGRenderableBatcher()
+{
+    releaseResources();
+}
+
+bool QSSGRenderableBatcher::isSupported(QRhi *rhi)
+{
+    return rhi && rhi->isFeatureSupported(QRhi::Instancing);
+}
+
+bool QSSGRenderableBatcher::isBatchable(const QSSGSubsetRenderable &renderable, const QSSGShaderDefaultMaterialKeyProperties &keyProperties)
+{
+    if (renderable.type != QSSGRenderableObject::Type::DefaultMaterialMeshSubset)
+        return false;
+
+    const QSSGRenderModel &model = renderable.modelContext.model;
+    if (model.instancing() || model.usesBoneTexture() || model.hasLightmap() || !model.morphWeights.isEmpty())
+        return false;
+
+    if (renderable.renderableFlags.rendersWithLightmap() || renderable.subset.rhi.targetsTexture)
+        return false;
+
+    const QSSGShaderDefaultMaterialKey &key = renderable.shaderDescription;
+    return keyProperties.m_boneCount.getValue(key) == 0
+            && keyProperties.m_targetCount.getValue(key) == 0
+            && !keyProperties.m_blendParticles.getValue(key);
+}
+
+bool QSSGRenderableBatcher::isCompatible(const QSSGSubsetRenderable &lhs, const QSSGSubsetRenderable &rhs)
+{
+    if (!(lhs.shaderDescription == rhs.shaderDescription)
+            || lhs.renderableFlags != rhs.renderableFlags
+            || lhs.depthWriteMode != rhs.depthWriteMode
+            || lhs.subsetLevelOfDetail != rhs.subsetLevelOfDetail
+            || lhs.opacity != rhs.opacity
+            || lhs.reflectionProbeIndex != rhs.reflectionProbeIndex
+            || lhs.lights.size() != rhs.lights.size()) {
+        return false;
+    }
+
+    for (int i = 0, end = int(lhs.lights.size()); i < end; ++i) {
+        if (lhs.lights[i].light != rhs.lights[i].light || lhs.lights[i].shadows != rhs.lights[i].shadows)
+            return false;
+    }
+
+    return true;
+}
+
+QSSGRenderableBatch *QSSGRenderableBatcher::nextBatch()
+{
+    if (m_batchCount == qsizetype(m_batches.size()))
+        m_batches.push_back(std::make_unique<QSSGRenderableBatch>());
+    QSSGRenderableBatch *batch = m_batches[m_batchCount++].get();
+    batch->instances.clear();
+    batch->uploaded = false;
+    return batch;
+}
+
+qsizetype QSSGRenderableBatcher::batch(QSSGRenderableObjectList &list,
+                                       const QSSGShaderDefaultMaterialKeyProperties &keyProperties,
+                                       QSSGPerFrameAllocator &allocator)
+{
+    m_batchCount = 0;
+    m_groupIndices.clear();
+    m_groups.clear();
+
+    const qsizetype count = list.size();
+    m_groupOf.assign(size_t(count), -1);
+
+    // Find the groups first, a group that ends up too small is left alone
+    bool hasBatches = false;
+    for (qsizetype i = 0; i < count; ++i) {
+        QSSGRenderableObject *obj = list.at(i).obj;
+        if (obj->type != QSSGRenderableObject::Type::DefaultMaterialMeshSubset)
+            continue;
+        auto *renderable = static_cast<QSSGSubsetRenderable *>(obj);
+        if (!isBatchable(*renderable, keyProperties))
+            continue;
+
+        const std::pair<const void *, const void *> key(&renderable->subset, &renderable->material);
+        auto it = m_groupIndices.find(key);
+        if (it == m_groupIndices.end()) {
+            it = m_groupIndices.insert(key, qsizetype(m_groups.size()));
+            m_groups.push_back({ renderable, nullptr, 0 });
+        }
+
+        // Incompatible renderables with the same mesh and material are
+        // rare, they are not batched rather than starting another group
+        Group &group = m_groups[it.value()];
+        if (group.first == renderable || isCompatible(*group.first, *renderable)) {
+            m_groupOf[i] = it.value();
+            hasBatches |= (++group.size >= MIN_BATCH_SIZE);
+        }
+    }
+
+    if (!hasBatches)
+        return 0;
+
+    qsizetype out = 0;
+    for (qsizetype i = 0; i < count; ++i) {
+        const qsizetype groupIndex = m_groupOf[i];
+        if (groupIndex < 0 || m_groups[groupIndex].size < MIN_BATCH_SIZE) {
+            list[out++] = list.at(i);
+            continue;
+        }
+
+        Group &group = m_groups[groupIndex];
+        auto *renderable = static_cast<QSSGSubsetRenderable *>(list.at(i).obj);
+        if (!group.merged) {
+            group.merged = new (allocator.allocate(sizeof(QSSGSubsetRenderable))) QSSGSubsetRenderable(*renderable);
+            keyProperties.m_usesInstancing.setValue(group.merged->shaderDescription, true);
+            group.merged->batch = nextBatch();
+            group.merged->batch->instances.reserve(group.size);
+            group.merged->instanceBuffer = nullptr;
+            list[out++] = { group.merged, list.at(i).cameraDistanceSq };
+        } else {
+            group.merged->globalBounds.include(renderable->globalBounds);
+        }
+
+        // The rows of the global transform, as in the instance tables
+        const QMatrix4x4 &transform = renderable->globalTransform;
+        group.merged->batch->instances.append({ transform.row(0), transform.row(1), transform.row(2),
+                                                 QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector4D() });
+    }
+
+    const qsizetype removed = count - out;
+    list.resize(out);
+    return removed;
+}
+
+QRhiBuffer *QSSGRenderableBatcher::prepareInstanceBuffer(QSSGRhiContext *rhiCtx, QSSGRenderableBatch &batch)
+{
+    const quint32 size = quint32(batch.instances.size() * sizeof(QSSGRenderInstanceTableEntry));
+    if (batch.buffer && batch.buffer->size() < size) {
+        batch.buffer->setSize(size);
+        batch.buffer->create();
+        batch.uploaded = false;
+    }
+    if (!batch.buffer) {
+        batch.buffer = rhiCtx->rhi()->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer, size);
+        batch.buffer->setName(QByteArrayLiteral("Renderable batch"));
+        if (!batch.buffer->create()) {
+            qWarning("Failed to build instance buffer for a renderable batch (size %u)", size);
+            delete batch.buffer;
+            batch.buffer = nullptr;
+            return nullptr;
+        }
+        batch.uploaded = false;
+    }
+
+    if (!batch.uploaded) {
+        QRhiResourceUpdateBatch *rub = rhiCtx->rhi()->nextResourceUpdateBatch();
+        rub->updateDynamicBuffer(batch.buffer, 0, size, batch.instances.constData());
+        rhiCtx->commandBuffer()->resourceUpdate(rub);
+        batch.uploaded = true;
+    }
+
+    return batch.buffer;
+}
+
+void QSSGRenderableBatcher::releaseResources()
+{
+    for (auto &batch : m_batches)
+        delete batch->buffer;
+    m_batches.clear();
+    m_batchCount = 0;
+}
+
+QT_END_NAMESPACE
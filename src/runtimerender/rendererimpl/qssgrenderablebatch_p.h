@@ -0,0 +1,94 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGRENDERABLEBATCH_P_H
+#define QSSGRENDERABLEBATCH_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+
+#include <QtCore/qhash.h>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QSSGPerFrameAllocator;
+class QSSGRhiContext;
+struct QSSGShaderDefaultMaterialKeyProperties;
+
+// Merges opaque renderables that only differ in their transform into one
+// instanced renderable each. The merged renderable is a copy of the first
+// one with instancing enabled in its shader key, and the global transforms
+// of all the models as instance data. That is the same vertex path the
+// instance tables go through, the parent and local instance transforms are
+// identities.
+//
+// Only default materials on plain models are merged: no instancing,
+// skinning, morphing, lightmaps or particles. Everything else that ends up
+// in the uniforms (opacity, lights, reflection probe, flags) has to match.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderableBatcher
+{
+public:
+    QSSGRenderableBatcher() = default;
+    ~QSSGRenderableBatcher();
+
+    Q_DISABLE_COPY_MOVE(QSSGRenderableBatcher)
+
+    static bool isSupported(QRhi *rhi);
+
+    // Replaces the batched renderables in list with the merged ones, at the
+    // position of their first member. The merged renderables are allocated
+    // with allocator. Returns the number of entries removed from list.
+    qsizetype batch(QSSGRenderableObjectList &list,
+                    const QSSGShaderDefaultMaterialKeyProperties &keyProperties,
+                    QSSGPerFrameAllocator &allocator);
+
+    // Creates the instance buffer of batch, and uploads the data on first
+    // use in a frame.
+    static QRhiBuffer *prepareInstanceBuffer(QSSGRhiContext *rhiCtx, QSSGRenderableBatch &batch);
+
+    void releaseResources();
+
+    [[nodiscard]] qsizetype batchCount() const { return m_batchCount; }
+
+private:
+    // Fewer models are not worth the extra work in the vertex shader
+    static constexpr qsizetype MIN_BATCH_SIZE = 4;
+
+    struct Group
+    {
+        QSSGSubsetRenderable *first = nullptr;
+        QSSGSubsetRenderable *merged = nullptr;
+        qsizetype size = 0;
+    };
+
+    static bool isBatchable(const QSSGSubsetRenderable &renderable, const QSSGShaderDefaultMaterialKeyProperties &keyProperties);
+    static bool isCompatible(const QSSGSubsetRenderable &lhs, const QSSGSubsetRenderable &rhs);
+    QSSGRenderableBatch *nextBatch();
+
+    // Groups are looked up by mesh subset and material, the rest is
+    // compared with isCompatible().
+    QHash<std::pair<const void *, const void *>, qsizetype> m_groupIndices;
+    std::vector<Group> m_groups;
+    std::vector<qsizetype> m_groupOf;
+    // Kept between frames, together with their buffers
+    std::vector<std::unique_ptr<QSSGRenderableBatch>> m_batches;
+    qsizetype m_batchCount = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGRENDERABLEBATCH_P_H
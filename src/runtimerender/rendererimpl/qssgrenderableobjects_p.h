@@ -233,6 +233,8 @@ struct QSSGRenderableObject
     const Type type;
     float instancingLodMin = -1;
     float instancingLodMax = -1;
+    // Slot of globalBounds in the layer's renderableBounds, or -1
+    qint32 boundsSlot = -1;
 
     QSSGRenderableObject(Type ty,
                          QSSGRenderableObjectFlags inFlags,
@@ -290,6 +292,16 @@ class QSSGRenderer;
 class QSSGLayerRenderData;
 struct QSSGShadowMapEntry;
 
+// Per-instance data of a renderable drawing several models that share the
+// mesh and the material, see QSSGRenderableBatcher. Laid out like the data
+// of an instance table.
+struct QSSGRenderableBatch
+{
+    QVector<QSSGRenderInstanceTableEntry> instances;
+    QRhiBuffer *buffer = nullptr;
+    bool uploaded = false; // this frame
+};
+
 struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSubsetRenderable : public QSSGRenderableObject
 {
     int reflectionProbeIndex = -1;
@@ -300,6 +312,7 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSubsetRenderable : public QSSGRenderabl
     const QSSGModelContext &modelContext;
     const QSSGRenderSubset &subset;
     QRhiBuffer *instanceBuffer = nullptr;
+    QSSGRenderableBatch *batch = nullptr;
     float opacity;
     const QSSGRenderGraphObject &material;
     QSSGRenderableImage *firstImage;
@@ -309,22 +322,27 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSubsetRenderable : public QSSGRenderabl
     struct {
         // Transient (due to the subsetRenderable being allocated using a
         // per-frame allocator on every frame), not owned refs from the
-        // rhi-prepare step, used by the rhi-render step.
+        // rhi-prepare step, used by the rhi-render step. The uniform data
+        // is in the layer's uniform arena, at the given offsets.
         struct {
             QRhiGraphicsPipeline *pipeline = nullptr;
             QRhiShaderResourceBindings *srb = nullptr;
+            QSSGRhiUniformOffsets uniformOffsets;
         } mainPass;
         struct {
             QRhiGraphicsPipeline *pipeline = nullptr;
             QRhiShaderResourceBindings *srb = nullptr;
+            QSSGRhiUniformOffsets uniformOffsets;
         } depthPrePass;
         struct {
             QRhiGraphicsPipeline *pipeline = nullptr;
             QRhiShaderResourceBindings *srb[6] = {};
+            QSSGRhiUniformOffsets uniformOffsets[6];
         } shadowPass;
         struct {
             QRhiGraphicsPipeline *pipeline = nullptr;
             QRhiShaderResourceBindings *srb[6] = {};
+            QSSGRhiUniformOffsets uniformOffsets[6];
         } reflectionPass;
     } rhiRenderData;
 
@@ -342,6 +360,17 @@ struct Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSubsetRenderable : public QSSGRenderabl
                          const QSSGShaderLightListView &inLights);
 
     [[nodiscard]] const QSSGRenderGraphObject &getMaterial() const { return material; }
+
+    // Either the model's instance table or a batch of models
+    [[nodiscard]] bool usesInstancing() const { return batch || modelContext.model.instancing(); }
+    [[nodiscard]] quint32 instanceCount() const
+    {
+        return batch ? quint32(batch->instances.size()) : quint32(modelContext.model.instanceCount());
+    }
+    [[nodiscard]] quint32 instanceStride() const
+    {
+        return batch ? quint32(sizeof(QSSGRenderInstanceTableEntry)) : quint32(modelContext.model.instanceTable->stride());
+    }
 };
 
 Q_STATIC_ASSERT(std::is_trivially_destructible<QSSGSubsetRenderable>::value);
@@ -0,0 +1,195 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgrenderablesort_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderparticles_p.h>
+
+#include <algorithm>
+#include <array>
+
+QT_BEGIN_NAMESPACE
+
+quint32 QSSGRenderableSorter::pipelineId(const QSSGRenderableObject &obj)
+{
+    std::pair<int, size_t> key(int(obj.type), 0);
+    if (obj.type == QSSGRenderableObject::Type::Particles)
+        key.second = size_t(static_cast<const QSSGParticlesRenderable &>(obj).particles.m_featureLevel);
+    else
+        key.second = static_cast<const QSSGSubsetRenderable &>(obj).shaderDescription.hash();
+
+    auto it = m_pipelineIds.constFind(key);
+    if (it != m_pipelineIds.cend())
+        return it.value();
+
+    // Starting over only costs the order of the groups for a frame
+    if (quint32(m_pipelineIds.size()) > MaxId)
+        m_pipelineIds.clear();
+    const quint32 id = quint32(m_pipelineIds.size());
+    m_pipelineIds.insert(key, id);
+    return id;
+}
+
+quint32 QSSGRenderableSorter::materialId(const QSSGRenderableObject &obj)
+{
+    const void *material = nullptr;
+    if (obj.type == QSSGRenderableObject::Type::Particles)
+        material = &static_cast<const QSSGParticlesRenderable &>(obj).particles;
+    else
+        material = &static_cast<const QSSGSubsetRenderable &>(obj).material;
+
+    auto it = m_materialIds.constFind(material);
+    if (it != m_materialIds.cend())
+        return it.value();
+
+    if (quint32(m_materialIds.size()) > MaxId)
+        m_materialIds.clear();
+    const quint32 id = quint32(m_materialIds.size());
+    m_materialIds.insert(material, id);
+    return id;
+}
+
+QSSGRenderableSorter::Id QSSGRenderableSorter::id(const QSSGRenderableObject &obj) noexcept
+{
+    if (obj.type == QSSGRenderableObject::Type::Particles)
+        return { &static_cast<const QSSGParticlesRenderable &>(obj).particles, nullptr };
+
+    // Models sharing a mesh share the subsets as well
+    const auto &subsetRenderable = static_cast<const QSSGSubsetRenderable &>(obj);
+    return { &subsetRenderable.modelContext.model, &subsetRenderable.subset };
+}
+
+void QSSGRenderableSorter::prepareIds(const QSSGRenderableObjectList &list)
+{
+    m_ids.resize(size_t(list.size()));
+    for (qsizetype i = 0, end = list.size(); i < end; ++i)
+        m_ids[i] = id(*list.at(i).obj);
+}
+
+void QSSGRenderableSorter::sortOpaque(QSSGRenderableObjectList &list, History *history)
+{
+    m_keys.resize(size_t(list.size()));
+    for (qsizetype i = 0, end = list.size(); i < end; ++i) {
+        const QSSGRenderableObjectHandle &handle = list.at(i);
+        m_keys[i] = opaqueKey(pipelineId(*handle.obj), materialId(*handle.obj), handle.cameraDistanceSq);
+    }
+    if (history)
+        prepareIds(list);
+    sort(list, m_keys.data(), history ? m_ids.data() : nullptr, history);
+}
+
+void QSSGRenderableSorter::sortTransparent(QSSGRenderableObjectList &list, History *history)
+{
+    m_keys.resize(size_t(list.size()));
+    for (qsizetype i = 0, end = list.size(); i < end; ++i)
+        m_keys[i] = transparentKey(list.at(i).cameraDistanceSq);
+    if (history)
+        prepareIds(list);
+    sort(list, m_keys.data(), history ? m_ids.data() : nullptr, history);
+}
+
+bool QSSGRenderableSorter::insertionSort(Entry *entries, qsizetype count)
+{
+    qsizetype moves = 0;
+    for (qsizetype i = 1; i < count; ++i) {
+        if (entries[i].key >= entries[i - 1].key)
+            continue;
+        const Entry entry = entries[i];
+        qsizetype j = i;
+        for (; j > 0 && entry.key < entries[j - 1].key; --j)
+            entries[j] = entries[j - 1];
+        entries[j] = entry;
+        moves += i - j;
+        if (moves > count)
+            return false;
+    }
+    return true;
+}
+
+QSSGRenderableSorter::Entry *QSSGRenderableSorter::sortEntries(qsizetype count)
+{
+    Entry *src = m_entries.data();
+    if (count <= MIN_RADIX_SORT_SIZE) {
+        std::stable_sort(src, src + count, [](const Entry &lhs, const Entry &rhs) {
+            return lhs.key < rhs.key;
+        });
+        return src;
+    }
+
+    m_scratch.resize(size_t(count));
+    Entry *dst = m_scratch.data();
+
+    // The histograms of all the bytes are collected in one go
+    std::array<std::array<quint32, 256>, 8> histograms {};
+    for (qsizetype i = 0; i < count; ++i) {
+        const quint64 key = src[i].key;
+        for (int byte = 0; byte < 8; ++byte)
+            ++histograms[byte][(key >> (byte * 8)) & 0xff];
+    }
+
+    for (int byte = 0; byte < 8; ++byte) {
+        const int shift = byte * 8;
+        auto &histogram = histograms[byte];
+        // Bytes that are the same for all the keys, like the unused
+        // upper half of the transparent keys, need no pass
+        if (histogram[(src[0].key >> shift) & 0xff] == quint32(count))
+            continue;
+
+        quint32 offset = 0;
+        for (quint32 &bucket : histogram) {
+            const quint32 size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (qsizetype i = 0; i < count; ++i)
+            dst[histogram[(src[i].key >> shift) & 0xff]++] = src[i];
+        std::swap(src, dst);
+    }
+
+    return src;
+}
+
+void QSSGRenderableSorter::sort(QSSGRenderableObjectList &list, const quint64 *keys, const Id *ids, History *history)
+{
+    const qsizetype count = list.size();
+    if (!ids)
+        history = nullptr;
+    if (count < 2) {
+        if (history)
+            history->reset();
+        return;
+    }
+
+    m_entries.resize(size_t(count));
+    Entry *sorted = nullptr;
+
+    // Only the same renderables in the same order can reuse the old order
+    const bool coherent = history && history->ids.size() == size_t(count)
+            && std::equal(ids, ids + count, history->ids.cbegin());
+    if (coherent) {
+        for (qsizetype i = 0; i < count; ++i) {
+            const quint32 index = history->order[i];
+            m_entries[i] = { keys[index], list.at(index), index };
+        }
+        sorted = m_entries.data();
+        if (!insertionSort(sorted, count))
+            sorted = sortEntries(count);
+    } else {
+        for (qsizetype i = 0; i < count; ++i)
+            m_entries[i] = { keys[i], list.at(i), quint32(i) };
+        sorted = sortEntries(count);
+        if (history)
+            history->ids.assign(ids, ids + count);
+    }
+
+    for (qsizetype i = 0; i < count; ++i)
+        list[i] = sorted[i].handle;
+
+    if (history) {
+        history->order.resize(size_t(count));
+        for (qsizetype i = 0; i < count; ++i)
+            history->order[i] = sorted[i].index;
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,128 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGRENDERABLESORT_P_H
+#define QSSGRENDERABLESORT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+
+#include <QtCore/qhash.h>
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+// Sorts the renderable lists by 64-bit keys with a stable LSD radix sort.
+//
+// Opaque objects are grouped by their shader pipeline and material, so that
+// consecutive draws share as much state as possible, and are front to back
+// within a group. The depth is the least significant part of the key:
+//
+//   | pipeline id (16) | material id (16) | depth (32) |
+//
+// Transparent objects only have the depth, back to front. The ids are dense
+// and kept between frames, so that the order of the groups is stable.
+//
+// With a History, a list that has the same renderables as in the previous
+// frame starts out in the previous order and is fixed up with an insertion
+// sort. With a slow moving camera, or none at all, that is close to a single
+// pass over the keys. Too much disorder falls back to a full sort.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGRenderableSorter
+{
+public:
+    static constexpr int IdBits = 16;
+    static constexpr quint32 MaxId = (1u << IdBits) - 1;
+
+    // Maps the float to an unsigned integer with the same order
+    [[nodiscard]] static quint32 depthKey(float distance) noexcept
+    {
+        quint32 bits;
+        std::memcpy(&bits, &distance, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    [[nodiscard]] static quint64 opaqueKey(quint32 pipelineId, quint32 materialId, float distance) noexcept
+    {
+        return (quint64(pipelineId & MaxId) << (32 + IdBits)) | (quint64(materialId & MaxId) << 32) | depthKey(distance);
+    }
+
+    [[nodiscard]] static quint64 transparentKey(float distance) noexcept
+    {
+        return quint64(~depthKey(distance));
+    }
+
+    // Identifies a renderable across frames, unlike the renderable objects
+    // themselves, which are allocated per frame.
+    using Id = std::pair<const void *, const void *>;
+
+    [[nodiscard]] static Id id(const QSSGRenderableObject &obj) noexcept;
+
+    // The order of a list in the previous frame
+    struct History
+    {
+        std::vector<Id> ids; // in the order of the unsorted list
+        std::vector<quint32> order; // indices into ids, sorted
+
+        void reset()
+        {
+            ids.clear();
+            order.clear();
+        }
+    };
+
+    // Nearest to furthest, grouped by pipeline and material
+    void sortOpaque(QSSGRenderableObjectList &list, History *history = nullptr);
+    // Furthest to nearest
+    void sortTransparent(QSSGRenderableObjectList &list, History *history = nullptr);
+    // Sorts list by the ascending keys, one per entry. Without a history,
+    // entries with equal keys keep their order. The history is only used
+    // together with the ids of the entries.
+    void sort(QSSGRenderableObjectList &list, const quint64 *keys, const Id *ids = nullptr, History *history = nullptr);
+
+private:
+    // Lists up to this size are sorted with std::stable_sort
+    static constexpr qsizetype MIN_RADIX_SORT_SIZE = 64;
+
+    struct Entry
+    {
+        quint64 key;
+        QSSGRenderableObjectHandle handle;
+        quint32 index; // in the unsorted list
+    };
+
+    quint32 pipelineId(const QSSGRenderableObject &obj);
+    quint32 materialId(const QSSGRenderableObject &obj);
+    void prepareIds(const QSSGRenderableObjectList &list);
+    // Returns the sorted entries, either m_entries or m_scratch
+    Entry *sortEntries(qsizetype count);
+    // Gives up, leaving the entries partially sorted, once there were more
+    // moves than entries.
+    static bool insertionSort(Entry *entries, qsizetype count);
+
+    // Pipelines are identified by the renderable type and the hash of
+    // the shader key. Hash collisions only merge groups.
+    QHash<std::pair<int, size_t>, quint32> m_pipelineIds;
+    QHash<const void *, quint32> m_materialIds;
+    std::vector<quint64> m_keys;
+    std::vector<Id> m_ids;
+    std::vector<Entry> m_entries;
+    std::vector<Entry> m_scratch;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGRENDERABLESORT_P_H
@@ -14,10 +14,13 @@
 #include <QtQuick3DRuntimeRender/private/qssgrhicustommaterialsystem_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendershadercodegenerator_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderdefaultmaterialshadergenerator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgperframeallocator_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrhiquadrenderer_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendertexturedata_p.h>
 #include <QtQuick3DRuntimeRender/private/qssglayerrenderdata_p.h>
+#include <QtQuick3DRuntimeRender/private/qssginstancebvh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgpicksnapshot_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrhiparticles_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgvertexpipelineimpl_p.h>
 #include "../qssgshadermapkey_p.h"
@@ -174,11 +177,17 @@ void QSSGRenderer::cleanupUnreferencedBuffers(QSSGRenderLayer *inLayer)
 {
     // Now check for unreferenced buffers and release them if necessary
     m_contextInterface->bufferManager()->cleanupUnreferencedBuffers(m_frameCount, inLayer);
+    // and for the srbs, pipelines, etc. nothing has used for a while
+    QSSGRhiContextPrivate::get(*m_contextInterface->rhiContext()).releaseUnusedResources(m_frameCount);
 }
 
 void QSSGRenderer::resetResourceCounters(QSSGRenderLayer *inLayer)
 {
-    m_contextInterface->bufferManager()->resetUsageCounters(m_frameCount, inLayer);
+    const auto &bufferManager = m_contextInterface->bufferManager();
+    bufferManager->resetUsageCounters(m_frameCount, inLayer);
+    QSSGRhiContextPrivate::get(*m_contextInterface->rhiContext()).setCurrentFrame(m_frameCount);
+    // Before anything in the frame gets the streamed textures
+    bufferManager->streamImages(m_frameCount);
 }
 
 bool QSSGRenderer::prepareLayerForRender(QSSGRenderLayer &inLayer)
@@ -212,10 +221,15 @@ void QSSGRenderer::rhiPrepare(QSSGRenderLayer &inLayer)
         const auto &activePasses = theRenderData->activePasses;
         for (const auto &pass : activePasses) {
             pass->renderPrep(*this, *theRenderData);
+            // Standalone passes render right away, the uniform data has to be
+            // in the buffers before that.
+            theRenderData->uniformArena.flush();
             if (pass->passType() == QSSGRenderPass::Type::Standalone)
                 pass->renderPass(*this);
         }
 
+        QSSGRHICTX_STAT(rhiCtx, uniformArenaUsage(theRenderData->uniformArena.usedSize(), theRenderData->uniformArena.capacity()));
+
         endLayerRender();
     }
 }
@@ -303,21 +317,37 @@ QSSGRhiShaderPipelinePtr QSSGRendererPrivate::generateRhiShaderPipelineImpl(QSSG
                                                                             const QSSGShaderFeatures &featureSet,
                                                                             QByteArray &shaderString)
 {
-    shaderString = logPrefix();
     QSSGShaderDefaultMaterialKey theKey(renderable.shaderDescription);
 
+    // Check the in-memory, per-QSSGShaderCache (and so per-QQuickWindow)
+    // runtime cache. That may get cleared upon an explicit call to
+    // QQuickWindow::releaseResources(), but will otherwise store all
+    // encountered shader pipelines in any View3D in the window. The binary
+    // key avoids building the string when the shaders are there already.
+    const QSSGShaderMaterialKey materialKey(theKey, featureSet);
+    if (const auto &maybePipeline = shaderCache.tryGetRhiShaderPipeline(materialKey, shaderString))
+        return maybePipeline;
+
     // This is not a cheap operation. This function assumes that it will not be
     // hit for every material for every model in every frame (except of course
     // for materials that got changed). In practice this is ensured by the
     // cheaper-to-lookup cache in getShaderPipelineForDefaultMaterial().
+    shaderString = logPrefix();
     theKey.toString(shaderString, shaderKeyProperties);
 
-    // Check the in-memory, per-QSSGShaderCache (and so per-QQuickWindow)
-    // runtime cache. That may get cleared upon an explicit call to
-    // QQuickWindow::releaseResources(), but will otherwise store all
-    // encountered shader pipelines in any View3D in the window.
+    const auto remember = [&](const QSSGRhiShaderPipelinePtr &pipeline) {
+        if (pipeline)
+            shaderCache.insertRhiShaderPipeline(materialKey, shaderString, pipeline);
+        return pipeline;
+    };
+
+    // Shaders compiled on a worker thread are only cached by their string key.
     if (const auto &maybePipeline = shaderCache.tryGetRhiShaderPipeline(shaderString, featureSet))
-        return maybePipeline;
+        return remember(maybePipeline);
+
+    // Being compiled on a worker thread, nothing to do until that is done.
+    if (shaderCache.isCompiling(shaderString, featureSet))
+        return {};
 
     // Check if there's a pre-built (offline generated) shader for available.
     const QByteArray qsbcKey = QQsbCollection::EntryDesc::generateSha(shaderString, QQsbCollection::toFeatureSet(featureSet));
@@ -325,12 +355,12 @@ QSSGRhiShaderPipelinePtr QSSGRendererPrivate::generateRhiShaderPipelineImpl(QSSG
     if (!pregenEntries.isEmpty()) {
         const auto foundIt = pregenEntries.constFind(QQsbCollection::Entry(qsbcKey));
         if (foundIt != pregenEntries.cend())
-            return shaderCache.newPipelineFromPregenerated(shaderString, featureSet, *foundIt, renderable.material);
+            return remember(shaderCache.newPipelineFromPregenerated(shaderString, featureSet, *foundIt, renderable.material));
     }
 
     // Try the persistent (disk-based) cache then.
     if (const auto &maybePipeline = shaderCache.tryNewPipelineFromPersistentCache(qsbcKey, shaderString, featureSet))
-        return maybePipeline;
+        return remember(maybePipeline);
 
     // Otherwise, build new shader code and run the resulting shaders through
     // the shader conditioning pipeline.
@@ -339,16 +369,16 @@ QSSGRhiShaderPipelinePtr QSSGRendererPrivate::generateRhiShaderPipelineImpl(QSSG
                                               shaderKeyProperties,
                                               material.adapter);
 
-    return QSSGMaterialShaderGenerator::generateMaterialRhiShader(logPrefix(),
-                                                                  vertexPipeline,
-                                                                  renderable.shaderDescription,
-                                                                  shaderKeyProperties,
-                                                                  featureSet,
-                                                                  renderable.material,
-                                                                  renderable.lights,
-                                                                  renderable.firstImage,
-                                                                  shaderLibraryManager,
-                                                                  shaderCache);
+    return remember(QSSGMaterialShaderGenerator::generateMaterialRhiShader(logPrefix(),
+                                                                           vertexPipeline,
+                                                                           renderable.shaderDescription,
+                                                                           shaderKeyProperties,
+                                                                           featureSet,
+                                                                           renderable.material,
+                                                                           renderable.lights,
+                                                                           renderable.firstImage,
+                                                                           shaderLibraryManager,
+                                                                           shaderCache));
 }
 
 QSSGRhiShaderPipelinePtr QSSGRendererPrivate::generateRhiShaderPipeline(QSSGRenderer &renderer,
@@ -371,6 +401,8 @@ void QSSGRenderer::beginFrame(QSSGRenderLayer &layer, bool allowRecursion)
         m_contextInterface->perFrameAllocator()->reset();
         QSSGRHICTX_STAT(m_contextInterface->rhiContext().get(), start(&layer));
         resetResourceCounters(&layer);
+        // Pick up the shaders that finished compiling in the background
+        m_contextInterface->shaderCache()->collectCompiledShaders();
     }
 }
 
@@ -450,6 +482,25 @@ QSSGRenderPickResult QSSGRendererPrivate::syncPick(const QSSGRenderContextInterf
     return QSSGPickResultProcessResult();
 }
 
+QVector<QSSGRenderPickResult> QSSGRendererPrivate::syncPickBatch(const QSSGRenderContextInterface &ctx,
+                                                                 const QSSGRenderLayer &layer,
+                                                                 const QVector<QSSGRenderRay> &rays)
+{
+    const auto &bufferManager = ctx.bufferManager();
+    const bool isGlobalPickingEnabled = QSSGRendererPrivate::isGlobalPickingEnabled(*ctx.renderer());
+
+    Q_ASSERT(layer.getGlobalState(QSSGRenderNode::GlobalState::Active));
+    QVector<QSSGRenderPickResult> pickResults(rays.size());
+    if (rays.isEmpty())
+        return pickResults;
+
+    // The scene is only read while taking the snapshot, the rays are traced
+    // against the snapshot on the worker threads
+    const auto snapshot = QSSGPickSnapshot::create(*bufferManager, layer, isGlobalPickingEnabled);
+    snapshot->pickParallel(rays.constData(), rays.size(), pickResults.data());
+    return pickResults;
+}
+
 
 
 void QSSGRendererPrivate::setGlobalPickingEnabled(QSSGRenderer &renderer, bool isEnabled)
@@ -508,7 +559,34 @@ void QSSGRendererPrivate::getLayerHitObjectList(const QSSGRenderLayer &layer,
     for (const auto &childNode : layer.children)
         dfs(childNode, renderables);
 
+    // Static models with bounds not hit by the ray can be skipped before
+    // looking up their mesh. The scene BVH is only trusted for nodes that
+    // haven't changed since it was last updated on the render thread, which
+    // the serial tells also when another layer recalculated the node.
+    QBitArray skip;
+    if (const QSSGLayerRenderData *renderData = layer.renderData) {
+        const QSSGSceneBVH &sceneBVH = renderData->sceneBVH;
+        QMutexLocker bvhLocker(sceneBVH.updateMutex());
+        if (sceneBVH.isValid() && sceneBVH.primitiveCount() > 0) {
+            QBitArray hits;
+            sceneBVH.intersectRay(ray, hits);
+            skip.resize(renderables.size());
+            for (int idx = 0, end = renderables.size(); idx != end; ++idx) {
+                const auto &node = *renderables.at(idx);
+                if (node.type != QSSGRenderGraphObject::Type::Model || node.isDirty(QSSGRenderNode::DirtyFlag::GlobalValuesDirty))
+                    continue;
+                const qint32 primitive = sceneBVH.primitiveIndexForPicking(node);
+                if (primitive >= 0 && !hits.testBit(primitive)
+                        && sceneBVH.primitiveTransformSerial(primitive) == node.globalTransformSerial
+                        && static_cast<const QSSGRenderModel &>(node).meshPath == sceneBVH.primitiveMeshPath(primitive))
+                    skip.setBit(idx);
+            }
+        }
+    }
+
     for (int idx = renderables.size() - 1; idx >= 0; --idx) {
+        if (!skip.isEmpty() && skip.testBit(idx))
+            continue;
         const auto &pickableObject = renderables.at(idx);
         if (inPickEverything || pickableObject->getLocalState(QSSGRenderNode::LocalState::Pickable))
             intersectRayWithSubsetRenderable(bufferManager, ray, *pickableObject, outIntersectionResult);
@@ -532,88 +610,43 @@ void QSSGRendererPrivate::intersectRayWithSubsetRenderable(QSSGBufferManager &bu
 
     const QSSGRenderModel &model = static_cast<const QSSGRenderModel &>(node);
 
-    // We have to have a guard here, as the meshes are usually loaded on the render thread,
-    // and we assume all meshes are loaded before picking and none are removed, which
-    // is usually true, except for custom geometry which can be updated at any time. So this
-    // guard should really only be locked whenever a custom geometry buffer is being updated
-    // on the render thread.  Still naughty though because this can block the render thread.
-    QMutexLocker mutexLocker(bufferManager.meshUpdateMutex());
-    auto mesh = bufferManager.getMeshForPicking(model);
-    if (!mesh)
+    // The picking data is shared with the buffer manager, so the mesh update
+    // mutex is only locked for meshes that were loaded after the picking data
+    // was last published at the end of a frame.
+    const auto meshData = bufferManager.getMeshPickingData(model);
+    if (!meshData || meshData->bounds.isEmpty())
         return;
 
-    const auto &subMeshes = mesh->subsets;
-    QSSGBounds3 modelBounds;
-    for (const auto &subMesh : subMeshes)
-        modelBounds.include(subMesh.bounds);
+    const auto appendResult = [&](const QSSGRenderRay::IntersectionResult &result, int subset, int instanceIndex) {
+        outIntersectionResultList.push_back(QSSGRenderPickResult { &model,
+                                                                   result.rayLengthSquared,
+                                                                   result.relXY,
+                                                                   result.scenePosition,
+                                                                   result.localPosition,
+                                                                   result.faceNormal,
+                                                                   subset,
+                                                                   instanceIndex
+                                            });
+    };
 
-    if (modelBounds.isEmpty())
+    QSSGRenderRay::IntersectionResult intersectionResult;
+    int resultSubset = 0;
+    if (!model.instancing()) { // && instancePickingEnabled
+        if (QSSGPickSnapshot::intersectRayWithMesh(inRay, model.globalTransform, *meshData, intersectionResult, resultSubset))
+            appendResult(intersectionResult, resultSubset, 0);
         return;
+    }
 
-    const bool instancing = model.instancing(); // && instancePickingEnabled
-    int instanceCount = instancing ? model.instanceTable->count() : 1;
-
-    for (int instanceIndex = 0; instanceIndex < instanceCount; ++instanceIndex) {
-
-        QMatrix4x4 modelTransform;
-        if (instancing) {
-            modelTransform = model.globalInstanceTransform * model.instanceTable->getTransform(instanceIndex) * model.localInstanceTransform;
-        } else {
-            modelTransform = model.globalTransform;
-        }
-        auto rayData = QSSGRenderRay::createRayData(modelTransform, inRay);
-
-        auto hit = QSSGRenderRay::intersectWithAABBv2(rayData, modelBounds);
-
-        // If we don't intersect with the model at all, then there's no need to go furher down!
-        if (!hit.intersects())
-            continue;
-
-        // Check each submesh to find the closest intersection point
-        float minRayLength = std::numeric_limits<float>::max();
-        QSSGRenderRay::IntersectionResult intersectionResult;
-        QVector<QSSGRenderRay::IntersectionResult> results;
-
-        int subset = 0;
-        int resultSubset = 0;
-        for (const auto &subMesh : subMeshes) {
-            QSSGRenderRay::IntersectionResult result;
-            if (!subMesh.bvhRoot.isNull()) {
-                hit = QSSGRenderRay::intersectWithAABBv2(rayData, subMesh.bvhRoot->boundingData);
-                if (hit.intersects()) {
-                    results.clear();
-                    inRay.intersectWithBVH(rayData, static_cast<const QSSGMeshBVHNode *>(subMesh.bvhRoot), mesh, results);
-                    float subMeshMinRayLength = std::numeric_limits<float>::max();
-                    for (const auto &subMeshResult : std::as_const(results)) {
-                        if (subMeshResult.rayLengthSquared < subMeshMinRayLength) {
-                            result = subMeshResult;
-                            subMeshMinRayLength = result.rayLengthSquared;
-                        }
-                    }
-                }
-            } else {
-                hit = QSSGRenderRay::intersectWithAABBv2(rayData, subMesh.bounds);
-                if (hit.intersects())
-                    result = QSSGRenderRay::createIntersectionResult(rayData, hit);
-            }
-            if (result.intersects && result.rayLengthSquared < minRayLength) {
-                intersectionResult = result;
-                minRayLength = intersectionResult.rayLengthSquared;
-                resultSubset = subset;
-            }
-            subset++;
-        }
-
-        if (intersectionResult.intersects)
-            outIntersectionResultList.push_back(QSSGRenderPickResult { &model,
-                                                                       intersectionResult.rayLengthSquared,
-                                                                       intersectionResult.relXY,
-                                                                       intersectionResult.scenePosition,
-                                                                       intersectionResult.localPosition,
-                                                                       intersectionResult.faceNormal,
-                                                                       resultSubset,
-                                                                       instanceIndex
-                                                });
+    // Only the instances with bounds hit by the ray need a closer look
+    const auto instanceBVH = QSSGInstanceBVH::forModel(model, meshData->bounds);
+    if (!instanceBVH)
+        return;
+    QVector<qint32> hitInstances;
+    instanceBVH->intersectRay(QSSGRenderRay::createRayData(model.globalInstanceTransform, inRay), hitInstances);
+    for (const qint32 instanceIndex : std::as_const(hitInstances)) {
+        const QMatrix4x4 modelTransform = model.globalInstanceTransform * instanceBVH->instanceTransform(instanceIndex);
+        if (QSSGPickSnapshot::intersectRayWithMesh(inRay, modelTransform, *meshData, intersectionResult, resultSubset))
+            appendResult(intersectionResult, resultSubset, instanceIndex);
     }
 }
 
@@ -665,19 +698,25 @@ QSSGRhiShaderPipelinePtr QSSGRendererPrivate::getShaderPipelineForDefaultMateria
 
     QSSGRhiShaderPipelinePtr shaderPipeline;
 
-    // This just references inFeatureSet and inRenderable.shaderDescription -
-    // cheap to construct and is good enough for the find()
-    QSSGShaderMapKey skey = QSSGShaderMapKey(QByteArray(),
-                                             inFeatureSet,
-                                             inRenderable.shaderDescription);
+    // A copy of inFeatureSet and inRenderable.shaderDescription, a few dozen
+    // bytes, cheap to construct, hash and compare
+    const QSSGShaderMapKey skey = QSSGShaderMapKey(QByteArray(),
+                                                   inFeatureSet,
+                                                   inRenderable.shaderDescription);
     auto it = shaderMap.find(skey);
     if (it == shaderMap.end()) {
         Q_TRACE_SCOPE(QSSG_generateShader);
         Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DGenerateShader);
-        shaderPipeline = QSSGRendererPrivate::generateRhiShaderPipeline(renderer, inRenderable, inFeatureSet);
+        const auto &shaderCache = renderer.m_contextInterface->shaderCache();
+        {
+            const bool async = m_currentLayer->layer.shaderCompilationMode == QSSGRenderLayer::ShaderCompilationMode::Asynchronous;
+            QSSGShaderCache::AsynchronousScope asyncScope(*shaderCache, async || shaderCache->asynchronousCompilation());
+            shaderPipeline = QSSGRendererPrivate::generateRhiShaderPipeline(renderer, inRenderable, inFeatureSet);
+        }
         Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DGenerateShader, 0, inRenderable.material.profilingId);
-        // make skey useable as a key for the QHash (makes a copy of the materialKey, instead of just referencing)
-        skey.detach();
+        // The renderable is skipped in this frame, ask again in the next one
+        if (!shaderPipeline && shaderCache->isCompiling(renderer.m_generatedShaderString, inFeatureSet))
+            return {};
         // insert it no matter what, no point in trying over and over again
         shaderMap.insert(skey, shaderPipeline);
     } else {
@@ -697,4 +736,54 @@ QSSGRhiShaderPipelinePtr QSSGRendererPrivate::getShaderPipelineForDefaultMateria
     return shaderPipeline;
 }
 
+void QSSGRendererPrivate::precompileShaders(QSSGRenderer &renderer, QSSGRenderLayer &layer)
+{
+    QSSGLayerRenderData *renderData = layer.renderData;
+    if (!renderData || !renderData->camera || !renderData->layerPrepResult.isLayerVisible())
+        return;
+
+    const auto &shaderCache = renderer.m_contextInterface->shaderCache();
+    const auto &customMaterialSystem = renderer.m_contextInterface->customMaterialSystem();
+    const auto &keyProperties = renderData->getDefaultMaterialPropertyTable();
+    const QSSGShaderFeatures layerFeatures = renderData->getShaderFeatures();
+
+    // Request the shaders of the main pass the same way the passes do, but
+    // with the compilation going to the worker threads. Everything that is
+    // not in the cache yet gets baked in parallel, then we wait for it.
+    renderer.beginLayerRender(*renderData);
+    {
+        QSSGShaderCache::AsynchronousScope asyncScope(*shaderCache, true);
+        const QSSGRenderableObjectList *lists[] = { &renderData->getSortedOpaqueRenderableObjects(),
+                                                    &renderData->getSortedTransparentRenderableObjects(),
+                                                    &renderData->getSortedScreenTextureRenderableObjects() };
+        for (const QSSGRenderableObjectList *list : lists) {
+            for (const QSSGRenderableObjectHandle &handle : *list) {
+                QSSGRenderableObject *obj = handle.obj;
+                if (obj->type != QSSGRenderableObject::Type::DefaultMaterialMeshSubset
+                        && obj->type != QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
+                    continue;
+                }
+                auto &subsetRenderable = static_cast<QSSGSubsetRenderable &>(*obj);
+                QSSGShaderFeatures features = layerFeatures;
+                if (subsetRenderable.reflectionProbeIndex >= 0 && subsetRenderable.renderableFlags.testFlag(QSSGRenderableObjectFlag::ReceivesReflections))
+                    features.set(QSSGShaderFeatures::Feature::ReflectionProbe, true);
+                if (subsetRenderable.renderableFlags.rendersWithLightmap())
+                    features.set(QSSGShaderFeatures::Feature::Lightmap, true);
+
+                if (obj->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset) {
+                    getShaderPipelineForDefaultMaterial(renderer, subsetRenderable, features);
+                } else {
+                    const auto &material = static_cast<const QSSGRenderCustomMaterial &>(subsetRenderable.getMaterial());
+                    features.set(QSSGShaderFeatures::Feature::LightProbe, layer.lightProbe || material.m_iblProbe);
+                    QSSGRhiGraphicsPipelineState ps;
+                    customMaterialSystem->shadersForCustomMaterial(&ps, material, subsetRenderable, keyProperties, features);
+                }
+            }
+        }
+    }
+    renderer.endLayerRender();
+
+    shaderCache->waitForPendingCompilations();
+}
+
 QT_END_NAMESPACE
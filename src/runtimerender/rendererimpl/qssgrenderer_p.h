@@ -54,6 +54,10 @@ public:
                                                                         QSSGSubsetRenderable &inRenderable,
                                                                         const QSSGShaderFeatures &inFeatureSet);
 
+    // Compiles the shaders the main pass of the layer will need on worker
+    // threads and waits for them. Called after prepareLayerForRender().
+    static void precompileShaders(QSSGRenderer &renderer, QSSGRenderLayer &layer);
+
     static void getLayerHitObjectList(const QSSGRenderLayer &layer,
                                       QSSGBufferManager &bufferManager,
                                       const QSSGRenderRay &ray,
@@ -76,6 +80,12 @@ public:
                                          const QSSGRenderRay &ray,
                                          QSSGRenderNode *target = nullptr);
 
+    // The closest hit of each ray, picked against a snapshot of the layer
+    // with the rays spread over the global thread pool, see QSSGPickSnapshot
+    static QVector<QSSGRenderPickResult> syncPickBatch(const QSSGRenderContextInterface &ctx,
+                                                       const QSSGRenderLayer &layer,
+                                                       const QVector<QSSGRenderRay> &rays);
+
     // Setting this true enables picking for all the models, regardless of
     // the models pickable property.
     static bool isGlobalPickingEnabled(const QSSGRenderer &renderer) { return renderer.m_globalPickingEnabled; }
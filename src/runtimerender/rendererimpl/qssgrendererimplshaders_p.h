@@ -6,6 +6,8 @@
 
 #include <QtCore/qbytearray.h>
 
+#include <optional>
+
 #include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderglobal_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgrhicontext_p.h>
@@ -35,6 +37,7 @@ class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGBuiltInRhiShaderCache
     QSSGRhiShaderPipelinePtr m_cubemapShadowBlurXRhiShader;
     QSSGRhiShaderPipelinePtr m_cubemapShadowBlurYRhiShader;
     QSSGRhiShaderPipelinePtr m_gridShader;
+    QSSGRhiShaderPipelinePtr m_hiZDownsampleRhiShader;
     QSSGRhiShaderPipelinePtr m_orthographicShadowBlurXRhiShader;
     QSSGRhiShaderPipelinePtr m_orthographicShadowBlurYRhiShader;
     QSSGRhiShaderPipelinePtr m_ssaoRhiShader;
@@ -67,7 +70,12 @@ class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGBuiltInRhiShaderCache
     QSSGRhiShaderPipelinePtr m_lineParticlesMappedVLightRhiShader;
     QSSGRhiShaderPipelinePtr m_lineParticlesAnimatedVLightRhiShader;
 
+    // Compute shaders, set once loading has been attempted
+    std::optional<QShader> m_particleSimulateShader;
+    std::optional<QShader> m_particleSortShader;
+
     QSSGRhiShaderPipelinePtr getBuiltinRhiShader(const QByteArray &name, QSSGRhiShaderPipelinePtr &storage);
+    QShader getBuiltinRhiComputeShader(const QByteArray &name, std::optional<QShader> &storage);
 
     QSSGShaderCache &m_shaderCache; // We're owned by the shadercache
     explicit QSSGBuiltInRhiShaderCache(QSSGShaderCache &shaderCache)
@@ -86,6 +94,7 @@ public:
     QSSGRhiShaderPipelinePtr getRhiCubemapShadowBlurXShader();
     QSSGRhiShaderPipelinePtr getRhiCubemapShadowBlurYShader();
     QSSGRhiShaderPipelinePtr getRhiGridShader();
+    QSSGRhiShaderPipelinePtr getRhiHiZDownsampleShader();
     QSSGRhiShaderPipelinePtr getRhiOrthographicShadowBlurXShader();
     QSSGRhiShaderPipelinePtr getRhiOrthographicShadowBlurYShader();
     QSSGRhiShaderPipelinePtr getRhiSsaoShader();
@@ -102,6 +111,10 @@ public:
     QSSGRhiShaderPipelinePtr getRhiReflectionprobePreFilterShader();
     QSSGRhiShaderPipelinePtr getRhienvironmentmapPreFilterShader(bool isRGBE);
     QSSGRhiShaderPipelinePtr getRhiEnvironmentmapShader();
+
+    // Compute shaders, invalid if loading failed
+    QShader getRhiParticleSimulateShader();
+    QShader getRhiParticleSortShader();
 };
 
 QT_END_NAMESPACE
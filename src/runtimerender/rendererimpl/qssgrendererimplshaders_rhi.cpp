@@ -13,6 +13,8 @@
 #include <QtQuick3DRuntimeRender/private/qssgrenderdefaultmaterialshadergenerator_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgvertexpipelineimpl_p.h>
 
+#include <QtCore/qfile.h>
+
 // this file contains the getXxxxShader implementations suitable for the QRhi-based rendering path
 
 QT_BEGIN_NAMESPACE
@@ -29,6 +31,21 @@ QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getBuiltinRhiShader(const QB
     return result;
 }
 
+QShader QSSGBuiltInRhiShaderCache::getBuiltinRhiComputeShader(const QByteArray &name,
+                                                              std::optional<QShader> &storage)
+{
+    if (!storage) {
+        QFile f(QString::fromUtf8(QSSGShaderCache::resourceFolder() + name + QByteArrayLiteral(".comp.qsb")));
+        if (f.open(QIODevice::ReadOnly))
+            storage = QShader::fromSerialized(f.readAll());
+        else
+            storage = QShader();
+        if (!storage->isValid())
+            qWarning("Failed to load compute shader %s", name.constData());
+    }
+    return *storage;
+}
+
 QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiCubemapShadowBlurXShader()
 {
     return getBuiltinRhiShader(QByteArrayLiteral("cubeshadowblurx"), m_cubemapShadowBlurXRhiShader);
@@ -44,6 +61,11 @@ QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiGridShader()
     return getBuiltinRhiShader(QByteArrayLiteral("grid"), m_gridShader);
 }
 
+QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiHiZDownsampleShader()
+{
+    return getBuiltinRhiShader(QByteArrayLiteral("hizdownsample"), m_hiZDownsampleRhiShader);
+}
+
 QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiOrthographicShadowBlurXShader()
 {
     return getBuiltinRhiShader(QByteArrayLiteral("orthoshadowblurx"), m_orthographicShadowBlurXRhiShader);
@@ -159,6 +181,16 @@ QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiParticleShader(QSSGRen
     return getBuiltinRhiShader(QByteArrayLiteral("particlesnolightanimated"), m_particlesNoLightingAnimatedRhiShader);
 }
 
+QShader QSSGBuiltInRhiShaderCache::getRhiParticleSimulateShader()
+{
+    return getBuiltinRhiComputeShader(QByteArrayLiteral("particlesimulate"), m_particleSimulateShader);
+}
+
+QShader QSSGBuiltInRhiShaderCache::getRhiParticleSortShader()
+{
+    return getBuiltinRhiComputeShader(QByteArrayLiteral("particlesort"), m_particleSortShader);
+}
+
 QSSGRhiShaderPipelinePtr QSSGBuiltInRhiShaderCache::getRhiSimpleQuadShader()
 {
     return getBuiltinRhiShader(QByteArrayLiteral("simplequad"), m_simpleQuadRhiShader);
@@ -64,8 +64,10 @@ static void updateUniformsForDefaultMaterial(QSSGRhiShaderPipeline &shaderPipeli
     const auto &modelNode = subsetRenderable.modelContext.model;
     QRhiTexture *lightmapTexture = inData.getLightmapTexture(subsetRenderable.modelContext);
 
-    const QMatrix4x4 &localInstanceTransform(modelNode.localInstanceTransform);
-    const QMatrix4x4 &globalInstanceTransform(modelNode.globalInstanceTransform);
+    // Batched models have their whole global transform in the instance data
+    const QMatrix4x4 identity;
+    const QMatrix4x4 &localInstanceTransform(subsetRenderable.batch ? identity : modelNode.localInstanceTransform);
+    const QMatrix4x4 &globalInstanceTransform(subsetRenderable.batch ? identity : modelNode.globalInstanceTransform);
     const QMatrix4x4 &modelMatrix(modelNode.usesBoneTexture() ? QMatrix4x4() : subsetRenderable.globalTransform);
 
     QSSGMaterialShaderGenerator::setRhiMaterialProperties(*renderer->contextInterface(),
@@ -444,7 +446,7 @@ static int setupInstancing(QSSGSubsetRenderable *renderable, QSSGRhiGraphicsPipe
     int instanceBufferBinding = 0;
     if (instancing) {
         // set up new bindings for instanced buffers
-        const quint32 stride = renderable->modelContext.model.instanceTable->stride();
+        const quint32 stride = renderable->instanceStride();
         QVarLengthArray<QRhiVertexInputBinding, 8> bindings;
         std::copy(ps->ia.inputLayout.cbeginBindings(), ps->ia.inputLayout.cendBindings(), std::back_inserter(bindings));
         bindings.append({ stride, QRhiVertexInputBinding::PerInstance });
@@ -469,6 +471,8 @@ static void rhiPrepareResourcesForReflectionMap(QSSGRhiContext *rhiCtx,
     if ((inData.layer.background == QSSGRenderLayer::Background::SkyBox && inData.layer.lightProbe) ||
          inData.layer.background == QSSGRenderLayer::Background::SkyBoxCubeMap)
         rhiPrepareSkyBoxForReflectionMap(rhiCtx, passKey, inData.layer, inCamera, renderer, pEntry, cubeFace);
+    else // Don't leave an srb of an earlier frame around, it may have been released since
+        pEntry->m_skyBoxSrbs[QSSGBaseTypeHelpers::indexOfCubeFace(cubeFace)] = nullptr;
 
     QSSGShaderFeatures features = inData.getShaderFeatures();
     const auto &defaultMaterialShaderKeyProperties = inData.getDefaultMaterialPropertyTable();
@@ -517,7 +521,6 @@ static inline void addDepthTextureBindings(QSSGRhiContext *rhiCtx,
 
 static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
                                             const QSSGLayerRenderData &inData,
-                                            QSSGPassKey passKey,
                                             QSSGShadowMapEntry *pEntry,
                                             QSSGRhiGraphicsPipelineState *ps,
                                             const QVector2D *depthAdjust,
@@ -544,20 +547,17 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
         if (isOpaqueDepthPrePass)
             objectFeatureSet.set(QSSGShaderFeatures::Feature::OpaqueDepthPrePass, true);
 
-        QSSGRhiDrawCallData *dcd = nullptr;
         QMatrix4x4 modelViewProjection;
         QSSGSubsetRenderable &renderable(static_cast<QSSGSubsetRenderable &>(*theObject));
         if (theObject->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset || theObject->type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
             const bool hasSkinning = defaultMaterialShaderKeyProperties.m_boneCount.getValue(renderable.shaderDescription) > 0;
             modelViewProjection = hasSkinning ? pEntry->m_lightVP
                                               : pEntry->m_lightVP * renderable.globalTransform;
-            const quintptr entryIdx = quintptr(cubeFace != QSSGRenderTextureCubeFaceNone) * (cubeFaceIdx + (quintptr(renderable.subset.offset) << 3));
-            dcd = &QSSGRhiContextPrivate::get(*rhiCtx).drawCallData({ passKey, &renderable.modelContext.model,
-                                          pEntry, entryIdx });
         }
 
         QSSGRhiShaderResourceBindingList bindings;
         QSSGRhiShaderPipelinePtr shaderPipeline;
+        QSSGRhiUniformArena::Allocation ubuf;
         QSSGSubsetRenderable &subsetRenderable(static_cast<QSSGSubsetRenderable &>(*theObject));
         if (theObject->type == QSSGSubsetRenderable::Type::DefaultMaterialMeshSubset) {
             const auto &material = static_cast<const QSSGRenderDefaultMaterial &>(subsetRenderable.getMaterial());
@@ -567,12 +567,12 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
             shaderPipeline = shadersForDefaultMaterial(ps, subsetRenderable, objectFeatureSet);
             if (!shaderPipeline)
                 continue;
-            shaderPipeline->ensureCombinedMainLightsUniformBuffer(&dcd->ubuf);
-            char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
-            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, inCamera, depthAdjust, &modelViewProjection);
+            ubuf = inData.uniformArena.allocate(rhiCtx->rhi(), shaderPipeline->combinedMainLightsUniformBufferSize());
+            if (!ubuf.buffer)
+                continue;
+            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubuf.data, ps, subsetRenderable, inCamera, depthAdjust, &modelViewProjection);
             if (blendParticles)
-                QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubufData, &subsetRenderable.modelContext.model, subsetRenderable.subset.offset);
-            dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+                QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubuf.data, &subsetRenderable.modelContext.model, subsetRenderable.subset.offset);
             if (blendParticles)
                 QSSGParticleRenderer::prepareParticlesForModel(*shaderPipeline, rhiCtx, bindings, &subsetRenderable.modelContext.model);
         } else if (theObject->type == QSSGSubsetRenderable::Type::CustomMaterialMeshSubset) {
@@ -583,12 +583,12 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
             shaderPipeline = customMaterialSystem.shadersForCustomMaterial(ps, material, subsetRenderable, inData.getDefaultMaterialPropertyTable(), objectFeatureSet);
             if (!shaderPipeline)
                 continue;
-            shaderPipeline->ensureCombinedMainLightsUniformBuffer(&dcd->ubuf);
-            char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
+            ubuf = inData.uniformArena.allocate(rhiCtx->rhi(), shaderPipeline->combinedMainLightsUniformBufferSize());
+            if (!ubuf.buffer)
+                continue;
             // inCamera is the shadow camera, not the same as inData.camera
-            customMaterialSystem.updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, material, subsetRenderable,
+            customMaterialSystem.updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, inData, ubuf.data, ps, material, subsetRenderable,
                                                                  inCamera, depthAdjust, &modelViewProjection);
-            dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
         }
 
         if (theObject->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset || theObject->type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
@@ -599,7 +599,8 @@ static void rhiPrepareResourcesForShadowMap(QSSGRhiContext *rhiCtx,
             ps->ia.bakeVertexInputLocations(*shaderPipeline, instanceBufferBinding);
 
 
-            bindings.addUniformBuffer(0, RENDERER_VISIBILITY_ALL, dcd->ubuf);
+            subsetRenderable.rhiRenderData.shadowPass.uniformOffsets[cubeFaceIdx] =
+                    inData.uniformArena.addMainUniformBindings(ubuf, *shaderPipeline, false, RENDERER_VISIBILITY_ALL, bindings);
 
                  // Depth and SSAO textures, in case a custom material's shader code does something with them.
             addDepthTextureBindings(rhiCtx, shaderPipeline.get(), bindings);
@@ -725,12 +726,12 @@ void RenderHelpers::rhiPrepareRenderable(QSSGRhiContext *rhiCtx,
 
             QSSGRhiDrawCallData &dcd = QSSGRhiContextPrivate::get(*rhiCtx).drawCallData({ passKey, &modelNode, entryId, entryIdx });
 
-            shaderPipeline->ensureCombinedMainLightsUniformBuffer(&dcd.ubuf);
-            char *ubufData = dcd.ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
-            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, *camera, nullptr, alteredModelViewProjection);
+            const auto ubuf = inData.uniformArena.allocate(rhiCtx->rhi(), shaderPipeline->combinedMainLightsUniformBufferSize());
+            if (!ubuf.buffer)
+                break;
+            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubuf.data, ps, subsetRenderable, *camera, nullptr, alteredModelViewProjection);
             if (blendParticles)
-                QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubufData, &subsetRenderable.modelContext.model, subsetRenderable.subset.offset);
-            dcd.ubuf->endFullDynamicBufferUpdateForCurrentFrame();
+                QSSGParticleRenderer::updateUniformsForParticleModel(*shaderPipeline, ubuf.data, &subsetRenderable.modelContext.model, subsetRenderable.subset.offset);
 
             if (blendParticles)
                 QSSGParticleRenderer::prepareParticlesForModel(*shaderPipeline, rhiCtx, bindings, &subsetRenderable.modelContext.model);
@@ -784,13 +785,9 @@ void RenderHelpers::rhiPrepareRenderable(QSSGRhiContext *rhiCtx,
             int instanceBufferBinding = setupInstancing(&subsetRenderable, ps, rhiCtx, cameraDirection, cameraPosition);
             ps->ia.bakeVertexInputLocations(*shaderPipeline, instanceBufferBinding);
 
-            bindings.addUniformBuffer(0, RENDERER_VISIBILITY_ALL, dcd.ubuf, 0, shaderPipeline->ub0Size());
-
-            if (shaderPipeline->isLightingEnabled()) {
-                bindings.addUniformBuffer(1, RENDERER_VISIBILITY_ALL, dcd.ubuf,
-                                          shaderPipeline->ub0LightDataOffset(),
-                                          shaderPipeline->ub0LightDataSize());
-            }
+            const QSSGRhiUniformOffsets uniformOffsets = inData.uniformArena.addMainUniformBindings(ubuf, *shaderPipeline,
+                                                                                                   shaderPipeline->isLightingEnabled(),
+                                                                                                   RENDERER_VISIBILITY_ALL, bindings);
 
             // Texture maps
             QSSGRenderableImage *renderableImage = subsetRenderable.firstImage;
@@ -909,10 +906,13 @@ void RenderHelpers::rhiPrepareRenderable(QSSGRhiContext *rhiCtx,
                 srbChanged = true;
             }
 
-            if (cubeFace != QSSGRenderTextureCubeFaceNone)
+            if (cubeFace != QSSGRenderTextureCubeFaceNone) {
                 subsetRenderable.rhiRenderData.reflectionPass.srb[cubeFaceIdx] = srb;
-            else
+                subsetRenderable.rhiRenderData.reflectionPass.uniformOffsets[cubeFaceIdx] = uniformOffsets;
+            } else {
                 subsetRenderable.rhiRenderData.mainPass.srb = srb;
+                subsetRenderable.rhiRenderData.mainPass.uniformOffsets = uniformOffsets;
+            }
 
             const auto pipelineKey = QSSGGraphicsPipelineStateKeyPrivate::create(*ps, renderPassDescriptor, srb);
             if (dcd.pipeline
@@ -994,11 +994,13 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
 
         QRhiGraphicsPipeline *ps = subsetRenderable.rhiRenderData.mainPass.pipeline;
         QRhiShaderResourceBindings *srb = subsetRenderable.rhiRenderData.mainPass.srb;
+        const QSSGRhiUniformOffsets *uniformOffsets = &subsetRenderable.rhiRenderData.mainPass.uniformOffsets;
 
         if (cubeFace != QSSGRenderTextureCubeFaceNone) {
             const auto cubeFaceIdx = QSSGBaseTypeHelpers::indexOfCubeFace(cubeFace);
             ps = subsetRenderable.rhiRenderData.reflectionPass.pipeline;
             srb = subsetRenderable.rhiRenderData.reflectionPass.srb[cubeFaceIdx];
+            uniformOffsets = &subsetRenderable.rhiRenderData.reflectionPass.uniformOffsets[cubeFaceIdx];
         }
 
         if (!ps || !srb)
@@ -1010,7 +1012,7 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
         QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
         // QRhi optimizes out unnecessary binding of the same pipline
         cb->setGraphicsPipeline(ps);
-        cb->setShaderResources(srb);
+        uniformOffsets->setShaderResources(cb, srb);
 
         if (*needsSetViewport) {
             cb->setViewport(state.viewport);
@@ -1023,8 +1025,8 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
         int vertexBufferCount = 1;
         vertexBuffers[0] = QRhiCommandBuffer::VertexInput(vertexBuffer, 0);
         quint32 instances = 1;
-        if ( subsetRenderable.modelContext.model.instancing()) {
-            instances = subsetRenderable.modelContext.model.instanceCount();
+        if (subsetRenderable.usesInstancing()) {
+            instances = subsetRenderable.instanceCount();
             // If the instance count is 0, the bail out before trying to do any
             // draw calls. Making an instanced draw call with a count of 0 is invalid
             // for Metal and likely other API's as well.
@@ -1068,7 +1070,6 @@ void RenderHelpers::rhiRenderRenderable(QSSGRhiContext *rhiCtx,
 }
 
 void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
-                                       QSSGPassKey passKey,
                                        QSSGRhiGraphicsPipelineState &ps,
                                        QSSGRenderShadowMap &shadowMapManager,
                                        const QSSGRenderCamera &camera,
@@ -1107,7 +1108,7 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                 cb->setGraphicsPipeline(renderable->rhiRenderData.shadowPass.pipeline);
 
                 QRhiShaderResourceBindings *srb = renderable->rhiRenderData.shadowPass.srb[cubeFace];
-                cb->setShaderResources(srb);
+                renderable->rhiRenderData.shadowPass.uniformOffsets[cubeFace].setShaderResources(cb, srb);
 
                 if (needsSetViewport) {
                     cb->setViewport(ps->viewport);
@@ -1118,8 +1119,8 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                 int vertexBufferCount = 1;
                 vertexBuffers[0] = QRhiCommandBuffer::VertexInput(vertexBuffer, 0);
                 quint32 instances = 1;
-                if (renderable->modelContext.model.instancing()) {
-                    instances = renderable->modelContext.model.instanceCount();
+                if (renderable->usesInstancing()) {
+                    instances = renderable->instanceCount();
                     vertexBuffers[1] = QRhiCommandBuffer::VertexInput(renderable->instanceBuffer, 0);
                     vertexBufferCount = 2;
                 }
@@ -1262,8 +1263,9 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
             theCamera.calculateViewProjectionMatrix(pEntry->m_lightVP);
             pEntry->m_lightView = theCamera.globalTransform.inverted(); // pre-calculate this for the material
 
-            rhiPrepareResourcesForShadowMap(rhiCtx, layerData, passKey, pEntry, &ps, &depthAdjust,
+            rhiPrepareResourcesForShadowMap(rhiCtx, layerData, pEntry, &ps, &depthAdjust,
                                             sortedOpaqueObjects, theCamera, true, QSSGRenderTextureCubeFaceNone);
+            layerData.uniformArena.flush();
 
             // Render into the 2D texture pEntry->m_rhiDepthMap, using
             // pEntry->m_rhiDepthStencil as the (throwaway) depth/stencil buffer.
@@ -1298,9 +1300,10 @@ void RenderHelpers::rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
                 theCameras[quint8(face)].calculateViewProjectionMatrix(pEntry->m_lightVP);
                 pEntry->m_lightCubeView[quint8(face)] = theCameras[quint8(face)].globalTransform.inverted(); // pre-calculate this for the material
 
-                rhiPrepareResourcesForShadowMap(rhiCtx, layerData, passKey, pEntry, &ps, &depthAdjust,
+                rhiPrepareResourcesForShadowMap(rhiCtx, layerData, pEntry, &ps, &depthAdjust,
                                                 sortedOpaqueObjects, theCameras[quint8(face)], false, face);
             }
+            layerData.uniformArena.flush();
 
             for (const auto face : QSSGRenderTextureCubeFaces) {
                 // Render into one face of the cubemap texture pEntry->m_rhiDephCube, using
@@ -1397,6 +1400,7 @@ void RenderHelpers::rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
             rhiPrepareResourcesForReflectionMap(rhiCtx, passKey, inData, pEntry, ps,
                                                 reflectionPassObjects, theCameras[cubeFaceIdx], renderer, face);
         }
+        inData.uniformArena.flush();
         QRhiRenderPassDescriptor *renderPassDesc = nullptr;
         for (auto face : QSSGRenderTextureCubeFaces) {
             if (pEntry->m_timeSlicing == QSSGRenderReflectionProbe::ReflectionTimeSlicing::IndividualFaces)
@@ -1679,6 +1683,15 @@ static void rhiPrepareSkyBox_helper(QSSGRhiContext *rhiCtx,
             cubeMapMode ? renderer.contextInterface()->bufferManager()->loadRenderImage(layer.skyBoxCubeMap, QSSGBufferManager::MipModeDisable)
                         : renderer.contextInterface()->bufferManager()->loadRenderImage(layer.lightProbe, QSSGBufferManager::MipModeBsdf);
     const bool hasValidTexture = lightProbeTexture.m_texture != nullptr;
+
+    // An srb from an earlier frame may have been released by the srb cache
+    // since (see QSSGRhiContextPrivate::releaseUnusedResources()), so the
+    // srb is only set when it was prepared for this frame.
+    if (cubeFace != QSSGRenderTextureCubeFaceNone)
+        entry->m_skyBoxSrbs[QSSGBaseTypeHelpers::indexOfCubeFace(cubeFace)] = nullptr;
+    else
+        layer.skyBoxSrb = nullptr;
+
     if (hasValidTexture) {
         if (cubeFace == QSSGRenderTextureCubeFaceNone)
             layer.skyBoxIsRgbe8 = lightProbeTexture.m_flags.isRgbe8();
@@ -1783,7 +1796,6 @@ void RenderHelpers::rhiPrepareSkyBoxForReflectionMap(QSSGRhiContext *rhiCtx,
 }
 
 bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
-                                        QSSGPassKey passKey,
                                         const QSSGRhiGraphicsPipelineState &basePipelineState,
                                         QRhiRenderPassDescriptor *rpDesc,
                                         QSSGLayerRenderData &inData,
@@ -1792,7 +1804,6 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
                                         int samples)
 {
     static const auto rhiPrepareDepthPassForObject = [](QSSGRhiContext *rhiCtx,
-                                                        QSSGPassKey passKey,
                                                         QSSGLayerRenderData &inData,
                                                         QSSGRenderableObject *obj,
                                                         QRhiRenderPassDescriptor *rpDesc,
@@ -1805,27 +1816,18 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
         if (isOpaqueDepthPrePass)
             featureSet.set(QSSGShaderFeatures::Feature::OpaqueDepthPrePass, true);
 
-        QSSGRhiDrawCallData *dcd = nullptr;
-        if (obj->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset || obj->type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
-            QSSGSubsetRenderable &subsetRenderable(static_cast<QSSGSubsetRenderable &>(*obj));
-            const void *modelNode = &subsetRenderable.modelContext.model;
-            dcd = &QSSGRhiContextPrivate::get(*rhiCtx).drawCallData({ passKey, modelNode, &subsetRenderable.material, 0 });
-        }
-
+        QSSGRhiUniformArena::Allocation ubuf;
         if (obj->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset) {
             QSSGSubsetRenderable &subsetRenderable(static_cast<QSSGSubsetRenderable &>(*obj));
             const auto &material = static_cast<const QSSGRenderDefaultMaterial &>(subsetRenderable.getMaterial());
             ps->cullMode = QSSGRhiGraphicsPipelineState::toCullMode(material.cullMode);
 
             shaderPipeline = shadersForDefaultMaterial(ps, subsetRenderable, featureSet);
-            if (shaderPipeline) {
-                shaderPipeline->ensureCombinedMainLightsUniformBuffer(&dcd->ubuf);
-                char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
-                updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, subsetRenderable, *inData.camera, nullptr, nullptr);
-                dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
-            } else {
+            if (shaderPipeline)
+                ubuf = inData.uniformArena.allocate(rhiCtx->rhi(), shaderPipeline->combinedMainLightsUniformBufferSize());
+            if (!ubuf.buffer)
                 return false;
-            }
+            updateUniformsForDefaultMaterial(*shaderPipeline, rhiCtx, inData, ubuf.data, ps, subsetRenderable, *inData.camera, nullptr, nullptr);
         } else if (obj->type == QSSGRenderableObject::Type::CustomMaterialMeshSubset) {
             QSSGSubsetRenderable &subsetRenderable(static_cast<QSSGSubsetRenderable &>(*obj));
 
@@ -1836,15 +1838,12 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
             QSSGCustomMaterialSystem &customMaterialSystem(*subsetRenderable.renderer->contextInterface()->customMaterialSystem().get());
             shaderPipeline = customMaterialSystem.shadersForCustomMaterial(ps, customMaterial, subsetRenderable, inData.getDefaultMaterialPropertyTable(), featureSet);
 
-            if (shaderPipeline) {
-                shaderPipeline->ensureCombinedMainLightsUniformBuffer(&dcd->ubuf);
-                char *ubufData = dcd->ubuf->beginFullDynamicBufferUpdateForCurrentFrame();
-                customMaterialSystem.updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, inData, ubufData, ps, customMaterial, subsetRenderable,
-                                                                     *inData.camera, nullptr, nullptr);
-                dcd->ubuf->endFullDynamicBufferUpdateForCurrentFrame();
-            } else {
+            if (shaderPipeline)
+                ubuf = inData.uniformArena.allocate(rhiCtx->rhi(), shaderPipeline->combinedMainLightsUniformBufferSize());
+            if (!ubuf.buffer)
                 return false;
-            }
+            customMaterialSystem.updateUniformsForCustomMaterial(*shaderPipeline, rhiCtx, inData, ubuf.data, ps, customMaterial, subsetRenderable,
+                                                                 *inData.camera, nullptr, nullptr);
         }
 
         // the rest is common, only relying on QSSGSubsetRenderableBase, not the subclasses
@@ -1856,7 +1855,8 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
             ps->ia.bakeVertexInputLocations(*shaderPipeline, instanceBufferBinding);
 
             QSSGRhiShaderResourceBindingList bindings;
-            bindings.addUniformBuffer(0, RENDERER_VISIBILITY_ALL, dcd->ubuf);
+            subsetRenderable.rhiRenderData.depthPrePass.uniformOffsets =
+                    inData.uniformArena.addMainUniformBindings(ubuf, *shaderPipeline, false, RENDERER_VISIBILITY_ALL, bindings);
 
             // Depth and SSAO textures, in case a custom material's shader code does something with them.
             addDepthTextureBindings(rhiCtx, shaderPipeline.get(), bindings);
@@ -1896,12 +1896,12 @@ bool RenderHelpers::rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
     ps.targetBlend.colorWrite = {};
 
     for (const QSSGRenderableObjectHandle &handle : sortedOpaqueObjects) {
-        if (!rhiPrepareDepthPassForObject(rhiCtx, passKey, inData, handle.obj, rpDesc, &ps))
+        if (!rhiPrepareDepthPassForObject(rhiCtx, inData, handle.obj, rpDesc, &ps))
             return false;
     }
 
     for (const QSSGRenderableObjectHandle &handle : sortedTransparentObjects) {
-        if (!rhiPrepareDepthPassForObject(rhiCtx, passKey, inData, handle.obj, rpDesc, &ps))
+        if (!rhiPrepareDepthPassForObject(rhiCtx, inData, handle.obj, rpDesc, &ps))
             return false;
     }
 
@@ -1941,7 +1941,7 @@ void RenderHelpers::rhiRenderDepthPass(QSSGRhiContext *rhiCtx,
 
                 Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderCall);
                 cb->setGraphicsPipeline(ps);
-                cb->setShaderResources(srb);
+                subsetRenderable->rhiRenderData.depthPrePass.uniformOffsets.setShaderResources(cb, srb);
 
                 if (*needsSetViewport) {
                     cb->setViewport(pipelineState.viewport);
@@ -1952,8 +1952,8 @@ void RenderHelpers::rhiRenderDepthPass(QSSGRhiContext *rhiCtx,
                 int vertexBufferCount = 1;
                 vertexBuffers[0] = QRhiCommandBuffer::VertexInput(vertexBuffer, 0);
                 quint32 instances = 1;
-                if (subsetRenderable->modelContext.model.instancing()) {
-                    instances = subsetRenderable->modelContext.model.instanceCount();
+                if (subsetRenderable->usesInstancing()) {
+                    instances = subsetRenderable->instanceCount();
                     vertexBuffers[1] = QRhiCommandBuffer::VertexInput(subsetRenderable->instanceBuffer, 0);
                     vertexBufferCount = 2;
                 }
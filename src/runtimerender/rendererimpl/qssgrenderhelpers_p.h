@@ -37,7 +37,6 @@ std::pair<QSSGBoxPoints, QSSGBoxPoints> calculateSortedObjectBounds(const QSSGRe
                                                                     const QSSGRenderableObjectList &sortedTransparentObjects);
 
 void rhiRenderShadowMap(QSSGRhiContext *rhiCtx,
-                        QSSGPassKey passKey,
                         QSSGRhiGraphicsPipelineState &ps,
                         QSSGRenderShadowMap &shadowMapManager,
                         const QSSGRenderCamera &camera,
@@ -57,7 +56,6 @@ void rhiRenderReflectionMap(QSSGRhiContext *rhiCtx,
                             QSSGRenderer &renderer);
 
 bool rhiPrepareDepthPass(QSSGRhiContext *rhiCtx,
-                         QSSGPassKey passKey,
                          const QSSGRhiGraphicsPipelineState &basePipelineState,
                          QRhiRenderPassDescriptor *rpDesc,
                          QSSGLayerRenderData &inData,
@@ -33,9 +33,96 @@ static inline QMatrix4x4 correctMVPForScissor(QRectF viewportRect, QRect scissor
 }
 // SHADOW PASS
 
+// Point and spot lights render into cube maps, seeing at most as far as the
+// corners of the faces' frustums (shadowMapFar * sqrt(3)) from the light. If
+// there's no directional light casting shadows, casters that are out of reach
+// of every light can be dropped.
+static void cullShadowCasters(const QSSGSceneBVH &sceneBVH, const QSSGShaderLightList &lights, QSSGRenderableObjectList &casters)
+{
+    if (casters.isEmpty() || !sceneBVH.isValid() || sceneBVH.primitiveCount() == 0)
+        return;
+
+    constexpr float sqrt3 = 1.7320508f;
+    QBitArray inRange(sceneBVH.primitiveCount());
+    bool hasShadowLights = false;
+    for (const auto &shaderLight : lights) {
+        if (!shaderLight.shadows || shaderLight.light->m_fullyBaked)
+            continue;
+        if (shaderLight.light->type == QSSGRenderLight::Type::DirectionalLight)
+            return;
+        // Same far plane as in setupCubeShadowCameras()
+        const float radius = qMax(2.0f, shaderLight.light->m_shadowMapFar) * sqrt3;
+        sceneBVH.overlapSphere(shaderLight.light->getGlobalPos(), radius, inRange);
+        hasShadowLights = true;
+    }
+
+    if (!hasShadowLights)
+        return;
+
+    casters.removeIf([&sceneBVH, &inRange](const QSSGRenderableObjectHandle &handle) {
+        const qint32 primitive = sceneBVH.primitiveIndex(*handle.obj);
+        return primitive >= 0 && !inRange.testBit(primitive);
+    });
+}
+
+// A caster hidden from the camera can still throw its shadow on something
+// visible, so what is tested against the Hi-Z buffer is the volume the shadow
+// can fall into. For directional lights that's the caster bounds extruded
+// along the light direction, far enough to reach every receiver. For point
+// and spot lights the bounds are pushed away from the light up to the range
+// of the shadow map. A caster is dropped only when its shadow volume is
+// occluded for every light.
+static qsizetype cullOccludedShadowCasters(const QSSGHiZBuffer &hiZBuffer,
+                                           const QSSGSceneBVH &sceneBVH,
+                                           const QSSGShaderLightList &lights,
+                                           const QSSGBoxPoints &receivingObjectsBox,
+                                           QSSGRenderableObjectList &casters)
+{
+    constexpr float sqrt3 = 1.7320508f;
+    QSSGBounds3 receivingBounds;
+    for (const QVector3D &point : receivingObjectsBox)
+        receivingBounds.include(point);
+
+    const auto isShadowOccluded = [&](const QSSGBounds3 &bounds) {
+        for (const auto &shaderLight : lights) {
+            const QSSGRenderLight *light = shaderLight.light;
+            if (!shaderLight.shadows || light->m_fullyBaked)
+                continue;
+            QSSGBounds3 shadowBounds = bounds;
+            if (light->type == QSSGRenderLight::Type::DirectionalLight) {
+                QSSGBounds3 sceneBounds = receivingBounds;
+                sceneBounds.include(bounds);
+                const QVector3D offset = light->getDirection().normalized() * sceneBounds.dimensions().length();
+                shadowBounds.include(QSSGBounds3(bounds.minimum + offset, bounds.maximum + offset));
+            } else {
+                const QVector3D lightPos = light->getGlobalPos();
+                const QVector3D closest(qBound(bounds.minimum.x(), lightPos.x(), bounds.maximum.x()),
+                                        qBound(bounds.minimum.y(), lightPos.y(), bounds.maximum.y()),
+                                        qBound(bounds.minimum.z(), lightPos.z(), bounds.maximum.z()));
+                const float distance = (closest - lightPos).length();
+                // Same far plane as in setupCubeShadowCameras()
+                const float range = qMax(2.0f, light->m_shadowMapFar) * sqrt3;
+                if (distance < 0.001f)
+                    return false;
+                if (distance < range) {
+                    const float scale = range / distance;
+                    shadowBounds.include(QSSGBounds3(lightPos + (bounds.minimum - lightPos) * scale,
+                                                     lightPos + (bounds.maximum - lightPos) * scale));
+                }
+            }
+            if (!hiZBuffer.isOccluded(shadowBounds))
+                return false;
+        }
+        return true;
+    };
+
+    return casters.removeIf([&](const QSSGRenderableObjectHandle &handle) {
+        return sceneBVH.primitiveIndex(*handle.obj) >= 0 && isShadowOccluded(handle.obj->globalBounds);
+    });
+}
+
 void ShadowMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
 {
-    Q_UNUSED(renderer)
     using namespace RenderHelpers;
 
     camera = data.camera;
@@ -55,6 +142,8 @@ void ShadowMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data
 
     globalLights = data.globalLights;
 
+    cullShadowCasters(data.sceneBVH, globalLights, shadowPassObjects);
+
     enabled = !shadowPassObjects.isEmpty() || !globalLights.isEmpty();
 
     if (enabled) {
@@ -73,6 +162,12 @@ void ShadowMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data
                                                                       sortedTransparentObjects);
         castingObjectsBox = casting;
         receivingObjectsBox = receiving;
+
+        if (data.layerPrepResult.flags.requiresOcclusionCulling() && data.hiZBuffer.isValid()) {
+            const qsizetype culledCount = cullOccludedShadowCasters(data.hiZBuffer, data.sceneBVH, globalLights,
+                                                                    receivingObjectsBox, shadowPassObjects);
+            QSSGRHICTX_STAT(renderer.contextInterface()->rhiContext().get(), occlusionCulledShadowCasters(culledCount));
+        }
     }
 }
 
@@ -98,7 +193,6 @@ void ShadowMapPass::renderPass(QSSGRenderer &renderer)
 
         QSSG_CHECK(shadowMapManager);
         rhiRenderShadowMap(rhiCtx.get(),
-                           this,
                            ps,
                            *shadowMapManager,
                            *camera,
@@ -230,7 +324,7 @@ void ZPrePassPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
     cb->debugMarkBegin(QByteArrayLiteral("Quick3D prepare Z prepass"));
     Q_TRACE_SCOPE(QSSG_renderPass, QStringLiteral("Quick3D prepare Z prepass"));
     Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
-    active = rhiPrepareDepthPass(rhiCtx.get(), this, ps, rhiCtx->mainRenderPassDescriptor(), data,
+    active = rhiPrepareDepthPass(rhiCtx.get(), ps, rhiCtx->mainRenderPassDescriptor(), data,
                                          renderedDepthWriteObjects, renderedOpaqueDepthPrepassObjects,
                                          rhiCtx->mainPassSampleCount());
     data.setZPrePassPrepResult(active);
@@ -357,7 +451,7 @@ void DepthMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
     if (Q_LIKELY(rhiDepthTexture && rhiPrepareDepthTexture(rhiCtx.get(), layerPrepResult.textureDimensions(), rhiDepthTexture))) {
         sortedOpaqueObjects = data.getSortedOpaqueRenderableObjects();
         sortedTransparentObjects = data.getSortedTransparentRenderableObjects();
-        ready = rhiPrepareDepthPass(rhiCtx.get(), this, ps, rhiDepthTexture->rpDesc, data,
+        ready = rhiPrepareDepthPass(rhiCtx.get(), ps, rhiDepthTexture->rpDesc, data,
                                     sortedOpaqueObjects, sortedTransparentObjects,
                                     1);
     }
@@ -420,6 +514,87 @@ void DepthMapPass::resetForFrame()
     ps = {};
 }
 
+// OCCLUSION CULLING PASS
+void OcclusionCullingPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
+{
+    const auto &rhiCtx = renderer.contextInterface()->rhiContext();
+    QSSG_ASSERT(rhiCtx->rhi()->isRecordingFrame(), return);
+
+    // Results of an earlier frame become available for the passes after this one
+    hiZBuffer = &data.hiZBuffer;
+    hiZBuffer->prepare(rhiCtx.get());
+
+    QSSG_ASSERT_X(data.cameraData.has_value(), "Preparing occlusion culling pass failed, missing camera", return);
+
+    const auto &shaderCache = renderer.contextInterface()->shaderCache();
+    hiZShaderPipeline = shaderCache->getBuiltInRhiShaders().getRhiHiZDownsampleShader();
+
+    // When the depth texture is rendered anyway it has the opaque objects of
+    // this very frame.
+    if (data.layerPrepResult.flags.requiresDepthTexture()) {
+        const auto *rhiDepthTexture = data.getRenderResult(QSSGFrameData::RenderResult::DepthTexture);
+        QSSG_ASSERT_X((rhiDepthTexture && rhiDepthTexture->isValid()), "Preparing occlusion culling pass failed, missing depth texture", return);
+        depthTexture = rhiDepthTexture->texture;
+        viewport = data.getPipelineState().viewport;
+        viewProjection = data.cameraData->viewProjection;
+        data.hiZSource = {};
+        return;
+    }
+
+    // Otherwise the depth attachment of the main pass is used, which at this
+    // point still holds what the previous frame rendered into it.
+    QRhiTexture *mainDepthTexture = QSSGHiZBuffer::mainPassDepthTexture(rhiCtx.get());
+    QSSG_ASSERT_X(mainDepthTexture, "Preparing occlusion culling pass failed, missing depth texture", return);
+    auto &source = data.hiZSource;
+    if (source.depthTexture == mainDepthTexture && source.pixelSize == mainDepthTexture->pixelSize()) {
+        depthTexture = mainDepthTexture;
+        viewport = source.viewport;
+        viewProjection = source.viewProjection;
+    }
+
+    if (data.mainPassDepthIsOpaque)
+        source = { mainDepthTexture, mainDepthTexture->pixelSize(), data.getPipelineState().viewport, data.cameraData->viewProjection };
+    else
+        source = {};
+}
+
+void OcclusionCullingPass::renderPass(QSSGRenderer &renderer)
+{
+    // INPUT: Depth texture or the main pass depth of the previous frame + camera
+
+    // DEPENDECY: Depth map, if there is one
+
+    // OUTPUT: Hi-Z buffer readback, used from the next frame(s) on
+
+    // CONDITION: Occlusion culling enabled, nothing to reduce in the first frame
+    if (!depthTexture)
+        return;
+
+    QSSG_ASSERT(hiZBuffer && hiZShaderPipeline, return);
+
+    const auto &rhiCtx = renderer.contextInterface()->rhiContext();
+    QSSG_ASSERT(rhiCtx->rhi()->isRecordingFrame(), return);
+
+    QRhiCommandBuffer *cb = rhiCtx->commandBuffer();
+    cb->debugMarkBegin(QByteArrayLiteral("Quick3D Hi-Z buffer"));
+    Q_TRACE_SCOPE(QSSG_renderPass, QStringLiteral("Quick3D Hi-Z buffer"));
+    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DRenderPass);
+
+    hiZBuffer->render(rhiCtx.get(), renderer, *hiZShaderPipeline, depthTexture, viewport, viewProjection);
+
+    cb->debugMarkEnd();
+    Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DRenderPass, 0, QByteArrayLiteral("hiz_buffer"));
+}
+
+void OcclusionCullingPass::resetForFrame()
+{
+    hiZBuffer = nullptr;
+    depthTexture = nullptr;
+    hiZShaderPipeline = nullptr;
+    viewport = {};
+    viewProjection = {};
+}
+
 // SCREEN TEXTURE PASS
 
 void ScreenMapPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
@@ -602,11 +777,16 @@ void OpaquePass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data)
         const auto &clippingFrustum = data.cameraData->clippingFrustum;
         const auto &opaqueObjects = data.getSortedOpaqueRenderableObjects();
         if (clippingFrustum.has_value())
-            QSSGLayerRenderData::frustumCulling(clippingFrustum.value(), opaqueObjects, sortedOpaqueObjects);
+            data.sceneFrustumCulling(clippingFrustum.value(), opaqueObjects, sortedOpaqueObjects);
         else
             sortedOpaqueObjects = opaqueObjects;
     }
 
+    if (data.layerPrepResult.flags.requiresOcclusionCulling()) {
+        const qsizetype culledCount = data.occlusionCullingInline(sortedOpaqueObjects);
+        QSSGRHICTX_STAT(rhiCtx.get(), occlusionCulledObjects(culledCount));
+    }
+
     shaderFeatures = data.getShaderFeatures();
 
     const auto &layer = data.layer;
@@ -679,7 +859,7 @@ void TransparentPass::renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &da
         const auto &clippingFrustum = data.cameraData->clippingFrustum;
         const auto &transparentObject = data.getSortedTransparentRenderableObjects();
         if (clippingFrustum.has_value())
-            QSSGLayerRenderData::frustumCulling(clippingFrustum.value(), transparentObject, sortedTransparentObjects);
+            data.sceneFrustumCulling(clippingFrustum.value(), transparentObject, sortedTransparentObjects);
         else
             sortedTransparentObjects = transparentObject;
     }
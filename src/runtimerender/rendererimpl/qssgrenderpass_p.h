@@ -29,6 +29,7 @@ class QSSGRenderer;
 class QSSGRenderShadowMap;
 class QSSGRenderReflectionMap;
 class QSSGLayerRenderData;
+class QSSGHiZBuffer;
 struct QSSGRenderCamera;
 struct QSSGRenderItem2D;
 
@@ -131,6 +132,21 @@ public:
     QSSGRhiRenderableTexture *rhiDepthTexture = nullptr;
 };
 
+class OcclusionCullingPass : public QSSGRenderPass
+{
+public:
+    void renderPrep(QSSGRenderer &renderer, QSSGLayerRenderData &data) final;
+    void renderPass(QSSGRenderer &renderer) final;
+    Type passType() const final { return Type::Standalone; }
+    void resetForFrame() final;
+
+    QSSGHiZBuffer *hiZBuffer = nullptr;
+    QRhiTexture *depthTexture = nullptr;
+    QSSGRhiShaderPipelinePtr hiZShaderPipeline;
+    QRhiViewport viewport;
+    QMatrix4x4 viewProjection;
+};
+
 class ScreenMapPass : public QSSGRenderPass
 {
 public:
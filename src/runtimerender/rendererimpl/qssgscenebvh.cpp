@@ -0,0 +1,380 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qssgscenebvh_p.h"
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderclippingfrustum_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderray_p.h>
+
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+// Models that move or deform without going through the node's dirty flags
+// are left out of the tree.
+static bool isEligible(const QSSGRenderableNodeEntry &entry)
+{
+    if (entry.node->type != QSSGRenderGraphObject::Type::Model || entry.mesh == nullptr)
+        return false;
+
+    const auto &model = static_cast<const QSSGRenderModel &>(*entry.node);
+    return !model.usesBoneTexture()
+            && !model.instancing()
+            && model.particleBuffer == nullptr
+            && model.geometry == nullptr
+            && model.morphTargets.isEmpty();
+}
+
+// World space bounds of all the subsets of the model. These contain the
+// global bounds of every subset renderable of the model.
+static QSSGBounds3 modelBounds(const QSSGRenderableNodeEntry &entry)
+{
+    QSSGBounds3 bounds;
+    for (const auto &subset : std::as_const(entry.mesh->subsets))
+        bounds.include(subset.bounds);
+    if (!bounds.isEmpty())
+        bounds.transform(entry.node->globalTransform);
+    return bounds;
+}
+
+static float distanceSquared(const QSSGBounds3 &bounds, const QVector3D &point)
+{
+    float distSq = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        const float v = point[axis];
+        if (v < bounds.minimum[axis])
+            distSq += (bounds.minimum[axis] - v) * (bounds.minimum[axis] - v);
+        else if (v > bounds.maximum[axis])
+            distSq += (v - bounds.maximum[axis]) * (v - bounds.maximum[axis]);
+    }
+    return distSq;
+}
+
+qint32 QSSGSceneBVH::primitiveIndex(const QSSGRenderableObject &renderable) const
+{
+    if (renderable.type != QSSGRenderableObject::Type::DefaultMaterialMeshSubset
+            && renderable.type != QSSGRenderableObject::Type::CustomMaterialMeshSubset)
+        return -1;
+    const auto &subsetRenderable = static_cast<const QSSGSubsetRenderable &>(renderable);
+    // A batch draws several models, the model it was made from is only the first of them
+    if (subsetRenderable.batch)
+        return -1;
+    return primitiveIndex(subsetRenderable.modelContext.model);
+}
+
+void QSSGSceneBVH::invalidate()
+{
+    QMutexLocker locker(&m_updateMutex);
+    m_valid = false;
+}
+
+void QSSGSceneBVH::clear()
+{
+    QMutexLocker locker(&m_updateMutex);
+    m_nodes.clear();
+    m_primitives.clear();
+    m_slots.clear();
+    m_pickingIndex.clear();
+    m_modelCount = 0;
+    m_valid = false;
+}
+
+void QSSGSceneBVH::update(const QVector<QSSGRenderableNodeEntry> &renderableModels)
+{
+    QMutexLocker locker(&m_updateMutex);
+
+    // The tree can be kept as long as we have the same models as last time,
+    // in which case only the ones that were moved need to be refitted.
+    bool needsRebuild = (renderableModels.size() != m_modelCount);
+    m_movedEntries.clear();
+    for (qsizetype i = 0, end = renderableModels.size(); i != end && !needsRebuild; ++i) {
+        const auto &entry = renderableModels.at(i);
+        const quint32 dfsIndex = entry.node->dfsIndex;
+        if (dfsIndex >= m_slots.size()) {
+            needsRebuild = true;
+            break;
+        }
+        const Slot &slot = m_slots[dfsIndex];
+        const bool eligible = isEligible(entry);
+        if (slot.node != entry.node || slot.eligible != eligible) {
+            needsRebuild = true;
+        } else if (slot.primitive >= 0) {
+            const Primitive &primitive = m_primitives[slot.primitive];
+            if (primitive.transformSerial != entry.node->globalTransformSerial || primitive.mesh != entry.mesh)
+                m_movedEntries.push_back(i);
+        } else if (eligible && slot.mesh != entry.mesh) {
+            needsRebuild = true;
+        }
+    }
+
+    // Refitting is cheap, but the tree gets worse with every refit. When a
+    // large part of the scene is moving it's better to start over.
+    if (!needsRebuild && !m_movedEntries.isEmpty())
+        needsRebuild = (m_movedEntries.size() * 4 > qsizetype(m_primitives.size())) || !refit(renderableModels);
+
+    if (needsRebuild)
+        rebuild(renderableModels);
+
+    m_valid = true;
+}
+
+void QSSGSceneBVH::rebuild(const QVector<QSSGRenderableNodeEntry> &renderableModels)
+{
+    m_nodes.clear();
+    m_primitives.clear();
+    m_slots.clear();
+    m_pickingIndex.clear();
+    m_modelCount = renderableModels.size();
+    ++m_buildCount;
+
+    quint32 maxDfsIndex = 0;
+    for (const auto &entry : renderableModels)
+        maxDfsIndex = qMax(maxDfsIndex, entry.node->dfsIndex);
+    m_slots.resize(size_t(maxDfsIndex) + 1);
+
+    for (const auto &entry : renderableModels) {
+        Slot &slot = m_slots[entry.node->dfsIndex];
+        slot.node = entry.node;
+        slot.mesh = entry.mesh;
+        slot.eligible = isEligible(entry);
+        if (!slot.eligible)
+            continue;
+
+        const QSSGBounds3 bounds = modelBounds(entry);
+        if (bounds.isEmpty())
+            continue;
+
+        Primitive primitive;
+        primitive.node = entry.node;
+        primitive.mesh = entry.mesh;
+        primitive.meshPath = static_cast<const QSSGRenderModel *>(entry.node)->meshPath;
+        primitive.bounds = bounds;
+        primitive.center = bounds.center();
+        primitive.transformSerial = entry.node->globalTransformSerial;
+        m_primitives.push_back(std::move(primitive));
+    }
+
+    if (!m_primitives.empty()) {
+        // A binary tree with at most n leaves has less than 2n nodes.
+        m_nodes.reserve(2 * m_primitives.size());
+        m_nodes.emplace_back();
+        buildNode(0, 0, quint32(m_primitives.size()));
+    }
+
+    m_pickingIndex.reserve(qsizetype(m_primitives.size()));
+    for (qint32 i = 0, end = qint32(m_primitives.size()); i != end; ++i) {
+        const Primitive &primitive = m_primitives[i];
+        m_slots[primitive.node->dfsIndex].primitive = i;
+        m_pickingIndex.insert(primitive.node, i);
+    }
+}
+
+// Top-down build, splitting the primitives at the median of their centers
+// along the widest axis.
+void QSSGSceneBVH::buildNode(quint32 nodeIndex, quint32 first, quint32 count)
+{
+    QSSGBounds3 bounds;
+    QSSGBounds3 centers;
+    for (quint32 i = first, end = first + count; i != end; ++i) {
+        bounds.include(m_primitives[i].bounds);
+        centers.include(m_primitives[i].center);
+    }
+
+    {
+        Node &node = m_nodes[nodeIndex];
+        node.bounds = bounds;
+        node.first = first;
+        node.count = count;
+    }
+
+    if (count <= MAX_PRIMITIVES_PER_LEAF) {
+        for (quint32 i = first, end = first + count; i != end; ++i)
+            m_primitives[i].leaf = nodeIndex;
+        return;
+    }
+
+    const QVector3D dimensions = centers.dimensions();
+    int axis = 0;
+    if (dimensions.y() > dimensions[axis])
+        axis = 1;
+    if (dimensions.z() > dimensions[axis])
+        axis = 2;
+
+    const quint32 half = count / 2;
+    const auto begin = m_primitives.begin() + first;
+    std::nth_element(begin, begin + half, begin + count, [axis](const Primitive &lhs, const Primitive &rhs) {
+        return lhs.center[axis] < rhs.center[axis];
+    });
+
+    const quint32 left = quint32(m_nodes.size());
+    m_nodes.emplace_back().parent = qint32(nodeIndex);
+    m_nodes.emplace_back().parent = qint32(nodeIndex);
+    m_nodes[nodeIndex].left = left;
+
+    buildNode(left, first, half);
+    buildNode(left + 1, first + half, count - half);
+}
+
+bool QSSGSceneBVH::refit(const QVector<QSSGRenderableNodeEntry> &renderableModels)
+{
+    QVarLengthArray<quint32, 64> dirtyNodes;
+    for (const qsizetype entryIndex : std::as_const(m_movedEntries)) {
+        const auto &entry = renderableModels.at(entryIndex);
+        const QSSGBounds3 bounds = modelBounds(entry);
+        if (bounds.isEmpty())
+            return false;
+
+        Slot &slot = m_slots[entry.node->dfsIndex];
+        Primitive &primitive = m_primitives[slot.primitive];
+        slot.mesh = entry.mesh;
+        primitive.mesh = entry.mesh;
+        primitive.meshPath = static_cast<const QSSGRenderModel *>(entry.node)->meshPath;
+        primitive.bounds = bounds;
+        primitive.center = bounds.center();
+        primitive.transformSerial = entry.node->globalTransformSerial;
+        dirtyNodes.push_back(primitive.leaf);
+    }
+
+    // Children are always stored after their parent, so going through the
+    // nodes from the back updates the children before their parents.
+    for (qsizetype i = 0; i != dirtyNodes.size(); ++i) {
+        const qint32 parent = m_nodes[dirtyNodes.at(i)].parent;
+        if (parent >= 0)
+            dirtyNodes.push_back(quint32(parent));
+    }
+    std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<quint32>());
+    const auto dirtyEnd = std::unique(dirtyNodes.begin(), dirtyNodes.end());
+
+    for (auto it = dirtyNodes.begin(); it != dirtyEnd; ++it) {
+        Node &node = m_nodes[*it];
+        QSSGBounds3 bounds;
+        if (node.left == 0) {
+            for (quint32 i = node.first, end = node.first + node.count; i != end; ++i)
+                bounds.include(m_primitives[i].bounds);
+        } else {
+            bounds.include(m_nodes[node.left].bounds);
+            bounds.include(m_nodes[node.left + 1].bounds);
+        }
+        node.bounds = bounds;
+    }
+
+    return true;
+}
+
+void QSSGSceneBVH::cullFrustum(const QSSGClippingFrustum &frustum, QVector<Visibility> &result) const
+{
+    result.fill(Visibility::Outside, qsizetype(m_primitives.size()));
+    if (m_nodes.empty())
+        return;
+
+    // Planes the box is known to be on the inside of don't need to be tested
+    // again further down the tree.
+    constexpr quint8 allPlanes = 0x3f;
+    const auto classify = [&frustum](const QSSGBounds3 &bounds, quint8 &planeMask) {
+        for (int plane = 0; plane < 6; ++plane) {
+            if (!(planeMask & (1 << plane)))
+                continue;
+            const int side = frustum.mPlanes[plane].intersect(bounds);
+            if (side < 0)
+                return false;
+            if (side > 0)
+                planeMask &= ~(1 << plane);
+        }
+        return true;
+    };
+
+    struct StackEntry
+    {
+        quint32 node;
+        quint8 planeMask;
+    };
+    QVarLengthArray<StackEntry, 64> stack;
+    stack.push_back({ 0, allPlanes });
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes[stack.last().node];
+        quint8 planeMask = stack.last().planeMask;
+        stack.removeLast();
+        if (!classify(node.bounds, planeMask))
+            continue;
+
+        if (planeMask == 0) {
+            std::fill(result.begin() + node.first, result.begin() + node.first + node.count, Visibility::Inside);
+        } else if (node.left == 0) {
+            for (quint32 i = node.first, end = node.first + node.count; i != end; ++i) {
+                quint8 primitiveMask = planeMask;
+                if (classify(m_primitives[i].bounds, primitiveMask))
+                    result[i] = (primitiveMask == 0) ? Visibility::Inside : Visibility::Intersecting;
+            }
+        } else {
+            stack.push_back({ node.left, planeMask });
+            stack.push_back({ node.left + 1, planeMask });
+        }
+    }
+}
+
+void QSSGSceneBVH::overlapSphere(const QVector3D &center, float radius, QBitArray &result) const
+{
+    if (result.size() < qsizetype(m_primitives.size()))
+        result.resize(qsizetype(m_primitives.size()));
+    if (m_nodes.empty())
+        return;
+
+    const float radiusSq = radius * radius;
+    QVarLengthArray<quint32, 64> stack;
+    stack.push_back(0);
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes[stack.last()];
+        stack.removeLast();
+        if (distanceSquared(node.bounds, center) > radiusSq)
+            continue;
+
+        if (node.left == 0) {
+            for (quint32 i = node.first, end = node.first + node.count; i != end; ++i) {
+                if (distanceSquared(m_primitives[i].bounds, center) <= radiusSq)
+                    result.setBit(i);
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.left + 1);
+        }
+    }
+}
+
+void QSSGSceneBVH::intersectRay(const QSSGRenderRay &ray, QBitArray &result) const
+{
+    if (result.size() < qsizetype(m_primitives.size()))
+        result.resize(qsizetype(m_primitives.size()));
+    if (m_nodes.empty())
+        return;
+
+    // The bounds are in world space already
+    const QMatrix4x4 identity;
+    const auto rayData = QSSGRenderRay::createRayData(identity, ray);
+
+    QVarLengthArray<quint32, 64> stack;
+    stack.push_back(0);
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes[stack.last()];
+        stack.removeLast();
+        if (!QSSGRenderRay::intersectWithAABBv2(rayData, node.bounds).intersects())
+            continue;
+
+        if (node.left == 0) {
+            for (quint32 i = node.first, end = node.first + node.count; i != end; ++i) {
+                if (QSSGRenderRay::intersectWithAABBv2(rayData, m_primitives[i].bounds).intersects())
+                    result.setBit(i);
+            }
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.left + 1);
+        }
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,149 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QSSGSCENEBVH_P_H
+#define QSSGSCENEBVH_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtQuick3DRuntimeRender/private/qtquick3druntimerenderexports_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendererutil_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendernode_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <QtCore/qbitarray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qvector.h>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+struct QSSGRenderMesh;
+struct QSSGRenderRay;
+struct QSSGRenderableNodeEntry;
+struct QSSGRenderableObject;
+struct QSSGClippingFrustum;
+
+// Bounding volume hierarchy over the world space bounds of the static models
+// in a layer. Models that can change their bounds without their node being
+// marked dirty (skinning, morphing, instancing, particles and custom geometry)
+// are not part of the tree and callers need to treat them as unknown.
+//
+// The tree is kept up to date from the renderable models gathered each
+// frame: if the set of models changes it is rebuilt, otherwise only the
+// models whose global values were recalculated (or whose mesh changed) are
+// refitted. Recalculations are detected with the nodes'
+// globalTransformSerial, so a scene shown by several layers, each with its
+// own tree, keeps all the trees up to date.
+class Q_QUICK3DRUNTIMERENDER_EXPORT QSSGSceneBVH
+{
+public:
+    enum class Visibility : quint8
+    {
+        Outside,
+        Intersecting,
+        Inside
+    };
+
+    // Marks the tree as out of date until the next update(), for the
+    // queries made from other threads (picking) while the nodes change.
+    void invalidate();
+    void update(const QVector<QSSGRenderableNodeEntry> &renderableModels);
+    void clear();
+
+    [[nodiscard]] bool isValid() const { return m_valid; }
+    [[nodiscard]] qsizetype primitiveCount() const { return qsizetype(m_primitives.size()); }
+
+    // Index of the node in the per primitive query results, or -1 if the
+    // node is not in the tree. Only usable on the thread calling update().
+    [[nodiscard]] qint32 primitiveIndex(const QSSGRenderNode &node) const
+    {
+        const quint32 dfsIndex = node.dfsIndex;
+        if (dfsIndex < m_slots.size() && m_slots[dfsIndex].node == &node)
+            return m_slots[dfsIndex].primitive;
+        return -1;
+    }
+    // Index of the model the renderable is a subset of, or -1. Batched
+    // renderables have no model of their own and are not in the tree.
+    [[nodiscard]] qint32 primitiveIndex(const QSSGRenderableObject &renderable) const;
+
+    // Same as primitiveIndex() but without looking at the node, for threads
+    // not owning the render nodes. Expects updateMutex() to be held.
+    [[nodiscard]] qint32 primitiveIndexForPicking(const QSSGRenderNode &node) const { return m_pickingIndex.value(&node, -1); }
+    [[nodiscard]] const QSSGRenderPath &primitiveMeshPath(qint32 primitive) const { return m_primitives[primitive].meshPath; }
+    // The node's globalTransformSerial the bounds of the primitive were computed with
+    [[nodiscard]] quint32 primitiveTransformSerial(qint32 primitive) const { return m_primitives[primitive].transformSerial; }
+
+    // Number of times the tree was built from scratch rather than refitted
+    [[nodiscard]] quint32 buildCount() const { return m_buildCount; }
+
+    QMutex *updateMutex() const { return &m_updateMutex; }
+
+    // The queries below write one entry per primitive.
+    void cullFrustum(const QSSGClippingFrustum &frustum, QVector<Visibility> &result) const;
+    // Sets the bits of the primitives with bounds touching the sphere, other bits are left as they are.
+    void overlapSphere(const QVector3D &center, float radius, QBitArray &result) const;
+    // Sets the bits of the primitives with bounds hit by the ray, other bits are left as they are.
+    void intersectRay(const QSSGRenderRay &ray, QBitArray &result) const;
+
+private:
+    static constexpr quint32 MAX_PRIMITIVES_PER_LEAF = 4;
+
+    struct Node
+    {
+        QSSGBounds3 bounds;
+        qint32 parent = -1;
+        quint32 left = 0; // Right child is left + 1, 0 for leaves (the root is never a child)
+        quint32 first = 0; // The primitives of a subtree are always consecutive
+        quint32 count = 0;
+    };
+
+    struct Primitive
+    {
+        const QSSGRenderNode *node = nullptr;
+        const QSSGRenderMesh *mesh = nullptr;
+        QSSGRenderPath meshPath;
+        QSSGBounds3 bounds;
+        QVector3D center;
+        quint32 leaf = 0;
+        quint32 transformSerial = 0;
+    };
+
+    // Indexed by QSSGRenderNode::dfsIndex
+    struct Slot
+    {
+        const QSSGRenderNode *node = nullptr;
+        const QSSGRenderMesh *mesh = nullptr;
+        qint32 primitive = -1; // -1 when not eligible, or when the mesh has no bounds
+        bool eligible = false;
+    };
+
+    void rebuild(const QVector<QSSGRenderableNodeEntry> &renderableModels);
+    void buildNode(quint32 nodeIndex, quint32 first, quint32 count);
+    bool refit(const QVector<QSSGRenderableNodeEntry> &renderableModels);
+
+    std::vector<Node> m_nodes;
+    std::vector<Primitive> m_primitives;
+    std::vector<Slot> m_slots;
+    QHash<const QSSGRenderNode *, qint32> m_pickingIndex;
+    qsizetype m_modelCount = 0;
+    QVector<qsizetype> m_movedEntries;
+    mutable QMutex m_updateMutex;
+    quint32 m_buildCount = 0;
+    bool m_valid = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSSGSCENEBVH_P_H
@@ -128,6 +128,7 @@ void QSSGMaterialVertexPipeline::beginVertexGeneration(const QSSGShaderDefaultMa
     const bool usesInvProjectionMatrix = defaultMaterialShaderKeyProperties.m_usesInverseProjectionMatrix.getValue(inKey);
     const bool usesPointsTopology = defaultMaterialShaderKeyProperties.m_usesPointsTopology.getValue(inKey);
     const bool usesFloatJointIndices = defaultMaterialShaderKeyProperties.m_usesFloatJointIndices.getValue(inKey);
+    const bool usesQuantizedDirections = defaultMaterialShaderKeyProperties.m_usesQuantizedDirections.getValue(inKey);
     const bool blendParticles = defaultMaterialShaderKeyProperties.m_blendParticles.getValue(inKey);
     usesInstancing = defaultMaterialShaderKeyProperties.m_usesInstancing.getValue(inKey);
     m_hasSkinning = defaultMaterialShaderKeyProperties.m_boneCount.getValue(inKey) > 0;
@@ -260,7 +261,11 @@ void QSSGMaterialVertexPipeline::beginVertexGeneration(const QSSGShaderDefaultMa
     }
 
     if (meshHasNormals) {
-        vertexShader.append("    qt_vertNormal = attr_norm;");
+        // Quantized directions are stored as unsigned normalized bytes
+        if (usesQuantizedDirections)
+            vertexShader.append("    qt_vertNormal = attr_norm * 2.0 - 1.0;");
+        else
+            vertexShader.append("    qt_vertNormal = attr_norm;");
         vertexShader.addIncoming("attr_norm", "vec3");
     }
     if (meshHasTexCoord0) {
@@ -276,11 +281,19 @@ void QSSGMaterialVertexPipeline::beginVertexGeneration(const QSSGShaderDefaultMa
         vertexShader.addIncoming("attr_lightmapuv", "vec2");
     }
     if (meshHasTangents) {
-        vertexShader.append("    qt_vertTangent = attr_textan;");
+        // Quantized directions are stored as unsigned normalized bytes
+        if (usesQuantizedDirections)
+            vertexShader.append("    qt_vertTangent = attr_textan * 2.0 - 1.0;");
+        else
+            vertexShader.append("    qt_vertTangent = attr_textan;");
         vertexShader.addIncoming("attr_textan", "vec3");
     }
     if (meshHasBinormals) {
-        vertexShader.append("    qt_vertBinormal = attr_binormal;");
+        // Quantized directions are stored as unsigned normalized bytes
+        if (usesQuantizedDirections)
+            vertexShader.append("    qt_vertBinormal = attr_binormal * 2.0 - 1.0;");
+        else
+            vertexShader.append("    qt_vertBinormal = attr_binormal;");
         vertexShader.addIncoming("attr_binormal", "vec3");
     }
     if (meshHasColors) {
@@ -0,0 +1,23 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#version 440
+
+layout(location = 0) out vec4 fragOutput;
+
+// Either the depth texture or the previous level of the chain
+layout(binding = 0) uniform sampler2D depthTexture;
+
+void main()
+{
+    // Every texel of the destination is the farthest depth of a 2x2 block in
+    // the source. With an odd source size the destination is rounded up, and
+    // the last block is clamped to the edge.
+    ivec2 maxCoord = textureSize(depthTexture, 0) - ivec2(1);
+    ivec2 coord = ivec2(gl_FragCoord.xy) * 2;
+    float d0 = texelFetch(depthTexture, min(coord, maxCoord), 0).r;
+    float d1 = texelFetch(depthTexture, min(coord + ivec2(1, 0), maxCoord), 0).r;
+    float d2 = texelFetch(depthTexture, min(coord + ivec2(0, 1), maxCoord), 0).r;
+    float d3 = texelFetch(depthTexture, min(coord + ivec2(1, 1), maxCoord), 0).r;
+    fragOutput = vec4(max(max(d0, d1), max(d2, d3)), 0.0, 0.0, 1.0);
+}
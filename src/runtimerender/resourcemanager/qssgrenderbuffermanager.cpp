@@ -14,10 +14,14 @@
 #include <QtQuick/QSGTexture>
 
 #include <QtCore/QDir>
+#include <QtConcurrent/qtconcurrentrun.h>
 #include <QtGui/private/qimage_p.h>
 #include <QtQuick/private/qsgtexture_p.h>
 #include <QtQuick/private/qsgcompressedtexture_p.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <ssg/qssgrenderbasetypes.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendergeometry_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
@@ -107,8 +111,32 @@ static constexpr QSize sizeForMipLevel(int mipLevel, const QSize &baseLevelSize)
     return QSize(qMax(1, baseLevelSize.width() >> mipLevel), qMax(1, baseLevelSize.height() >> mipLevel));
 }
 
+// Streamed images start out with the largest level that is not larger than this
+static const int STREAMING_INITIAL_SIZE = 64;
+
+static int streamingBaseLevel(const QTextureFileData &tex)
+{
+    int level = 0;
+    for (; level < tex.numLevels() - 1; ++level) {
+        const QSize size = sizeForMipLevel(level, tex.size());
+        if (qMax(size.width(), size.height()) <= STREAMING_INITIAL_SIZE)
+            break;
+    }
+    return level;
+}
+
+quint64 QSSGBufferManager::defaultMemoryBudget()
+{
+    static const int budgetMB = qEnvironmentVariableIntValue("QT_QUICK3D_MEMORY_BUDGET");
+    return budgetMB > 0 ? quint64(budgetMB) * 1024 * 1024 : 0;
+}
+
 QSSGBufferManager::QSSGBufferManager()
 {
+    memoryBudgetBytes = defaultMemoryBudget();
+    const int streamingBudgetKB = qEnvironmentVariableIntValue("QT_QUICK3D_TEXTURE_STREAMING_BUDGET");
+    if (streamingBudgetKB > 0)
+        streamingBudgetBytes = quint64(streamingBudgetKB) * 1024;
 }
 
 QSSGBufferManager::~QSSGBufferManager()
@@ -197,23 +225,50 @@ QSSGRenderImageTexture QSSGBufferManager::loadRenderImage(const QSSGRenderImage
         if (foundIt != imageMap.cend()) {
             result = foundIt.value().renderImageTexture;
         } else {
-            Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DTextureLoad);
-            QScopedPointer<QSSGLoadedTexture> theLoadedTexture;
+            std::shared_ptr<QSSGLoadedTexture> theLoadedTexture;
             const auto &path = image->m_imagePath.path();
             const bool flipY = flags.testFlag(LoadWithFlippedY);
+            if (image->m_asynchronous) {
+                auto pendingIt = pendingImages.find(imageKey);
+                if (pendingIt == pendingImages.end()) {
+                    pendingImages.insert(imageKey, { QtConcurrent::run(&asyncLoadPool, &QSSGBufferManager::loadImageAsync,
+                                                                       path, image->m_format, flipY) });
+                    loadStatusChanged = true;
+                    return result;
+                }
+                pendingIt->requested = true;
+                if (!pendingIt->future.isFinished())
+                    return result;
+                theLoadedTexture = pendingIt->future.result();
+                pendingImages.erase(pendingIt);
+            }
+            Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DTextureLoad);
             Q_TRACE_SCOPE(QSSG_textureLoadPath, path);
-            theLoadedTexture.reset(QSSGLoadedTexture::load(path, image->m_format, flipY));
+            if (!image->m_asynchronous)
+                theLoadedTexture.reset(QSSGLoadedTexture::load(path, image->m_format, flipY));
+            loadStatusChanged = true;
             if (theLoadedTexture) {
                 foundIt = imageMap.insert(imageKey, ImageData());
                 CreateRhiTextureFlags rhiTexFlags = ScanForTransparency;
                 if (image->type == QSSGRenderGraphObject::Type::ImageCube)
                     rhiTexFlags |= CubeMap;
-                if (!createRhiTexture(foundIt.value().renderImageTexture, theLoadedTexture.data(), inMipMode, rhiTexFlags, QFileInfo(path).fileName())) {
+                // Only the files that come with their mip levels can be streamed
+                int baseLevel = 0;
+                if (image->m_streaming && image->type == QSSGRenderGraphObject::Type::Image2D
+                        && inMipMode != MipModeBsdf && theLoadedTexture->textureFileData.isValid()) {
+                    baseLevel = streamingBaseLevel(theLoadedTexture->textureFileData);
+                }
+                const QString debugObjectName = QFileInfo(path).fileName();
+                if (!createRhiTexture(foundIt.value().renderImageTexture, theLoadedTexture.get(), inMipMode, rhiTexFlags, debugObjectName, baseLevel)) {
                     foundIt.value() = ImageData();
                 } else {
 #ifdef QSSG_RENDERBUFFER_DEBUGGING
                     qDebug() << "+ uploadTexture: " << image->m_imagePath.path() << currentLayer;
 #endif
+                    if (baseLevel > 0) {
+                        foundIt.value().stream = std::make_shared<TextureStream>(
+                                TextureStream { theLoadedTexture, inMipMode, baseLevel, baseLevel, debugObjectName });
+                    }
                 }
                 result = foundIt.value().renderImageTexture;
                 increaseMemoryStat(result.m_texture);
@@ -330,6 +385,86 @@ QSSGRenderMesh *QSSGBufferManager::getMeshForPicking(const QSSGRenderModel &mode
     return nullptr;
 }
 
+QSSGBufferManager::MeshPickingDataPtr QSSGBufferManager::getMeshPickingData(const QSSGRenderModel &model)
+{
+    if (const auto maps = std::atomic_load(&meshPickingData)) {
+        if (!model.meshPath.isNull()) {
+            const auto foundIt = maps->meshes.constFind(model.meshPath);
+            if (foundIt != maps->meshes.constEnd())
+                return foundIt.value();
+        }
+        if (model.geometry) {
+            const auto foundIt = maps->customMeshes.constFind(model.geometry);
+            if (foundIt != maps->customMeshes.constEnd() && foundIt.value()->generationId == model.geometry->generationId())
+                return foundIt.value();
+        }
+    }
+
+    // Not published yet
+    QMutexLocker meshMutexLocker(&meshBufferMutex);
+    if (!model.meshPath.isNull()) {
+        const auto foundIt = meshMap.constFind(model.meshPath);
+        if (foundIt != meshMap.constEnd() && foundIt->mesh)
+            return createMeshPickingData(foundIt->mesh, 0);
+    }
+    if (model.geometry) {
+        const auto foundIt = customMeshMap.constFind(model.geometry);
+        if (foundIt != customMeshMap.constEnd() && foundIt->mesh)
+            return createMeshPickingData(foundIt->mesh, foundIt->generationId);
+    }
+
+    return nullptr;
+}
+
+QSSGBufferManager::MeshPickingDataPtr QSSGBufferManager::createMeshPickingData(const QSSGRenderMesh *mesh, quint32 generationId)
+{
+    auto data = std::make_shared<MeshPickingData>();
+    data->bvh = mesh->bvh;
+    data->generationId = generationId;
+    data->subsetBounds.reserve(mesh->subsets.size());
+    data->subsetRoots.reserve(mesh->subsets.size());
+    for (const QSSGRenderSubset &subset : mesh->subsets) {
+        data->subsetBounds.append(subset.bounds);
+        data->subsetRoots.append(mesh->bvh ? subset.bvhRoot : QSSGMeshBVHNode::Handle());
+        data->bounds.include(subset.bounds);
+    }
+    return data;
+}
+
+// Only the render thread changes the mesh maps, no need to lock for reading them here
+void QSSGBufferManager::publishMeshPickingData()
+{
+    const auto previous = std::atomic_load(&meshPickingData);
+    auto maps = std::make_shared<MeshPickingDataMaps>();
+
+    // Entries of meshes that did not change are shared with the previous maps
+    const auto isCurrent = [](const MeshPickingDataPtr &data, const QSSGRenderMesh *mesh, quint32 generationId) {
+        return data && data->bvh && data->bvh == mesh->bvh && data->generationId == generationId;
+    };
+
+    maps->meshes.reserve(meshMap.size());
+    for (auto it = meshMap.cbegin(), end = meshMap.cend(); it != end; ++it) {
+        if (!it->mesh)
+            continue;
+        MeshPickingDataPtr data = previous ? previous->meshes.value(it.key()) : nullptr;
+        if (!isCurrent(data, it->mesh, 0))
+            data = createMeshPickingData(it->mesh, 0);
+        maps->meshes.insert(it.key(), std::move(data));
+    }
+
+    maps->customMeshes.reserve(customMeshMap.size());
+    for (auto it = customMeshMap.cbegin(), end = customMeshMap.cend(); it != end; ++it) {
+        if (!it->mesh)
+            continue;
+        MeshPickingDataPtr data = previous ? previous->customMeshes.value(it.key()) : nullptr;
+        if (!isCurrent(data, it->mesh, it->generationId))
+            data = createMeshPickingData(it->mesh, it->generationId);
+        maps->customMeshes.insert(it.key(), std::move(data));
+    }
+
+    std::atomic_store(&meshPickingData, std::shared_ptr<const MeshPickingDataMaps>(std::move(maps)));
+}
+
 QRhiTexture::Format QSSGBufferManager::toRhiFormat(const QSSGRenderTextureFormat format)
 {
     switch (format.format) {
@@ -898,7 +1033,8 @@ bool QSSGBufferManager::createRhiTexture(QSSGRenderImageTexture &texture,
                                          const QSSGLoadedTexture *inTexture,
                                          MipMode inMipMode,
                                          CreateRhiTextureFlags inFlags,
-                                         const QString &debugObjectName)
+                                         const QString &debugObjectName,
+                                         int baseLevel)
 {
     Q_ASSERT(inMipMode != MipModeFollowRenderImage);
     QVarLengthArray<QRhiTextureUploadEntry, 16> textureUploads;
@@ -962,8 +1098,9 @@ bool QSSGBufferManager::createRhiTexture(QSSGRenderImageTexture &texture,
         }
     } else if (inTexture->textureFileData.isValid()) {
         const QTextureFileData &tex = inTexture->textureFileData;
-        size = tex.size();
-        mipmapCount = tex.numLevels();
+        Q_ASSERT(baseLevel < tex.numLevels());
+        size = sizeForMipLevel(baseLevel, tex.size());
+        mipmapCount = tex.numLevels() - baseLevel;
 
         int numFaces = 1;
         // Just having a container with 6 faces is not enough, we only treat it
@@ -972,11 +1109,11 @@ bool QSSGBufferManager::createRhiTexture(QSSGRenderImageTexture &texture,
         if (tex.numFaces() == 6 && inFlags.testFlag(CubeMap))
             numFaces = 6;
 
-        for (int level = 0; level < tex.numLevels(); ++level) {
+        for (int level = 0; level < mipmapCount; ++level) {
             QRhiTextureSubresourceUploadDescription subDesc;
             subDesc.setSourceSize(sizeForMipLevel(level, size));
             for (int face = 0; face < numFaces; ++face) {
-                subDesc.setData(tex.getDataView(level, face).toByteArray());
+                subDesc.setData(tex.getDataView(baseLevel + level, face).toByteArray());
                 textureUploads << QRhiTextureUploadEntry{ face, level, subDesc };
             }
         }
@@ -1130,7 +1267,14 @@ QSSGRenderMesh *QSSGBufferManager::loadMesh(const QSSGRenderModel *model)
             options.meshFileOverride = QSSGLightmapper::lightmapAssetPathForLoad(*model,
                                                                                  QSSGLightmapper::LightmapAsset::MeshWithLightmapUV);
         }
-        theMesh = loadRenderMesh(model->meshPath, options);
+        LoadRenderMeshFlags flags;
+        if (model->asynchronous) {
+            flags |= LoadAsynchronously;
+            // Saves the render thread from building it on the first pick
+            if (model->getLocalState(QSSGRenderNode::LocalState::Pickable))
+                flags |= LoadWithBVH;
+        }
+        theMesh = loadRenderMesh(model->meshPath, options, flags);
     }
 
     return theMesh;
@@ -1154,22 +1298,53 @@ QSSGBounds3 QSSGBufferManager::getModelBounds(const QSSGRenderModel *model) cons
             const auto &subSets = theMesh->subsets;
             for (const auto &subSet : subSets)
                 retval.include(subSet.bounds);
+        } else if (model->asynchronous) {
+            // Not loading it here, that is what the worker thread is for.
+            // The bounds are there once the mesh is.
         } else {
-            // The model has not been loaded yet, load it without uploading the geometry
-            // TODO: Try to do this without loading the whole mesh struct
-            QSSGMesh::Mesh mesh = loadMeshData(model->meshPath);
-            if (mesh.isValid()) {
-               auto const &subsets = mesh.subsets();
-               for (const auto &subset : subsets)
-                   retval.include(QSSGBounds3(subset.bounds.min, subset.bounds.max));
-            }
+            // The model has not been loaded yet, only read the subsets
+            const auto subsets = loadMeshSubsets(model->meshPath);
+            for (const auto &subset : subsets)
+                retval.include(QSSGBounds3(subset.bounds.min, subset.bounds.max));
         }
     }
     return retval;
 }
 
+QSSGBufferManager::LoadStatus QSSGBufferManager::loadStatus(const QSSGRenderImage *image) const
+{
+    if (image->m_imagePath.isEmpty())
+        return LoadStatus::Null;
+
+    // Light probes and skyboxes are loaded with their own mip mode
+    for (MipMode mipMode : { MipModeEnable, MipModeDisable, MipModeBsdf }) {
+        const ImageCacheKey imageKey = { image->m_imagePath, mipMode, int(image->type) };
+        if (pendingImages.contains(imageKey))
+            return LoadStatus::Loading;
+        const auto foundIt = imageMap.constFind(imageKey);
+        if (foundIt != imageMap.cend())
+            return foundIt->renderImageTexture.m_texture ? LoadStatus::Ready : LoadStatus::Error;
+    }
+
+    return LoadStatus::Null;
+}
+
+QSSGBufferManager::LoadStatus QSSGBufferManager::loadStatus(const QSSGRenderModel *model) const
+{
+    if (model->meshPath.isNull())
+        return LoadStatus::Null;
+    if (pendingMeshes.contains(model->meshPath))
+        return LoadStatus::Loading;
+    if (meshMap.contains(model->meshPath))
+        return LoadStatus::Ready;
+    if (failedMeshes.contains(model->meshPath))
+        return LoadStatus::Error;
+    return LoadStatus::Null;
+}
+
 QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh, const QString &debugObjectName)
 {
+    invalidateMeshPickingData();
     QSSGRenderMesh *newMesh = new QSSGRenderMesh(QSSGRenderDrawMode(mesh.drawMode()),
                                                  QSSGRenderWinding(mesh.winding()));
     const QSSGMesh::Mesh::VertexBuffer vertexBuffer = mesh.vertexBuffer();
@@ -1199,6 +1374,7 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
         QSSGRhiBufferPtr indexBuffer;
         QSSGRhiInputAssemblerState ia;
         QRhiTexture *targetsTexture = nullptr;
+        bool quantizedDirections = false;
     } rhi;
 
     QRhiResourceUpdateBatch *rub = meshBufferUpdateBatch();
@@ -1209,7 +1385,9 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
                                                        vertexBuffer.stride,
                                                        vertexBuffer.data.size());
     rhi.vertexBuffer->buffer()->setName(debugObjectName.toLatin1()); // this is what shows up in DebugView
-    rub->uploadStaticBuffer(rhi.vertexBuffer->buffer(), vertexBuffer.data);
+    // The data is copied right away, the buffers of a mesh loaded with
+    // loadMeshMapped() are only valid for as long as the mesh is.
+    rub->uploadStaticBuffer(rhi.vertexBuffer->buffer(), vertexBuffer.data.constData());
 
     if (!indexBuffer.data.isEmpty()) {
         rhi.indexBuffer = std::make_shared<QSSGRhiBuffer>(*context.get(),
@@ -1218,7 +1396,7 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
                                                           0,
                                                           indexBuffer.data.size(),
                                                           rhiIndexFormat);
-        rub->uploadStaticBuffer(rhi.indexBuffer->buffer(), indexBuffer.data);
+        rub->uploadStaticBuffer(rhi.indexBuffer->buffer(), indexBuffer.data.constData());
     }
 
     if (!targetBuffer.data.isEmpty()) {
@@ -1314,6 +1492,12 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
         if (ok) {
             QRhiVertexInputAttribute inputAttr(binding, location, format, offset);
             inputAttrs.append(inputAttr);
+            if (format == QRhiVertexInputAttribute::UNormByte4) {
+                const auto semantic = rhi.ia.inputs.last();
+                rhi.quantizedDirections |= semantic == QSSGRhiInputAssemblerState::NormalSemantic
+                        || semantic == QSSGRhiInputAssemblerState::TangentSemantic
+                        || semantic == QSSGRhiInputAssemblerState::BinormalSemantic;
+            }
         }
     }
     rhi.ia.inputLayout.setAttributes(inputAttrs.cbegin(), inputAttrs.cend());
@@ -1337,6 +1521,7 @@ QSSGRenderMesh *QSSGBufferManager::createRenderMesh(const QSSGMesh::Mesh &mesh,
         if (rhi.vertexBuffer) {
             subset.rhi.vertexBuffer = rhi.vertexBuffer;
             subset.rhi.ia = rhi.ia;
+            subset.rhi.quantizedDirections = rhi.quantizedDirections;
         }
         if (rhi.indexBuffer)
             subset.rhi.indexBuffer = rhi.indexBuffer;
@@ -1365,6 +1550,7 @@ void QSSGBufferManager::releaseGeometry(QSSGRenderGeometry *geometry)
         decreaseMemoryStat(meshItr.value().mesh);
         m_contextInterface->rhiContext()->releaseMesh(meshItr.value().mesh);
         customMeshMap.erase(meshItr);
+        invalidateMeshPickingData();
         Q_QUICK3D_PROFILE_END_WITH_ID(QQuick3DProfiler::Quick3DCustomMeshLoad,
                                            stats.meshDataSize, geometry->profilingId);
     }
@@ -1420,6 +1606,7 @@ void QSSGBufferManager::releaseMesh(const QSSGRenderPath &inSourcePath)
         decreaseMemoryStat(meshItr.value().mesh);
         m_contextInterface->rhiContext()->releaseMesh(meshItr.value().mesh);
         meshMap.erase(meshItr);
+        invalidateMeshPickingData();
         Q_QUICK3D_PROFILE_END_WITH_STRING(QQuick3DProfiler::Quick3DMeshLoad,
                                            stats.meshDataSize, inSourcePath.path().toUtf8());
     }
@@ -1445,6 +1632,61 @@ void QSSGBufferManager::releaseImage(const ImageCacheKey &key)
     }
 }
 
+static bool isUnused(const QHash<QSSGRenderLayer*, uint32_t> &usages)
+{
+    for (const auto &value : usages)
+        if (value != 0)
+            return false;
+    return true;
+}
+
+// A mesh that was reloaded with other processing options, nobody can get it anymore
+static inline bool isReapedMesh(const QSSGRenderPath &path)
+{
+    return path.path().endsWith(u"@reaped");
+}
+
+void QSSGBufferManager::evictToMemoryBudget()
+{
+    if (stats.meshDataSize + stats.imageDataSize <= memoryBudgetBytes)
+        return;
+
+    struct Candidate {
+        quint32 lastUsedFrame;
+        QSSGRenderPath meshPath;
+        ImageCacheKey imageKey;
+    };
+    QVarLengthArray<Candidate, 32> candidates;
+    {
+        QMutexLocker meshMutexLocker(&meshBufferMutex);
+        for (auto it = meshMap.cbegin(), end = meshMap.cend(); it != end; ++it) {
+            if (isUnused(it->usageCounts))
+                candidates.append({ it->lastUsedFrame, it.key(), {} });
+        }
+    }
+    for (auto it = imageMap.cbegin(), end = imageMap.cend(); it != end; ++it) {
+        if (isUnused(it->usageCounts))
+            candidates.append({ it->lastUsedFrame, {}, it.key() });
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        return a.lastUsedFrame < b.lastUsedFrame;
+    });
+
+    quint64 evictionCount = 0;
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        if (stats.meshDataSize + stats.imageDataSize <= memoryBudgetBytes)
+            break;
+        if (candidate.meshPath.isNull())
+            releaseImage(candidate.imageKey);
+        else
+            releaseMesh(candidate.meshPath);
+        ++evictionCount;
+    }
+
+    stats.evictionCount += evictionCount;
+    QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).resourcesEvicted(evictionCount);
+}
+
 void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLayer *currentLayer)
 {
 #if !defined(QSSG_RENDERBUFFER_DEBUGGING) && !defined(QSSG_RENDERBUFFER_DEBUGGING_USAGES)
@@ -1455,27 +1697,43 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
     if (frameId == frameCleanupIndex)
         return;
 
-    auto isUnused = [] (const QHash<QSSGRenderLayer*, uint32_t> &usages) -> bool {
-        for (const auto &value : std::as_const(usages))
-            if (value != 0)
-                return false;
-        return true;
+    // Asynchronous loads nobody asked for since the last cleanup. Dropping
+    // the future does not stop the worker, the result is freed when it is done.
+    const auto dropUnrequested = [](auto &pending) {
+        for (auto it = pending.begin(); it != pending.end(); ) {
+            if (it->requested) {
+                it->requested = false;
+                ++it;
+            } else {
+                it = pending.erase(it);
+            }
+        }
     };
+    dropUnrequested(pendingImages);
+    dropUnrequested(pendingMeshes);
+
+    // Unused meshes and images loaded from files are kept while there is a
+    // budget, evictToMemoryBudget() releases them when it is exceeded
+    const bool keepUnused = memoryBudgetBytes > 0;
 
     {
         QMutexLocker meshMutexLocker(&meshBufferMutex);
         // Meshes (by path)
-        auto meshIterator = meshMap.cbegin();
-        while (meshIterator != meshMap.cend()) {
-            if (isUnused(meshIterator.value().usageCounts)) {
+        auto meshIterator = meshMap.begin();
+        while (meshIterator != meshMap.end()) {
+            if (!isUnused(meshIterator.value().usageCounts)) {
+                meshIterator.value().lastUsedFrame = frameId;
+                ++meshIterator;
+            } else if (keepUnused && meshIterator.value().mesh && !isReapedMesh(meshIterator.key())) {
+                ++meshIterator;
+            } else {
 #ifdef QSSG_RENDERBUFFER_DEBUGGING
                 qDebug() << "- releaseGeometry: " << meshIterator.key().path() << currentLayer;
 #endif
                 decreaseMemoryStat(meshIterator.value().mesh);
                 m_contextInterface->rhiContext()->releaseMesh(meshIterator.value().mesh);
                 meshIterator = meshMap.erase(meshIterator);
-            } else {
-                ++meshIterator;
+                invalidateMeshPickingData();
             }
         }
 
@@ -1489,6 +1747,7 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
                 decreaseMemoryStat(customMeshIterator.value().mesh);
                 m_contextInterface->rhiContext()->releaseMesh(customMeshIterator.value().mesh);
                 customMeshIterator = customMeshMap.erase(customMeshIterator);
+                invalidateMeshPickingData();
             } else {
                 ++customMeshIterator;
             }
@@ -1509,9 +1768,14 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
     }
 
     // Images
-    auto imageKeyIterator = imageMap.cbegin();
-    while (imageKeyIterator != imageMap.cend()) {
-        if (isUnused(imageKeyIterator.value().usageCounts)) {
+    auto imageKeyIterator = imageMap.begin();
+    while (imageKeyIterator != imageMap.end()) {
+        if (!isUnused(imageKeyIterator.value().usageCounts)) {
+            imageKeyIterator.value().lastUsedFrame = frameId;
+            ++imageKeyIterator;
+        } else if (keepUnused && imageKeyIterator.value().renderImageTexture.m_texture) {
+            ++imageKeyIterator;
+        } else {
             auto rhiTexture = imageKeyIterator.value().renderImageTexture.m_texture;
             if (rhiTexture) {
 #ifdef QSSG_RENDERBUFFER_DEBUGGING
@@ -1521,8 +1785,6 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
                 m_contextInterface->rhiContext()->releaseTexture(rhiTexture);
             }
             imageKeyIterator = imageMap.erase(imageKeyIterator);
-        } else {
-            ++imageKeyIterator;
         }
     }
 
@@ -1562,6 +1824,12 @@ void QSSGBufferManager::cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLa
         }
     }
 
+    if (keepUnused)
+        evictToMemoryBudget();
+
+    if (meshPickingDataDirty.fetchAndStoreRelaxed(0))
+        publishMeshPickingData();
+
     // Resource Tracking Debug Code
     frameCleanupIndex = frameId;
 #ifdef QSSG_RENDERBUFFER_DEBUGGING_USAGES
@@ -1611,6 +1879,75 @@ void QSSGBufferManager::resetUsageCounters(quint32 frameId, QSSGRenderLayer *lay
     frameResetIndex = frameId;
 }
 
+void QSSGBufferManager::requestImageDetail(const QSSGRenderImage *image, float screenSize)
+{
+    const ImageCacheKey imageKey = { image->m_imagePath, image->m_generateMipmaps ? MipModeEnable : MipModeDisable, int(image->type) };
+    const auto it = imageMap.find(imageKey);
+    if (it == imageMap.end() || !it->stream)
+        return;
+
+    // Enough for one texel per pixel, each level has half of the texels of
+    // the one above along either side
+    TextureStream &stream = *it->stream;
+    const QSize size = stream.source->textureFileData.size();
+    const float texels = float(qMax(size.width(), size.height()));
+    const int level = (screenSize >= texels) ? 0 : int(std::log2(texels / qMax(screenSize, 1.0f)));
+    stream.wantedLevel = qMin(stream.wantedLevel, level);
+}
+
+void QSSGBufferManager::streamImages(quint32 frameId)
+{
+    if (frameStreamIndex == frameId)
+        return;
+    frameStreamIndex = frameId;
+
+    // Nothing uses the textures in this frame yet, so they can be replaced
+    // here. The first image always gets its next level, even if that alone
+    // is over the budget, otherwise the larger levels would never be there.
+    quint64 uploaded = 0;
+    for (auto it = imageMap.begin(), end = imageMap.end(); it != end && uploaded < streamingBudgetBytes; ++it) {
+        if (it->stream && it->stream->wantedLevel < it->stream->baseLevel)
+            uploaded += streamImage(it.value());
+    }
+}
+
+bool QSSGBufferManager::hasPendingStreams() const
+{
+    return std::any_of(imageMap.cbegin(), imageMap.cend(), [](const ImageData &imageData) {
+        return imageData.stream && imageData.stream->wantedLevel < imageData.stream->baseLevel;
+    });
+}
+
+quint64 QSSGBufferManager::streamImage(ImageData &imageData)
+{
+    TextureStream &stream = *imageData.stream;
+    const int baseLevel = stream.baseLevel - 1;
+    const QTextureFileData &tex = stream.source->textureFileData;
+
+    // The texture is created again with one more level, rather than copying
+    // the levels it has, since that cannot be done for compressed formats on
+    // every backend.
+    QSSGRenderImageTexture texture;
+    if (!createRhiTexture(texture, stream.source.get(), stream.mipMode, ScanForTransparency, stream.debugObjectName, baseLevel)) {
+        imageData.stream.reset();
+        return 0;
+    }
+
+    decreaseMemoryStat(imageData.renderImageTexture.m_texture);
+    m_contextInterface->rhiContext()->releaseTexture(imageData.renderImageTexture.m_texture);
+    imageData.renderImageTexture = texture;
+    increaseMemoryStat(texture.m_texture);
+
+    quint64 uploaded = 0;
+    for (int level = baseLevel; level < tex.numLevels(); ++level)
+        uploaded += quint64(tex.dataLength(level));
+
+    stream.baseLevel = baseLevel;
+    if (baseLevel == 0)
+        imageData.stream.reset();
+    return uploaded;
+}
+
 void QSSGBufferManager::registerMeshData(const QString &assetId, const QVector<QSSGMesh::Mesh> &meshData)
 {
     auto it = g_assetMeshMap->find(assetId);
@@ -1627,7 +1964,63 @@ void QSSGBufferManager::unregisterMeshData(const QString &assetId)
         g_assetMeshMap->erase(AssetMeshMap::const_iterator(it));
 }
 
-QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(const QSSGRenderPath &inMeshPath, QSSGMeshProcessingOptions options)
+static QSSGMesh::Mesh loadMeshWithOptions(const QSSGRenderPath &inMeshPath,
+                                          const QSSGMeshProcessingOptions &options,
+                                          QString *resultSourcePath)
+{
+    QSSGMesh::Mesh result;
+
+    if (options.wantsLightmapUVs && !options.meshFileOverride.isEmpty()) {
+        // So now we have a hint, e.g "qlm_xxxx.mesh" that says that if that
+        // file exists, then we should prefer that because it has the lightmap
+        // UV unwrapping and associated rebuilding already done.
+        if (QFile::exists(options.meshFileOverride)) {
+            *resultSourcePath = options.meshFileOverride;
+            result = QSSGBufferManager::loadMeshData(QSSGRenderPath(options.meshFileOverride),
+                                                     QSSGBufferManager::LoadMeshDataMapped);
+        }
+    }
+
+    if (!result.isValid()) {
+        *resultSourcePath = inMeshPath.path();
+        result = QSSGBufferManager::loadMeshData(inMeshPath, QSSGBufferManager::LoadMeshDataMapped);
+    }
+
+    if (result.isValid() && options.wantsLightmapUVs) {
+        // Does nothing if the lightmap uv attribute is already present,
+        // otherwise this is a potentially expensive step that will do UV
+        // unwrapping and rebuild much of the mesh's data.
+        result.createLightmapUVChannel(options.lightmapBaseResolution);
+    }
+
+    return result;
+}
+
+// Runs on a worker thread, must not touch anything but its arguments
+std::shared_ptr<QSSGBufferManager::AsyncMeshData> QSSGBufferManager::loadMeshAsync(const QSSGRenderPath &inSourcePath,
+                                                                                   const QSSGMeshProcessingOptions &options,
+                                                                                   bool buildBVH)
+{
+    auto data = std::make_shared<AsyncMeshData>();
+    data->mesh = loadMeshWithOptions(inSourcePath, options, &data->sourcePath);
+    if (buildBVH && data->mesh.isValid()) {
+        QSSGMeshBVHBuilder meshBVHBuilder(data->mesh);
+        data->bvh = meshBVHBuilder.buildTree();
+    }
+    return data;
+}
+
+// Runs on a worker thread
+std::shared_ptr<QSSGLoadedTexture> QSSGBufferManager::loadImageAsync(const QString &inPath,
+                                                                     QSSGRenderTextureFormat inFormat,
+                                                                     bool inFlipY)
+{
+    return std::shared_ptr<QSSGLoadedTexture>(QSSGLoadedTexture::load(inPath, inFormat, inFlipY));
+}
+
+QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(const QSSGRenderPath &inMeshPath,
+                                                  QSSGMeshProcessingOptions options,
+                                                  LoadRenderMeshFlags flags)
 {
     if (inMeshPath.isNull())
         return nullptr;
@@ -1647,45 +2040,68 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(const QSSGRenderPath &inMeshPa
         }
     }
 
-    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DMeshLoad);
-    Q_TRACE_SCOPE(QSSG_meshLoadPath, inMeshPath.path());
-
     QSSGMesh::Mesh result;
     QString resultSourcePath;
-
-    if (options.wantsLightmapUVs && !options.meshFileOverride.isEmpty()) {
-        // So now we have a hint, e.g "qlm_xxxx.mesh" that says that if that
-        // file exists, then we should prefer that because it has the lightmap
-        // UV unwrapping and associated rebuilding already done.
-        if (QFile::exists(options.meshFileOverride)) {
-            resultSourcePath = options.meshFileOverride;
-            result = loadMeshData(QSSGRenderPath(options.meshFileOverride));
+    std::unique_ptr<QSSGMeshBVH> bvh;
+
+    // Primitives and meshes registered at runtime are in memory already
+    const bool asynchronous = flags.testFlag(LoadAsynchronously)
+            && !inMeshPath.path().startsWith(u'#')
+            && !inMeshPath.path().startsWith(u'!');
+    if (asynchronous) {
+        auto pendingIt = pendingMeshes.find(inMeshPath);
+        if (pendingIt != pendingMeshes.end() && !options.isCompatible(pendingIt->options)) {
+            pendingMeshes.erase(pendingIt);
+            pendingIt = pendingMeshes.end();
+        }
+        if (pendingIt == pendingMeshes.end()) {
+            // A file that failed to load is not retried every frame
+            if (failedMeshes.contains(inMeshPath))
+                return nullptr;
+            pendingMeshes.insert(inMeshPath, { QtConcurrent::run(&asyncLoadPool, &QSSGBufferManager::loadMeshAsync,
+                                                                 inMeshPath, options, flags.testFlag(LoadWithBVH)),
+                                               options });
+            loadStatusChanged = true;
+            return nullptr;
         }
+        pendingIt->requested = true;
+        if (!pendingIt->future.isFinished())
+            return nullptr;
+        const std::shared_ptr<AsyncMeshData> data = pendingIt->future.result();
+        pendingMeshes.erase(pendingIt);
+        result = data->mesh;
+        resultSourcePath = data->sourcePath;
+        bvh = std::move(data->bvh);
     }
 
-    if (!result.isValid()) {
-        resultSourcePath = inMeshPath.path();
-        result = loadMeshData(inMeshPath);
-    }
+    Q_QUICK3D_PROFILE_START(QQuick3DProfiler::Quick3DMeshLoad);
+    Q_TRACE_SCOPE(QSSG_meshLoadPath, inMeshPath.path());
+
+    if (!asynchronous)
+        result = loadMeshWithOptions(inMeshPath, options, &resultSourcePath);
 
     if (!result.isValid()) {
+        if (!failedMeshes.contains(inMeshPath)) {
+            failedMeshes.insert(inMeshPath);
+            loadStatusChanged = true;
+        }
         qCWarning(WARNING, "Failed to load mesh: %s", qPrintable(inMeshPath.path()));
         Q_QUICK3D_PROFILE_END_WITH_PAYLOAD(QQuick3DProfiler::Quick3DMeshLoad,
                                            stats.meshDataSize);
         return nullptr;
     }
+    failedMeshes.remove(inMeshPath);
+    loadStatusChanged = true;
 #ifdef QSSG_RENDERBUFFER_DEBUGGING
     qDebug() << "+ uploadGeometry: " << inMeshPath.path() << currentLayer;
 #endif
 
-    if (options.wantsLightmapUVs) {
-        // Does nothing if the lightmap uv attribute is already present,
-        // otherwise this is a potentially expensive step that will do UV
-        // unwrapping and rebuild much of the mesh's data.
-        result.createLightmapUVChannel(options.lightmapBaseResolution);
-    }
-
     auto ret = createRenderMesh(result, QFileInfo(resultSourcePath).fileName());
+    if (bvh) {
+        ret->bvh = std::move(bvh);
+        for (qsizetype i = 0, end = qMin(ret->bvh->roots.size(), ret->subsets.size()); i < end; ++i)
+            ret->subsets[i].bvhRoot = ret->bvh->roots.at(i);
+    }
     meshMap.insert(inMeshPath, { ret, {{currentLayer, 1}}, 0, options });
     m_contextInterface->rhiContext()->registerMesh(ret);
     increaseMemoryStat(ret);
@@ -1745,7 +2161,7 @@ QSSGRenderMesh *QSSGBufferManager::loadRenderMesh(QSSGRenderGeometry *geometry,
 
 std::unique_ptr<QSSGMeshBVH> QSSGBufferManager::loadMeshBVH(const QSSGRenderPath &inSourcePath)
 {
-    const QSSGMesh::Mesh mesh = loadMeshData(inSourcePath);
+    const QSSGMesh::Mesh mesh = loadMeshData(inSourcePath, LoadMeshDataMapped);
     if (!mesh.isValid()) {
         qCWarning(WARNING, "Failed to load mesh: %s", qPrintable(inSourcePath.path()));
         return nullptr;
@@ -1800,7 +2216,7 @@ std::unique_ptr<QSSGMeshBVH> QSSGBufferManager::loadMeshBVH(QSSGRenderGeometry *
     return meshBVHBuilder.buildTree();
 }
 
-QSSGMesh::Mesh QSSGBufferManager::loadMeshData(const QSSGRenderPath &inMeshPath)
+QSSGMesh::Mesh QSSGBufferManager::loadMeshData(const QSSGRenderPath &inMeshPath, LoadMeshDataFlags flags)
 {
     QSSGMesh::Mesh result;
 
@@ -1835,7 +2251,9 @@ QSSGMesh::Mesh QSSGBufferManager::loadMeshData(const QSSGRenderPath &inMeshPath)
         if (!pathBuilder.isEmpty()) {
             QSharedPointer<QIODevice> device(QSSGInputUtil::getStreamForFile(pathBuilder));
             if (device) {
-                QSSGMesh::Mesh mesh = QSSGMesh::Mesh::loadMesh(device.data(), id);
+                QSSGMesh::Mesh mesh = flags.testFlag(LoadMeshDataMapped)
+                        ? QSSGMesh::Mesh::loadMeshMapped(device, id)
+                        : QSSGMesh::Mesh::loadMesh(device.data(), id);
                 if (mesh.isValid())
                     result = mesh;
             }
@@ -1845,6 +2263,28 @@ QSSGMesh::Mesh QSSGBufferManager::loadMeshData(const QSSGRenderPath &inMeshPath)
     return result;
 }
 
+QVector<QSSGMesh::Mesh::Subset> QSSGBufferManager::loadMeshSubsets(const QSSGRenderPath &inMeshPath)
+{
+    // Primitives and meshes registered at runtime are in memory already
+    QString pathBuilder = inMeshPath.path();
+    if (pathBuilder.startsWith(u'#') || pathBuilder.startsWith(u'!'))
+        return loadMeshData(inMeshPath).subsets();
+
+    const int poundIndex = pathBuilder.lastIndexOf(QChar::fromLatin1('#'));
+    quint32 id = 0;
+    if (poundIndex != -1) {
+        id = QStringView(pathBuilder).mid(poundIndex + 1).toUInt();
+        pathBuilder = pathBuilder.left(poundIndex);
+    }
+    if (!pathBuilder.isEmpty()) {
+        QSharedPointer<QIODevice> device(QSSGInputUtil::getStreamForFile(pathBuilder));
+        if (device)
+            return QSSGMesh::Mesh::loadSubsets(device.data(), id);
+    }
+
+    return {};
+}
+
 QSSGMesh::Mesh QSSGBufferManager::loadMeshData(const QSSGRenderGeometry *geometry)
 {
     QString error;
@@ -1875,6 +2315,12 @@ void QSSGBufferManager::registerExtensionResult(const QSSGRenderExtension &exten
 
 void QSSGBufferManager::clear()
 {
+    std::atomic_store(&meshPickingData, std::shared_ptr<const MeshPickingDataMaps>());
+    meshPickingDataDirty.storeRelaxed(0);
+    pendingImages.clear();
+    pendingMeshes.clear();
+    failedMeshes.clear();
+
     if (meshBufferUpdates) {
         meshBufferUpdates->release();
         meshBufferUpdates = nullptr;
@@ -2037,7 +2483,7 @@ void QSSGBufferManager::increaseMemoryStat(QRhiTexture *texture)
 
 void QSSGBufferManager::decreaseMemoryStat(QRhiTexture *texture)
 {
-    stats.imageDataSize = qMax(0u, stats.imageDataSize - textureMemorySize(texture));
+    stats.imageDataSize -= qMin(stats.imageDataSize, textureMemorySize(texture));
     QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).imageDataSizeChanges(stats.imageDataSize);
 }
 
@@ -2054,7 +2500,7 @@ void QSSGBufferManager::decreaseMemoryStat(QSSGRenderMesh *mesh)
     if (mesh)
     s = bufferMemorySize(mesh->subsets.at(0).rhi.vertexBuffer)
             + bufferMemorySize(mesh->subsets.at(0).rhi.indexBuffer);
-    stats.meshDataSize = qMax(0u, stats.meshDataSize - s);
+    stats.meshDataSize -= qMin(stats.meshDataSize, s);
     QSSGRhiContextStats::get(*m_contextInterface->rhiContext()).meshDataSizeChanges(stats.meshDataSize);
 }
 
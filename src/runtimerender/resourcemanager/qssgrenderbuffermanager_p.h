@@ -26,6 +26,12 @@
 #include <QtQuick3DUtils/private/qquick3dprofiler_p.h>
 
 #include <QtCore/QMutex>
+#include <QtCore/QFuture>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+
+#include <memory>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
@@ -89,10 +95,28 @@ public:
         int mipMode;
     };
 
+    enum MipMode {
+        MipModeFollowRenderImage,
+        MipModeEnable,
+        MipModeDisable,
+        MipModeBsdf
+    };
+
+    // The source of a streamed image, kept until all of its levels are uploaded
+    struct TextureStream {
+        std::shared_ptr<QSSGLoadedTexture> source;
+        MipMode mipMode = MipModeDisable;
+        int baseLevel = 0; // the level of the source that is level 0 of the texture
+        int wantedLevel = 0; // the largest level asked for by requestImageDetail()
+        QString debugObjectName;
+    };
+
     struct ImageData {
         QSSGRenderImageTexture renderImageTexture;
         QHash<QSSGRenderLayer*, uint32_t> usageCounts;
         uint32_t generationId = 0;
+        quint32 lastUsedFrame = 0;
+        std::shared_ptr<TextureStream> stream;
     };
 
     struct MeshData {
@@ -100,18 +124,13 @@ public:
         QHash<QSSGRenderLayer*, uint32_t> usageCounts;
         uint32_t generationId = 0;
         QSSGMeshProcessingOptions options;
+        quint32 lastUsedFrame = 0;
     };
 
     struct MemoryStats {
         quint64 meshDataSize = 0;
         quint64 imageDataSize = 0;
-    };
-
-    enum MipMode {
-        MipModeFollowRenderImage,
-        MipModeEnable,
-        MipModeDisable,
-        MipModeBsdf
+        quint64 evictionCount = 0;
     };
 
     enum LoadRenderImageFlag {
@@ -119,6 +138,18 @@ public:
     };
     Q_DECLARE_FLAGS(LoadRenderImageFlags, LoadRenderImageFlag)
 
+    enum LoadMeshDataFlag {
+        LoadMeshDataMapped = 0x01
+    };
+    Q_DECLARE_FLAGS(LoadMeshDataFlags, LoadMeshDataFlag)
+
+    enum class LoadStatus {
+        Null,
+        Loading,
+        Ready,
+        Error
+    };
+
     QSSGBufferManager();
     ~QSSGBufferManager();
 
@@ -135,14 +166,71 @@ public:
     QSSGRenderImageTexture loadSkinmap(QSSGRenderTextureData *skin);
 
     QSSGRenderMesh *getMeshForPicking(const QSSGRenderModel &model) const;
+
+    // What picking needs from a mesh. It is shared with QSSGPickSnapshot and
+    // stays valid after the mesh is released.
+    struct MeshPickingData {
+        std::shared_ptr<const QSSGMeshBVH> bvh;
+        QVector<QSSGBounds3> subsetBounds;
+        QVector<QSSGMeshBVHNode::Handle> subsetRoots; // Null for subsets without a BVH
+        QSSGBounds3 bounds; // Of all the subsets
+        quint32 generationId = 0; // Of the custom geometry
+    };
+    using MeshPickingDataPtr = std::shared_ptr<const MeshPickingData>;
+
+    // Lock free for the meshes loaded before the last
+    // cleanupUnreferencedBuffers(), which publishes the picking data. Meshes
+    // loaded after that are looked up with meshUpdateMutex() locked.
+    MeshPickingDataPtr getMeshPickingData(const QSSGRenderModel &model);
+    // Republish the picking data at the end of the frame, e.g. when a mesh got its BVH
+    void invalidateMeshPickingData() { meshPickingDataDirty.storeRelaxed(1); }
     QSSGBounds3 getModelBounds(const QSSGRenderModel *model) const;
 
     QSSGRenderMesh *loadMesh(const QSSGRenderModel *model);
 
+    // Images and models that are marked asynchronous are read and decoded on
+    // a worker thread. Until the data is there, loadRenderImage() and
+    // loadMesh() return nothing for them, the first call after that uploads
+    // it. The status of the source of an image or model is Null until it is
+    // asked for the first time.
+    LoadStatus loadStatus(const QSSGRenderImage *image) const;
+    LoadStatus loadStatus(const QSSGRenderModel *model) const;
+    [[nodiscard]] bool hasPendingLoads() const { return !pendingImages.isEmpty() || !pendingMeshes.isEmpty(); }
+    // True when a load from a file was started or finished since the last
+    // call, meaning that the status of some image or model changed.
+    bool takeLoadStatusChanged() { return std::exchange(loadStatusChanged, false); }
+
     // Called at the end of the frame to release unreferenced geometry and textures
     void cleanupUnreferencedBuffers(quint32 frameId, QSSGRenderLayer *layer);
     void resetUsageCounters(quint32 frameId, QSSGRenderLayer *layer);
 
+    // With a budget, meshes and images loaded from files stay cached when
+    // nothing uses them anymore, so that switching back to a scene does not
+    // load them again. When the mesh and image data gets over the budget, the
+    // cached ones are released, the least recently used first. Without a
+    // budget (0, the default unless QT_QUICK3D_MEMORY_BUDGET gives one in
+    // megabytes) they are released at the end of the frame they were last
+    // used in. View3D::memoryBudget overrides the default.
+    [[nodiscard]] static quint64 defaultMemoryBudget();
+    void setMemoryBudget(quint64 bytes) { memoryBudgetBytes = bytes; }
+    quint64 memoryBudget() const { return memoryBudgetBytes; }
+    const MemoryStats &memoryStats() const { return stats; }
+
+    // Images marked for streaming that come from a file with mip levels get
+    // only the levels up to the initial streaming size uploaded at first.
+    // requestImageDetail() tells how large such an image is on the screen,
+    // in pixels, and streamImages(), called at the start of a frame, uploads
+    // the larger levels needed for that. That is one level per image and
+    // frame, until the budget of bytes per frame is used up (4 MB, unless
+    // QT_QUICK3D_TEXTURE_STREAMING_BUDGET gives one in kilobytes).
+    void requestImageDetail(const QSSGRenderImage *image, float screenSize);
+    void streamImages(quint32 frameId);
+    // True while a streamed image still needs larger levels, which are only
+    // uploaded when more frames are rendered
+    [[nodiscard]] bool hasPendingStreams() const;
+    void setStreamingBudget(quint64 bytesPerFrame) { streamingBudgetBytes = bytesPerFrame; }
+    quint64 streamingBudget() const { return streamingBudgetBytes; }
+
     void releaseGeometry(QSSGRenderGeometry *geometry);
     void releaseTextureData(const QSSGRenderTextureData *data);
     void releaseTextureData(const CustomImageCacheKey &key);
@@ -155,7 +243,11 @@ public:
     static std::unique_ptr<QSSGMeshBVH> loadMeshBVH(const QSSGRenderPath &inSourcePath);
     static std::unique_ptr<QSSGMeshBVH> loadMeshBVH(QSSGRenderGeometry *geometry);
 
-    static QSSGMesh::Mesh loadMeshData(const QSSGRenderPath &inSourcePath);
+    // With LoadMeshDataMapped, mesh files are memory mapped instead of read,
+    // see QSSGMesh::Mesh::loadMeshMapped() for what that implies.
+    static QSSGMesh::Mesh loadMeshData(const QSSGRenderPath &inSourcePath, LoadMeshDataFlags flags = {});
+    // Reads the subsets, with their bounds, without the buffers
+    static QVector<QSSGMesh::Mesh::Subset> loadMeshSubsets(const QSSGRenderPath &inSourcePath);
     QSSGMesh::Mesh loadMeshData(const QSSGRenderGeometry *geometry);
 
     void registerExtensionResult(const QSSGRenderExtension &extensions, QRhiTexture *texture);
@@ -186,19 +278,42 @@ private:
     QRhiResourceUpdateBatch *meshBufferUpdateBatch();
 
     static QSSGMesh::Mesh loadPrimitive(const QString &inRelativePath);
+
+    enum LoadRenderMeshFlag {
+        LoadAsynchronously = 0x01,
+        LoadWithBVH = 0x02
+    };
+    Q_DECLARE_FLAGS(LoadRenderMeshFlags, LoadRenderMeshFlag)
+
+    struct AsyncMeshData {
+        QSSGMesh::Mesh mesh;
+        QString sourcePath;
+        std::unique_ptr<QSSGMeshBVH> bvh;
+    };
+    static std::shared_ptr<AsyncMeshData> loadMeshAsync(const QSSGRenderPath &inSourcePath,
+                                                        const QSSGMeshProcessingOptions &options,
+                                                        bool buildBVH);
+    static std::shared_ptr<QSSGLoadedTexture> loadImageAsync(const QString &inPath,
+                                                             QSSGRenderTextureFormat inFormat,
+                                                             bool inFlipY);
     enum CreateRhiTextureFlag {
         ScanForTransparency = 0x01,
         CubeMap = 0x02,
         Texture3D = 0x04
     };
     Q_DECLARE_FLAGS(CreateRhiTextureFlags, CreateRhiTextureFlag)
+    // With a baseLevel, the texture gets the levels of a texture file from
+    // that one on, see streamImages()
     bool createRhiTexture(QSSGRenderImageTexture &texture,
                           const QSSGLoadedTexture *inTexture,
                           MipMode inMipMode,
                           CreateRhiTextureFlags inFlags,
-                          const QString &debugObjectName);
+                          const QString &debugObjectName,
+                          int baseLevel = 0);
+    quint64 streamImage(ImageData &imageData);
 
-    QSSGRenderMesh *loadRenderMesh(const QSSGRenderPath &inSourcePath, QSSGMeshProcessingOptions options);
+    QSSGRenderMesh *loadRenderMesh(const QSSGRenderPath &inSourcePath, QSSGMeshProcessingOptions options,
+                                   LoadRenderMeshFlags flags = {});
     QSSGRenderMesh *loadRenderMesh(QSSGRenderGeometry *geometry, QSSGMeshProcessingOptions options);
 
     QSSGRenderMesh *createRenderMesh(const QSSGMesh::Mesh &mesh, const QString &debugObjectName = {});
@@ -207,6 +322,9 @@ private:
 
     void releaseMesh(const QSSGRenderPath &inSourcePath);
     void releaseImage(const ImageCacheKey &key);
+    static MeshPickingDataPtr createMeshPickingData(const QSSGRenderMesh *mesh, quint32 generationId);
+    void publishMeshPickingData();
+    void evictToMemoryBudget();
 
     QSSGRenderContextInterface *m_contextInterface = nullptr; // ContextInterfaces owns BufferManager
 
@@ -218,16 +336,47 @@ private:
     QHash<QSSGRenderPath, MeshData> meshMap;                    // Meshes (specififed by path)
     QHash<QSSGRenderGeometry *, MeshData> customMeshMap;        // Meshes (QQuick3DGeometry)
 
+    // Asynchronous loads, until the first loadRenderImage() or loadMesh()
+    // after they are done. The ones nobody asked for in a frame are dropped.
+    struct PendingImage {
+        QFuture<std::shared_ptr<QSSGLoadedTexture>> future;
+        bool requested = true;
+    };
+    struct PendingMesh {
+        QFuture<std::shared_ptr<AsyncMeshData>> future;
+        QSSGMeshProcessingOptions options;
+        bool requested = true;
+    };
+    QHash<ImageCacheKey, PendingImage> pendingImages;
+    QHash<QSSGRenderPath, PendingMesh> pendingMeshes;
+    QSet<QSSGRenderPath> failedMeshes;
+    // Not the global pool, the render thread uses that for its own jobs
+    QThreadPool asyncLoadPool;
+    bool loadStatusChanged = false;
+
     QRhiResourceUpdateBatch *meshBufferUpdates = nullptr;
     QMutex meshBufferMutex;
 
+    // Snapshot of the picking data of meshMap and customMeshMap, replaced
+    // (with std::atomic_store) by the render thread and read without locking
+    struct MeshPickingDataMaps {
+        QHash<QSSGRenderPath, MeshPickingDataPtr> meshes;
+        QHash<const QSSGRenderGeometry *, MeshPickingDataPtr> customMeshes;
+    };
+    std::shared_ptr<const MeshPickingDataMaps> meshPickingData;
+    QAtomicInt meshPickingDataDirty;
+
     quint32 frameCleanupIndex = 0;
     quint32 frameResetIndex = 0;
     QSSGRenderLayer *currentLayer = nullptr;
     MemoryStats stats;
+    quint64 memoryBudgetBytes = 0;
+    quint64 streamingBudgetBytes = 4 * 1024 * 1024;
+    quint32 frameStreamIndex = 0;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QSSGBufferManager::LoadRenderImageFlags)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QSSGBufferManager::LoadMeshDataFlags)
 
 inline size_t qHash(const QSSGBufferManager::ImageCacheKey &k, size_t seed) Q_DECL_NOTHROW
 {
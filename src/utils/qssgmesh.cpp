@@ -3,6 +3,8 @@
 
 #include "qssgmesh_p.h"
 
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
 #include <QtCore/QVector>
 #include <QtQuick3DUtils/private/qssgdataref_p.h>
 #include <QtQuick3DUtils/private/qssglightmapuvgenerator_p.h>
@@ -92,15 +94,178 @@ void MeshInternal::writeFileHeader(QIODevice *device, const MeshInternal::MultiM
     outputStream << meshFileInfo.fileId << meshFileInfo.fileVersion << multiEntriesOffset << meshCount;
 }
 
-quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh, MeshDataHeader *header)
+// Directions share the exponent between their components, everything else
+// is filtered per component so that large and small values next to each
+// other keep their precision.
+static const int FILTER_DIRECTION_BITS = 12;
+static const int FILTER_COMPONENT_BITS = 16;
+
+static void filterVertexData(char *data, quint32 vertexCount, quint32 stride,
+                             const QVector<Mesh::VertexBufferEntry> &entries)
+{
+    for (const Mesh::VertexBufferEntry &entry : entries) {
+        if (entry.componentType != Mesh::ComponentType::Float32 || entry.offset % sizeof(float) != 0)
+            continue;
+        const bool isDirection = entry.name == MeshInternal::getNormalAttrName()
+                || entry.name == MeshInternal::getTexTanAttrName()
+                || entry.name == MeshInternal::getTexBinormalAttrName();
+        const size_t size = entry.componentCount * sizeof(float);
+        const size_t filterStride = isDirection ? size : sizeof(float);
+        const int bits = isDirection ? FILTER_DIRECTION_BITS : FILTER_COMPONENT_BITS;
+        for (quint32 i = 0; i < vertexCount; ++i) {
+            float *v = reinterpret_cast<float *>(data + i * stride + entry.offset);
+            meshopt_encodeFilterExp(v, size / filterStride, filterStride, bits, v);
+        }
+    }
+}
+
+static void unfilterVertexData(char *data, quint32 vertexCount, quint32 stride,
+                               const QVector<Mesh::VertexBufferEntry> &entries)
+{
+    // The filter decodes every component in isolation, so when there is
+    // nothing but floats the whole buffer goes in one go
+    const bool allFloats = stride % sizeof(float) == 0
+            && std::all_of(entries.cbegin(), entries.cend(), [](const Mesh::VertexBufferEntry &entry) {
+                   return entry.componentType == Mesh::ComponentType::Float32;
+               });
+    if (allFloats) {
+        meshopt_decodeFilterExp(data, vertexCount * (stride / sizeof(float)), sizeof(float));
+        return;
+    }
+    for (const Mesh::VertexBufferEntry &entry : entries) {
+        if (entry.componentType != Mesh::ComponentType::Float32 || entry.offset % sizeof(float) != 0)
+            continue;
+        for (quint32 i = 0; i < vertexCount; ++i)
+            meshopt_decodeFilterExp(data + i * stride + entry.offset, entry.componentCount, sizeof(float));
+    }
+}
+
+// Empty when the data cannot be encoded or would not get any smaller
+static QByteArray encodeVertexData(const QByteArray &data, quint32 vertexSize)
+{
+    if (data.isEmpty() || vertexSize == 0 || vertexSize % 4 != 0 || vertexSize > 256
+            || data.size() % vertexSize != 0) {
+        return QByteArray();
+    }
+
+    const size_t vertexCount = data.size() / vertexSize;
+    QByteArray encoded(meshopt_encodeVertexBufferBound(vertexCount, vertexSize), Qt::Uninitialized);
+    const size_t encodedSize = meshopt_encodeVertexBuffer(reinterpret_cast<unsigned char *>(encoded.data()),
+                                                          encoded.size(), data.constData(),
+                                                          vertexCount, vertexSize);
+    if (encodedSize == 0 || encodedSize >= size_t(data.size()))
+        return QByteArray();
+    encoded.truncate(encodedSize);
+    return encoded;
+}
+
+static bool decodeVertexData(char *dst, quint32 size, quint32 vertexSize, const QByteArray &encoded)
+{
+    if (vertexSize == 0 || size % vertexSize != 0)
+        return false;
+    return meshopt_decodeVertexBuffer(dst, size / vertexSize, vertexSize,
+                                      reinterpret_cast<const unsigned char *>(encoded.constData()),
+                                      encoded.size()) == 0;
+}
+
+// The index codec only handles triangle lists, and it may rotate the
+// triangles, the winding stays the same
+static QByteArray encodeIndexData(const QByteArray &data, Mesh::ComponentType componentType, Mesh::DrawMode drawMode)
+{
+    if (drawMode != Mesh::DrawMode::Triangles)
+        return QByteArray();
+    if (componentType != Mesh::ComponentType::UnsignedInt16 && componentType != Mesh::ComponentType::UnsignedInt32)
+        return QByteArray();
+
+    const quint32 indexSize = MeshInternal::byteSizeForComponentType(componentType);
+    const size_t indexCount = data.size() / indexSize;
+    if (indexCount == 0 || indexCount % 3 != 0)
+        return QByteArray();
+
+    QVector<quint32> indices(indexCount);
+    quint32 maxIndex = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        if (indexSize == 2)
+            indices[i] = reinterpret_cast<const quint16 *>(data.constData())[i];
+        else
+            indices[i] = reinterpret_cast<const quint32 *>(data.constData())[i];
+        maxIndex = qMax(maxIndex, indices[i]);
+    }
+
+    QByteArray encoded(meshopt_encodeIndexBufferBound(indexCount, size_t(maxIndex) + 1), Qt::Uninitialized);
+    const size_t encodedSize = meshopt_encodeIndexBuffer(reinterpret_cast<unsigned char *>(encoded.data()),
+                                                         encoded.size(), indices.constData(), indexCount);
+    if (encodedSize == 0 || encodedSize >= size_t(data.size()))
+        return QByteArray();
+    encoded.truncate(encodedSize);
+    return encoded;
+}
+
+static bool decodeIndexData(char *dst, quint32 size, Mesh::ComponentType componentType, const QByteArray &encoded)
+{
+    const quint32 indexSize = MeshInternal::byteSizeForComponentType(componentType);
+    if ((indexSize != 2 && indexSize != 4) || size % indexSize != 0)
+        return false;
+    return meshopt_decodeIndexBuffer(dst, size / indexSize, indexSize,
+                                     reinterpret_cast<const unsigned char *>(encoded.constData()),
+                                     encoded.size()) == 0;
+}
+
+// The target buffer is made of 4 floats per vertex
+static const quint32 TARGET_TEXEL_SIZE = 4 * sizeof(float);
+
+quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh, MeshDataHeader *header,
+                                   ReadMode mode, const char *mappedData)
 {
-    static char alignPadding[4] = {};
+    Q_ASSERT(mode != ReadMode::Map || mappedData);
+
+    // The big blocks, everything else is small enough to just read
+    const auto readBlock = [device, mode, mappedData](quint32 size) -> QByteArray {
+        switch (mode) {
+        case ReadMode::Copy:
+            return device->read(size);
+        case ReadMode::Map: {
+            const qint64 pos = device->pos();
+            const qint64 available = qMin(qint64(size), device->size() - pos);
+            device->skip(available);
+            return QByteArray::fromRawData(mappedData + pos, available);
+        }
+        case ReadMode::SubsetsOnly:
+            device->skip(size);
+            break;
+        }
+        return QByteArray();
+    };
 
     device->seek(offset);
     QDataStream inputStream(device);
     inputStream.setByteOrder(QDataStream::LittleEndian);
     inputStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
 
+    // Compressed buffers are prefixed with their encoded size, 0 when they
+    // are stored as-is. storedSize is what the buffer takes in the file.
+    bool decodeFailed = false;
+    const auto readBuffer = [&](quint32 size, quint32 *storedSize, const auto &decode) -> QByteArray {
+        if (!header->hasCompressedBuffers()) {
+            *storedSize = size;
+            return readBlock(size);
+        }
+        quint32 encodedSize = 0;
+        inputStream >> encodedSize;
+        *storedSize = sizeof(quint32) + (encodedSize ? encodedSize : size);
+        if (encodedSize == 0)
+            return readBlock(size);
+        const QByteArray encoded = readBlock(encodedSize);
+        if (mode == ReadMode::SubsetsOnly)
+            return QByteArray();
+        QByteArray decoded(size, Qt::Uninitialized);
+        if (encoded.size() != qsizetype(encodedSize) || !decode(decoded.data(), size, encoded)) {
+            decodeFailed = true;
+            return QByteArray();
+        }
+        return decoded;
+    };
+
     inputStream >> header->fileId >> header->fileVersion >> header->flags >> header->sizeInBytes;
     if (!header->isValid()) {
         qWarning() << "Mesh data invalid";
@@ -172,7 +337,7 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
     }
     quint32 alignAmount = offsetTracker.alignedAdvance(entriesByteSize);
     if (alignAmount)
-        device->read(alignPadding, alignAmount);
+        device->skip(alignAmount);
 
     // vertex buffer entry names
     quint32 numTargets = 0;
@@ -187,7 +352,7 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
         entry.name = QByteArray(nameWithZeroTerminator.constData(), qMax(0, nameWithZeroTerminator.size() - 1));
         alignAmount = offsetTracker.alignedAdvance(nameLength);
         if (alignAmount)
-            device->read(alignPadding, alignAmount);
+            device->skip(alignAmount);
         // Old morph meshes' target attributes were appended sequentially
         // behind vertex attributes. However, since the number of targets are restricted by 8
         // the other attributes were named by "attr_unsupported"
@@ -236,15 +401,26 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
         }
     }
 
-    mesh->m_vertexBuffer.data = device->read(vertexBufferDataSize);
-    alignAmount = offsetTracker.alignedAdvance(vertexBufferDataSize);
+    quint32 storedSize = 0;
+    mesh->m_vertexBuffer.data = readBuffer(vertexBufferDataSize, &storedSize,
+                                           [mesh](char *dst, quint32 size, const QByteArray &encoded) {
+        return decodeVertexData(dst, size, mesh->m_vertexBuffer.stride, encoded);
+    });
+    if (header->hasFilteredBuffers() && mesh->m_vertexBuffer.stride > 0 && !mesh->m_vertexBuffer.data.isEmpty()) {
+        unfilterVertexData(mesh->m_vertexBuffer.data.data(), vertexBufferDataSize / mesh->m_vertexBuffer.stride,
+                           mesh->m_vertexBuffer.stride, mesh->m_vertexBuffer.entries);
+    }
+    alignAmount = offsetTracker.alignedAdvance(storedSize);
     if (alignAmount)
-        device->read(alignPadding, alignAmount);
+        device->skip(alignAmount);
 
-    mesh->m_indexBuffer.data = device->read(indexBufferDataSize);
-    alignAmount = offsetTracker.alignedAdvance(indexBufferDataSize);
+    mesh->m_indexBuffer.data = readBuffer(indexBufferDataSize, &storedSize,
+                                          [mesh](char *dst, quint32 size, const QByteArray &encoded) {
+        return decodeIndexData(dst, size, mesh->m_indexBuffer.componentType, encoded);
+    });
+    alignAmount = offsetTracker.alignedAdvance(storedSize);
     if (alignAmount)
-        device->read(alignPadding, alignAmount);
+        device->skip(alignAmount);
 
     quint32 subsetByteSize = 0;
     QVector<MeshInternal::Subset> internalSubsets;
@@ -291,13 +467,13 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
     }
     alignAmount = offsetTracker.alignedAdvance(subsetByteSize);
     if (alignAmount)
-        device->read(alignPadding, alignAmount);
+        device->skip(alignAmount);
 
     for (MeshInternal::Subset &internalSubset : internalSubsets) {
         internalSubset.rawNameUtf16 = device->read(internalSubset.nameLength * 2); //UTF_16_le
         alignAmount = offsetTracker.alignedAdvance(internalSubset.nameLength * 2);
         if (alignAmount)
-            device->read(alignPadding, alignAmount);
+            device->skip(alignAmount);
     }
 
     quint32 lodByteSize = 0;
@@ -319,11 +495,11 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
     }
     alignAmount = offsetTracker.alignedAdvance(lodByteSize);
     if (alignAmount)
-        device->read(alignPadding, alignAmount);
+        device->skip(alignAmount);
 
 
     // Data for morphTargets
-    if (targetBufferEntriesCount > 0) {
+    if (targetBufferEntriesCount > 0 && mode != ReadMode::SubsetsOnly) {
         if (header->hasSeparateTargetBuffer()) {
             entriesByteSize = 0;
             for (quint32 i = 0; i < targetBufferEntriesCount; ++i) {
@@ -340,7 +516,7 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
             }
             alignAmount = offsetTracker.alignedAdvance(entriesByteSize);
             if (alignAmount)
-                device->read(alignPadding, alignAmount);
+                device->skip(alignAmount);
 
             for (auto &entry : mesh->m_targetBuffer.entries) {
                 quint32 nameLength;
@@ -350,10 +526,17 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
                 entry.name = QByteArray(nameWithZeroTerminator.constData(), qMax(0, nameWithZeroTerminator.size() - 1));
                 alignAmount = offsetTracker.alignedAdvance(nameLength);
                 if (alignAmount)
-                    device->read(alignPadding, alignAmount);
+                    device->skip(alignAmount);
             }
 
-            mesh->m_targetBuffer.data = device->read(targetBufferDataSize);
+            mesh->m_targetBuffer.data = readBuffer(targetBufferDataSize, &storedSize,
+                                                   [](char *dst, quint32 size, const QByteArray &encoded) {
+                return decodeVertexData(dst, size, TARGET_TEXEL_SIZE, encoded);
+            });
+            if (header->hasFilteredBuffers() && !mesh->m_targetBuffer.data.isEmpty()) {
+                meshopt_decodeFilterExp(mesh->m_targetBuffer.data.data(),
+                                        mesh->m_targetBuffer.data.size() / sizeof(float), sizeof(float));
+            }
         } else {
             // remove target entries from vertexbuffer entries
             mesh->m_vertexBuffer.entries.remove(vertexBufferEntriesCount - targetBufferEntriesCount,
@@ -383,6 +566,11 @@ quint64 MeshInternal::readMeshData(QIODevice *device, quint64 offset, Mesh *mesh
         }
     }
 
+    if (decodeFailed) {
+        qWarning("Failed to decode the mesh buffers");
+        return 0;
+    }
+
     return header->sizeInBytes;
 }
 
@@ -404,7 +592,7 @@ void MeshInternal::writeMeshHeader(QIODevice *device, const MeshDataHeader &head
 // that's also legacy nonsense, but having that allows the reader not have to
 // branch based on the version.
 
-quint64 MeshInternal::writeMeshData(QIODevice *device, const Mesh &mesh)
+quint64 MeshInternal::writeMeshData(QIODevice *device, const Mesh &mesh, quint16 flags)
 {
     static const char alignPadding[4] = {};
 
@@ -474,13 +662,34 @@ quint64 MeshInternal::writeMeshData(QIODevice *device, const Mesh &mesh)
             device->write(alignPadding, alignAmount);
     }
 
-    device->write(mesh.m_vertexBuffer.data.constData(), vertexBufferDataSize);
-    alignAmount = offsetTracker.alignedAdvance(vertexBufferDataSize);
+    // See readMeshData for the layout of the compressed buffers
+    const bool compressed = (flags & MeshDataHeader::CompressedBuffers);
+    const bool filtered = compressed && (flags & MeshDataHeader::FilteredBuffers);
+    const auto writeBuffer = [device, &outputStream, compressed](const QByteArray &data, const QByteArray &encoded) -> quint32 {
+        if (!compressed) {
+            device->write(data.constData(), data.size());
+            return data.size();
+        }
+        const QByteArray &stored = encoded.isEmpty() ? data : encoded;
+        outputStream << quint32(encoded.size());
+        device->write(stored.constData(), stored.size());
+        return sizeof(quint32) + stored.size();
+    };
+
+    QByteArray vertexData = mesh.m_vertexBuffer.data;
+    if (filtered && vertexBufferStride > 0) {
+        filterVertexData(vertexData.data(), vertexBufferDataSize / vertexBufferStride,
+                         vertexBufferStride, mesh.m_vertexBuffer.entries);
+    }
+    quint32 storedSize = writeBuffer(vertexData, compressed ? encodeVertexData(vertexData, vertexBufferStride) : QByteArray());
+    alignAmount = offsetTracker.alignedAdvance(storedSize);
     if (alignAmount)
         device->write(alignPadding, alignAmount);
 
-    device->write(mesh.m_indexBuffer.data.constData(), indexBufferDataSize);
-    alignAmount = offsetTracker.alignedAdvance(indexBufferDataSize);
+    storedSize = writeBuffer(mesh.m_indexBuffer.data,
+                             compressed ? encodeIndexData(mesh.m_indexBuffer.data, mesh.m_indexBuffer.componentType, mesh.m_drawMode)
+                                        : QByteArray());
+    alignAmount = offsetTracker.alignedAdvance(storedSize);
     if (alignAmount)
         device->write(alignPadding, alignAmount);
 
@@ -570,7 +779,12 @@ quint64 MeshInternal::writeMeshData(QIODevice *device, const Mesh &mesh)
             device->write(alignPadding, alignAmount);
     }
 
-    device->write(mesh.m_targetBuffer.data.constData(), targetBufferDataSize);
+    QByteArray targetData = mesh.m_targetBuffer.data;
+    if (filtered && !targetData.isEmpty()) {
+        float *v = reinterpret_cast<float *>(targetData.data());
+        meshopt_encodeFilterExp(v, targetBufferDataSize / sizeof(float), sizeof(float), FILTER_COMPONENT_BITS, v);
+    }
+    writeBuffer(targetData, compressed ? encodeVertexData(targetData, TARGET_TEXEL_SIZE) : QByteArray());
 
     const quint32 endPos = device->pos();
     const quint32 sizeInBytes = endPos - startPos;
@@ -578,25 +792,60 @@ quint64 MeshInternal::writeMeshData(QIODevice *device, const Mesh &mesh)
     return sizeInBytes;
 }
 
-Mesh Mesh::loadMesh(QIODevice *device, quint32 id)
+static bool readMeshWithId(QIODevice *device, quint32 id, Mesh *mesh,
+                           MeshInternal::ReadMode mode = MeshInternal::ReadMode::Copy,
+                           const char *mappedData = nullptr)
 {
     MeshInternal::MeshDataHeader header;
     const MeshInternal::MultiMeshInfo meshFileInfo = MeshInternal::readFileHeader(device);
     auto it = meshFileInfo.meshEntries.constFind(id);
-    if (it != meshFileInfo.meshEntries.constEnd()) {
-        Mesh mesh;
-        quint64 size = MeshInternal::readMeshData(device, *it, &mesh, &header);
-        if (size)
-            return mesh;
-    } else if (id == 0 && !meshFileInfo.meshEntries.isEmpty()) {
-        Mesh mesh;
-        quint64 size = MeshInternal::readMeshData(device, *meshFileInfo.meshEntries.cbegin(), &mesh, &header);
-        if (size)
-            return mesh;
+    if (it == meshFileInfo.meshEntries.constEnd()) {
+        if (id != 0 || meshFileInfo.meshEntries.isEmpty())
+            return false;
+        it = meshFileInfo.meshEntries.cbegin();
     }
+    return MeshInternal::readMeshData(device, *it, mesh, &header, mode, mappedData) != 0;
+}
+
+Mesh Mesh::loadMesh(QIODevice *device, quint32 id)
+{
+    Mesh mesh;
+    if (readMeshWithId(device, id, &mesh))
+        return mesh;
     return Mesh();
 }
 
+Mesh Mesh::loadMeshMapped(const QSharedPointer<QIODevice> &device, quint32 id)
+{
+    QFile *file = qobject_cast<QFile *>(device.data());
+    const qint64 fileSize = file ? file->size() : 0;
+    uchar *mapped = fileSize > 0 ? file->map(0, fileSize) : nullptr;
+    if (!mapped)
+        return loadMesh(device.data(), id);
+
+    // The headers are parsed from the mapping too, the QBuffer does not copy it
+    const char *mappedData = reinterpret_cast<const char *>(mapped);
+    QBuffer buffer;
+    buffer.setData(QByteArray::fromRawData(mappedData, fileSize));
+    buffer.open(QIODevice::ReadOnly);
+
+    Mesh mesh;
+    if (!readMeshWithId(&buffer, id, &mesh, MeshInternal::ReadMode::Map, mappedData)) {
+        file->unmap(mapped);
+        return Mesh();
+    }
+    mesh.m_mappedFile = device;
+    return mesh;
+}
+
+QVector<Mesh::Subset> Mesh::loadSubsets(QIODevice *device, quint32 id)
+{
+    Mesh mesh;
+    if (readMeshWithId(device, id, &mesh, MeshInternal::ReadMode::SubsetsOnly))
+        return mesh.m_subsets;
+    return {};
+}
+
 QMap<quint32, Mesh> Mesh::loadAll(QIODevice *device)
 {
     MeshInternal::MeshDataHeader header;
@@ -910,7 +1159,7 @@ Mesh Mesh::fromRuntimeData(const RuntimeMeshData &data, QString *error)
     return mesh;
 }
 
-quint32 Mesh::save(QIODevice *device, quint32 id) const
+quint32 Mesh::save(QIODevice *device, quint32 id, SaveFlags flags) const
 {
     qint64 newMeshStartPosFromEnd = 0;
     quint32 newId = 1;
@@ -941,9 +1190,15 @@ quint32 Mesh::save(QIODevice *device, quint32 id) const
     header.meshEntries.insert(newId, meshOffset);
 
     MeshInternal::MeshDataHeader meshHeader = MeshInternal::MeshDataHeader::withDefaults();
+    if (flags & (SaveCompressed | SaveQuantized))
+        meshHeader.flags |= MeshInternal::MeshDataHeader::CompressedBuffers;
+    if (flags & SaveQuantized)
+        meshHeader.flags |= MeshInternal::MeshDataHeader::FilteredBuffers;
+    if (!meshHeader.flags)
+        meshHeader.fileVersion = MeshInternal::MeshDataHeader::UNFLAGGED_FILE_VERSION;
     // skip the space for the mesh header for now
     device->seek(device->pos() + MESH_HEADER_STRUCT_SIZE);
-    meshHeader.sizeInBytes = MeshInternal::writeMeshData(device, *this);
+    meshHeader.sizeInBytes = MeshInternal::writeMeshData(device, *this, meshHeader.flags);
     // now the mesh header is ready to be written out
     device->seek(meshOffset);
     MeshInternal::writeMeshHeader(device, meshHeader);
@@ -1019,6 +1274,36 @@ bool Mesh::hasLightmapUVChannel() const
     return false;
 }
 
+static inline bool isDirectionAttribute(const QByteArray &name)
+{
+    return name == MeshInternal::getNormalAttrName()
+            || name == MeshInternal::getTexTanAttrName()
+            || name == MeshInternal::getTexBinormalAttrName();
+}
+
+// Unsigned normalized bytes hold directions as n * 0.5 + 0.5, see quantizeVertexData()
+static inline void readDirection(const char *src, Mesh::ComponentType componentType, float *dst)
+{
+    if (componentType == Mesh::ComponentType::UnsignedInt8) {
+        const quint8 *v = reinterpret_cast<const quint8 *>(src);
+        for (int i = 0; i < 3; ++i)
+            dst[i] = float(v[i]) / 255.0f * 2.0f - 1.0f;
+    } else {
+        memcpy(dst, src, 3 * sizeof(float));
+    }
+}
+
+static inline void readTexCoord(const char *src, Mesh::ComponentType componentType, float *dst)
+{
+    if (componentType == Mesh::ComponentType::Float16) {
+        const qfloat16 *v = reinterpret_cast<const qfloat16 *>(src);
+        dst[0] = float(v[0]);
+        dst[1] = float(v[1]);
+    } else {
+        memcpy(dst, src, 2 * sizeof(float));
+    }
+}
+
 bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
 {
     const char *posAttrName = MeshInternal::getPositionAttrName();
@@ -1044,6 +1329,8 @@ bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
     quint32 positionOffset = UINT32_MAX;
     quint32 normalOffset = UINT32_MAX;
     quint32 uvOffset = UINT32_MAX;
+    ComponentType normalComponentType = ComponentType::Float32;
+    ComponentType uvComponentType = ComponentType::Float32;
 
     for (const VertexBufferEntry &vbe : std::as_const(m_vertexBuffer.entries)) {
         if (vbe.name == posAttrName) {
@@ -1053,17 +1340,20 @@ bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
             }
             positionOffset = vbe.offset;
         } else if (vbe.name == normalAttrName) {
-            if (vbe.componentCount != 3) {
+            const bool quantized = vbe.componentType == ComponentType::UnsignedInt8 && vbe.componentCount == 4;
+            if (vbe.componentCount != 3 && !quantized) {
                 qWarning("Lightmap UV unwrapping encountered a Mesh non-float3 normal data, this cannot happen");
                 return false;
             }
             normalOffset = vbe.offset;
+            normalComponentType = vbe.componentType;
         } else if (vbe.name == uvAttrName) {
             if (vbe.componentCount != 2) {
                 qWarning("Lightmap UV unwrapping encountered a Mesh non-float2 UV0 data, this cannot happen");
                 return false;
             }
             uvOffset = vbe.offset;
+            uvComponentType = vbe.componentType;
         }
     }
 
@@ -1090,10 +1380,8 @@ bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
         float *normPtr = reinterpret_cast<float *>(normalData.data());
         for (qsizetype i = 0; i < vertexCount; ++i) {
             const char *vertexBasePtr = srcVertexData + i * srcVertexStride;
-            const float *srcNormal = reinterpret_cast<const float *>(vertexBasePtr + normalOffset);
-            *normPtr++ = *srcNormal++;
-            *normPtr++ = *srcNormal++;
-            *normPtr++ = *srcNormal++;
+            readDirection(vertexBasePtr + normalOffset, normalComponentType, normPtr);
+            normPtr += 3;
         }
     }
 
@@ -1103,9 +1391,8 @@ bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
         float *uvPtr = reinterpret_cast<float *>(uvData.data());
         for (qsizetype i = 0; i < vertexCount; ++i) {
             const char *vertexBasePtr = srcVertexData + i * srcVertexStride;
-            const float *srcUv = reinterpret_cast<const float *>(vertexBasePtr + uvOffset);
-            *uvPtr++ = *srcUv++;
-            *uvPtr++ = *srcUv++;
+            readTexCoord(vertexBasePtr + uvOffset, uvComponentType, uvPtr);
+            uvPtr += 2;
         }
     }
 
@@ -1246,6 +1533,122 @@ bool Mesh::createLightmapUVChannel(uint lightmapBaseResolution)
     return true;
 }
 
+bool Mesh::quantizeVertexData()
+{
+    const quint32 srcStride = m_vertexBuffer.stride;
+    if (srcStride == 0 || m_vertexBuffer.data.isEmpty())
+        return false;
+
+    const auto isTexCoordAttribute = [](const QByteArray &name) {
+        return name == MeshInternal::getUV0AttrName() || name == MeshInternal::getUV1AttrName();
+    };
+
+    // Every attribute stays 4 byte aligned, not all graphics APIs accept
+    // anything else
+    QVector<VertexBufferEntry> entries = m_vertexBuffer.entries;
+    bool changed = false;
+    quint32 offset = 0;
+    for (VertexBufferEntry &entry : entries) {
+        if (entry.componentType == ComponentType::Float32) {
+            if (entry.componentCount == 3 && isDirectionAttribute(entry.name)) {
+                entry.componentType = ComponentType::UnsignedInt8;
+                entry.componentCount = 4;
+                changed = true;
+            } else if (entry.componentCount == 2 && isTexCoordAttribute(entry.name)) {
+                entry.componentType = ComponentType::Float16;
+                changed = true;
+            }
+        }
+        entry.offset = getAlignedOffset(offset, 4);
+        offset = entry.offset + entry.componentCount * MeshInternal::byteSizeForComponentType(entry.componentType);
+    }
+    if (!changed)
+        return false;
+
+    const quint32 dstStride = getAlignedOffset(offset, 4);
+    const qsizetype vertexCount = m_vertexBuffer.data.size() / srcStride;
+    QByteArray data(vertexCount * dstStride, '\0');
+    const char *src = m_vertexBuffer.data.constData();
+    char *dst = data.data();
+    for (qsizetype i = 0; i < vertexCount; ++i) {
+        for (qsizetype e = 0; e < entries.size(); ++e) {
+            const VertexBufferEntry &srcEntry = m_vertexBuffer.entries[e];
+            const VertexBufferEntry &dstEntry = entries[e];
+            const char *srcValue = src + i * srcStride + srcEntry.offset;
+            char *dstValue = dst + i * dstStride + dstEntry.offset;
+            if (dstEntry.componentType == srcEntry.componentType) {
+                memcpy(dstValue, srcValue, srcEntry.componentCount * MeshInternal::byteSizeForComponentType(srcEntry.componentType));
+            } else if (dstEntry.componentType == ComponentType::UnsignedInt8) {
+                const float *v = reinterpret_cast<const float *>(srcValue);
+                quint8 *d = reinterpret_cast<quint8 *>(dstValue);
+                for (int c = 0; c < 3; ++c)
+                    d[c] = quint8(qRound((qBound(-1.0f, v[c], 1.0f) * 0.5f + 0.5f) * 255.0f));
+                d[3] = 255;
+            } else {
+                const float *v = reinterpret_cast<const float *>(srcValue);
+                qfloat16 *d = reinterpret_cast<qfloat16 *>(dstValue);
+                d[0] = qfloat16(v[0]);
+                d[1] = qfloat16(v[1]);
+            }
+        }
+    }
+
+    m_vertexBuffer.entries = entries;
+    m_vertexBuffer.stride = dstStride;
+    m_vertexBuffer.data = data;
+    return true;
+}
+
+bool Mesh::dequantizeVertexData()
+{
+    const quint32 srcStride = m_vertexBuffer.stride;
+    if (srcStride == 0 || m_vertexBuffer.data.isEmpty())
+        return false;
+
+    QVector<VertexBufferEntry> entries = m_vertexBuffer.entries;
+    bool changed = false;
+    quint32 offset = 0;
+    for (VertexBufferEntry &entry : entries) {
+        if (entry.componentType == ComponentType::UnsignedInt8 && entry.componentCount == 4 && isDirectionAttribute(entry.name)) {
+            entry.componentType = ComponentType::Float32;
+            entry.componentCount = 3;
+            changed = true;
+        } else if (entry.componentType == ComponentType::Float16 && entry.componentCount == 2) {
+            entry.componentType = ComponentType::Float32;
+            changed = true;
+        }
+        entry.offset = getAlignedOffset(offset, 4);
+        offset = entry.offset + entry.componentCount * MeshInternal::byteSizeForComponentType(entry.componentType);
+    }
+    if (!changed)
+        return false;
+
+    const quint32 dstStride = getAlignedOffset(offset, 4);
+    const qsizetype vertexCount = m_vertexBuffer.data.size() / srcStride;
+    QByteArray data(vertexCount * dstStride, '\0');
+    const char *src = m_vertexBuffer.data.constData();
+    char *dst = data.data();
+    for (qsizetype i = 0; i < vertexCount; ++i) {
+        for (qsizetype e = 0; e < entries.size(); ++e) {
+            const VertexBufferEntry &srcEntry = m_vertexBuffer.entries[e];
+            const VertexBufferEntry &dstEntry = entries[e];
+            const char *srcValue = src + i * srcStride + srcEntry.offset;
+            float *dstValue = reinterpret_cast<float *>(dst + i * dstStride + dstEntry.offset);
+            if (dstEntry.componentType == srcEntry.componentType)
+                memcpy(dstValue, srcValue, srcEntry.componentCount * MeshInternal::byteSizeForComponentType(srcEntry.componentType));
+            else if (srcEntry.componentType == ComponentType::UnsignedInt8)
+                readDirection(srcValue, srcEntry.componentType, dstValue);
+            else
+                readTexCoord(srcValue, srcEntry.componentType, dstValue);
+        }
+    }
+
+    m_vertexBuffer.entries = entries;
+    m_vertexBuffer.stride = dstStride;
+    m_vertexBuffer.data = data;
+    return true;
+}
+
 size_t simplifyMesh(unsigned int *destination, const unsigned int *indices, size_t indexCount, const float *vertexPositions, size_t vertexCount, size_t vertexPositionsStride, size_t targetIndexCount, float targetError, unsigned int options, float *resultError)
 {
     return meshopt_simplify(destination, indices, indexCount, vertexPositions, vertexCount, vertexPositionsStride, targetIndexCount, targetError, options, resultError);
@@ -25,6 +25,7 @@
 #include <QtCore/qbytearray.h>
 #include <QtCore/qiodevice.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qsharedpointer.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -145,6 +146,16 @@ public:
     // id 0 == first, otherwise has to match
     static Mesh loadMesh(QIODevice *device, quint32 id = 0);
 
+    // Same as loadMesh(), except that the vertex, index and target buffers
+    // point into a memory mapping of the file instead of being read. The
+    // mesh and its copies keep the mapping alive, buffers taken out of the
+    // mesh must not outlive them. Falls back to reading when the device is
+    // not a file that can be mapped.
+    static Mesh loadMeshMapped(const QSharedPointer<QIODevice> &device, quint32 id = 0);
+
+    // Only the subsets, the buffers are skipped
+    static QVector<Subset> loadSubsets(QIODevice *device, quint32 id = 0);
+
     static QMap<quint32, Mesh> loadAll(QIODevice *device);
 
     static Mesh fromAssetData(const QVector<AssetVertexEntry> &vbufEntries,
@@ -161,12 +172,31 @@ public:
     DrawMode drawMode() const { return m_drawMode; }
     Winding winding() const { return m_winding; }
 
+    enum SaveFlag {
+        // Encode the buffers with the meshoptimizer vertex and index codecs,
+        // decoded again when loading. Lossless, but triangles may be rotated.
+        SaveCompressed = 0x01,
+        // Also reduce the precision of the float attributes so that they
+        // compress better. Lossy, implies SaveCompressed.
+        SaveQuantized = 0x02
+    };
+    Q_DECLARE_FLAGS(SaveFlags, SaveFlag)
+
     // id 0 == generate new id; otherwise uses it as-is, and must be an unused one
-    quint32 save(QIODevice *device, quint32 id = 0) const;
+    quint32 save(QIODevice *device, quint32 id = 0, SaveFlags flags = {}) const;
 
     bool hasLightmapUVChannel() const;
     bool createLightmapUVChannel(uint lightmapBaseResolution);
 
+    // Stores the normals, tangents and binormals as unsigned normalized
+    // bytes, and UV0 and UV1 as half floats. The positions, the lightmap UVs
+    // and the morph targets are left as they are. Returns false when there
+    // was nothing to convert.
+    bool quantizeVertexData();
+    // The reverse, for code that reads the vertex data on the CPU and
+    // expects float attributes. Returns false when nothing was quantized.
+    bool dequantizeVertexData();
+
 private:
     DrawMode m_drawMode = DrawMode::Triangles;
     Winding m_winding = Winding::CounterClockwise;
@@ -174,6 +204,8 @@ private:
     IndexBuffer m_indexBuffer;
     TargetBuffer m_targetBuffer;
     QVector<Subset> m_subsets;
+    // Set when the buffers are in a memory mapping of this file
+    QSharedPointer<QIODevice> m_mappedFile;
     friend struct MeshInternal;
 };
 
@@ -310,7 +342,19 @@ struct Q_QUICK3DUTILS_EXPORT MeshInternal
         // Version 6 differs from 5 with additional lodCount per subset as well
         // as a list of Level of Detail data after the subset names.
         // Version 7 will split the morph target data
-        static const quint32 FILE_VERSION = 7;
+        // Version 8 adds the flags below, the buffers may be stored encoded
+        // with the meshoptimizer codecs. Each buffer is then prefixed with
+        // its encoded size, 0 meaning it is stored as-is.
+        static const quint32 FILE_VERSION = 8;
+        // Without any flags the layout is the same as in version 7, which is
+        // what gets written then, so that older readers still load the file
+        static const quint32 UNFLAGGED_FILE_VERSION = 7;
+
+        enum Flag : quint16 {
+            CompressedBuffers = 0x01,
+            // The float vertex and target data went through meshopt_encodeFilterExp
+            FilteredBuffers = 0x02
+        };
 
         static MeshDataHeader withDefaults() {
             return { FILE_ID, FILE_VERSION, 0, 0 };
@@ -333,6 +377,14 @@ struct Q_QUICK3DUTILS_EXPORT MeshInternal
         bool hasSeparateTargetBuffer() const {
             return fileVersion >= 7;
         }
+
+        bool hasCompressedBuffers() const {
+            return fileVersion >= 8 && (flags & CompressedBuffers);
+        }
+
+        bool hasFilteredBuffers() const {
+            return hasCompressedBuffers() && (flags & FilteredBuffers);
+        }
     };
 
     struct MeshOffsetTracker {
@@ -383,9 +435,16 @@ struct Q_QUICK3DUTILS_EXPORT MeshInternal
 
     static MultiMeshInfo readFileHeader(QIODevice *device);
     static void writeFileHeader(QIODevice *device, const MultiMeshInfo &meshFileInfo);
-    static quint64 readMeshData(QIODevice *device, quint64 offset, Mesh *mesh, MeshDataHeader *header);
+    enum class ReadMode {
+        Copy, // the buffers are read from the device
+        Map, // the device is a QBuffer over mappedData, the buffers point into it
+        SubsetsOnly // the buffers are skipped
+    };
+
+    static quint64 readMeshData(QIODevice *device, quint64 offset, Mesh *mesh, MeshDataHeader *header,
+                                ReadMode mode = ReadMode::Copy, const char *mappedData = nullptr);
     static void writeMeshHeader(QIODevice *device, const MeshDataHeader &header);
-    static quint64 writeMeshData(QIODevice *device, const Mesh &mesh);
+    static quint64 writeMeshData(QIODevice *device, const Mesh &mesh, quint16 flags = 0);
 
     static quint32 byteSizeForComponentType(Mesh::ComponentType componentType) { return quint32(QSSGBaseTypeHelpers::getSizeOfType(componentType)); }
 
@@ -431,6 +490,8 @@ void Q_QUICK3DUTILS_EXPORT optimizeVertexCache(unsigned int* destination,
 
 } // namespace QSSGMesh
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QSSGMesh::Mesh::SaveFlags)
+
 QT_END_NAMESPACE
 
 #endif // QSSGMESHUTILITIES_P_H
@@ -9,4 +9,29 @@ QSSGMeshBVH::~QSSGMeshBVH()
 {
 }
 
+void QSSGMeshBVH::updateFlatNodes()
+{
+    flatNodes.clear();
+    flatNodes.resize(m_nodes.size());
+
+    for (qsizetype i = 0, end = m_nodes.size(); i < end; ++i) {
+        const QSSGMeshBVHNode &node = m_nodes.at(i);
+        QSSGMeshBVHFlatNode &flatNode = flatNodes[i];
+        flatNode.bounds = node.boundingData;
+        if (node.count != 0) {
+            flatNode.rightOrOffset = quint32(node.offset);
+            flatNode.count = quint32(node.count);
+        } else if (node.left.isNull() && node.right.isNull()) {
+            // Empty leaf, no right child can have index 0
+            flatNode.rightOrOffset = 0;
+        } else if (node.left.idx == i + 1 && node.right.idx > i + 1) {
+            flatNode.rightOrOffset = quint32(node.right.idx);
+        } else {
+            // Not in depth-first order, traversal falls back to the nodes
+            flatNodes.clear();
+            return;
+        }
+    }
+}
+
 QT_END_NAMESPACE
@@ -61,6 +61,19 @@ struct Q_QUICK3DUTILS_EXPORT QSSGMeshBVHTriangle
     QVector2D uvCoord3;
 };
 
+// Compact form of a QSSGMeshBVHNode used for traversal. The nodes are
+// stored in depth-first order so the left child of an internal node is
+// always the next node and only the index of the right child is needed.
+struct QSSGMeshBVHFlatNode
+{
+    QSSGBounds3 bounds;
+    quint32 rightOrOffset = 0; // Index of the right child, or the triangle offset for leaves
+    quint32 count = 0; // Triangle count, 0 for internal nodes
+
+    bool isLeaf() const { return count != 0; }
+    bool isEmpty() const { return count == 0 && rightOrOffset == 0; }
+};
+
 struct Q_QUICK3DUTILS_EXPORT QSSGMeshBVH
 {
     QSSGMeshBVH() = default;
@@ -83,9 +96,15 @@ struct Q_QUICK3DUTILS_EXPORT QSSGMeshBVH
         return (idx >= 0 && idx < m_nodes.size()) ? &m_nodes.at(idx) : nullptr;
     }
 
+    // Rebuilds flatNodes from m_nodes. Leaves flatNodes empty if the nodes
+    // are not in depth-first order.
+    void updateFlatNodes();
+
     QVector<QSSGMeshBVHNode::Handle> roots;
     QVector<QSSGMeshBVHNode> m_nodes;
     QVector<QSSGMeshBVHTriangle> triangles;
+    // Same indices as m_nodes
+    QVector<QSSGMeshBVHFlatNode> flatNodes;
 };
 
 QSSGMeshBVHNode::Handle::operator const QSSGMeshBVHNode *() const
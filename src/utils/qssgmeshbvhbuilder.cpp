@@ -4,11 +4,29 @@
 #include "qssgmeshbvhbuilder_p.h"
 #include <QtQuick3DUtils/private/qssgassert_p.h>
 
+#include <QtCore/qfloat16.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
+
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 static constexpr quint32 QSSG_MAX_TREE_DEPTH = 40;
 static constexpr quint32 QSSG_MAX_LEAF_TRIANGLES = 10;
 
+// BinnedSAH
+static constexpr quint32 QSSG_SAH_BIN_COUNT = 16;
+static constexpr float QSSG_SAH_TRAVERSAL_COST = 1.0f; // Relative to testing one triangle
+static constexpr quint32 QSSG_PARALLEL_BUILD_MAX_DEPTH = 4;
+static constexpr quint32 QSSG_PARALLEL_BUILD_MIN_TRIANGLES = 32768;
+
+QSSGMeshBVHBuilder::BuildMode QSSGMeshBVHBuilder::defaultBuildMode()
+{
+    static const bool useSAH = qEnvironmentVariableIntValue("QT_QUICK3D_MESH_BVH_SAH") > 0;
+    return useSAH ? BuildMode::BinnedSAH : BuildMode::Average;
+}
+
 QSSGMeshBVHBuilder::QSSGMeshBVHBuilder(const QSSGMesh::Mesh &mesh)
     : m_mesh(mesh)
 {
@@ -33,9 +51,11 @@ QSSGMeshBVHBuilder::QSSGMeshBVHBuilder(const QSSGMesh::Mesh &mesh)
         } else if (!strcmp(entry.m_name, QSSGMesh::MeshInternal::getUV0AttrName())) {
             m_hasUVData = true;
             m_vertexUVOffset = entry.m_firstItemOffset;
+            m_hasHalfUVData = entry.m_componentType == QSSGRenderComponentType::Float16;
         } else if (!m_hasUVData && !strcmp(entry.m_name, QSSGMesh::MeshInternal::getUV1AttrName())) {
             m_hasUVData = true;
             m_vertexUVOffset = entry.m_firstItemOffset;
+            m_hasHalfUVData = entry.m_componentType == QSSGRenderComponentType::Float16;
         }
     }
     m_vertexStride = vb.stride;
@@ -85,34 +105,55 @@ std::unique_ptr<QSSGMeshBVH> QSSGMeshBVHBuilder::buildTree()
         indexCount = m_vertexBufferData.size() / m_vertexStride;
     triangleBounds = calculateTriangleBounds(0, indexCount);
 
+    QVector<BuildPrimitive> primitives;
+    if (m_buildMode == BuildMode::BinnedSAH) {
+        primitives.resize(triangleBounds.size());
+        for (qsizetype i = 0, end = triangleBounds.size(); i < end; ++i)
+            primitives[i] = { triangleBounds.at(i).bounds, triangleBounds.at(i).bounds.center(), quint32(i) };
+    }
+
+    const auto buildRoot = [&](quint32 triangleOffset, quint32 triangleCount) {
+        const QSSGBounds3 bounds = getBounds(*meshBvh, triangleOffset, triangleCount);
+        if (m_buildMode == BuildMode::BinnedSAH) {
+            const qsizetype idx = splitNodeSAH(*meshBvh, nodes, primitives.data(), triangleOffset, triangleCount, bounds, 0, m_parallelBuild);
+            roots.append({ idx, meshBvh.get() });
+        } else {
+            const auto idx = nodes.size();
+            nodes.emplace_back();
+            QSSGMeshBVHNode::Handle root{ idx, meshBvh.get() };
+            root->boundingData = bounds;
+            // Recursively split the mesh into a tree of smaller bounding volumns
+            root = splitNode(*meshBvh, root, triangleOffset, triangleCount);
+            roots.append(root);
+        }
+    };
+
     // For each submesh, generate a root bvh node
     if (m_mesh.isValid()) {
         const QVector<QSSGMesh::Mesh::Subset> subsets = m_mesh.subsets();
         roots.reserve(subsets.size());
         for (quint32 subsetIdx = 0, subsetEnd = subsets.size(); subsetIdx < subsetEnd; ++subsetIdx) {
             const QSSGMesh::Mesh::Subset &source(subsets[subsetIdx]);
-            const auto idx = nodes.size();
-            nodes.emplace_back();
-            QSSGMeshBVHNode::Handle root{ idx, meshBvh.get() };
             // Offsets provided by subset are for the index buffer
             // Convert them to work with the triangle bounds list
-            const quint32 triangleOffset = source.offset / 3;
-            const quint32 triangleCount = source.count / 3;
-            root->boundingData = getBounds(*meshBvh, triangleOffset, triangleCount);
-            // Recursively split the mesh into a tree of smaller bounding volumns
-            root = splitNode(*meshBvh, root, triangleOffset, triangleCount);
-            roots.append(root);
+            buildRoot(source.offset / 3, source.count / 3);
         }
     } else {
         // Custom Geometry only has one subset
-        auto idx = nodes.size();
-        nodes.emplace_back();
-        QSSGMeshBVHNode::Handle root{ idx, meshBvh.get() };
-        root->boundingData = getBounds(*meshBvh, 0, triangleBounds.size());
-        root = splitNode(*meshBvh, root, 0, triangleBounds.size());
-        roots.append(root);
+        buildRoot(0, triangleBounds.size());
+    }
+
+    // The SAH build only sorted the primitives, put the triangles in the same order
+    if (m_buildMode == BuildMode::BinnedSAH) {
+        QVector<QSSGMeshBVHTriangle> sortedTriangles;
+        sortedTriangles.reserve(triangleBounds.size());
+        for (const BuildPrimitive &primitive : std::as_const(primitives))
+            sortedTriangles.append(triangleBounds.at(primitive.triangle));
+        triangleBounds = std::move(sortedTriangles);
     }
 
+    meshBvh->updateFlatNodes();
+
     return meshBvh;
 }
 
@@ -143,9 +184,14 @@ static inline QVector3D getVertexBufferValuePosition(quint32 index, const quint3
     return *position;
 }
 
-static inline QVector2D getVertexBufferValueUV(quint32 index, const quint32 vertexStride, const quint32 vertexUVOffset, const QByteArray &vertexBufferData)
+static inline QVector2D getVertexBufferValueUV(quint32 index, const quint32 vertexStride, const quint32 vertexUVOffset, const bool halfUV, const QByteArray &vertexBufferData)
 {
     const quint32 offset = index * vertexStride + vertexUVOffset;
+    if (halfUV) {
+        // Quantized meshes store the texture coordinates as half floats
+        const qfloat16 *uv = reinterpret_cast<const qfloat16 *>(vertexBufferData.begin() + offset);
+        return QVector2D(uv[0], uv[1]);
+    }
     const QVector2D *uv = reinterpret_cast<const QVector2D *>(vertexBufferData.begin() + offset);
 
     return *uv;
@@ -158,6 +204,7 @@ static void calculateTriangleBoundsImpl(quint32 indexOffset,
                                         const QByteArray &vertexBufferData,
                                         [[maybe_unused]] const quint32 vertexStride,
                                         [[maybe_unused]] const quint32 vertexUVOffset,
+                                        [[maybe_unused]] const bool halfUV,
                                         [[maybe_unused]] const quint32 vertexPosOffset,
                                         QVector<QSSGMeshBVHTriangle> &triangleBounds)
 {
@@ -187,9 +234,9 @@ static void calculateTriangleBoundsImpl(quint32 indexOffset,
             }
 
             if constexpr (hasUVData) {
-                triangle.uvCoord1 = getVertexBufferValueUV(index1, vertexStride, vertexUVOffset, vertexBufferData);
-                triangle.uvCoord2 = getVertexBufferValueUV(index2, vertexStride, vertexUVOffset, vertexBufferData);
-                triangle.uvCoord3 = getVertexBufferValueUV(index3, vertexStride, vertexUVOffset, vertexBufferData);
+                triangle.uvCoord1 = getVertexBufferValueUV(index1, vertexStride, vertexUVOffset, halfUV, vertexBufferData);
+                triangle.uvCoord2 = getVertexBufferValueUV(index2, vertexStride, vertexUVOffset, halfUV, vertexBufferData);
+                triangle.uvCoord3 = getVertexBufferValueUV(index3, vertexStride, vertexUVOffset, halfUV, vertexBufferData);
             }
         }
 
@@ -204,7 +251,7 @@ QVector<QSSGMeshBVHTriangle> QSSGMeshBVHBuilder::calculateTriangleBounds(quint32
 {
     QVector<QSSGMeshBVHTriangle> data;
 
-    using CalcTriangleBoundsFn = void (*)(quint32, quint32, const QByteArray &, const QByteArray &, const quint32, const quint32, const quint32, QVector<QSSGMeshBVHTriangle> &);
+    using CalcTriangleBoundsFn = void (*)(quint32, quint32, const QByteArray &, const QByteArray &, const quint32, const quint32, const bool, const quint32, QVector<QSSGMeshBVHTriangle> &);
     static const CalcTriangleBoundsFn calcTriangleBounds16Fns[] { &calculateTriangleBoundsImpl<QSSGRenderComponentType::UnsignedInt16, false, false, false>,
                                                                   &calculateTriangleBoundsImpl<QSSGRenderComponentType::UnsignedInt16, false, false, true>,
                                                                   &calculateTriangleBoundsImpl<QSSGRenderComponentType::UnsignedInt16, false, true, false>,
@@ -227,9 +274,9 @@ QVector<QSSGMeshBVHTriangle> QSSGMeshBVHBuilder::calculateTriangleBounds(quint32
     const size_t idx = (size_t(m_hasIndexBuffer) << 2u) | (size_t(m_hasPositionData) << 1u) | (size_t(m_hasUVData));
 
     if (m_indexBufferComponentType == QSSGRenderComponentType::UnsignedInt16)
-        calcTriangleBounds16Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_vertexPosOffset, data);
+        calcTriangleBounds16Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_hasHalfUVData, m_vertexPosOffset, data);
     else if (m_indexBufferComponentType == QSSGRenderComponentType::UnsignedInt32)
-        calcTriangleBounds32Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_vertexPosOffset, data);
+        calcTriangleBounds32Fns[idx](indexOffset, indexCount, m_indexBufferData, m_vertexBufferData, m_vertexStride, m_vertexUVOffset, m_hasHalfUVData, m_vertexPosOffset, data);
     return data;
 }
 
@@ -293,6 +340,166 @@ QSSGMeshBVHNode::Handle QSSGMeshBVHBuilder::splitNode(QSSGMeshBVH &bvh, QSSGMesh
     return node;
 }
 
+static inline float halfSurfaceArea(const QSSGBounds3 &bounds)
+{
+    if (bounds.isEmpty())
+        return 0.0f;
+    const QVector3D d = bounds.dimensions();
+    return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+}
+
+static inline quint32 sahBinIndex(float center, float minimum, float scale)
+{
+    return qMin(quint32((center - minimum) * scale), QSSG_SAH_BIN_COUNT - 1);
+}
+
+// Appends the node to nodes, followed by its subtree in depth-first order,
+// and returns its index. The child handles are indices into nodes, which
+// are rebased when a subtree built in parallel is appended.
+qsizetype QSSGMeshBVHBuilder::splitNodeSAH(QSSGMeshBVH &bvh,
+                                           QVector<QSSGMeshBVHNode> &nodes,
+                                           BuildPrimitive *primitives,
+                                           quint32 offset,
+                                           quint32 count,
+                                           const QSSGBounds3 &bounds,
+                                           quint32 depth,
+                                           bool parallel)
+{
+    const qsizetype idx = nodes.size();
+    nodes.emplace_back();
+    nodes[idx].boundingData = bounds;
+
+    const auto makeLeaf = [&]() {
+        nodes[idx].offset = int(offset);
+        nodes[idx].count = int(count);
+        return idx;
+    };
+
+    if (count <= 2 || depth >= QSSG_MAX_TREE_DEPTH)
+        return makeLeaf();
+
+    BuildPrimitive *begin = primitives + offset;
+    BuildPrimitive *end = begin + count;
+
+    QSSGBounds3 centerBounds;
+    for (const BuildPrimitive *p = begin; p != end; ++p)
+        centerBounds.include(p->center);
+
+    struct Bin {
+        QSSGBounds3 bounds;
+        quint32 count = 0;
+    };
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    quint32 bestBin = 0;
+    QSSGBounds3 bestLeftBounds;
+    QSSGBounds3 bestRightBounds;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        const float minimum = centerBounds.minimum[axis];
+        const float extent = centerBounds.maximum[axis] - minimum;
+        // All centers on the same plane (or invalid data)
+        if (!(extent > 0.0f))
+            continue;
+        const float scale = QSSG_SAH_BIN_COUNT / extent;
+
+        Bin bins[QSSG_SAH_BIN_COUNT];
+        for (const BuildPrimitive *p = begin; p != end; ++p) {
+            Bin &bin = bins[sahBinIndex(p->center[axis], minimum, scale)];
+            bin.bounds.include(p->bounds);
+            ++bin.count;
+        }
+
+        // Sweep from the right first, the split after bin i has bins
+        // [0, i] on the left and [i + 1, BIN_COUNT) on the right
+        QSSGBounds3 rightBounds[QSSG_SAH_BIN_COUNT - 1];
+        quint32 rightCounts[QSSG_SAH_BIN_COUNT - 1];
+        QSSGBounds3 accumulated;
+        quint32 accumulatedCount = 0;
+        for (quint32 i = QSSG_SAH_BIN_COUNT - 1; i > 0; --i) {
+            accumulated.include(bins[i].bounds);
+            accumulatedCount += bins[i].count;
+            rightBounds[i - 1] = accumulated;
+            rightCounts[i - 1] = accumulatedCount;
+        }
+
+        accumulated.setEmpty();
+        accumulatedCount = 0;
+        for (quint32 i = 0; i < QSSG_SAH_BIN_COUNT - 1; ++i) {
+            accumulated.include(bins[i].bounds);
+            accumulatedCount += bins[i].count;
+            if (accumulatedCount == 0 || rightCounts[i] == 0)
+                continue;
+            const float cost = halfSurfaceArea(accumulated) * accumulatedCount
+                    + halfSurfaceArea(rightBounds[i]) * rightCounts[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = i;
+                bestLeftBounds = accumulated;
+                bestRightBounds = rightBounds[i];
+            }
+        }
+    }
+
+    // All the triangle centers are in the same spot, no split can separate them
+    if (bestAxis < 0)
+        return makeLeaf();
+
+    // Small nodes stay leaves when testing all the triangles is cheaper
+    // than the expected cost of the children
+    const float nodeArea = halfSurfaceArea(bounds);
+    const float splitCost = QSSG_SAH_TRAVERSAL_COST + (nodeArea > 0.0f ? bestCost / nodeArea : 0.0f);
+    if (count <= QSSG_MAX_LEAF_TRIANGLES && splitCost >= float(count))
+        return makeLeaf();
+
+    const float minimum = centerBounds.minimum[bestAxis];
+    const float scale = QSSG_SAH_BIN_COUNT / (centerBounds.maximum[bestAxis] - minimum);
+    const BuildPrimitive *middle = std::partition(begin, end, [&](const BuildPrimitive &p) {
+        return sahBinIndex(p.center[bestAxis], minimum, scale) <= bestBin;
+    });
+    const quint32 leftCount = quint32(middle - begin);
+    QSSG_ASSERT(leftCount > 0 && leftCount < count, return makeLeaf());
+
+    const quint32 rightOffset = offset + leftCount;
+    const quint32 rightCount = count - leftCount;
+
+    // Build the right subtree into its own storage on a worker thread, if
+    // one is available, while this thread continues with the left one
+    QVector<QSSGMeshBVHNode> rightNodes;
+    QSemaphore done;
+    bool rightStarted = false;
+    if (parallel && depth < QSSG_PARALLEL_BUILD_MAX_DEPTH && rightCount >= QSSG_PARALLEL_BUILD_MIN_TRIANGLES) {
+        rightStarted = QThreadPool::globalInstance()->tryStart([&, depth] {
+            splitNodeSAH(bvh, rightNodes, primitives, rightOffset, rightCount, bestRightBounds, depth + 1, parallel);
+            done.release();
+        });
+    }
+
+    const qsizetype leftIdx = splitNodeSAH(bvh, nodes, primitives, offset, leftCount, bestLeftBounds, depth + 1, parallel);
+
+    qsizetype rightIdx = -1;
+    if (rightStarted) {
+        done.acquire();
+        rightIdx = nodes.size();
+        nodes.reserve(rightIdx + rightNodes.size());
+        for (QSSGMeshBVHNode &node : rightNodes) {
+            if (!node.left.isNull())
+                node.left.idx += rightIdx;
+            if (!node.right.isNull())
+                node.right.idx += rightIdx;
+            nodes.append(node);
+        }
+    } else {
+        rightIdx = splitNodeSAH(bvh, nodes, primitives, rightOffset, rightCount, bestRightBounds, depth + 1, parallel);
+    }
+
+    nodes[idx].left = { leftIdx, &bvh };
+    nodes[idx].right = { rightIdx, &bvh };
+    return idx;
+}
+
 QSSGBounds3 QSSGMeshBVHBuilder::getBounds(QSSGMeshBVH &bvh, quint32 offset, quint32 count)
 {
     QSSGBounds3 totalBounds;
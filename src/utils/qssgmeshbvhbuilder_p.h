@@ -33,6 +33,22 @@ public:
                        const QByteArray &indexBuffer = QByteArray(),
                        QSSGRenderComponentType indexBufferType = QSSGRenderComponentType::Int32);
 
+    enum class BuildMode
+    {
+        Average, // Split the longest axis at the average triangle center
+        BinnedSAH // Binned surface area heuristic, slower to build but faster to traverse
+    };
+
+    // QT_QUICK3D_MESH_BVH_SAH=1 selects BinnedSAH, Average otherwise
+    static BuildMode defaultBuildMode();
+
+    BuildMode buildMode() const { return m_buildMode; }
+    void setBuildMode(BuildMode mode) { m_buildMode = mode; }
+
+    // Build the top levels of the BinnedSAH tree on the global thread pool
+    bool isParallelBuild() const { return m_parallelBuild; }
+    void setParallelBuild(bool enable) { m_parallelBuild = enable; }
+
     std::unique_ptr<QSSGMeshBVH> buildTree();
 
 private:
@@ -57,6 +73,21 @@ private:
     static float getAverageValue(QSSGMeshBVH &bvh, quint32 offset, quint32 count, Axis axis);
     static quint32 partition(QSSGMeshBVH &bvh, quint32 offset, quint32 count, const Split &split);
 
+    struct BuildPrimitive {
+        QSSGBounds3 bounds;
+        QVector3D center;
+        quint32 triangle;
+    };
+
+    static qsizetype splitNodeSAH(QSSGMeshBVH &bvh,
+                                  QVector<QSSGMeshBVHNode> &nodes,
+                                  BuildPrimitive *primitives,
+                                  quint32 offset,
+                                  quint32 count,
+                                  const QSSGBounds3 &bounds,
+                                  quint32 depth,
+                                  bool parallel);
+
     QSSGMesh::Mesh m_mesh;
     QSSGRenderComponentType m_indexBufferComponentType;
     QByteArray m_indexBufferData;
@@ -66,7 +97,10 @@ private:
     quint32 m_vertexPosOffset;
     bool m_hasUVData = false;
     quint32 m_vertexUVOffset;
+    bool m_hasHalfUVData = false;
     bool m_hasIndexBuffer = true;
+    BuildMode m_buildMode = defaultBuildMode();
+    bool m_parallelBuild = true;
 };
 
 QT_END_NAMESPACE
@@ -7,6 +7,7 @@
 
 #include <QtQuick3DParticles/private/qquick3dparticle_p.h>
 #include <QtQuick3DParticles/private/qquick3dparticlegravity_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderparticles_p.h>
 
 
 class tst_QQuick3DParticleGravity : public QObject
@@ -23,11 +24,23 @@ class tst_QQuick3DParticleGravity : public QObject
         {
             QQuick3DParticleGravity::affectParticle(sd, d, time);
         }
+
+        void testAffectParticles(QQuick3DParticleDataCurrentBatch &batch)
+        {
+            QQuick3DParticleGravity::affectParticles(batch);
+        }
+
+        bool testSimulationAffector(QSSGParticleSimulationAffector *affector)
+        {
+            return QQuick3DParticleGravity::simulationAffector(affector);
+        }
     };
 
 private slots:
     void testGravity();
     void testGravityAffect();
+    void testGravityAffectBatch();
+    void testGravitySimulation();
 };
 
 void tst_QQuick3DParticleGravity::testGravity()
@@ -69,5 +82,77 @@ void tst_QQuick3DParticleGravity::testGravityAffect()
     delete gravity;
 }
 
+void tst_QQuick3DParticleGravity::testGravityAffectBatch()
+{
+    Gravity *gravity = new Gravity();
+    gravity->setMagnitude(50.0f);
+    gravity->setDirection(QVector3D(1.0f, 2.0f, 3.0f));
+
+    const int count = 10;
+    QQuick3DParticleData particleData[count];
+    QQuick3DParticleDataCurrent expected[count];
+    QQuick3DParticleDataCurrentBatch batch;
+    for (int i = 0; i < count; ++i) {
+        particleData[i].index = i;
+        expected[i].position = QVector3D(float(i), 1.0f, -float(i));
+        batch.append(i, &particleData[i], 0.1f * i, expected[i]);
+        gravity->testAffectParticle(particleData[i], &expected[i], 0.1f * i);
+    }
+
+    // The batch must give the same results as affecting one by one
+    gravity->testAffectParticles(batch);
+    QCOMPARE(batch.count, count);
+    for (int i = 0; i < count; ++i)
+        QVERIFY(qFuzzyCompare(batch.current(i).position, expected[i].position));
+
+    delete gravity;
+}
+
+void tst_QQuick3DParticleGravity::testGravitySimulation()
+{
+    Gravity *gravity = new Gravity();
+    gravity->setMagnitude(50.0f);
+    gravity->setDirection(QVector3D(1.0f, 2.0f, 3.0f));
+
+    QSSGParticleSimulation simulation;
+    simulation.affectors.resize(1);
+    QVERIFY(gravity->testSimulationAffector(&simulation.affectors[0]));
+    QVERIFY(simulation.affectors[0].type == QSSGParticleSimulationAffector::Type::Gravity);
+
+    QSSGParticleSimulationData data = {};
+    data.startPosition = QVector3D(1.0f, 2.0f, 3.0f);
+    data.startVelocity = QVector3D(10.0f, 0.0f, -10.0f);
+    data.startTime = 1.0f;
+    data.lifetime = 2.0f;
+    data.startSize = 1.0f;
+    data.endSize = 1.0f;
+    data.color = QVector4D(1.0f, 1.0f, 1.0f, 1.0f);
+    simulation.particles = QByteArray(reinterpret_cast<const char *>(&data), sizeof(data));
+    QCOMPARE(simulation.particleCount(), 1);
+
+    // The renderer must give the same positions as affecting on the CPU
+    QQuick3DParticleData particleData;
+    for (float time : { 1.0f, 1.5f, 2.9f }) {
+        const float particleTime = time - data.startTime;
+        QQuick3DParticleDataCurrent expected;
+        expected.position = data.startPosition + data.startVelocity * particleTime;
+        gravity->testAffectParticle(particleData, &expected, particleTime);
+
+        QSSGParticleSimple particle;
+        simulation.time = time;
+        QVERIFY(simulation.evaluate(0, &particle));
+        QVERIFY(qFuzzyCompare(particle.position, expected.position));
+    }
+
+    // Not alive before emitting and after the lifetime
+    QSSGParticleSimple particle;
+    simulation.time = 0.5f;
+    QVERIFY(!simulation.evaluate(0, &particle));
+    simulation.time = 3.5f;
+    QVERIFY(!simulation.evaluate(0, &particle));
+
+    delete gravity;
+}
+
 QTEST_APPLESS_MAIN(tst_QQuick3DParticleGravity)
 #include "tst_qquick3dparticlegravity.moc"
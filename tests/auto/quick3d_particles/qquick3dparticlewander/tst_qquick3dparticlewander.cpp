@@ -24,6 +24,10 @@ class tst_QQuick3DParticleWander : public QObject
         {
             QQuick3DParticleWander::affectParticle(sd, d, time);
         }
+        void testAffectParticles(QQuick3DParticleDataCurrentBatch &batch)
+        {
+            QQuick3DParticleWander::affectParticles(batch);
+        }
     };
 
     class TestSystem : public QQuick3DParticleSystem
@@ -43,6 +47,7 @@ class tst_QQuick3DParticleWander : public QObject
 private slots:
     void testInitialization();
     void testAffectParticle();
+    void testAffectParticles();
 };
 
 void tst_QQuick3DParticleWander::testInitialization()
@@ -110,5 +115,44 @@ void tst_QQuick3DParticleWander::testAffectParticle()
     delete system;
 }
 
+void tst_QQuick3DParticleWander::testAffectParticles()
+{
+    TestSystem *system = new TestSystem();
+    Wander *wander = new Wander();
+
+    system->init();
+    wander->setSystem(system);
+
+    wander->setGlobalAmount(QVector3D(1.0f, 2.0f, 3.0f));
+    wander->setGlobalPace(QVector3D(1.0f, 0.5f, 0.25f));
+    wander->setUniqueAmount(QVector3D(3.0f, 2.0f, 1.0f));
+    wander->setUniquePace(QVector3D(0.5f, 1.0f, 2.0f));
+    wander->setUniqueAmountVariation(0.5f);
+    wander->setUniquePaceVariation(0.5f);
+    wander->setFadeInDuration(200);
+    wander->setFadeOutDuration(300);
+
+    const int count = 10;
+    QQuick3DParticleData particleData[count];
+    QQuick3DParticleDataCurrent expected[count];
+    QQuick3DParticleDataCurrentBatch batch;
+    for (int i = 0; i < count; ++i) {
+        particleData[i].index = i * 7;
+        particleData[i].lifetime = 1.0f;
+        expected[i].position = QVector3D(float(i), 1.0f, -float(i));
+        batch.append(i, &particleData[i], 0.1f * i, expected[i]);
+        wander->testAffectParticle(particleData[i], &expected[i], 0.1f * i);
+    }
+
+    // The batch must give the same results as affecting one by one
+    wander->testAffectParticles(batch);
+    QCOMPARE(batch.count, count);
+    for (int i = 0; i < count; ++i)
+        QVERIFY(qFuzzyCompare(batch.current(i).position, expected[i].position));
+
+    delete wander;
+    delete system;
+}
+
 QTEST_APPLESS_MAIN(tst_QQuick3DParticleWander)
 #include "tst_qquick3dparticlewander.moc"
@@ -38,6 +38,8 @@ private slots:
     void staticScene_data();
     void staticScene();
     void dynamicScene();
+    void memoryBudget();
+    void textureStreaming();
 
 private:
     bool initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename);
@@ -327,6 +329,132 @@ void tst_BufferManager::dynamicScene()
     QCOMPARE(bufferManager->getCustomMeshMap().size(), 0);
 }
 
+void tst_BufferManager::memoryBudget()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QString("dynamic.qml")));
+
+    if (renderer.quickWindow->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL) {
+#ifdef Q_OS_MACOS
+        QSKIP("Skipping test due to sofware OpenGL renderer problems on macOS");
+#endif
+    }
+
+    bool readCompleted = false;
+    QRhiReadbackResult readResult;
+    QImage result;
+
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer.quickWindow)->rci();
+    QVERIFY(context);
+
+    const auto &bufferManager = context->bufferManager();
+    bufferManager->setMemoryBudget(quint64(1024) * 1024 * 1024);
+
+    const auto controller = renderer.rootItem->property("controller").value<QQuick3DNode*>();
+    QVERIFY(controller);
+
+    auto addModel = [controller](const QString &path) -> QQuick3DModel* {
+        QQuick3DModel *model = nullptr;
+        QMetaObject::invokeMethod(controller, "addModel", Q_RETURN_ARG(QQuick3DModel*, model), Q_ARG(QString, path));
+        return model;
+    };
+
+    auto addTexture = [controller](const QString &path) -> QQuick3DTexture* {
+        QQuick3DTexture *texture = nullptr;
+        QMetaObject::invokeMethod(controller, "addTexture", Q_RETURN_ARG(QQuick3DTexture*, texture), Q_ARG(QString, path));
+        return texture;
+    };
+
+    // Unused assets stay cached while they fit in the budget
+    QQuick3DModel *model = addModel("#Cube");
+    QQuick3DTexture *texture = addTexture("noise1.jpg");
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getMeshMap().size(), 2);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+    QRhiTexture *rhiTexture = bufferManager->getImageMap().cbegin()->renderImageTexture.m_texture;
+    QVERIFY(rhiTexture);
+
+    QMetaObject::invokeMethod(controller, "removeModel", Qt::DirectConnection);
+    delete model;
+    QMetaObject::invokeMethod(controller, "removeTexture");
+    delete texture;
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getMeshMap().size(), 2);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+
+    // Using them again does not load them again
+    texture = addTexture("noise1.jpg");
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+    QCOMPARE(bufferManager->getImageMap().cbegin()->renderImageTexture.m_texture, rhiTexture);
+    QMetaObject::invokeMethod(controller, "removeTexture");
+    delete texture;
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    // Over the budget, only what is in use stays
+    const quint64 evictionCount = bufferManager->memoryStats().evictionCount;
+    bufferManager->setMemoryBudget(1);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getMeshMap().size(), 1);
+    QCOMPARE(bufferManager->getImageMap().size(), 0);
+    QCOMPARE(bufferManager->memoryStats().evictionCount, evictionCount + 2);
+}
+
+void tst_BufferManager::textureStreaming()
+{
+    QQuick3DTestOffscreenRenderer renderer;
+    QVERIFY(initRenderer(&renderer, QString("dynamic.qml")));
+
+    bool readCompleted = false;
+    QRhiReadbackResult readResult;
+    QImage result;
+
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+
+    const auto &context = QQuick3DSceneManager::getOrSetWindowAttachment(*renderer.quickWindow)->rci();
+    QVERIFY(context);
+    if (!context->rhiContext()->rhi()->isTextureFormatSupported(QRhiTexture::ETC2_RGBA8))
+        QSKIP("ETC2 textures are not supported");
+
+    const auto &bufferManager = context->bufferManager();
+    const auto controller = renderer.rootItem->property("controller").value<QQuick3DNode*>();
+    QVERIFY(controller);
+
+    // 128x128 with all 8 levels. Tiled 4 times, the sphere needs no more than 64x64.
+    QQuick3DTexture *texture = nullptr;
+    QMetaObject::invokeMethod(controller, "addTexture", Q_RETURN_ARG(QQuick3DTexture*, texture), Q_ARG(QString, "miptester_etc2.ktx"));
+    QVERIFY(texture);
+    texture->setStreaming(true);
+    texture->setScaleU(4.0f);
+    texture->setScaleV(4.0f);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+    {
+        const auto &imageData = *bufferManager->getImageMap().cbegin();
+        QVERIFY(imageData.renderImageTexture.m_texture);
+        QCOMPARE(imageData.renderImageTexture.m_texture->pixelSize(), QSize(64, 64));
+        QCOMPARE(imageData.renderImageTexture.m_mipmapCount, 7);
+        QVERIFY(imageData.stream);
+    }
+
+    // Without the tiling, the sphere is larger than that on the screen
+    texture->setScaleU(1.0f);
+    texture->setScaleV(1.0f);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    renderNextFrame(&renderer, &readCompleted, &readResult, &result);
+    QCOMPARE(bufferManager->getImageMap().size(), 1);
+    {
+        const auto &imageData = *bufferManager->getImageMap().cbegin();
+        QVERIFY(imageData.renderImageTexture.m_texture);
+        QCOMPARE(imageData.renderImageTexture.m_texture->pixelSize(), QSize(128, 128));
+        QCOMPARE(imageData.renderImageTexture.m_mipmapCount, 8);
+        QVERIFY(!imageData.stream);
+    }
+}
+
 bool tst_BufferManager::initRenderer(QQuick3DTestOffscreenRenderer *renderer, const QString &filename)
 {
     const bool initSuccess = renderer->init(testFileUrl(filename),
@@ -1,7 +1,9 @@
 // Copyright (C) 2021 The Qt Company Ltd.
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+#include <QSet>
 #include <QSignalSpy>
 #include <QTest>
+#include <QtMath>
 #include <QtQuick/QQuickItem>
 
 #include <QtQuick3D/private/qquick3dviewport_p.h>
@@ -127,10 +129,12 @@ private Q_SLOTS:
     void test_object_picking2();
     void test_picking_QTBUG_111997();
     void test_picking_corner_case();
+    void test_ray_pick_batch();
     void test_triangleIntersect();
 
 private:
     QQuickItem *find2DChildIn3DNode(QQuickView *view, const QString &objectName, const QString &itemName);
+    void compareRayPickBatch(QQuick3DViewport *view3d, const QList<QVector3D> &origins, const QList<QVector3D> &directions);
 
 };
 
@@ -509,6 +513,97 @@ void tst_Picking::test_picking_corner_case()
 
 }
 
+// rayPickBatch() must return, for each ray, what rayPick() returns for it
+void tst_Picking::compareRayPickBatch(QQuick3DViewport *view3d,
+                                      const QList<QVector3D> &origins,
+                                      const QList<QVector3D> &directions)
+{
+    const auto resultList = view3d->rayPickBatch(origins, directions);
+    QCOMPARE(resultList.size(), origins.size());
+    for (qsizetype i = 0; i < origins.size(); ++i) {
+        const auto result = view3d->rayPick(origins.at(i), directions.at(i));
+        QCOMPARE(resultList[i].objectHit(), result.objectHit());
+        QCOMPARE(resultList[i].distance(), result.distance());
+        QCOMPARE(resultList[i].instanceIndex(), result.instanceIndex());
+        QCOMPARE(resultList[i].scenePosition(), result.scenePosition());
+    }
+}
+
+void tst_Picking::test_ray_pick_batch()
+{
+    QScopedPointer<QQuickView> view(createView(QLatin1String("picking.qml"), QSize(400, 400)));
+    QVERIFY(view);
+    QVERIFY(QTest::qWaitForWindowExposed(view.data()));
+
+    QQuick3DViewport *view3d = view->findChild<QQuick3DViewport *>(QStringLiteral("view"));
+    QVERIFY(view3d);
+    QQuick3DModel *model1 = view3d->findChild<QQuick3DModel *>(QStringLiteral("model1"));
+    QVERIFY(model1);
+    QQuick3DModel *instancedModel = view3d->findChild<QQuick3DModel *>(QStringLiteral("instancedModel"));
+    QVERIFY(instancedModel);
+    QQuickItem *item2d = qmlobject_cast<QQuickItem *>(find2DChildIn3DNode(view.data(), "item2dNode", "item2d"));
+    QVERIFY(item2d);
+
+    // Enough rays for the batch to be split over several jobs: a grid down
+    // the z axis in front of the camera, the same grid up the z axis from
+    // behind the scene and rays towards the origin from around the scene.
+    // The grid is offset from the cube edges, which are multiples of 25.
+    QList<QVector3D> origins;
+    QList<QVector3D> directions;
+    for (int y = -195; y < 200; y += 10) {
+        for (int x = -295; x < 300; x += 10) {
+            origins.append(QVector3D(x, y, 600.0f));
+            directions.append(QVector3D(0.0f, 0.0f, -1.0f));
+            origins.append(QVector3D(x, y, -600.0f));
+            directions.append(QVector3D(0.0f, 0.0f, 1.0f));
+        }
+    }
+    for (int angle = 0; angle < 360; angle += 15) {
+        const float radians = qDegreesToRadians(float(angle));
+        const QVector3D origin(500.0f * qCos(radians), 300.0f * qSin(radians), 400.0f);
+        origins.append(origin);
+        directions.append(-origin.normalized());
+        // Pointing away from the scene, so these miss
+        origins.append(origin);
+        directions.append(origin.normalized());
+    }
+
+    compareRayPickBatch(view3d, origins, directions);
+    if (QTest::currentTestFailed())
+        return;
+
+    // Check that the rays cover what the batch has to get right
+    const auto resultList = view3d->rayPickBatch(origins, directions);
+    bool hasMiss = false;
+    bool hasModel = false;
+    QSet<int> hitInstances;
+    for (const auto &result : resultList) {
+        hasMiss |= result.objectHit() == nullptr;
+        hasModel |= result.objectHit() == model1;
+        if (result.objectHit() == instancedModel)
+            hitInstances.insert(result.instanceIndex());
+    }
+    QVERIFY(hasMiss);
+    QVERIFY(hasModel);
+    QCOMPARE(hitInstances, QSet<int>({ 0, 1, 2 }));
+
+    // The 2D item in front of model1 takes the hits once enabled, those
+    // are not reported as models
+    const QVector3D origin(5.0f, 5.0f, 600.0f);
+    const QVector3D direction(0.0f, 0.0f, -1.0f);
+    QCOMPARE(view3d->rayPickBatch({ origin }, { direction }).first().objectHit(), model1);
+    item2d->setEnabled(true);
+    QTest::qWait(100);
+    QCOMPARE(view3d->rayPickBatch({ origin }, { direction }).first().objectHit(), nullptr);
+    compareRayPickBatch(view3d, origins, directions);
+    if (QTest::currentTestFailed())
+        return;
+
+    // Mismatching lists give no results
+    QTest::ignoreMessage(QtWarningMsg, "View3D::rayPickBatch: 2 origins but 1 directions");
+    QVERIFY(view3d->rayPickBatch({ origin, origin }, { direction }).isEmpty());
+}
+
 void tst_Picking::test_triangleIntersect()
 {
     const QVector3D direction(0, 0, -1);
@@ -0,0 +1,48 @@
+import QtQuick
+import QtQuick3D
+
+View3D {
+    anchors.fill: parent
+    environment: SceneEnvironment {
+        backgroundMode: SceneEnvironment.Color
+        clearColor: "black"
+    }
+    PerspectiveCamera {
+        z: 600
+        frustumCullingEnabled: true
+    }
+
+    PrincipledMaterial {
+        id: red
+        baseColor: "red"
+        lighting: PrincipledMaterial.NoLighting
+    }
+
+    // The models only differ in their position, so they are drawn as one
+    // batch. The first one in the batch is the nearest to the camera, it is
+    // outside of the frustum while the others are in it.
+    Model {
+        source: "#Cube"
+        position: Qt.vector3d(300, 0, 450)
+        materials: red
+    }
+    Model {
+        source: "#Cube"
+        position: Qt.vector3d(-200, 0, 0)
+        materials: red
+    }
+    Model {
+        source: "#Cube"
+        materials: red
+    }
+    Model {
+        source: "#Cube"
+        position: Qt.vector3d(200, 0, 0)
+        materials: red
+    }
+    Model {
+        source: "#Cube"
+        position: Qt.vector3d(0, 200, 0)
+        materials: red
+    }
+}
@@ -0,0 +1,22 @@
+import QtQuick
+import QtQuick3D
+
+View3D {
+    anchors.fill: parent
+    shaderCompilationMode: View3D.Asynchronous
+    environment: SceneEnvironment {
+        backgroundMode: SceneEnvironment.Color
+        clearColor: "black"
+    }
+    OrthographicCamera { z: 600 }
+    Model {
+        objectName: "model"
+        source: "#Rectangle"
+        scale: Qt.vector3d(2, 2, 1)
+        visible: false
+        materials: PrincipledMaterial {
+            baseColor: "red"
+            lighting: PrincipledMaterial.NoLighting
+        }
+    }
+}
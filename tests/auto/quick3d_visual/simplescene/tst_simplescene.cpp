@@ -4,6 +4,9 @@
 #include <QTest>
 #include <QQuickView>
 
+#include <QtQuick3D/private/qquick3dviewport_p.h>
+#include <QtQuick3D/private/qquick3dmodel_p.h>
+
 #include "../shared/util.h"
 
 class tst_SimpleScene : public QQuick3DDataTest
@@ -13,6 +16,8 @@ class tst_SimpleScene : public QQuick3DDataTest
 private slots:
     void initTestCase() override;
     void cube();
+    void precompileShaders();
+    void batchFrustumCulling();
 };
 
 void tst_SimpleScene::initTestCase()
@@ -45,5 +50,45 @@ void tst_SimpleScene::cube()
     QVERIFY(comparePixelNormPos(result, 0.5, 0.375, QColor::fromRgb(181, 181, 181), FUZZ));
 }
 
+void tst_SimpleScene::precompileShaders()
+{
+    QScopedPointer<QQuickView> view(createView(QLatin1String("precompile.qml"), QSize(640, 480)));
+    QVERIFY(view);
+    QVERIFY(QTest::qWaitForWindowExposed(view.data()));
+
+    QQuick3DViewport *view3d = qobject_cast<QQuick3DViewport *>(view->rootObject());
+    QVERIFY(view3d);
+    QQuick3DModel *model = view3d->findChild<QQuick3DModel *>(QStringLiteral("model"));
+    QVERIFY(model);
+
+    // With asynchronous compilation a new material would be missing from the
+    // first frame it is in, unless its shaders were requested up front
+    model->setVisible(true);
+    view3d->precompileShaders();
+
+    const QImage result = grab(view.data());
+    if (result.isNull())
+        return; // was QFAIL'ed already
+
+    QVERIFY(comparePixelNormPos(result, 0.5, 0.5, Qt::red, FUZZ));
+}
+
+void tst_SimpleScene::batchFrustumCulling()
+{
+    QScopedPointer<QQuickView> view(createView(QLatin1String("batchculling.qml"), QSize(640, 480)));
+    QVERIFY(view);
+    QVERIFY(QTest::qWaitForWindowExposed(view.data()));
+
+    const QImage result = grab(view.data());
+    if (result.isNull())
+        return; // was QFAIL'ed already
+
+    // The models in the frustum are drawn even though the first model of
+    // their batch is culled
+    QVERIFY(comparePixelNormPos(result, 0.5, 0.5, Qt::red, FUZZ));
+    QVERIFY(comparePixelNormPos(result, 0.5, 0.2, Qt::red, FUZZ));
+    QVERIFY(comparePixelNormPos(result, 0.5, 0.8, Qt::black, FUZZ));
+}
+
 QTEST_MAIN(tst_SimpleScene)
 #include "tst_simplescene.moc"
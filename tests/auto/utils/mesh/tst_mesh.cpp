@@ -0,0 +1,385 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DUtils/private/qssgmesh_p.h>
+
+class mesh : public QObject
+{
+    Q_OBJECT
+
+public:
+    mesh() = default;
+    ~mesh() = default;
+
+private slots:
+    void initTestCase();
+    void test_loadMapped_data();
+    void test_loadMapped();
+    void test_loadMappedOutlivesFile();
+    void test_loadMappedFallback();
+    void test_loadSubsets();
+    void test_compressed_data();
+    void test_compressed();
+    void test_fileVersion_data();
+    void test_fileVersion();
+    void test_quantizeVertexData();
+
+private:
+    static QSSGMesh::Mesh createGrid(int gridSize, float scale);
+    static void compareMeshes(const QSSGMesh::Mesh &actual, const QSSGMesh::Mesh &expected);
+    static void compareTriangles(const QSSGMesh::Mesh &actual, const QSSGMesh::Mesh &expected);
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    QSSGMesh::Mesh m_meshes[2];
+};
+
+// A grid with positions and texture coordinates, split in two subsets
+QSSGMesh::Mesh mesh::createGrid(int gridSize, float scale)
+{
+    QSSGMesh::RuntimeMeshData data;
+    data.m_vertexBuffer.resize(qsizetype(gridSize) * gridSize * 5 * sizeof(float));
+    float *vertex = reinterpret_cast<float *>(data.m_vertexBuffer.data());
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            const float u = float(x) / float(gridSize - 1);
+            const float v = float(y) / float(gridSize - 1);
+            *vertex++ = u * scale;
+            *vertex++ = v * scale;
+            *vertex++ = 0.0f;
+            *vertex++ = u;
+            *vertex++ = v;
+        }
+    }
+
+    const int quadCount = (gridSize - 1) * (gridSize - 1);
+    data.m_indexBuffer.resize(qsizetype(quadCount) * 6 * sizeof(quint16));
+    quint16 *index = reinterpret_cast<quint16 *>(data.m_indexBuffer.data());
+    for (int y = 0; y < gridSize - 1; ++y) {
+        for (int x = 0; x < gridSize - 1; ++x) {
+            const quint16 i = quint16(y * gridSize + x);
+            *index++ = i;
+            *index++ = i + 1;
+            *index++ = i + gridSize;
+            *index++ = i + 1;
+            *index++ = i + gridSize + 1;
+            *index++ = i + gridSize;
+        }
+    }
+
+    using Attribute = QSSGMesh::RuntimeMeshData::Attribute;
+    data.m_attributes[0] = { Attribute::PositionSemantic, QSSGMesh::Mesh::ComponentType::Float32, 0 };
+    data.m_attributes[1] = { Attribute::TexCoord0Semantic, QSSGMesh::Mesh::ComponentType::Float32, 3 * sizeof(float) };
+    data.m_attributes[2] = { Attribute::IndexSemantic, QSSGMesh::Mesh::ComponentType::UnsignedInt16, 0 };
+    data.m_attributeCount = 3;
+    data.m_stride = 5 * sizeof(float);
+
+    const quint32 half = quint32(quadCount / 2) * 6;
+    QSSGMesh::Mesh::Subset lower;
+    lower.name = QStringLiteral("lower");
+    lower.bounds = { QVector3D(0.0f, 0.0f, 0.0f), QVector3D(scale, scale * 0.5f, 0.0f) };
+    lower.count = half;
+    data.m_subsets.append(lower);
+    QSSGMesh::Mesh::Subset upper;
+    upper.name = QStringLiteral("upper");
+    upper.bounds = { QVector3D(0.0f, scale * 0.5f, 0.0f), QVector3D(scale, scale, 0.0f) };
+    upper.offset = half;
+    upper.count = quint32(quadCount) * 6 - half;
+    data.m_subsets.append(upper);
+
+    QString error;
+    const QSSGMesh::Mesh result = QSSGMesh::Mesh::fromRuntimeData(data, &error);
+    if (!result.isValid())
+        qWarning("Failed to create mesh: %s", qPrintable(error));
+    return result;
+}
+
+void mesh::compareMeshes(const QSSGMesh::Mesh &actual, const QSSGMesh::Mesh &expected)
+{
+    QVERIFY(actual.isValid());
+    QCOMPARE(actual.drawMode(), expected.drawMode());
+    QCOMPARE(actual.vertexBuffer().stride, expected.vertexBuffer().stride);
+    QCOMPARE(actual.vertexBuffer().entries.size(), expected.vertexBuffer().entries.size());
+    QCOMPARE(actual.vertexBuffer().data, expected.vertexBuffer().data);
+    QCOMPARE(actual.indexBuffer().componentType, expected.indexBuffer().componentType);
+    QCOMPARE(actual.indexBuffer().data, expected.indexBuffer().data);
+    const auto actualSubsets = actual.subsets();
+    const auto expectedSubsets = expected.subsets();
+    QCOMPARE(actualSubsets.size(), expectedSubsets.size());
+    for (qsizetype i = 0; i < actualSubsets.size(); ++i) {
+        QCOMPARE(actualSubsets[i].name, expectedSubsets[i].name);
+        QCOMPARE(actualSubsets[i].offset, expectedSubsets[i].offset);
+        QCOMPARE(actualSubsets[i].count, expectedSubsets[i].count);
+        QCOMPARE(actualSubsets[i].bounds.min, expectedSubsets[i].bounds.min);
+        QCOMPARE(actualSubsets[i].bounds.max, expectedSubsets[i].bounds.max);
+    }
+}
+
+// The index codec may rotate the triangles
+void mesh::compareTriangles(const QSSGMesh::Mesh &actual, const QSSGMesh::Mesh &expected)
+{
+    QCOMPARE(actual.indexBuffer().componentType, QSSGMesh::Mesh::ComponentType::UnsignedInt16);
+    QCOMPARE(actual.indexBuffer().data.size(), expected.indexBuffer().data.size());
+    const quint16 *a = reinterpret_cast<const quint16 *>(actual.indexBuffer().data.constData());
+    const quint16 *e = reinterpret_cast<const quint16 *>(expected.indexBuffer().data.constData());
+    const qsizetype count = expected.indexBuffer().data.size() / sizeof(quint16);
+    for (qsizetype i = 0; i < count; i += 3) {
+        const bool same = (a[i] == e[i] && a[i + 1] == e[i + 1] && a[i + 2] == e[i + 2])
+                || (a[i] == e[i + 1] && a[i + 1] == e[i + 2] && a[i + 2] == e[i])
+                || (a[i] == e[i + 2] && a[i + 1] == e[i] && a[i + 2] == e[i + 1]);
+        QVERIFY2(same, qPrintable(QStringLiteral("triangle %1").arg(i / 3)));
+    }
+}
+
+void mesh::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_path = m_dir.filePath(QStringLiteral("grids.mesh"));
+
+    m_meshes[0] = createGrid(17, 1.0f);
+    m_meshes[1] = createGrid(33, 4.0f);
+    QVERIFY(m_meshes[0].isValid());
+    QVERIFY(m_meshes[1].isValid());
+
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QCOMPARE(m_meshes[0].save(&file, 1), 1u);
+    QCOMPARE(m_meshes[1].save(&file, 2), 2u);
+}
+
+void mesh::test_loadMapped_data()
+{
+    QTest::addColumn<quint32>("id");
+    QTest::addColumn<int>("expected");
+    QTest::newRow("first") << 0u << 0;
+    QTest::newRow("1") << 1u << 0;
+    QTest::newRow("2") << 2u << 1;
+}
+
+void mesh::test_loadMapped()
+{
+    QFETCH(quint32, id);
+    QFETCH(int, expected);
+
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QSSGMesh::Mesh read = QSSGMesh::Mesh::loadMesh(&file, id);
+    compareMeshes(read, m_meshes[expected]);
+
+    QSharedPointer<QIODevice> mappedFile(new QFile(m_path));
+    QVERIFY(mappedFile->open(QIODevice::ReadOnly));
+    const QSSGMesh::Mesh mapped = QSSGMesh::Mesh::loadMeshMapped(mappedFile, id);
+    compareMeshes(mapped, m_meshes[expected]);
+
+    // Not an id in the file
+    QVERIFY(!QSSGMesh::Mesh::loadMeshMapped(mappedFile, 3).isValid());
+}
+
+void mesh::test_loadMappedOutlivesFile()
+{
+    QSSGMesh::Mesh mapped;
+    {
+        QSharedPointer<QIODevice> mappedFile(new QFile(m_path));
+        QVERIFY(mappedFile->open(QIODevice::ReadOnly));
+        mapped = QSSGMesh::Mesh::loadMeshMapped(mappedFile, 2);
+    }
+    // The mesh keeps the file and its mapping alive
+    compareMeshes(mapped, m_meshes[1]);
+
+    // Modifying the buffers detaches them from the mapping
+    QSSGMesh::Mesh copy = mapped;
+    mapped = QSSGMesh::Mesh();
+    QVERIFY(copy.createLightmapUVChannel(64));
+    QVERIFY(copy.hasLightmapUVChannel());
+}
+
+void mesh::test_loadMappedFallback()
+{
+    // Not a file, read as usual
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QSharedPointer<QIODevice> buffer(new QBuffer);
+    static_cast<QBuffer *>(buffer.data())->setData(file.readAll());
+    QVERIFY(buffer->open(QIODevice::ReadOnly));
+    compareMeshes(QSSGMesh::Mesh::loadMeshMapped(buffer, 1), m_meshes[0]);
+}
+
+void mesh::test_loadSubsets()
+{
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    for (quint32 id : { 1u, 2u }) {
+        const auto subsets = QSSGMesh::Mesh::loadSubsets(&file, id);
+        const auto expected = m_meshes[id - 1].subsets();
+        QCOMPARE(subsets.size(), expected.size());
+        for (qsizetype i = 0; i < subsets.size(); ++i) {
+            QCOMPARE(subsets[i].name, expected[i].name);
+            QCOMPARE(subsets[i].bounds.min, expected[i].bounds.min);
+            QCOMPARE(subsets[i].bounds.max, expected[i].bounds.max);
+        }
+    }
+    QVERIFY(QSSGMesh::Mesh::loadSubsets(&file, 3).isEmpty());
+}
+
+void mesh::test_compressed_data()
+{
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<float>("tolerance");
+    QTest::newRow("compressed") << int(QSSGMesh::Mesh::SaveCompressed) << 0.0f;
+    QTest::newRow("quantized") << int(QSSGMesh::Mesh::SaveQuantized) << 0.001f;
+}
+
+void mesh::test_compressed()
+{
+    QFETCH(int, flags);
+    QFETCH(float, tolerance);
+
+    const QString path = m_dir.filePath(QStringLiteral("compressed%1.mesh").arg(flags));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QCOMPARE(m_meshes[0].save(&file, 1, QSSGMesh::Mesh::SaveFlags(flags)), 1u);
+        QCOMPARE(m_meshes[1].save(&file, 2, QSSGMesh::Mesh::SaveFlags(flags)), 2u);
+    }
+    QVERIFY(QFileInfo(path).size() < QFileInfo(m_path).size());
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QSharedPointer<QIODevice> mappedFile(new QFile(path));
+    QVERIFY(mappedFile->open(QIODevice::ReadOnly));
+    for (quint32 id : { 1u, 2u }) {
+        const QSSGMesh::Mesh &expected = m_meshes[id - 1];
+        for (const QSSGMesh::Mesh &read : { QSSGMesh::Mesh::loadMesh(&file, id),
+                                            QSSGMesh::Mesh::loadMeshMapped(mappedFile, id) }) {
+            QVERIFY(read.isValid());
+            QCOMPARE(read.vertexBuffer().stride, expected.vertexBuffer().stride);
+            if (tolerance == 0.0f) {
+                QCOMPARE(read.vertexBuffer().data, expected.vertexBuffer().data);
+            } else {
+                const QByteArray &data = read.vertexBuffer().data;
+                QCOMPARE(data.size(), expected.vertexBuffer().data.size());
+                const float *a = reinterpret_cast<const float *>(data.constData());
+                const float *e = reinterpret_cast<const float *>(expected.vertexBuffer().data.constData());
+                for (qsizetype i = 0; i < data.size() / qsizetype(sizeof(float)); ++i)
+                    QVERIFY(qAbs(a[i] - e[i]) <= tolerance);
+            }
+            compareTriangles(read, expected);
+            QCOMPARE(read.subsets().size(), expected.subsets().size());
+        }
+        QCOMPARE(QSSGMesh::Mesh::loadSubsets(&file, id).size(), expected.subsets().size());
+    }
+}
+
+void mesh::test_fileVersion_data()
+{
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<int>("expected");
+    QTest::newRow("uncompressed") << 0 << 7;
+    QTest::newRow("compressed") << int(QSSGMesh::Mesh::SaveCompressed) << 8;
+    QTest::newRow("quantized") << int(QSSGMesh::Mesh::SaveQuantized) << 8;
+}
+
+void mesh::test_fileVersion()
+{
+    QFETCH(int, flags);
+    QFETCH(int, expected);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    QCOMPARE(m_meshes[0].save(&buffer, 1, QSSGMesh::Mesh::SaveFlags(flags)), 1u);
+
+    const auto fileInfo = QSSGMesh::MeshInternal::readFileHeader(&buffer);
+    QVERIFY(fileInfo.isValid());
+    QSSGMesh::Mesh read;
+    QSSGMesh::MeshInternal::MeshDataHeader header;
+    QVERIFY(QSSGMesh::MeshInternal::readMeshData(&buffer, fileInfo.meshEntries.value(1), &read, &header,
+                                                  QSSGMesh::MeshInternal::ReadMode::SubsetsOnly));
+    QCOMPARE(int(header.fileVersion), expected);
+    QCOMPARE(header.hasCompressedBuffers(), flags != 0);
+}
+
+void mesh::test_quantizeVertexData()
+{
+    const QVector3D positions[] = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+    const QVector3D normals[] = { QVector3D(0.0f, 0.0f, 1.0f), QVector3D(1.0f, 1.0f, 1.0f).normalized(),
+                                  QVector3D(-0.6f, 0.0f, -0.8f) };
+    const QVector2D uvs[] = { { 0.0f, 0.0f }, { 0.25f, 0.5f }, { 0.75f, 1.0f } };
+
+    QSSGMesh::RuntimeMeshData data;
+    data.m_primitiveType = QSSGMesh::Mesh::DrawMode::Triangles;
+    data.m_vertexBuffer.resize(3 * 8 * sizeof(float));
+    float *vertex = reinterpret_cast<float *>(data.m_vertexBuffer.data());
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 0; c < 3; ++c)
+            *vertex++ = positions[i][c];
+        for (int c = 0; c < 3; ++c)
+            *vertex++ = normals[i][c];
+        *vertex++ = uvs[i].x();
+        *vertex++ = uvs[i].y();
+    }
+    const quint16 indices[] = { 0, 1, 2 };
+    data.m_indexBuffer = QByteArray(reinterpret_cast<const char *>(indices), sizeof(indices));
+
+    using Attribute = QSSGMesh::RuntimeMeshData::Attribute;
+    data.m_attributes[0] = { Attribute::PositionSemantic, QSSGMesh::Mesh::ComponentType::Float32, 0 };
+    data.m_attributes[1] = { Attribute::NormalSemantic, QSSGMesh::Mesh::ComponentType::Float32, 3 * sizeof(float) };
+    data.m_attributes[2] = { Attribute::TexCoord0Semantic, QSSGMesh::Mesh::ComponentType::Float32, 6 * sizeof(float) };
+    data.m_attributes[3] = { Attribute::IndexSemantic, QSSGMesh::Mesh::ComponentType::UnsignedInt16, 0 };
+    data.m_attributeCount = 4;
+    data.m_stride = 8 * sizeof(float);
+
+    QString error;
+    QSSGMesh::Mesh result = QSSGMesh::Mesh::fromRuntimeData(data, &error);
+    QVERIFY2(result.isValid(), qPrintable(error));
+    QVERIFY(result.quantizeVertexData());
+    QVERIFY(!result.quantizeVertexData());
+
+    // 12 bytes of position, 4 bytes of normal and 4 bytes of UV
+    const QSSGMesh::Mesh::VertexBuffer vb = result.vertexBuffer();
+    QCOMPARE(vb.stride, 20u);
+    QCOMPARE(vb.data.size(), qsizetype(3 * 20));
+    QCOMPARE(vb.entries.size(), qsizetype(3));
+    QCOMPARE(vb.entries[0].componentType, QSSGMesh::Mesh::ComponentType::Float32);
+    QCOMPARE(vb.entries[1].componentType, QSSGMesh::Mesh::ComponentType::UnsignedInt8);
+    QCOMPARE(vb.entries[1].componentCount, 4u);
+    QCOMPARE(vb.entries[2].componentType, QSSGMesh::Mesh::ComponentType::Float16);
+
+    for (int i = 0; i < 3; ++i) {
+        const char *v = vb.data.constData() + i * vb.stride;
+        QCOMPARE(*reinterpret_cast<const QVector3D *>(v + vb.entries[0].offset), positions[i]);
+        const quint8 *n = reinterpret_cast<const quint8 *>(v + vb.entries[1].offset);
+        for (int c = 0; c < 3; ++c)
+            QVERIFY(qAbs(float(n[c]) / 255.0f * 2.0f - 1.0f - normals[i][c]) <= 1.0f / 255.0f);
+        const qfloat16 *uv = reinterpret_cast<const qfloat16 *>(v + vb.entries[2].offset);
+        QCOMPARE(float(uv[0]), uvs[i].x());
+        QCOMPARE(float(uv[1]), uvs[i].y());
+    }
+
+    // Back to floats, as the lightmapper wants them
+    QSSGMesh::Mesh dequantized = result;
+    QVERIFY(dequantized.dequantizeVertexData());
+    QVERIFY(!dequantized.dequantizeVertexData());
+    const QSSGMesh::Mesh::VertexBuffer fvb = dequantized.vertexBuffer();
+    QCOMPARE(fvb.stride, 32u);
+    QCOMPARE(fvb.entries[1].componentType, QSSGMesh::Mesh::ComponentType::Float32);
+    QCOMPARE(fvb.entries[1].componentCount, 3u);
+    QCOMPARE(fvb.entries[2].componentType, QSSGMesh::Mesh::ComponentType::Float32);
+    for (int i = 0; i < 3; ++i) {
+        const char *v = fvb.data.constData() + i * fvb.stride;
+        QCOMPARE(*reinterpret_cast<const QVector3D *>(v + fvb.entries[0].offset), positions[i]);
+        const QVector3D n = *reinterpret_cast<const QVector3D *>(v + fvb.entries[1].offset);
+        for (int c = 0; c < 3; ++c)
+            QVERIFY(qAbs(n[c] - normals[i][c]) <= 1.0f / 255.0f);
+        QCOMPARE(*reinterpret_cast<const QVector2D *>(v + fvb.entries[2].offset), uvs[i]);
+    }
+
+    // Lightmap UVs can still be generated from the quantized data
+    QVERIFY(result.createLightmapUVChannel(64));
+    QVERIFY(result.hasLightmapUVChannel());
+}
+
+QTEST_APPLESS_MAIN(mesh)
+
+#include "tst_mesh.moc"
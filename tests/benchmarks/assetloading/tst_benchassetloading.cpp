@@ -0,0 +1,286 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtGui/qimage.h>
+
+#include <ssg/qssgrendercontextcore.h>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercodegenerator_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrhicustommaterialsystem_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendershadercache_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderimage_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderlayer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DUtils/private/qssgmesh_p.h>
+
+#include <memory>
+#include <vector>
+
+// Loads a set of large meshes and images the way a scene coming into view
+// does, once with the file I/O and decoding on the render thread, and once
+// with it on the worker pool. The interesting number is the longest frame.
+class BenchAssetLoading : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void test_status();
+    void bench_worstFrame_data();
+    void bench_worstFrame();
+
+private:
+    static constexpr int MeshCount = 4;
+    static constexpr int ImageCount = 4;
+    static constexpr int GridSize = 512;
+    static constexpr int ImageSize = 2048;
+    // The rest of the frame at 60 Hz is spent waiting
+    static constexpr qint64 FrameInterval = 16 * 1000 * 1000;
+
+    struct FrameTimes
+    {
+        qint64 worstFrame = 0;
+        qint64 total = 0;
+        int frames = 0;
+    };
+
+    static void writeMesh(const QString &path, int gridSize);
+    static void writeImage(const QString &path, int size, quint32 seed);
+    FrameTimes loadAll(bool asynchronous);
+    QSSGBufferManager &bufferManager() const { return *m_renderContext->bufferManager(); }
+
+    QRhi *m_rhi = nullptr;
+    std::shared_ptr<QSSGRenderContextInterface> m_renderContext;
+    QSSGRenderLayer m_layer;
+    QTemporaryDir m_dir;
+    QStringList m_meshPaths;
+    QStringList m_imagePaths;
+    quint32 m_frameId = 0;
+};
+
+void BenchAssetLoading::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    m_rhi = QRhi::create(QRhi::Null, nullptr);
+    QRhiCommandBuffer *cb;
+    m_rhi->beginOffscreenFrame(&cb);
+
+    std::unique_ptr<QSSGRhiContext> rhiContext = std::make_unique<QSSGRhiContext>(m_rhi);
+    rhiContext->setCommandBuffer(cb);
+
+    m_renderContext = std::make_shared<QSSGRenderContextInterface>(std::make_unique<QSSGBufferManager>(),
+                                                                   std::make_unique<QSSGRenderer>(),
+                                                                   std::make_shared<QSSGShaderLibraryManager>(),
+                                                                   std::make_unique<QSSGShaderCache>(*rhiContext),
+                                                                   std::make_unique<QSSGCustomMaterialSystem>(),
+                                                                   std::make_unique<QSSGProgramGenerator>(),
+                                                                   std::move(rhiContext));
+
+    for (int i = 0; i < MeshCount; ++i) {
+        m_meshPaths.append(m_dir.filePath(QStringLiteral("grid%1.mesh").arg(i)));
+        writeMesh(m_meshPaths.last(), GridSize + i);
+    }
+    for (int i = 0; i < ImageCount; ++i) {
+        m_imagePaths.append(m_dir.filePath(QStringLiteral("noise%1.png").arg(i)));
+        writeImage(m_imagePaths.last(), ImageSize, quint32(i + 1));
+    }
+}
+
+void BenchAssetLoading::cleanupTestCase()
+{
+    m_renderContext.reset();
+    m_rhi->endOffscreenFrame();
+    delete m_rhi;
+}
+
+// A flat grid with positions, normals and texture coordinates
+void BenchAssetLoading::writeMesh(const QString &path, int gridSize)
+{
+    struct Vertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
+    QSSGMesh::RuntimeMeshData data;
+    data.m_vertexBuffer.resize(qsizetype(gridSize) * gridSize * sizeof(Vertex));
+    auto *vertex = reinterpret_cast<Vertex *>(data.m_vertexBuffer.data());
+    for (int y = 0; y < gridSize; ++y) {
+        for (int x = 0; x < gridSize; ++x) {
+            const float u = float(x) / float(gridSize - 1);
+            const float v = float(y) / float(gridSize - 1);
+            *vertex++ = { { u - 0.5f, v - 0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { u, v } };
+        }
+    }
+
+    const int quadCount = (gridSize - 1) * (gridSize - 1);
+    data.m_indexBuffer.resize(qsizetype(quadCount) * 6 * sizeof(quint32));
+    auto *index = reinterpret_cast<quint32 *>(data.m_indexBuffer.data());
+    for (int y = 0; y < gridSize - 1; ++y) {
+        for (int x = 0; x < gridSize - 1; ++x) {
+            const quint32 i = quint32(y * gridSize + x);
+            const quint32 quad[] = { i, i + 1, i + gridSize, i + 1, i + gridSize + 1, i + gridSize };
+            index = std::copy(std::begin(quad), std::end(quad), index);
+        }
+    }
+
+    using Attribute = QSSGMesh::RuntimeMeshData::Attribute;
+    data.m_attributes[0] = { Attribute::PositionSemantic, QSSGMesh::Mesh::ComponentType::Float32, 0 };
+    data.m_attributes[1] = { Attribute::NormalSemantic, QSSGMesh::Mesh::ComponentType::Float32, 3 * sizeof(float) };
+    data.m_attributes[2] = { Attribute::TexCoord0Semantic, QSSGMesh::Mesh::ComponentType::Float32, 6 * sizeof(float) };
+    data.m_attributes[3] = { Attribute::IndexSemantic, QSSGMesh::Mesh::ComponentType::UnsignedInt32, 0 };
+    data.m_attributeCount = 4;
+    data.m_stride = sizeof(Vertex);
+
+    QSSGMesh::Mesh::Subset subset;
+    subset.bounds = { QVector3D(-0.5f, -0.5f, 0.0f), QVector3D(0.5f, 0.5f, 0.0f) };
+    subset.count = quint32(quadCount * 6);
+    data.m_subsets.append(subset);
+
+    QString error;
+    const QSSGMesh::Mesh mesh = QSSGMesh::Mesh::fromRuntimeData(data, &error);
+    QVERIFY2(mesh.isValid(), qPrintable(error));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(mesh.save(&file) != 0);
+}
+
+// Noise does not compress, decoding it is close to the worst case
+void BenchAssetLoading::writeImage(const QString &path, int size, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QImage image(size, size, QImage::Format_RGBA8888);
+    for (int y = 0; y < size; ++y)
+        random.fillRange(reinterpret_cast<quint32 *>(image.scanLine(y)), size);
+    QVERIFY(image.save(path));
+}
+
+BenchAssetLoading::FrameTimes BenchAssetLoading::loadAll(bool asynchronous)
+{
+    QSSGBufferManager &manager = bufferManager();
+    manager.releaseCachedResources();
+
+    std::vector<std::unique_ptr<QSSGRenderModel>> models;
+    for (const QString &path : std::as_const(m_meshPaths)) {
+        models.push_back(std::make_unique<QSSGRenderModel>());
+        models.back()->meshPath = QSSGRenderPath(path);
+        models.back()->asynchronous = asynchronous;
+    }
+    std::vector<std::unique_ptr<QSSGRenderImage>> images;
+    for (const QString &path : std::as_const(m_imagePaths)) {
+        images.push_back(std::make_unique<QSSGRenderImage>());
+        images.back()->m_imagePath = QSSGRenderPath(path);
+        images.back()->m_asynchronous = asynchronous;
+    }
+
+    FrameTimes times;
+    QElapsedTimer total;
+    total.start();
+    const size_t assetCount = models.size() + images.size();
+    size_t ready = 0;
+    while (ready < assetCount && times.frames < 1000) {
+        QElapsedTimer frame;
+        frame.start();
+
+        ++m_frameId;
+        manager.resetUsageCounters(m_frameId, &m_layer);
+        ready = 0;
+        for (const auto &model : models)
+            ready += manager.loadMesh(model.get()) ? 1 : 0;
+        for (const auto &image : images)
+            ready += manager.loadRenderImage(image.get()).m_texture ? 1 : 0;
+        manager.commitBufferResourceUpdates();
+        manager.cleanupUnreferencedBuffers(m_frameId, &m_layer);
+
+        const qint64 elapsed = frame.nsecsElapsed();
+        times.worstFrame = qMax(times.worstFrame, elapsed);
+        ++times.frames;
+        if (elapsed < FrameInterval)
+            QThread::usleep(quint64((FrameInterval - elapsed) / 1000));
+    }
+    times.total = total.nsecsElapsed();
+
+    if (ready < assetCount)
+        qWarning("Only %d out of %d assets were loaded", int(ready), int(assetCount));
+    return times;
+}
+
+void BenchAssetLoading::test_status()
+{
+    QSSGBufferManager &manager = bufferManager();
+    manager.releaseCachedResources();
+
+    QSSGRenderModel model;
+    QCOMPARE(manager.loadStatus(&model), QSSGBufferManager::LoadStatus::Null);
+    model.meshPath = QSSGRenderPath(m_meshPaths.first());
+    model.asynchronous = true;
+    QCOMPARE(manager.loadStatus(&model), QSSGBufferManager::LoadStatus::Null);
+
+    QSSGRenderModel missing;
+    missing.meshPath = QSSGRenderPath(m_dir.filePath(QStringLiteral("missing.mesh")));
+    missing.asynchronous = true;
+
+    QSSGRenderImage image;
+    image.m_imagePath = QSSGRenderPath(m_imagePaths.first());
+    image.m_asynchronous = true;
+
+    // Nothing is there on the first request
+    QVERIFY(!manager.loadMesh(&model));
+    QVERIFY(!manager.loadMesh(&missing));
+    QVERIFY(!manager.loadRenderImage(&image).m_texture);
+    QVERIFY(manager.hasPendingLoads());
+    QVERIFY(manager.takeLoadStatusChanged());
+    QCOMPARE(manager.loadStatus(&image), QSSGBufferManager::LoadStatus::Loading);
+
+    QTRY_VERIFY_WITH_TIMEOUT(manager.loadMesh(&model) != nullptr, 10000);
+    QTRY_VERIFY_WITH_TIMEOUT(manager.loadRenderImage(&image).m_texture != nullptr, 10000);
+    const auto missingStatus = [&]() {
+        manager.loadMesh(&missing);
+        return manager.loadStatus(&missing);
+    };
+    QTRY_COMPARE_WITH_TIMEOUT(missingStatus(), QSSGBufferManager::LoadStatus::Error, 10000);
+    QVERIFY(!manager.hasPendingLoads());
+    QVERIFY(manager.takeLoadStatusChanged());
+    QVERIFY(!manager.takeLoadStatusChanged());
+
+    QCOMPARE(manager.loadStatus(&model), QSSGBufferManager::LoadStatus::Ready);
+    QCOMPARE(manager.loadStatus(&image), QSSGBufferManager::LoadStatus::Ready);
+    QVERIFY(!manager.getModelBounds(&model).isEmpty());
+
+    // A failed file is not retried asynchronously
+    QVERIFY(!manager.loadMesh(&missing));
+    QVERIFY(!manager.hasPendingLoads());
+
+    manager.releaseCachedResources();
+}
+
+void BenchAssetLoading::bench_worstFrame_data()
+{
+    QTest::addColumn<bool>("asynchronous");
+    QTest::newRow("synchronous") << false;
+    QTest::newRow("asynchronous") << true;
+}
+
+void BenchAssetLoading::bench_worstFrame()
+{
+    QFETCH(bool, asynchronous);
+
+    const FrameTimes times = loadAll(asynchronous);
+    qInfo("%d meshes and %d images loaded %s in %d frames, %.1f ms in total, worst frame %.1f ms",
+          MeshCount, ImageCount, asynchronous ? "asynchronously" : "synchronously", times.frames,
+          double(times.total) / 1e6, double(times.worstFrame) / 1e6);
+
+    QTest::setBenchmarkResult(double(times.worstFrame) / 1e6, QTest::WalltimeMilliseconds);
+}
+
+QTEST_GUILESS_MAIN(BenchAssetLoading)
+
+#include "tst_benchassetloading.moc"
@@ -9,6 +9,9 @@
 #include <QtQuick3DUtils/private/qssgbounds3_p.h>
 #include <QtQuick3DUtils/private/qssgutils_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderclippingfrustum_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermodel_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgscenebvh_p.h>
 
 class BenchFrustumCulling : public QObject
 {
@@ -22,8 +25,14 @@ private slots:
     void initTestCase();
     void cleanupTestCase();
     void test_frustumCulling();
+    void bench_outputlist_data();
     void bench_outputlist();
+    void bench_inline_data();
     void bench_inline();
+    void bench_boundslist_data();
+    void bench_boundslist();
+    void bench_scenebvh_data();
+    void bench_scenebvh();
 
 private:
     struct ObjectData
@@ -53,6 +62,16 @@ private:
         }
     }
 
+    static void addObjectCountRows()
+    {
+        QTest::addColumn<quint32>("objectCount");
+        QTest::newRow("10k") << quint32(10000);
+        QTest::newRow("100k") << quint32(100000);
+        QTest::newRow("1M") << quint32(1000000);
+    }
+
+    QList<ObjectData> createObjects(quint32 objectCount, quint32 nonCulledItemCount) const;
+
     QQuick3DPerspectiveCamera camera;
     QScopedPointer<QSSGRenderCamera> cameraNode;
     QSSGClippingFrustum clipFrustum;
@@ -108,7 +127,7 @@ void BenchFrustumCulling::test_frustumCulling()
 
 }
 
-void BenchFrustumCulling::bench_outputlist()
+QList<BenchFrustumCulling::ObjectData> BenchFrustumCulling::createObjects(quint32 objectCount, quint32 nonCulledItemCount) const
 {
     // bounds 10x10x10 all in world coordinates
     constexpr float widthAndHeight = 10.0f;
@@ -118,9 +137,6 @@ void BenchFrustumCulling::bench_outputlist()
     const float frustumNearBorder = camera.position().z() - camera.clipNear() + widthAndHeight;
     const float frustumFarBorder = camera.position().z() - camera.clipFar() - widthAndHeight;
 
-    const quint32 objectCount = 10000;
-    const quint32 nonCulledItemCount = 3;
-
     QSet<quint32> replaceIndexes;
     while (replaceIndexes.size() < nonCulledItemCount)
         replaceIndexes.insert(QRandomGenerator::global()->bounded(objectCount));
@@ -140,6 +156,20 @@ void BenchFrustumCulling::bench_outputlist()
     for (auto v : std::as_const(replaceIndexes))
         objects.replace(v, createRenderableData({0.0f, 0.0f, 0.0f}, QQuaternion::fromEulerAngles({}), bounds));
 
+    return objects;
+}
+
+void BenchFrustumCulling::bench_outputlist_data()
+{
+    addObjectCountRows();
+}
+
+void BenchFrustumCulling::bench_outputlist()
+{
+    QFETCH(quint32, objectCount);
+    const quint32 nonCulledItemCount = 3;
+
+    const QList<ObjectData> objects = createObjects(objectCount, nonCulledItemCount);
     QCOMPARE(objects.size(), objectCount);
 
     QList<QSSGRenderableObject> renderableObjects;
@@ -167,38 +197,17 @@ void BenchFrustumCulling::bench_outputlist()
     QCOMPARE(culledrenderables.size(), nonCulledItemCount);
 }
 
-void BenchFrustumCulling::bench_inline()
+void BenchFrustumCulling::bench_inline_data()
 {
-    // bounds 10x10x10 all in world coordinates
-    constexpr float widthAndHeight = 10.0f;
-    constexpr QSSGBounds3 bounds { { -widthAndHeight / 2.0f, -widthAndHeight / 2.0f, -widthAndHeight / 2.0f }, { widthAndHeight / 2.0f, widthAndHeight / 2.0f, widthAndHeight / 2.0f } };
-
-    // For simplicity we only do put "cullable" object in front or behind the frustum for now.
-    const float frustumNearBorder = camera.position().z() - camera.clipNear() + widthAndHeight;
-    const float frustumFarBorder = camera.position().z() - camera.clipFar() - widthAndHeight;
+    addObjectCountRows();
+}
 
-    const quint32 objectCount = 10000;
+void BenchFrustumCulling::bench_inline()
+{
+    QFETCH(quint32, objectCount);
     const quint32 nonCulledItemCount = 3;
 
-    QSet<quint32> replaceIndexes;
-    while (replaceIndexes.size() < nonCulledItemCount)
-        replaceIndexes.insert(QRandomGenerator::global()->bounded(objectCount));
-
-    QList<ObjectData> objects;
-    objects.reserve(objectCount);
-
-    // Fill the list with object data that should be culled
-    for (quint32 i = 0, end = objectCount; i != end; ++i) {
-        if (i % 2)
-            objects.push_back(createRenderableData({0.0f, 0.0f, frustumNearBorder }, QQuaternion::fromEulerAngles({}), bounds));
-        else
-            objects.push_back(createRenderableData({0.0f, 0.0f, frustumFarBorder }, QQuaternion::fromEulerAngles({}), bounds));
-    }
-
-    // Insert items at random positions in the list that should not be culled
-    for (auto v : std::as_const(replaceIndexes))
-        objects.replace(v, createRenderableData({0.0f, 0.0f, 0.0f}, QQuaternion::fromEulerAngles({}), bounds));
-
+    const QList<ObjectData> objects = createObjects(objectCount, nonCulledItemCount);
     QCOMPARE(objects.size(), objectCount);
 
     QList<QSSGRenderableObject> renderableObjects;
@@ -224,6 +233,134 @@ void BenchFrustumCulling::bench_inline()
     QCOMPARE(ret, nonCulledItemCount);
 }
 
+void BenchFrustumCulling::bench_boundslist_data()
+{
+    addObjectCountRows();
+}
+
+void BenchFrustumCulling::bench_boundslist()
+{
+    QFETCH(quint32, objectCount);
+    const quint32 nonCulledItemCount = 3;
+
+    const QList<ObjectData> objects = createObjects(objectCount, nonCulledItemCount);
+    QCOMPARE(objects.size(), objectCount);
+
+    // The bounds are already in a structure of arrays, so this is only the
+    // cost of the plane tests.
+    QSSGBoundsList boundsList;
+    boundsList.reserve(objects.size());
+    for (const auto &od : objects) {
+        QSSGBounds3 globalBounds = od.bounds;
+        globalBounds.transform(od.globalTransform);
+        boundsList.append(globalBounds);
+    }
+
+    QVector<quint32> visibleIndices(boundsList.size());
+
+    QVERIFY(!cameraNode->isDirty(QSSGRenderCamera::DirtyFlag::CameraDirty));
+
+    qsizetype ret;
+    QBENCHMARK {
+        ret = clipFrustum.intersectsWith(boundsList, visibleIndices.data());
+    }
+
+    QCOMPARE(ret, nonCulledItemCount);
+    for (qsizetype i = 0; i != ret; ++i)
+        QVERIFY(clipFrustum.intersectsWith(QSSGBounds3 { { boundsList.minX[visibleIndices[i]], boundsList.minY[visibleIndices[i]], boundsList.minZ[visibleIndices[i]] },
+                                                         { boundsList.maxX[visibleIndices[i]], boundsList.maxY[visibleIndices[i]], boundsList.maxZ[visibleIndices[i]] } }));
+}
+
+void BenchFrustumCulling::bench_scenebvh_data()
+{
+    QTest::addColumn<quint32>("objectCount");
+    QTest::newRow("10k") << quint32(10000);
+    QTest::newRow("100k") << quint32(100000);
+}
+
+void BenchFrustumCulling::bench_scenebvh()
+{
+    QFETCH(quint32, objectCount);
+    const quint32 nonCulledItemCount = 3;
+
+    const QList<ObjectData> objects = createObjects(objectCount, nonCulledItemCount);
+    QCOMPARE(objects.size(), objectCount);
+
+    // All the objects have the same bounds, so they can share one mesh.
+    QSSGRenderMesh mesh(QSSGRenderDrawMode::Triangles, QSSGRenderWinding::CounterClockwise);
+    QSSGRenderSubset subset;
+    subset.bounds = objects.first().bounds;
+    mesh.subsets.push_back(subset);
+
+    std::vector<QSSGRenderModel> models(objects.size());
+    QVector<QSSGRenderableNodeEntry> renderableModels;
+    renderableModels.reserve(objects.size());
+    for (qsizetype i = 0, end = objects.size(); i != end; ++i) {
+        auto &model = models[i];
+        model.globalTransform = objects.at(i).globalTransform;
+        model.dfsIndex = quint32(i + 1);
+        QSSGRenderableNodeEntry entry(model);
+        entry.mesh = &mesh;
+        renderableModels.push_back(entry);
+    }
+
+    QSSGSceneBVH sceneBVH;
+    sceneBVH.invalidate();
+    sceneBVH.update(renderableModels);
+    QCOMPARE(sceneBVH.primitiveCount(), objectCount);
+
+    // The tree of another view of the same scene
+    QSSGSceneBVH otherSceneBVH;
+    otherSceneBVH.update(renderableModels);
+
+    QVERIFY(!cameraNode->isDirty(QSSGRenderCamera::DirtyFlag::CameraDirty));
+
+    const auto countVisible = [](const QVector<QSSGSceneBVH::Visibility> &visibility) {
+        return std::count_if(visibility.cbegin(), visibility.cend(), [](QSSGSceneBVH::Visibility v) {
+            return v != QSSGSceneBVH::Visibility::Outside;
+        });
+    };
+
+    QVector<QSSGSceneBVH::Visibility> visibility;
+    QBENCHMARK {
+        sceneBVH.cullFrustum(clipFrustum, visibility);
+    }
+
+    QCOMPARE(countVisible(visibility), nonCulledItemCount);
+
+    // Moving one of the culled objects into the frustum only refits its
+    // branch, the tree is not built again and no primitive moves.
+    const auto culledIt = std::find_if(renderableModels.begin(), renderableModels.end(), [&](const QSSGRenderableNodeEntry &entry) {
+        return visibility.at(sceneBVH.primitiveIndex(*entry.node)) == QSSGSceneBVH::Visibility::Outside;
+    });
+    QVERIFY(culledIt != renderableModels.end());
+    auto &movedModel = static_cast<QSSGRenderModel &>(*culledIt->node);
+    movedModel.globalTransform = QSSGRenderNode::calculateTransformMatrix({}, {1.0f, 1.0f, 1.0f}, {}, {});
+    ++movedModel.globalTransformSerial;
+
+    const quint32 buildCount = sceneBVH.buildCount();
+    QVector<qint32> primitiveIndices;
+    primitiveIndices.reserve(renderableModels.size());
+    for (const auto &entry : std::as_const(renderableModels))
+        primitiveIndices.append(sceneBVH.primitiveIndex(*entry.node));
+
+    sceneBVH.update(renderableModels);
+    QCOMPARE(sceneBVH.buildCount(), buildCount);
+    for (qsizetype i = 0, end = renderableModels.size(); i != end; ++i)
+        QCOMPARE(sceneBVH.primitiveIndex(*renderableModels.at(i).node), primitiveIndices.at(i));
+
+    sceneBVH.cullFrustum(clipFrustum, visibility);
+    QCOMPARE(countVisible(visibility), nonCulledItemCount + 1);
+    QVERIFY(visibility.at(sceneBVH.primitiveIndex(movedModel)) != QSSGSceneBVH::Visibility::Outside);
+
+    // The other view's tree sees the move as well
+    const quint32 otherBuildCount = otherSceneBVH.buildCount();
+    otherSceneBVH.update(renderableModels);
+    QCOMPARE(otherSceneBVH.buildCount(), otherBuildCount);
+    otherSceneBVH.cullFrustum(clipFrustum, visibility);
+    QCOMPARE(countVisible(visibility), nonCulledItemCount + 1);
+}
+
 QTEST_APPLESS_MAIN(BenchFrustumCulling)
 
 #include "tst_benchfrustumculling.moc"
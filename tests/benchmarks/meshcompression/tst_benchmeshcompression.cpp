@@ -0,0 +1,142 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DUtils/private/qssgmesh_p.h>
+
+#include <limits>
+
+// Rewrites the meshes used by the baseline tests as they are, compressed,
+// and compressed with quantization, then compares the file sizes and the
+// time it takes to load them. compare() prints the differences to the
+// plain files side by side.
+class BenchMeshCompression : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void bench_load_data();
+    void bench_load();
+    void compare();
+
+private:
+    QStringList variantPaths(const QString &variant) const;
+    static bool loadAll(const QStringList &paths);
+
+    QTemporaryDir m_dir;
+    QStringList m_sources;
+};
+
+void BenchMeshCompression::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    QDirIterator it(QStringLiteral(BASELINE_MODELS_DIR), { QStringLiteral("*.mesh") },
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        m_sources.append(it.next());
+    if (m_sources.isEmpty())
+        QSKIP("No meshes found in " BASELINE_MODELS_DIR);
+    m_sources.sort();
+
+    const std::pair<const char *, QSSGMesh::Mesh::SaveFlags> variants[] = {
+        { "plain", {} },
+        { "compressed", QSSGMesh::Mesh::SaveCompressed },
+        { "quantized", QSSGMesh::Mesh::SaveQuantized }
+    };
+
+    for (qsizetype i = 0; i < m_sources.size(); ++i) {
+        QFile source(m_sources.at(i));
+        QVERIFY(source.open(QIODevice::ReadOnly));
+        const QMap<quint32, QSSGMesh::Mesh> meshes = QSSGMesh::Mesh::loadAll(&source);
+        QVERIFY(!meshes.isEmpty());
+
+        for (const auto &variant : variants) {
+            QFile file(m_dir.filePath(QStringLiteral("%1_%2.mesh").arg(QLatin1String(variant.first)).arg(i)));
+            QVERIFY(file.open(QIODevice::ReadWrite | QIODevice::Truncate));
+            for (auto meshIt = meshes.cbegin(), end = meshes.cend(); meshIt != end; ++meshIt)
+                QCOMPARE(meshIt.value().save(&file, meshIt.key(), variant.second), meshIt.key());
+        }
+    }
+}
+
+void BenchMeshCompression::bench_load_data()
+{
+    QTest::addColumn<QString>("variant");
+    QTest::newRow("plain") << QStringLiteral("plain");
+    QTest::newRow("compressed") << QStringLiteral("compressed");
+    QTest::newRow("quantized") << QStringLiteral("quantized");
+}
+
+QStringList BenchMeshCompression::variantPaths(const QString &variant) const
+{
+    QStringList paths;
+    for (qsizetype i = 0; i < m_sources.size(); ++i)
+        paths.append(m_dir.filePath(QStringLiteral("%1_%2.mesh").arg(variant).arg(i)));
+    return paths;
+}
+
+bool BenchMeshCompression::loadAll(const QStringList &paths)
+{
+    for (const QString &path : paths) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly) || QSSGMesh::Mesh::loadAll(&file).isEmpty())
+            return false;
+    }
+    return true;
+}
+
+void BenchMeshCompression::bench_load()
+{
+    QFETCH(QString, variant);
+
+    const QStringList paths = variantPaths(variant);
+    qint64 totalSize = 0;
+    for (const QString &path : paths)
+        totalSize += QFileInfo(path).size();
+    qInfo("%lld mesh files %s: %lld bytes", qint64(paths.size()), qPrintable(variant), totalSize);
+
+    QBENCHMARK {
+        if (!loadAll(paths))
+            QFAIL("Failed to load mesh");
+    }
+}
+
+void BenchMeshCompression::compare()
+{
+    // The best of a few runs, the first one also warms up the file cache
+    constexpr int runs = 10;
+    const QString variants[] = { QStringLiteral("plain"), QStringLiteral("compressed"), QStringLiteral("quantized") };
+
+    qint64 plainSize = 0;
+    double plainTime = 0.0;
+    for (const QString &variant : variants) {
+        const QStringList paths = variantPaths(variant);
+        qint64 totalSize = 0;
+        for (const QString &path : paths)
+            totalSize += QFileInfo(path).size();
+
+        double bestTime = std::numeric_limits<double>::max();
+        for (int run = 0; run < runs; ++run) {
+            QElapsedTimer timer;
+            timer.start();
+            QVERIFY(loadAll(paths));
+            bestTime = qMin(bestTime, timer.nsecsElapsed() / 1000000.0);
+        }
+
+        if (plainSize == 0) {
+            plainSize = totalSize;
+            plainTime = bestTime;
+        }
+        qInfo("%-10s %10lld bytes (%+6.1f%%) %9.3f ms (%+6.1f%%)",
+              qPrintable(variant),
+              totalSize, 100.0 * (totalSize - plainSize) / qMax<qint64>(plainSize, 1),
+              bestTime, 100.0 * (bestTime - plainTime) / qMax(plainTime, 0.001));
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchMeshCompression)
+
+#include "tst_benchmeshcompression.moc"
@@ -9,6 +9,12 @@
 #include <QtQuick3DRuntimeRender/private/qssgrendergeometry_p.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrendermesh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderray_p.h>
+
+#include <QtCore/qrandom.h>
+
+// #define ENABLE_LARGE_TEST
 
 class Bvh : public QObject
 {
@@ -34,9 +40,15 @@ private Q_SLOTS:
     void bench_bvh_small();
     void bench_bvh_medium();
     void bench_bvh_large();
+    void bench_build_data();
+    void bench_build();
+    void bench_raycast_data();
+    void bench_raycast();
 
 private:
     void prepRenderGeometry(qsizetype width, qsizetype height, QSSGRenderGeometry &renderGeometry);
+    void prepTerrain(qsizetype size, QByteArray &vertexBuffer, QByteArray &indexBuffer);
+    std::unique_ptr<QSSGMeshBVH> buildTerrainBVH(qsizetype size, QSSGMeshBVHBuilder::BuildMode mode, bool parallel);
 };
 
 void Bvh::bench_bvh_small()
@@ -75,7 +87,6 @@ void Bvh::bench_bvh_medium()
 
 void Bvh::bench_bvh_large()
 {
-// #define ENABLE_LARGE_TEST
 #ifndef ENABLE_LARGE_TEST
     QSKIP("The size for the large test is resource intensive and can be platform specific");
 #endif // ENABLE_LARGE_TEST
@@ -94,6 +105,158 @@ void Bvh::bench_bvh_large()
          QVERIFY(bvh != nullptr && bvh->m_nodes.size() > 0);
 }
 
+void Bvh::bench_build_data()
+{
+    QTest::addColumn<qsizetype>("size");
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<bool>("parallel");
+
+    const int average = int(QSSGMeshBVHBuilder::BuildMode::Average);
+    const int sah = int(QSSGMeshBVHBuilder::BuildMode::BinnedSAH);
+
+    // (size - 1) * (size - 1) * 2 triangles
+    QTest::newRow("average, 2M triangles") << qsizetype(1024) << average << false;
+    QTest::newRow("sah, 2M triangles") << qsizetype(1024) << sah << false;
+    QTest::newRow("sah parallel, 2M triangles") << qsizetype(1024) << sah << true;
+#ifdef ENABLE_LARGE_TEST
+    QTest::newRow("average, 8M triangles") << qsizetype(2048) << average << false;
+    QTest::newRow("sah, 8M triangles") << qsizetype(2048) << sah << false;
+    QTest::newRow("sah parallel, 8M triangles") << qsizetype(2048) << sah << true;
+#endif
+}
+
+void Bvh::bench_build()
+{
+    QFETCH(qsizetype, size);
+    QFETCH(int, mode);
+    QFETCH(bool, parallel);
+
+    QByteArray vertexBuffer;
+    QByteArray indexBuffer;
+    prepTerrain(size, vertexBuffer, indexBuffer);
+
+    QSSGMeshBVHBuilder builder(vertexBuffer, sizeof(QVector3D), 0, false, -1, true, indexBuffer, QSSGRenderComponentType::UnsignedInt32);
+    builder.setBuildMode(QSSGMeshBVHBuilder::BuildMode(mode));
+    builder.setParallelBuild(parallel);
+
+    std::unique_ptr<QSSGMeshBVH> bvh;
+    QBENCHMARK {
+        bvh = builder.buildTree();
+    }
+
+    QVERIFY(bvh != nullptr);
+    QCOMPARE(bvh->triangles.size(), (size - 1) * (size - 1) * 2);
+    QCOMPARE(bvh->flatNodes.size(), bvh->m_nodes.size());
+}
+
+void Bvh::bench_raycast_data()
+{
+    QTest::addColumn<qsizetype>("size");
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("average, 2M triangles, 10000 rays") << qsizetype(1024) << int(QSSGMeshBVHBuilder::BuildMode::Average);
+    QTest::newRow("sah, 2M triangles, 10000 rays") << qsizetype(1024) << int(QSSGMeshBVHBuilder::BuildMode::BinnedSAH);
+#ifdef ENABLE_LARGE_TEST
+    QTest::newRow("average, 8M triangles, 10000 rays") << qsizetype(2048) << int(QSSGMeshBVHBuilder::BuildMode::Average);
+    QTest::newRow("sah, 8M triangles, 10000 rays") << qsizetype(2048) << int(QSSGMeshBVHBuilder::BuildMode::BinnedSAH);
+#endif
+}
+
+void Bvh::bench_raycast()
+{
+    QFETCH(qsizetype, size);
+    QFETCH(int, mode);
+
+    QSSGRenderMesh mesh(QSSGRenderDrawMode::Triangles, QSSGRenderWinding::CounterClockwise);
+    mesh.bvh = buildTerrainBVH(size, QSSGMeshBVHBuilder::BuildMode(mode), true);
+    QVERIFY(mesh.bvh != nullptr && !mesh.bvh->roots.isEmpty());
+    const auto *root = static_cast<const QSSGMeshBVHNode *>(mesh.bvh->roots.first());
+
+    // Rays pointing (mostly) down at the terrain
+    QRandomGenerator random(1234);
+    QVector<QSSGRenderRay> rays;
+    rays.reserve(10000);
+    for (int i = 0; i < 10000; ++i) {
+        const QVector3D origin(float(random.bounded(double(size))), float(random.bounded(double(size))), 100.0f);
+        const QVector3D direction(float(random.bounded(0.2) - 0.1), float(random.bounded(0.2) - 0.1), -1.0f);
+        rays.append(QSSGRenderRay(origin, direction.normalized()));
+    }
+
+    const QMatrix4x4 globalTransform;
+    QVector<QSSGRenderRay::IntersectionResult> results;
+
+    // The tree must find the same hits as testing every triangle
+    for (int i = 0; i < 16; ++i) {
+        const auto rayData = QSSGRenderRay::createRayData(globalTransform, rays.at(i));
+        results.clear();
+        QSSGRenderRay::intersectWithBVH(rayData, root, &mesh, results);
+        const auto expected = QSSGRenderRay::intersectWithBVHTriangles(rayData, mesh.bvh->triangles, 0, int(mesh.bvh->triangles.size()));
+        QCOMPARE(results.size(), expected.size());
+    }
+
+    qsizetype hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (const QSSGRenderRay &ray : std::as_const(rays)) {
+            const auto rayData = QSSGRenderRay::createRayData(globalTransform, ray);
+            results.clear();
+            QSSGRenderRay::intersectWithBVH(rayData, root, &mesh, results);
+            hits += results.size();
+        }
+    }
+
+    QVERIFY(hits > 0);
+}
+
+std::unique_ptr<QSSGMeshBVH> Bvh::buildTerrainBVH(qsizetype size, QSSGMeshBVHBuilder::BuildMode mode, bool parallel)
+{
+    QByteArray vertexBuffer;
+    QByteArray indexBuffer;
+    prepTerrain(size, vertexBuffer, indexBuffer);
+
+    QSSGMeshBVHBuilder builder(vertexBuffer, sizeof(QVector3D), 0, false, -1, true, indexBuffer, QSSGRenderComponentType::UnsignedInt32);
+    builder.setBuildMode(mode);
+    builder.setParallelBuild(parallel);
+    return builder.buildTree();
+}
+
+// A size x size grid facing +Z with noisy heights. The columns get denser
+// towards x = 0 so the triangles are not uniformly distributed.
+void Bvh::prepTerrain(qsizetype size, QByteArray &vertexBuffer, QByteArray &indexBuffer)
+{
+    QRandomGenerator random(42);
+
+    vertexBuffer.resize(size * size * sizeof(QVector3D));
+    auto *vertices = reinterpret_cast<QVector3D *>(vertexBuffer.data());
+    for (qsizetype h = 0; h != size; ++h) {
+        for (qsizetype w = 0; w != size; ++w) {
+            const float u = float(w) / float(size - 1);
+            const float x = u * u * float(size);
+            const float y = float(h);
+            const float z = 8.0f * std::sin(x * 0.05f) * std::cos(y * 0.07f) + float(random.bounded(1.0));
+            vertices[h * size + w] = QVector3D(x, y, z);
+        }
+    }
+
+    const qsizetype quads = (size - 1) * (size - 1);
+    indexBuffer.resize(quads * 6 * sizeof(quint32));
+    auto *indices = reinterpret_cast<quint32 *>(indexBuffer.data());
+    for (qsizetype h = 0; h != size - 1; ++h) {
+        for (qsizetype w = 0; w != size - 1; ++w) {
+            const quint32 i00 = quint32(h * size + w);
+            const quint32 i10 = i00 + 1;
+            const quint32 i01 = i00 + quint32(size);
+            const quint32 i11 = i01 + 1;
+            *indices++ = i00;
+            *indices++ = i10;
+            *indices++ = i11;
+            *indices++ = i00;
+            *indices++ = i11;
+            *indices++ = i01;
+        }
+    }
+}
+
 void Bvh::prepRenderGeometry(qsizetype width, qsizetype height, QSSGRenderGeometry &renderGeometry)
 {
     const qsizetype entries = width * height;
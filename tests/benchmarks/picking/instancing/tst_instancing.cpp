@@ -0,0 +1,155 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR BSD-3-Clause
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssginstancebvh_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderinstancetable_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderray_p.h>
+
+#include <QtCore/qrandom.h>
+
+class instancing : public QObject
+{
+    Q_OBJECT
+
+public:
+    instancing() = default;
+    ~instancing() = default;
+
+private slots:
+    void bench_pick_data();
+    void bench_pick();
+    void bench_update_data();
+    void bench_update();
+
+private:
+    static QByteArray prepForest(int count, quint32 seed);
+};
+
+// A unit cube, like the #Cube primitive scaled down to 1
+static const QSSGBounds3 meshBounds{ QVector3D{ -0.5f, -0.5f, -0.5f }, QVector3D{ 0.5f, 0.5f, 0.5f } };
+
+// Trees of random size and rotation on a square, with roughly one tree per unit
+QByteArray instancing::prepForest(int count, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    const float side = std::sqrt(float(count));
+
+    QByteArray data;
+    data.resize(count * sizeof(QSSGRenderInstanceTableEntry));
+    auto *entries = reinterpret_cast<QSSGRenderInstanceTableEntry *>(data.data());
+    for (int i = 0; i < count; ++i) {
+        QMatrix4x4 transform;
+        transform.translate(float(random.bounded(double(side))), 0.0f, float(random.bounded(double(side))));
+        transform.rotate(float(random.bounded(360.0)), 0.0f, 1.0f, 0.0f);
+        const float scale = 0.2f + float(random.bounded(0.3));
+        transform.scale(scale, 2.0f * scale, scale);
+        entries[i] = { transform.row(0), transform.row(1), transform.row(2), QVector4D(1.0f, 1.0f, 1.0f, 1.0f), QVector4D() };
+    }
+    return data;
+}
+
+void instancing::bench_pick_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("useBVH");
+
+    for (int count : { 1000, 100000, 500000 }) {
+        QTest::addRow("per instance, %d instances", count) << count << false;
+        QTest::addRow("instance bvh, %d instances", count) << count << true;
+    }
+}
+
+// Finds the candidate instances for a ray crossing the forest, either the
+// way picking did before the instance BVH or with the BVH
+void instancing::bench_pick()
+{
+    QFETCH(int, count);
+    QFETCH(bool, useBVH);
+
+    QSSGRenderInstanceTable table;
+    table.setData(prepForest(count, 42), count, sizeof(QSSGRenderInstanceTableEntry));
+
+    const QMatrix4x4 globalInstanceTransform;
+    const QMatrix4x4 localInstanceTransform;
+    const float side = std::sqrt(float(count));
+    const QSSGRenderRay ray(QVector3D(-1.0f, 0.1f, 0.37f * side), QVector3D(1.0f, 0.0f, 0.1f).normalized());
+
+    const auto perInstance = [&](QVector<qint32> &result) {
+        for (int i = 0; i < count; ++i) {
+            const QMatrix4x4 modelTransform = globalInstanceTransform * table.getTransform(i) * localInstanceTransform;
+            const auto rayData = QSSGRenderRay::createRayData(modelTransform, ray);
+            if (QSSGRenderRay::intersectWithAABBv2(rayData, meshBounds).intersects())
+                result.append(i);
+        }
+    };
+
+    QSSGInstanceBVH bvh;
+    bvh.update(table, localInstanceTransform, meshBounds);
+    QCOMPARE(bvh.instanceCount(), qsizetype(count));
+    const auto instanceRayData = QSSGRenderRay::createRayData(globalInstanceTransform, ray);
+
+    // The tree is conservative, every instance hit must be a candidate
+    QVector<qint32> expected;
+    perInstance(expected);
+    QVector<qint32> candidates;
+    bvh.intersectRay(instanceRayData, candidates);
+    QVERIFY(!expected.isEmpty());
+    for (qint32 instance : std::as_const(expected))
+        QVERIFY(std::binary_search(candidates.cbegin(), candidates.cend(), instance));
+
+    QVector<qint32> result;
+    if (useBVH) {
+        QBENCHMARK {
+            result.clear();
+            bvh.intersectRay(instanceRayData, result);
+        }
+    } else {
+        QBENCHMARK {
+            result.clear();
+            perInstance(result);
+        }
+    }
+    QVERIFY(!result.isEmpty());
+}
+
+void instancing::bench_update_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("refit");
+
+    for (int count : { 1000, 100000, 500000 }) {
+        QTest::addRow("build, %d instances", count) << count << false;
+        QTest::addRow("refit, %d instances", count) << count << true;
+    }
+}
+
+// Cost of bringing the tree up to date after the instance table changed
+void instancing::bench_update()
+{
+    QFETCH(int, count);
+    QFETCH(bool, refit);
+
+    // The same count refits, a different count rebuilds
+    const int counts[2] = { count, refit ? count : count + 1 };
+    const QByteArray data[2] = { prepForest(counts[0], 42), prepForest(counts[1], 43) };
+
+    QSSGRenderInstanceTable table;
+    table.setData(data[0], counts[0], sizeof(QSSGRenderInstanceTableEntry));
+    const QMatrix4x4 localInstanceTransform;
+    QSSGInstanceBVH bvh;
+    bvh.update(table, localInstanceTransform, meshBounds);
+
+    int current = 0;
+    QBENCHMARK {
+        current = 1 - current;
+        table.setData(data[current], counts[current], sizeof(QSSGRenderInstanceTableEntry));
+        bvh.update(table, localInstanceTransform, meshBounds);
+    }
+    QVERIFY(bvh.instanceCount() > 0);
+}
+
+QTEST_APPLESS_MAIN(instancing)
+
+#include "tst_instancing.moc"
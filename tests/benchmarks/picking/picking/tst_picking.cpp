@@ -29,6 +29,8 @@ private Q_SLOTS:
     void bench_picking1Miss();
     void bench_picking1in1k();
     void bench_picking1in1kMiss();
+    void bench_pickingRays_data();
+    void bench_pickingRays();
 
 private:
     std::unique_ptr<QSSGRenderContextInterface> renderCtx;
@@ -117,6 +119,53 @@ void picking::benchImpl(int count, bool hit)
     QVERIFY(res.m_hitObject != nullptr);
 }
 
+void picking::bench_pickingRays_data()
+{
+    QTest::addColumn<bool>("batch");
+
+    QTest::addRow("syncPick") << false;
+    QTest::addRow("syncPickBatch") << true;
+}
+
+// 1000 rays against 100 models, one at a time or as one batch
+void picking::bench_pickingRays()
+{
+    QFETCH(bool, batch);
+
+    const auto &bufferManager = renderCtx->bufferManager();
+    QSSGRenderLayer dummyLayer;
+
+    QSSGRenderModel models[100];
+    const auto cubeMeshPath = QSSGRenderPath(QStringLiteral("#Cube"));
+    for (int i = 0; i != 100; ++i) {
+        auto &model = models[i];
+        model.meshPath = cubeMeshPath;
+        model.setState(QSSGRenderModel::LocalState::Pickable);
+        model.localTransform.translate(QVector3D(200.0f * (i % 10), 200.0f * (i / 10), 0.0f));
+        model.markDirty(QSSGRenderNode::DirtyFlag::TransformDirty);
+        model.calculateGlobalVariables();
+        dummyLayer.addChild(model);
+    }
+    bufferManager->loadMesh(models);
+
+    QVector<QSSGRenderRay> rays;
+    for (int i = 0; i != 1000; ++i)
+        rays.append(QSSGRenderRay{ { 2.0f * i, 1.8f * i, -100.0f }, { 0.0f, 0.0f, 1.0f } });
+
+    QVector<QSSGRenderPickResult> results(rays.size());
+    if (batch) {
+        QBENCHMARK {
+            results = QSSGRendererPrivate::syncPickBatch(*renderCtx, dummyLayer, rays);
+        }
+    } else {
+        QBENCHMARK {
+            for (qsizetype i = 0; i != rays.size(); ++i)
+                results[i] = QSSGRendererPrivate::syncPick(*renderCtx, dummyLayer, rays.at(i));
+        }
+    }
+    QVERIFY(std::any_of(results.cbegin(), results.cend(), [](const QSSGRenderPickResult &res) { return res.m_hitObject != nullptr; }));
+}
+
 QTEST_APPLESS_MAIN(picking)
 
 #include "tst_picking.moc"
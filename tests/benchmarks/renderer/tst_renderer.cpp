@@ -8,6 +8,7 @@
 #include <ssg/qssgrendercontextcore.h>
 
 #include <QtQuick3DRuntimeRender/private/qssgrenderer_p.h>
+#include <QtQuick3DRuntimeRender/private/qssglayerrenderdata_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendercamera_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrendernode_p.h>
 #include <QtQuick3DRuntimeRender/private/qssgrenderbuffermanager_p.h>
@@ -28,6 +29,14 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void bench_prep();
+    void bench_prep_parallel_data();
+    void bench_prep_parallel();
+    void bench_prep_batching_data();
+    void bench_prep_batching();
+    void bench_shader_precompile_data();
+    void bench_shader_precompile();
+    void bench_shader_key_data();
+    void bench_shader_key();
 
 private:
     QRhi *rhi = nullptr;
@@ -39,6 +48,13 @@ private:
     int modelCount = 0;
     QSSGRenderCamera camera{ QSSGRenderCamera::Type::OrthographicCamera };
     QSSGRenderLayer layer;
+    // Same grid of models, all sharing one material
+    QSSGRenderCamera sharedMaterialCamera{ QSSGRenderCamera::Type::OrthographicCamera };
+    QSSGRenderLayer sharedMaterialLayer;
+    // A few models, each with a material that needs its own shaders
+    QSSGRenderCamera shaderVariantCamera{ QSSGRenderCamera::Type::OrthographicCamera };
+    QSSGRenderLayer shaderVariantLayer;
+    int shaderVariantCount = 0;
 };
 
 tst_renderer::tst_renderer()
@@ -83,6 +99,11 @@ void tst_renderer::initTestCase()
     const float offset = -spacing * float(n) * 0.5f;
 
     layer.explicitCamera = &camera;
+    sharedMaterialLayer.explicitCamera = &sharedMaterialCamera;
+
+    QSSGRenderDefaultMaterial *sharedMaterial = new QSSGRenderDefaultMaterial;
+    sharedMaterial->color = QVector4D(1.0f, 0.0f, 0.0f, 1.0f);
+    sharedMaterial->lighting = QSSGRenderDefaultMaterial::MaterialLighting::NoLighting;
 
     const auto &renderer = renderContext->renderer();
     const auto viewport = QRect(QPoint(), QSize(800,600));
@@ -107,9 +128,35 @@ void tst_renderer::initTestCase()
 
                 model->materials.push_back(mat);
                 layer.addChild(*model);
+
+                QSSGRenderModel *sharedMaterialModel = new QSSGRenderModel;
+                sharedMaterialModel->meshPath = model->meshPath;
+                sharedMaterialModel->localTransform = model->localTransform;
+                sharedMaterialModel->materials.push_back(sharedMaterial);
+                sharedMaterialLayer.addChild(*sharedMaterialModel);
             }
         }
     }
+
+    // Every combination of a few material features that are part of the
+    // material key
+    shaderVariantLayer.explicitCamera = &shaderVariantCamera;
+    shaderVariantCount = 16;
+    for (int i = 0; i != shaderVariantCount; ++i) {
+        QSSGRenderModel *model = new QSSGRenderModel;
+        model->meshPath = QSSGRenderPath("#Cube");
+        model->localTransform.translate(QVector3D(float(i - shaderVariantCount / 2) * 40.0f, 0.0f, -100.0f));
+
+        QSSGRenderDefaultMaterial *mat = new QSSGRenderDefaultMaterial(QSSGRenderGraphObject::Type::PrincipledMaterial);
+        mat->lighting = (i & 1) ? QSSGRenderDefaultMaterial::MaterialLighting::FragmentLighting
+                                : QSSGRenderDefaultMaterial::MaterialLighting::NoLighting;
+        mat->fresnelPower = (i & 2) ? 5.0f : 0.0f;
+        mat->vertexColorsEnabled = (i & 4);
+        mat->clearcoatAmount = (i & 8) ? 1.0f : 0.0f;
+
+        model->materials.push_back(mat);
+        shaderVariantLayer.addChild(*model);
+    }
 }
 
 void tst_renderer::bench_prep()
@@ -123,6 +170,170 @@ void tst_renderer::bench_prep()
     }
 }
 
+void tst_renderer::bench_prep_parallel_data()
+{
+    QTest::addColumn<int>("jobs");
+
+    const int idealThreadCount = QThread::idealThreadCount();
+    for (int jobs = 1; jobs < idealThreadCount; jobs *= 2)
+        QTest::addRow("jobs=%d", jobs) << jobs;
+    QTest::addRow("jobs=%d", idealThreadCount) << idealThreadCount;
+}
+
+void tst_renderer::bench_prep_parallel()
+{
+    QFETCH(int, jobs);
+
+    QVERIFY(!layer.children.isEmpty());
+    const auto &renderer = renderContext->renderer();
+    if (!layer.renderData) {
+        renderer->beginFrame(layer);
+        renderer->prepareLayerForRender(layer);
+        renderer->endFrame(layer);
+    }
+    QVERIFY(layer.renderData);
+    layer.renderData->maxPrepareJobs = jobs;
+
+    QBENCHMARK {
+        renderer->beginFrame(layer);
+        renderer->prepareLayerForRender(layer);
+        renderer->endFrame(layer);
+    }
+}
+
+void tst_renderer::bench_prep_batching_data()
+{
+    QTest::addColumn<bool>("batching");
+    QTest::newRow("individual") << false;
+    QTest::newRow("batched") << true;
+}
+
+void tst_renderer::bench_prep_batching()
+{
+    QFETCH(bool, batching);
+
+    QVERIFY(!sharedMaterialLayer.children.isEmpty());
+    const auto &renderer = renderContext->renderer();
+    if (!sharedMaterialLayer.renderData) {
+        renderer->beginFrame(sharedMaterialLayer);
+        renderer->prepareLayerForRender(sharedMaterialLayer);
+        renderer->endFrame(sharedMaterialLayer);
+    }
+    QSSGLayerRenderData *renderData = sharedMaterialLayer.renderData;
+    QVERIFY(renderData);
+    renderData->renderableBatchingEnabled = batching;
+
+    // Preparing the draw calls is what scales with the number of them, so
+    // the prepare step alone mostly shows the cost of the batching itself.
+    qsizetype drawCount = 0;
+    QBENCHMARK {
+        renderer->beginFrame(sharedMaterialLayer);
+        renderer->prepareLayerForRender(sharedMaterialLayer);
+        drawCount = renderData->getSortedOpaqueRenderableObjects().size();
+        renderer->endFrame(sharedMaterialLayer);
+    }
+
+    qInfo("%d models in %d draw calls", modelCount, int(drawCount));
+    if (batching)
+        QCOMPARE(drawCount, qsizetype(1));
+    else
+        QVERIFY(drawCount > 1);
+}
+
+void tst_renderer::bench_shader_precompile_data()
+{
+    QTest::addColumn<int>("threads");
+
+    const int idealThreadCount = QThread::idealThreadCount();
+    for (int threads = 1; threads < idealThreadCount; threads *= 2)
+        QTest::addRow("threads=%d", threads) << threads;
+    QTest::addRow("threads=%d", idealThreadCount) << idealThreadCount;
+}
+
+void tst_renderer::bench_shader_precompile()
+{
+    QFETCH(int, threads);
+
+    QVERIFY(!shaderVariantLayer.children.isEmpty());
+    const auto &renderer = renderContext->renderer();
+    const auto &shaderCache = renderContext->shaderCache();
+    shaderCache->setMaxCompileThreads(threads);
+
+    QBENCHMARK {
+        // Start from empty caches every time, the layer's own shader map
+        // goes with its render data.
+        delete shaderVariantLayer.renderData;
+        shaderVariantLayer.renderData = nullptr;
+        shaderCache->releaseCachedResources();
+        shaderCache->persistentShaderBakingCache().clear();
+
+        renderer->beginFrame(shaderVariantLayer);
+        renderer->prepareLayerForRender(shaderVariantLayer);
+        QSSGRendererPrivate::precompileShaders(*renderer, shaderVariantLayer);
+        renderer->endFrame(shaderVariantLayer);
+    }
+
+    QVERIFY(!shaderCache->hasPendingCompilations());
+    QCOMPARE(int(shaderCache->persistentShaderBakingCache().availableEntries().size()), shaderVariantCount);
+}
+
+void tst_renderer::bench_shader_key_data()
+{
+    QTest::addColumn<bool>("binary");
+    QTest::newRow("string") << false;
+    QTest::newRow("binary") << true;
+}
+
+void tst_renderer::bench_shader_key()
+{
+    QFETCH(bool, binary);
+
+    QVERIFY(!layer.children.isEmpty());
+    const auto &renderer = renderContext->renderer();
+
+    // The material keys of all renderables, as they are after preparing
+    renderer->beginFrame(layer);
+    renderer->prepareLayerForRender(layer);
+    QSSGLayerRenderData *renderData = layer.renderData;
+    QVERIFY(renderData);
+    QVector<QSSGShaderDefaultMaterialKey> keys;
+    keys.reserve(modelCount);
+    for (const auto *list : { &renderData->getSortedOpaqueRenderableObjects(),
+                              &renderData->getSortedTransparentRenderableObjects() }) {
+        for (const QSSGRenderableObjectHandle &handle : *list) {
+            if (handle.obj->type == QSSGRenderableObject::Type::DefaultMaterialMeshSubset)
+                keys.append(static_cast<const QSSGSubsetRenderable *>(handle.obj)->shaderDescription);
+        }
+    }
+    renderer->endFrame(layer);
+    QVERIFY(!keys.isEmpty());
+
+    const QSSGShaderDefaultMaterialKeyProperties &keyProperties = renderData->getDefaultMaterialPropertyTable();
+    const QSSGShaderFeatures features = renderData->getShaderFeatures();
+
+    // A key for each renderable, hashed like for a lookup in the in-memory
+    // shader cache, either in the string form or in the binary one
+    QSet<size_t> hashes;
+    QByteArray shaderString;
+    QBENCHMARK {
+        hashes.clear();
+        for (const QSSGShaderDefaultMaterialKey &key : std::as_const(keys)) {
+            if (binary) {
+                hashes.insert(qHash(QSSGShaderMaterialKey(key, features)));
+            } else {
+                shaderString = QByteArrayLiteral("mesh default material pipeline-- ");
+                key.toString(shaderString, keyProperties);
+                QSSGShaderCacheKey cacheKey(shaderString);
+                cacheKey.m_features = features;
+                cacheKey.updateHashCode();
+                hashes.insert(qHash(cacheKey));
+            }
+        }
+    }
+
+    qInfo("%d renderables with %d distinct keys", int(keys.size()), int(hashes.size()));
+}
+
 QTEST_APPLESS_MAIN(tst_renderer)
 
 #include "tst_renderer.moc"
@@ -0,0 +1,325 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtTest>
+
+#include <QtQuick3DRuntimeRender/private/qssgrenderableobjects_p.h>
+#include <QtQuick3DRuntimeRender/private/qssgrenderablesort_p.h>
+#include <QtQuick3DUtils/private/qssgbounds3_p.h>
+
+#include <algorithm>
+
+class BenchRenderableSort : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void test_stateChanges();
+    void test_transparentOrder();
+    void test_temporalCoherence();
+    void bench_opaque_std_data();
+    void bench_opaque_std();
+    void bench_opaque_radix_data();
+    void bench_opaque_radix();
+    void bench_transparent_std_data();
+    void bench_transparent_std();
+    void bench_transparent_radix_data();
+    void bench_transparent_radix();
+    void bench_transparent_coherent_data();
+    void bench_transparent_coherent();
+
+private:
+    // A scene of objects sharing a limited set of materials, which in turn
+    // share a smaller set of shaders.
+    static constexpr int PipelineCount = 16;
+    static constexpr int MaterialCount = 200;
+
+    struct StateChanges
+    {
+        int pipelines = 0;
+        int materials = 0;
+    };
+
+    static void addObjectCountRows()
+    {
+        QTest::addColumn<int>("objectCount");
+        QTest::newRow("1k") << 1000;
+        QTest::newRow("10k") << 10000;
+        QTest::newRow("100k") << 100000;
+    }
+
+    void createObjects(int objectCount);
+    int indexOf(const QSSGRenderableObjectHandle &handle) const { return int(handle.obj - m_objects.constData()); }
+    StateChanges countStateChanges(const QSSGRenderableObjectList &list) const;
+    void opaqueKeys(const QSSGRenderableObjectList &list, std::vector<quint64> &keys) const;
+    void transparentKeys(const QSSGRenderableObjectList &list, std::vector<quint64> &keys) const;
+    void moveCamera(float amount);
+
+    QMatrix4x4 m_transform;
+    QSSGBounds3 m_bounds;
+    QList<QSSGRenderableObject> m_objects;
+    QList<int> m_materials;
+    QSSGRenderableObjectList m_renderables;
+    std::vector<QSSGRenderableSorter::Id> m_ids;
+};
+
+void BenchRenderableSort::initTestCase()
+{
+    m_bounds = QSSGBounds3({ -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f });
+}
+
+void BenchRenderableSort::createObjects(int objectCount)
+{
+    QRandomGenerator random(1234);
+    m_objects.clear();
+    m_materials.clear();
+    m_renderables.clear();
+    m_ids.clear();
+    m_objects.reserve(objectCount);
+    m_materials.reserve(objectCount);
+    m_renderables.reserve(objectCount);
+    for (int i = 0; i < objectCount; ++i) {
+        m_objects.push_back({ QSSGRenderableObject::Type::DefaultMaterialMeshSubset, QSSGRenderableObjectFlags(), {}, m_transform, m_bounds, 0.0f });
+        m_materials.push_back(random.bounded(MaterialCount));
+    }
+    // Only append once the list does not reallocate anymore
+    for (int i = 0; i < objectCount; ++i) {
+        m_renderables.push_back({ &m_objects[i], float(1.0 + random.bounded(999.0)) });
+        m_ids.push_back({ &m_objects[i], nullptr });
+    }
+}
+
+// A slow orbit only changes the distances a little from frame to frame
+void BenchRenderableSort::moveCamera(float amount)
+{
+    for (qsizetype i = 0; i < m_renderables.size(); ++i)
+        m_renderables[i].cameraDistanceSq += amount * float((i % 7) - 3);
+}
+
+BenchRenderableSort::StateChanges BenchRenderableSort::countStateChanges(const QSSGRenderableObjectList &list) const
+{
+    StateChanges changes;
+    int pipeline = -1;
+    int material = -1;
+    for (const auto &handle : list) {
+        const int m = m_materials.at(indexOf(handle));
+        const int p = m % PipelineCount;
+        if (p != pipeline)
+            ++changes.pipelines;
+        if (m != material)
+            ++changes.materials;
+        pipeline = p;
+        material = m;
+    }
+    return changes;
+}
+
+void BenchRenderableSort::opaqueKeys(const QSSGRenderableObjectList &list, std::vector<quint64> &keys) const
+{
+    keys.resize(size_t(list.size()));
+    for (qsizetype i = 0; i < list.size(); ++i) {
+        const int m = m_materials.at(indexOf(list.at(i)));
+        keys[i] = QSSGRenderableSorter::opaqueKey(quint32(m % PipelineCount), quint32(m), list.at(i).cameraDistanceSq);
+    }
+}
+
+void BenchRenderableSort::transparentKeys(const QSSGRenderableObjectList &list, std::vector<quint64> &keys) const
+{
+    keys.resize(size_t(list.size()));
+    for (qsizetype i = 0; i < list.size(); ++i)
+        keys[i] = QSSGRenderableSorter::transparentKey(list.at(i).cameraDistanceSq);
+}
+
+void BenchRenderableSort::test_stateChanges()
+{
+    createObjects(10000);
+
+    QSSGRenderableObjectList byDepth = m_renderables;
+    std::sort(byDepth.begin(), byDepth.end(), [](const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) {
+        return lhs.cameraDistanceSq < rhs.cameraDistanceSq;
+    });
+    const StateChanges before = countStateChanges(byDepth);
+
+    QSSGRenderableObjectList byKey = m_renderables;
+    std::vector<quint64> keys;
+    opaqueKeys(byKey, keys);
+    QSSGRenderableSorter sorter;
+    sorter.sort(byKey, keys.data());
+    const StateChanges after = countStateChanges(byKey);
+
+    qInfo("State changes per frame for %d objects, %d materials and %d pipelines:", int(m_renderables.size()), MaterialCount, PipelineCount);
+    qInfo("  depth sorted: %d pipeline changes, %d material changes", before.pipelines, before.materials);
+    qInfo("  key sorted:   %d pipeline changes, %d material changes", after.pipelines, after.materials);
+
+    // Every pipeline and material is bound once
+    QCOMPARE(after.pipelines, PipelineCount);
+    QCOMPARE(after.materials, MaterialCount);
+
+    // Still front to back within a material
+    for (qsizetype i = 1; i < byKey.size(); ++i) {
+        if (m_materials.at(indexOf(byKey.at(i))) == m_materials.at(indexOf(byKey.at(i - 1))))
+            QVERIFY(byKey.at(i - 1).cameraDistanceSq <= byKey.at(i).cameraDistanceSq);
+    }
+}
+
+void BenchRenderableSort::test_transparentOrder()
+{
+    createObjects(10000);
+
+    QSSGRenderableObjectList expected = m_renderables;
+    std::stable_sort(expected.begin(), expected.end(), [](const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) {
+        return lhs.cameraDistanceSq > rhs.cameraDistanceSq;
+    });
+
+    QSSGRenderableObjectList sorted = m_renderables;
+    QSSGRenderableSorter sorter;
+    sorter.sortTransparent(sorted);
+
+    for (qsizetype i = 0; i < sorted.size(); ++i)
+        QCOMPARE(sorted.at(i).obj, expected.at(i).obj);
+}
+
+void BenchRenderableSort::test_temporalCoherence()
+{
+    createObjects(10000);
+
+    QSSGRenderableSorter sorter;
+    QSSGRenderableSorter::History history;
+    std::vector<quint64> keys;
+    // Unchanged, slightly changed, and changed so much that the fix-up
+    // gives up.
+    for (float amount : { 0.0f, 0.0f, 0.01f, 0.5f, 100.0f, 0.0f }) {
+        moveCamera(amount);
+
+        QSSGRenderableObjectList expected = m_renderables;
+        std::sort(expected.begin(), expected.end(), [](const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) {
+            return lhs.cameraDistanceSq > rhs.cameraDistanceSq;
+        });
+
+        QSSGRenderableObjectList sorted = m_renderables;
+        transparentKeys(sorted, keys);
+        sorter.sort(sorted, keys.data(), m_ids.data(), &history);
+
+        // Objects at the same distance may be in a different order
+        for (qsizetype i = 0; i < sorted.size(); ++i)
+            QCOMPARE(sorted.at(i).cameraDistanceSq, expected.at(i).cameraDistanceSq);
+    }
+
+    // A different set of renderables is sorted from scratch
+    QSSGRenderableObjectList fewer = m_renderables.mid(0, 5000);
+    transparentKeys(fewer, keys);
+    sorter.sort(fewer, keys.data(), m_ids.data(), &history);
+    QCOMPARE(history.order.size(), size_t(fewer.size()));
+    for (qsizetype i = 1; i < fewer.size(); ++i)
+        QVERIFY(fewer.at(i - 1).cameraDistanceSq >= fewer.at(i).cameraDistanceSq);
+}
+
+void BenchRenderableSort::bench_opaque_std_data()
+{
+    addObjectCountRows();
+}
+
+void BenchRenderableSort::bench_opaque_std()
+{
+    QFETCH(int, objectCount);
+    createObjects(objectCount);
+
+    QSSGRenderableObjectList list;
+    QBENCHMARK {
+        list = m_renderables;
+        list.detach();
+        std::sort(list.begin(), list.end(), [](const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) {
+            return lhs.cameraDistanceSq < rhs.cameraDistanceSq;
+        });
+    }
+}
+
+void BenchRenderableSort::bench_opaque_radix_data()
+{
+    addObjectCountRows();
+}
+
+void BenchRenderableSort::bench_opaque_radix()
+{
+    QFETCH(int, objectCount);
+    createObjects(objectCount);
+
+    QSSGRenderableSorter sorter;
+    QSSGRenderableObjectList list;
+    std::vector<quint64> keys;
+    QBENCHMARK {
+        list = m_renderables;
+        list.detach();
+        opaqueKeys(list, keys);
+        sorter.sort(list, keys.data());
+    }
+}
+
+void BenchRenderableSort::bench_transparent_std_data()
+{
+    addObjectCountRows();
+}
+
+void BenchRenderableSort::bench_transparent_std()
+{
+    QFETCH(int, objectCount);
+    createObjects(objectCount);
+
+    QSSGRenderableObjectList list;
+    QBENCHMARK {
+        list = m_renderables;
+        list.detach();
+        std::sort(list.begin(), list.end(), [](const QSSGRenderableObjectHandle &lhs, const QSSGRenderableObjectHandle &rhs) {
+            return lhs.cameraDistanceSq > rhs.cameraDistanceSq;
+        });
+    }
+}
+
+void BenchRenderableSort::bench_transparent_radix_data()
+{
+    addObjectCountRows();
+}
+
+void BenchRenderableSort::bench_transparent_radix()
+{
+    QFETCH(int, objectCount);
+    createObjects(objectCount);
+
+    QSSGRenderableSorter sorter;
+    QSSGRenderableObjectList list;
+    QBENCHMARK {
+        list = m_renderables;
+        list.detach();
+        sorter.sortTransparent(list);
+    }
+}
+
+void BenchRenderableSort::bench_transparent_coherent_data()
+{
+    addObjectCountRows();
+}
+
+void BenchRenderableSort::bench_transparent_coherent()
+{
+    QFETCH(int, objectCount);
+    createObjects(objectCount);
+
+    QSSGRenderableSorter sorter;
+    QSSGRenderableSorter::History history;
+    QSSGRenderableObjectList list;
+    std::vector<quint64> keys;
+    float direction = 0.01f;
+    QBENCHMARK {
+        moveCamera(direction);
+        direction = -direction;
+        list = m_renderables;
+        list.detach();
+        transparentKeys(list, keys);
+        sorter.sort(list, keys.data(), m_ids.data(), &history);
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchRenderableSort)
+
+#include "tst_benchrenderablesort.moc"